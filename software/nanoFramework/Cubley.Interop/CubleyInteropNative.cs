@@ -142,4 +142,138 @@ namespace Cubley.Interop
         [MethodImpl(MethodImplOptions.InternalCall)]
         public static extern int NativeWrite(string text);
     }
+
+    /// <summary>
+    /// v1.x append-only W5500 receive slots. A separate class keeps them after
+    /// the baseline table instead of shifting the LNBH26 slots.
+    /// </summary>
+    public static class W5500SocketRx
+    {
+        /// <summary>
+        /// Read exactly count bytes into buffer[offset..] within timeoutMs. Returns a
+        /// W5500Socket.Status; on Timeout or a closed peer bytesRead holds the partial count.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeReceiveExact(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int bytesRead);
+
+        /// <summary>
+        /// Bytes waiting in the socket RX buffer, without consuming them.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativePeekAvailable(int socketHandle, out int available);
+
+        /// <summary>
+        /// Read one MQTT packet into buffer as [fixed header][variable header + payload]
+        /// (remaining length stripped). Returns a W5500Socket.Status; length is the packet
+        /// length, the required length on InvalidParam, or the partial count on a cut body.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeReceiveMqttFrame(int socketHandle, byte[] buffer, int timeoutMs, out int length);
+    }
+
+    public static class W5500SocketUdp
+    {
+        /// <summary>
+        /// Switch an open socket handle to UDP bound to localPort (0 picks a free source port).
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeBind(int socketHandle, int localPort);
+
+        /// <summary>
+        /// Send one datagram (1-1472 bytes) to host:port; host is a dotted quad,
+        /// 255.255.255.255 broadcasts. Returns a W5500Socket.Status.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeSendTo(int socketHandle, string host, int port, byte[] data, int offset, int count);
+
+        /// <summary>
+        /// Receive the next datagram into buffer[offset..] (up to count bytes, the rest of a
+        /// longer datagram is dropped). remoteAddress is the source IPv4 packed big-endian.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeReceiveFrom(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received, out uint remoteAddress, out int remotePort);
+    }
+
+    public static class W5500LinkProbe
+    {
+        /// <summary>
+        /// Put socket 0 in MACRAW mode and answer ARP / ping natively (false gives it back).
+        /// Returns a W5500Socket.Status; Busy while socket 0 is in use.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeEnable(bool enable);
+
+        /// <summary>
+        /// Answer queued frames, waiting up to timeoutMs for the first; handled counts them.
+        /// Frames are also answered from every other socket wait.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeService(int timeoutMs, out int handled);
+
+        /// <summary>
+        /// Counters since the probe was enabled; echo times run from request read to reply sent (us).
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeGetStats(out uint frames, out uint arpReplies, out uint echoReplies, out uint dropped, out uint lastEchoUs, out uint maxEchoUs);
+    }
+
+    public static class W5500SocketReconnect
+    {
+        /// <summary>
+        /// Hand an open socket handle to the native reconnect thread: it connects to host:port
+        /// in the background and reconnects after drops with jittered exponential backoff.
+        /// Returns a W5500Socket.Status; Busy while the socket is already supervised.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeStart(int socketHandle, string host, int port, int connectTimeoutMs, int minBackoffMs, int maxBackoffMs);
+
+        /// <summary>
+        /// Stop supervising the socket and disconnect it; the handle stays open.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeStop(int socketHandle);
+
+        /// <summary>
+        /// Supervised connection state (W5500Socket.ConnectionState) with the connect and
+        /// attempt counters; send and receive are usable while the state is Established.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeGetState(int socketHandle, out int state, out int connects, out int attempts);
+    }
+
+    public static class W5500SocketTx
+    {
+        /// <summary>
+        /// Send data[offset..offset+count) of any length, writing as much as the TX buffer
+        /// holds and continuing as space frees up, all within timeoutMs. With waitForSendOk
+        /// false it returns once the last SEND is issued. sent counts bytes committed.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeSendStream(int socketHandle, byte[] data, int offset, int count, int timeoutMs, bool waitForSendOk, out int sent);
+    }
+
+    public static class W5500MqttKeepAlive
+    {
+        /// <summary>
+        /// Keep an established MQTT session alive natively: a PINGREQ is sent after
+        /// keepAliveSeconds / 2 without a send and its PINGRESP never reaches
+        /// NativeReceiveMqttFrame; an unanswered ping disconnects. Call after CONNACK.
+        /// Returns a W5500Socket.Status; NotInitialized unless the socket is connected.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeStart(int socketHandle, int keepAliveSeconds);
+
+        /// <summary>
+        /// Stop pinging; disconnecting the socket also stops it.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeStop(int socketHandle);
+
+        /// <summary>
+        /// Ping counters since the last NativeStart; missed counts connections dropped for
+        /// an unanswered PINGREQ. Returns NotInitialized once keep-alive has stopped.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        public static extern int NativeGetStats(int socketHandle, out uint pingsSent, out uint pingResponses, out uint missed);
+    }
 }
@@ -6,12 +6,24 @@ namespace DiSEqC_Control.Mqtt
     {
         W5500Socket.Status Open(out int socketHandle);
 
-        W5500Socket.Status Connect(int socketHandle, string host, int port, int timeoutMs);
+        W5500Socket.Status StartReconnect(int socketHandle, string host, int port, int connectTimeoutMs, int minBackoffMs, int maxBackoffMs);
 
-        W5500Socket.Status Send(int socketHandle, byte[] data, int offset, int count, out int sent);
+        W5500Socket.Status GetConnectionState(int socketHandle, out W5500Socket.ConnectionState state, out int connects, out int attempts);
+
+        W5500Socket.Status WaitForConnectionState(int socketHandle, W5500Socket.ConnectionState state, int timeoutMs);
+
+        W5500Socket.Status StartMqttKeepAlive(int socketHandle, int keepAliveSeconds);
+
+        W5500Socket.Status SendStream(int socketHandle, byte[] data, int offset, int count, int timeoutMs, bool waitForSendOk, out int sent);
 
         W5500Socket.Status Receive(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received);
 
+        W5500Socket.Status ReceiveExact(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received);
+
+        W5500Socket.Status PeekAvailable(int socketHandle, out int available);
+
+        W5500Socket.Status ReceiveMqttFrame(int socketHandle, byte[] buffer, int timeoutMs, out int length);
+
         W5500Socket.Status Close(int socketHandle);
 
         bool IsConnected(int socketHandle);
@@ -8,25 +8,30 @@ namespace DiSEqC_Control.Mqtt
     /// Replaces the previous M2Mqtt-based facade; avoids any dependency on System.Net.
     ///
     /// Supports QoS 0 publish/receive and QoS 0/1 subscribe. PINGREQ keep-alive is
-    /// driven by an internal timer thread. A reader thread parses incoming packets
-    /// and fires <see cref="MessageReceived"/> for PUBLISH frames.
+    /// offloaded to the W5500 driver once CONNACK is in. A reader thread parses
+    /// incoming packets and fires <see cref="MessageReceived"/> for PUBLISH frames.
     /// </summary>
     internal sealed class MqttClient
     {
         public delegate void MessageReceivedEventHandler(string topic, byte[] payload);
         public delegate void ConnectionClosedEventHandler();
 
+        // Initial receive buffer; it only grows when a larger packet arrives.
+        private const int InitialReceiveBufferSize = 256;
+
         private readonly W5500MqttNetworkChannelCore _channel;
         private readonly object _writeLock = new object();
         private readonly object _stateLock = new object();
 
+        // Reused for every incoming packet (CONNACK, then only the reader thread):
+        // [0] fixed header, [1..] variable header + payload.
+        private byte[] _receiveBuffer = new byte[InitialReceiveBufferSize];
+
         private Thread _readerThread;
-        private Thread _keepAliveThread;
         private bool _running;
         private bool _connected;
         private ushort _nextPacketId = 1;
         private int _keepAliveSeconds;
-        private long _lastWriteTicksMs;
 
         public event MessageReceivedEventHandler MessageReceived;
         public event ConnectionClosedEventHandler ConnectionClosed;
@@ -42,6 +47,12 @@ namespace DiSEqC_Control.Mqtt
             get { lock (_stateLock) { return _connected; } }
         }
 
+        /// <summary>
+        /// True when the last Connect threw after the channel had waited out its whole
+        /// connect timeout, i.e. the caller has already paused for the native backoff.
+        /// </summary>
+        public bool ConnectWaitTimedOut => _channel.ConnectWaitTimedOut;
+
         /// <summary>
         /// Opens the TCP connection, sends CONNECT, waits for CONNACK.
         /// Returns the CONNACK return code (0 = accepted).
@@ -77,36 +88,51 @@ namespace DiSEqC_Control.Mqtt
             System.Threading.Thread.Sleep(800);
 
             // Wait synchronously for CONNACK before starting reader.
-            byte[] fixedAndPayload = ReadOnePacket(connAckTimeoutMs);
-            BringupBeacon(0xD4, (byte)(fixedAndPayload == null ? 0xFF : fixedAndPayload.Length));
+            int packetLength = ReadOnePacket(connAckTimeoutMs);
+            BringupBeacon(0xD4, (byte)(packetLength < 0 ? 0xFF : packetLength));
             System.Threading.Thread.Sleep(800);
-            if (fixedAndPayload == null)
+            if (packetLength < 0)
             {
                 throw new InvalidOperationException("Timed out waiting for CONNACK");
             }
 
-            byte type = (byte)(fixedAndPayload[0] & 0xF0);
-            if (type != MqttPacket.TypeConnAck)
+            byte type = (byte)(_receiveBuffer[0] & 0xF0);
+            if (type != MqttPacket.TypeConnAck || packetLength < 3)
             {
                 throw new InvalidOperationException("Expected CONNACK, got 0x" + type.ToString("X2"));
             }
 
-            // Variable-header bytes start after the fixed header. ReadOnePacket returns
-            // [fixedHeaderByte][... varint length bytes already stripped ...][variable+payload].
-            // Convention: fixedAndPayload[0] = fixed header byte, fixedAndPayload[1..] = variable+payload.
-            byte returnCode = fixedAndPayload[2];
+            // ReadOnePacket leaves [fixedHeaderByte][variable+payload] in _receiveBuffer
+            // (remaining-length varint stripped): [1] = ack flags, [2] = return code.
+            byte returnCode = _receiveBuffer[2];
+
+            if (returnCode == MqttPacket.ConnAckAccepted && keepAliveSeconds > 0)
+            {
+                // PINGREQ / PINGRESP are handled natively from here on.
+                try
+                {
+                    _channel.StartKeepAlive(keepAliveSeconds);
+                }
+                catch
+                {
+                    // The broker has accepted a session on this connection. Drop it, so
+                    // the next Connect opens a new one instead of sending a second
+                    // CONNECT on this one.
+                    try { _channel.Close(); } catch { }
+                    throw;
+                }
+            }
 
             lock (_stateLock)
             {
                 _connected = (returnCode == MqttPacket.ConnAckAccepted);
                 _running = _connected;
                 _keepAliveSeconds = keepAliveSeconds;
-                _lastWriteTicksMs = NowMs();
             }
 
             if (_connected)
             {
-                StartBackgroundThreads();
+                StartReaderThread();
             }
 
             return returnCode;
@@ -157,13 +183,10 @@ namespace DiSEqC_Control.Mqtt
             RaiseConnectionClosed();
         }
 
-        private void StartBackgroundThreads()
+        private void StartReaderThread()
         {
             _readerThread = new Thread(ReaderLoop);
             _readerThread.Start();
-
-            _keepAliveThread = new Thread(KeepAliveLoop);
-            _keepAliveThread.Start();
         }
 
         private void ReaderLoop()
@@ -174,61 +197,29 @@ namespace DiSEqC_Control.Mqtt
                 {
                     lock (_stateLock) { if (!_running) return; }
 
-                    byte[] packet = ReadOnePacket(_keepAliveSeconds > 0 ? (_keepAliveSeconds * 1000 * 2) : 5000);
-                    if (packet == null) continue;
+                    int packetLength = ReadOnePacket(_keepAliveSeconds > 0 ? (_keepAliveSeconds * 1000 * 2) : 5000);
+                    if (packetLength < 0) continue;
 
-                    HandleIncoming(packet);
+                    HandleIncoming(_receiveBuffer, packetLength);
                 }
             }
             catch (Exception)
             {
-                // Drop the connection on any read/parse error.
+                // Drop the connection on any read/parse error. That includes the broker
+                // closing it and the native thread having reconnected underneath (the
+                // channel reports both), so Program sends a fresh CONNECT.
                 lock (_stateLock) { _connected = false; _running = false; }
                 try { _channel.Close(); } catch { }
                 RaiseConnectionClosed();
             }
         }
 
-        private void KeepAliveLoop()
-        {
-            // Send PINGREQ when more than half the keep-alive interval has elapsed
-            // since the last write, so the broker never sees us go silent.
-            int interval = _keepAliveSeconds > 0 ? (_keepAliveSeconds * 1000) / 2 : 0;
-            if (interval <= 0) return;
-
-            while (true)
-            {
-                Thread.Sleep(interval);
-                lock (_stateLock) { if (!_running) return; }
-
-                long now = NowMs();
-                long last;
-                lock (_stateLock) { last = _lastWriteTicksMs; }
-
-                if ((now - last) >= interval)
-                {
-                    try
-                    {
-                        WriteRaw(MqttPacket.EncodeBare(MqttPacket.TypePingReq));
-                    }
-                    catch
-                    {
-                        return;
-                    }
-                }
-            }
-        }
-
-        private void HandleIncoming(byte[] packet)
+        private void HandleIncoming(byte[] packet, int length)
         {
             byte type = (byte)(packet[0] & 0xF0);
             if (type == MqttPacket.TypePublish)
             {
-                int variableLen = packet.Length - 1;
-                byte[] variablePayload = new byte[variableLen];
-                Array.Copy(packet, 1, variablePayload, 0, variableLen);
-
-                MqttPacket.DecodePublish(packet[0], variablePayload, out string topic, out byte[] payload, out byte qos, out ushort packetId);
+                MqttPacket.DecodePublish(packet[0], packet, 1, length - 1, out string topic, out byte[] payload, out byte qos, out ushort packetId);
 
                 if (qos == 1)
                 {
@@ -241,58 +232,32 @@ namespace DiSEqC_Control.Mqtt
                     try { handler(topic, payload); } catch { }
                 }
             }
-            // CONNACK / SUBACK / PUBACK / PINGRESP / UNSUBACK: consume silently.
+            // CONNACK / SUBACK / PUBACK / UNSUBACK: consume silently. PINGRESP never
+            // gets here; the native keep-alive swallows it.
         }
 
         /// <summary>
-        /// Reads one full MQTT packet from the channel.
-        /// Returns a byte array where index 0 is the fixed-header byte and indices 1..N-1
-        /// are the variable header + payload. The remaining-length varint is stripped.
-        /// Returns null on timeout (no header byte received).
+        /// Reads one full MQTT packet from the channel into <see cref="_receiveBuffer"/>:
+        /// index 0 is the fixed-header byte and indices 1..N-1 are the variable header +
+        /// payload. The remaining-length varint is decoded natively from the W5500 RX
+        /// buffer, so a packet is one interop call and costs no allocation unless it
+        /// outgrows the buffer. Returns N, or -1 on timeout (nothing received).
         /// </summary>
-        private byte[] ReadOnePacket(int timeoutMs)
+        private int ReadOnePacket(int timeoutMs)
         {
-            byte[] one = new byte[1];
-            int got = _channel.Receive(one, timeoutMs);
-            if (got == 0) return null;
-
-            byte fixedHeader = one[0];
-
-            // Read remaining-length varint, one byte at a time.
-            byte[] lenBytes = new byte[4];
-            int lenCount = 0;
-            int multiplier = 1;
-            int value = 0;
-            byte b;
-            do
+            int length = _channel.ReceiveMqttFrame(_receiveBuffer, timeoutMs);
+            if (length < 0)
             {
-                int rd = _channel.Receive(one, timeoutMs);
-                if (rd == 0) throw new InvalidOperationException("Truncated remaining-length");
-                b = one[0];
-                lenBytes[lenCount++] = b;
-                value += (b & 0x7F) * multiplier;
-                multiplier *= 128;
-                if (multiplier > 128 * 128 * 128 * 128)
+                // Nothing consumed yet: grow to the reported size and read it again.
+                _receiveBuffer = new byte[-length];
+                length = _channel.ReceiveMqttFrame(_receiveBuffer, timeoutMs);
+                if (length < 0)
                 {
-                    throw new InvalidOperationException("Malformed remaining length");
+                    throw new InvalidOperationException("MQTT packet size changed while reading");
                 }
-            } while ((b & 0x80) != 0);
-
-            byte[] body = new byte[value];
-            int offset = 0;
-            while (offset < value)
-            {
-                byte[] chunk = new byte[value - offset];
-                int rd = _channel.Receive(chunk, timeoutMs);
-                if (rd == 0) throw new InvalidOperationException("Truncated MQTT body");
-                Array.Copy(chunk, 0, body, offset, rd);
-                offset += rd;
             }
 
-            byte[] packet = new byte[1 + value];
-            packet[0] = fixedHeader;
-            if (value > 0) Array.Copy(body, 0, packet, 1, value);
-            return packet;
+            return length == 0 ? -1 : length;
         }
 
         private void WriteRaw(byte[] packet)
@@ -301,7 +266,6 @@ namespace DiSEqC_Control.Mqtt
             {
                 _channel.Send(packet);
             }
-            lock (_stateLock) { _lastWriteTicksMs = NowMs(); }
         }
 
         private ushort NextPacketId()
@@ -329,11 +293,6 @@ namespace DiSEqC_Control.Mqtt
             }
         }
 
-        private static long NowMs()
-        {
-            return DateTime.UtcNow.Ticks / TimeSpan.TicksPerMillisecond;
-        }
-
         private static void BringupBeacon(byte stage, byte detail)
         {
             try
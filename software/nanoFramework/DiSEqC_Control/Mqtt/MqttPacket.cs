@@ -163,17 +163,26 @@ namespace DiSEqC_Control.Mqtt
         /// Decodes a PUBLISH packet's variable header and payload (after the fixed header).
         /// </summary>
         public static void DecodePublish(byte fixedHeader, byte[] variablePayload, out string topic, out byte[] payload, out byte qos, out ushort packetId)
+        {
+            DecodePublish(fixedHeader, variablePayload, 0, variablePayload.Length, out topic, out payload, out qos, out packetId);
+        }
+
+        /// <summary>
+        /// Decode a PUBLISH whose variable header + payload sit at buffer[offset..offset+length),
+        /// e.g. inside a reused receive buffer.
+        /// </summary>
+        public static void DecodePublish(byte fixedHeader, byte[] buffer, int offset, int length, out string topic, out byte[] payload, out byte qos, out ushort packetId)
         {
             qos = (byte)((fixedHeader >> 1) & 0x03);
-            int p = 0;
-            int topicLen = (variablePayload[p] << 8) | variablePayload[p + 1];
+            int p = offset;
+            int topicLen = (buffer[p] << 8) | buffer[p + 1];
             p += 2;
-            topic = AsciiCodec.GetString(variablePayload, p, topicLen);
+            topic = AsciiCodec.GetString(buffer, p, topicLen);
             p += topicLen;
 
             if (qos > 0)
             {
-                packetId = (ushort)((variablePayload[p] << 8) | variablePayload[p + 1]);
+                packetId = (ushort)((buffer[p] << 8) | buffer[p + 1]);
                 p += 2;
             }
             else
@@ -181,11 +190,11 @@ namespace DiSEqC_Control.Mqtt
                 packetId = 0;
             }
 
-            int payloadLen = variablePayload.Length - p;
+            int payloadLen = offset + length - p;
             payload = new byte[payloadLen];
             if (payloadLen > 0)
             {
-                Array.Copy(variablePayload, p, payload, 0, payloadLen);
+                Array.Copy(buffer, p, payload, 0, payloadLen);
             }
         }
 
@@ -5,6 +5,16 @@ namespace DiSEqC_Control.Mqtt
 {
     internal sealed class W5500MqttNetworkChannelCore
     {
+        // Native reconnect policy: each SYN gets ReconnectAttemptTimeoutMs, failed attempts
+        // back off from ReconnectMinBackoffMs doubling up to ReconnectMaxBackoffMs.
+        private const int ReconnectAttemptTimeoutMs = 3000;
+        private const int ReconnectMinBackoffMs = 250;
+        private const int ReconnectMaxBackoffMs = 8000;
+
+        // Sends stream through the TX buffer without waiting for SENDOK: TCP delivers
+        // the bytes, and a failed SEND shows up on the next send or as a dropped socket.
+        private const int SendTimeoutMs = 5000;
+
         private readonly string _remoteHost;
         private readonly int _remotePort;
         private readonly int _defaultConnectTimeoutMs;
@@ -13,6 +23,11 @@ namespace DiSEqC_Control.Mqtt
 
         private int _socketHandle = -1;
 
+        // Native connect count when the current session came up. The reconnect thread
+        // replaces a dropped connection on the same socket; a new count means the broker
+        // has never seen CONNECT on it, so the channel reports itself disconnected.
+        private int _sessionConnects = -1;
+
         public W5500MqttNetworkChannelCore(
             string remoteHost,
             int remotePort,
@@ -27,10 +42,32 @@ namespace DiSEqC_Control.Mqtt
             _socketApi = socketApi;
         }
 
+        /// <summary>
+        /// True when the last Connect failed after waiting its whole connect timeout for the
+        /// native reconnect thread; false when it returned or failed without that wait.
+        /// </summary>
+        public bool ConnectWaitTimedOut { get; private set; }
+
         public bool DataAvailable => _socketHandle >= 0 && _socketApi.IsConnected(_socketHandle);
 
+        /// <summary>
+        /// Bytes that can be read without blocking; 0 when nothing is pending.
+        /// </summary>
+        public int Available
+        {
+            get
+            {
+                EnsureConnected();
+
+                W5500Socket.Status peekStatus = _socketApi.PeekAvailable(_socketHandle, out int available);
+                EnsureSuccess(peekStatus, "query W5500 receive buffer");
+                return available;
+            }
+        }
+
         public void Connect()
         {
+            ConnectWaitTimedOut = false;
             BringupBeacon(0xC0, 0x00);
             System.Threading.Thread.Sleep(800);
             if (string.IsNullOrEmpty(_remoteHost) || _remotePort < 1 || _remotePort > 65535)
@@ -44,31 +81,57 @@ namespace DiSEqC_Control.Mqtt
             if (_socketHandle >= 0 && _socketApi.IsConnected(_socketHandle))
             {
                 BringupBeacon(0xC1, 0x01);
+                TrackSession();
                 return;
             }
 
-            BringupBeacon(0xC2, 0x00);
+            // A socket left over from an earlier call is still supervised natively and
+            // reconnecting on its own, so it is waited on rather than reopened.
+            BringupBeacon(0xC2, (byte)(_socketHandle >= 0 ? 0x01 : 0x00));
             System.Threading.Thread.Sleep(800);
-            Close();
+            if (_socketHandle < 0)
+            {
+                BringupBeacon(0xC3, 0x00);
+                System.Threading.Thread.Sleep(800);
+                int socketHandle;
+                W5500Socket.Status openStatus = _socketApi.Open(out socketHandle);
+                BringupBeacon(0xC4, (byte)(((int)openStatus & 0x0F) | ((socketHandle & 0x0F) << 4)));
+                System.Threading.Thread.Sleep(800);
+                EnsureSuccess(openStatus, "open W5500 socket");
 
-            BringupBeacon(0xC3, 0x00);
-            System.Threading.Thread.Sleep(800);
-            int socketHandle;
-            W5500Socket.Status openStatus = _socketApi.Open(out socketHandle);
-            BringupBeacon(0xC4, (byte)(((int)openStatus & 0x0F) | ((socketHandle & 0x0F) << 4)));
-            System.Threading.Thread.Sleep(800);
-            EnsureSuccess(openStatus, "open W5500 socket");
+                BringupBeacon(0xC5, 0x00);
+                System.Threading.Thread.Sleep(800);
+                W5500Socket.Status startStatus = _socketApi.StartReconnect(
+                    socketHandle, _remoteHost, _remotePort,
+                    ReconnectAttemptTimeoutMs, ReconnectMinBackoffMs, ReconnectMaxBackoffMs);
+                BringupBeacon(0xC6, (byte)startStatus);
+                System.Threading.Thread.Sleep(800);
+                if (startStatus != W5500Socket.Status.Ok)
+                {
+                    _socketApi.Close(socketHandle);
+                }
 
-            BringupBeacon(0xC5, 0x00);
-            System.Threading.Thread.Sleep(800);
-            W5500Socket.Status connectStatus = _socketApi.Connect(socketHandle, _remoteHost, _remotePort, _defaultConnectTimeoutMs);
-            BringupBeacon(0xC6, (byte)connectStatus);
-            System.Threading.Thread.Sleep(800);
-            EnsureSuccess(connectStatus, "connect W5500 socket");
+                EnsureSuccess(startStatus, "start W5500 reconnect");
+                _socketHandle = socketHandle;
+            }
 
-            _socketHandle = socketHandle;
-            BringupBeacon(0xC7, 0x00);
+            // On timeout the socket stays supervised; the next Connect picks up its progress.
+            W5500Socket.Status waitStatus = _socketApi.WaitForConnectionState(
+                _socketHandle, W5500Socket.ConnectionState.Established, _defaultConnectTimeoutMs);
+            BringupBeacon(0xC7, (byte)waitStatus);
             System.Threading.Thread.Sleep(800);
+            ConnectWaitTimedOut = waitStatus == W5500Socket.Status.Timeout;
+            EnsureSuccess(waitStatus, "connect W5500 socket");
+            TrackSession();
+        }
+
+        // The caller is about to send CONNECT on whatever connection is up now.
+        private void TrackSession()
+        {
+            W5500Socket.Status stateStatus = _socketApi.GetConnectionState(
+                _socketHandle, out W5500Socket.ConnectionState state, out int connects, out int attempts);
+            EnsureSuccess(stateStatus, "query W5500 connection state");
+            _sessionConnects = connects;
         }
 
         private static void BringupBeacon(byte stage, byte detail)
@@ -83,6 +146,16 @@ namespace DiSEqC_Control.Mqtt
             }
         }
 
+        /// <summary>
+        /// Let the W5500 driver send PINGREQ and swallow PINGRESP for this session.
+        /// Call after every accepted CONNACK; a reconnect stops it.
+        /// </summary>
+        public void StartKeepAlive(int keepAliveSeconds)
+        {
+            EnsureConnected();
+            EnsureSuccess(_socketApi.StartMqttKeepAlive(_socketHandle, keepAliveSeconds), "start MQTT keep-alive");
+        }
+
         public int Send(byte[] buffer)
         {
             BringupBeacon(0xE0, (byte)(buffer == null ? 0xFF : buffer.Length));
@@ -103,7 +176,7 @@ namespace DiSEqC_Control.Mqtt
             {
                 BringupBeacon(0xE4, (byte)remaining);
                 System.Threading.Thread.Sleep(800);
-                W5500Socket.Status sendStatus = _socketApi.Send(_socketHandle, buffer, offset, remaining, out int sent);
+                W5500Socket.Status sendStatus = _socketApi.SendStream(_socketHandle, buffer, offset, remaining, SendTimeoutMs, false, out int sent);
                 BringupBeacon(0xE2, (byte)(((int)sendStatus & 0x0F) | ((sent & 0x0F) << 4)));
                 System.Threading.Thread.Sleep(800);
                 EnsureSuccess(sendStatus, "send W5500 payload");
@@ -151,6 +224,77 @@ namespace DiSEqC_Control.Mqtt
             return received;
         }
 
+        /// <summary>
+        /// Fill buffer[offset..offset+count) within one overall timeout. Returns the
+        /// number of bytes read: count on success, less when the timeout expired first.
+        /// </summary>
+        public int ReceiveExact(byte[] buffer, int offset, int count, int timeout)
+        {
+            if (buffer == null)
+            {
+                throw new ArgumentNullException(nameof(buffer));
+            }
+
+            if (timeout < 0)
+            {
+                timeout = _defaultReceiveTimeoutMs;
+            }
+
+            EnsureConnected();
+
+            W5500Socket.Status receiveStatus = _socketApi.ReceiveExact(_socketHandle, buffer, offset, count, timeout, out int received);
+            if (receiveStatus == W5500Socket.Status.Timeout)
+            {
+                return received;
+            }
+
+            EnsureSuccess(receiveStatus, "receive W5500 payload");
+            return received;
+        }
+
+        /// <summary>
+        /// Reads one MQTT packet into buffer as [fixed header][variable header + payload]
+        /// with the remaining length stripped, in a single native call. Returns its length,
+        /// 0 on timeout, or the negated required length when buffer is too small (nothing
+        /// is consumed, so the caller can grow the buffer and call again).
+        /// </summary>
+        public int ReceiveMqttFrame(byte[] buffer, int timeout)
+        {
+            if (buffer == null)
+            {
+                throw new ArgumentNullException(nameof(buffer));
+            }
+
+            if (timeout < 0)
+            {
+                timeout = _defaultReceiveTimeoutMs;
+            }
+
+            EnsureConnected();
+
+            W5500Socket.Status receiveStatus = _socketApi.ReceiveMqttFrame(_socketHandle, buffer, timeout, out int length);
+            if (receiveStatus == W5500Socket.Status.InvalidParam && length > buffer.Length)
+            {
+                return -length;
+            }
+
+            if (receiveStatus == W5500Socket.Status.Timeout)
+            {
+                if (length != 0)
+                {
+                    throw new InvalidOperationException("Truncated MQTT packet");
+                }
+
+                return 0;
+            }
+
+            EnsureSuccess(receiveStatus, "receive MQTT packet");
+            return length;
+        }
+
+        /// <summary>
+        /// Releases the socket, which also stops its native reconnect supervision.
+        /// </summary>
         public void Close()
         {
             if (_socketHandle < 0)
@@ -160,14 +304,27 @@ namespace DiSEqC_Control.Mqtt
 
             _socketApi.Close(_socketHandle);
             _socketHandle = -1;
+            _sessionConnects = -1;
         }
 
         private void EnsureConnected()
         {
-            if (_socketHandle < 0 || !_socketApi.IsConnected(_socketHandle))
+            if (_socketHandle < 0)
+            {
+                throw new InvalidOperationException("W5500 MQTT channel is not connected");
+            }
+
+            W5500Socket.Status stateStatus = _socketApi.GetConnectionState(
+                _socketHandle, out W5500Socket.ConnectionState state, out int connects, out int attempts);
+            if (stateStatus != W5500Socket.Status.Ok || state != W5500Socket.ConnectionState.Established)
             {
                 throw new InvalidOperationException("W5500 MQTT channel is not connected");
             }
+
+            if (connects != _sessionConnects)
+            {
+                throw new InvalidOperationException("W5500 MQTT channel reconnected; the MQTT session is gone");
+            }
         }
 
         private static void EnsureSuccess(W5500Socket.Status status, string operation)
@@ -9,14 +9,29 @@ namespace DiSEqC_Control.Mqtt
             return W5500Socket.Open(out socketHandle);
         }
 
-        public W5500Socket.Status Connect(int socketHandle, string host, int port, int timeoutMs)
+        public W5500Socket.Status StartReconnect(int socketHandle, string host, int port, int connectTimeoutMs, int minBackoffMs, int maxBackoffMs)
         {
-            return W5500Socket.Connect(socketHandle, host, port, timeoutMs);
+            return W5500Socket.StartReconnect(socketHandle, host, port, connectTimeoutMs, minBackoffMs, maxBackoffMs);
         }
 
-        public W5500Socket.Status Send(int socketHandle, byte[] data, int offset, int count, out int sent)
+        public W5500Socket.Status GetConnectionState(int socketHandle, out W5500Socket.ConnectionState state, out int connects, out int attempts)
         {
-            return W5500Socket.Send(socketHandle, data, offset, count, out sent);
+            return W5500Socket.GetConnectionState(socketHandle, out state, out connects, out attempts);
+        }
+
+        public W5500Socket.Status WaitForConnectionState(int socketHandle, W5500Socket.ConnectionState state, int timeoutMs)
+        {
+            return W5500ConnectionEvents.WaitForState(socketHandle, state, timeoutMs);
+        }
+
+        public W5500Socket.Status StartMqttKeepAlive(int socketHandle, int keepAliveSeconds)
+        {
+            return W5500Socket.StartMqttKeepAlive(socketHandle, keepAliveSeconds);
+        }
+
+        public W5500Socket.Status SendStream(int socketHandle, byte[] data, int offset, int count, int timeoutMs, bool waitForSendOk, out int sent)
+        {
+            return W5500Socket.SendStream(socketHandle, data, offset, count, timeoutMs, waitForSendOk, out sent);
         }
 
         public W5500Socket.Status Receive(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received)
@@ -24,6 +39,21 @@ namespace DiSEqC_Control.Mqtt
             return W5500Socket.Receive(socketHandle, buffer, offset, count, timeoutMs, out received);
         }
 
+        public W5500Socket.Status ReceiveExact(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received)
+        {
+            return W5500Socket.ReceiveExact(socketHandle, buffer, offset, count, timeoutMs, out received);
+        }
+
+        public W5500Socket.Status PeekAvailable(int socketHandle, out int available)
+        {
+            return W5500Socket.PeekAvailable(socketHandle, out available);
+        }
+
+        public W5500Socket.Status ReceiveMqttFrame(int socketHandle, byte[] buffer, int timeoutMs, out int length)
+        {
+            return W5500Socket.ReceiveMqttFrame(socketHandle, buffer, timeoutMs, out length);
+        }
+
         public W5500Socket.Status Close(int socketHandle)
         {
             return W5500Socket.Close(socketHandle);
@@ -16,7 +16,62 @@ namespace DiSEqC_Control.Native
             Ok = 0,
             Busy = 1,
             InvalidParam = 2,
-            Timeout = 3
+            Timeout = 3,
+            ReplyError = 4,
+            LnbError = 5,
+            NotFound = 6,
+            Aborted = 7
+        }
+
+        /// <summary>
+        /// Largest satellite table blob returned by ExportSatelliteTable (bytes)
+        /// </summary>
+        public const int SatelliteTableBlobMax = 8 + 24 * 8;
+
+        /// <summary>
+        /// Mini-DiSEqC tone burst
+        /// </summary>
+        public enum Burst
+        {
+            SatA = 0,
+            SatB = 1,
+            None = 2
+        }
+
+        /// <summary>
+        /// CustomEvent sub-category posted by native code when queued frames complete.
+        /// data1 carries the completion flags, data2 the newest completed ticket.
+        /// </summary>
+        public const byte CompletionEventSubCategory = 0xD5;
+
+        /// <summary>
+        /// Completion flag: a queued frame finished transmitting.
+        /// </summary>
+        public const ushort CompletionFlagFrameDone = 0x01;
+
+        /// <summary>
+        /// Completion flag: the queue drained and the bus is idle.
+        /// </summary>
+        public const ushort CompletionFlagIdle = 0x02;
+
+        /// <summary>
+        /// Completion flag: the estimated rotor motion finished (dish settled).
+        /// </summary>
+        public const ushort CompletionFlagSettled = 0x04;
+
+        /// <summary>
+        /// Completion flag: the queue was flushed by an abort; dropped tickets never complete.
+        /// </summary>
+        public const ushort CompletionFlagAborted = 0x08;
+
+        /// <summary>
+        /// Rotor motion estimator state
+        /// </summary>
+        public enum Motion
+        {
+            Settled = 0,
+            Moving = 1,
+            Driving = 2
         }
 
         /// <summary>
@@ -30,6 +85,42 @@ namespace DiSEqC_Control.Native
             return (Status)result;
         }
 
+        /// <summary>
+        /// Set the dish site used for USALS
+        /// </summary>
+        /// <param name="latitude">Degrees, North positive</param>
+        /// <param name="longitude">Degrees, East positive</param>
+        /// <returns>Status code</returns>
+        public static Status SetSite(float latitude, float longitude)
+        {
+            if (latitude < -90f || latitude > 90f || longitude < -180f || longitude > 180f)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeSetSite(ToMillidegrees(latitude), ToMillidegrees(longitude));
+        }
+
+        /// <summary>
+        /// Drive to a satellite longitude using USALS (motor angle computed natively)
+        /// </summary>
+        /// <param name="satelliteLongitude">Degrees, East positive</param>
+        /// <returns>Status code (NotFound without a site, InvalidParam below the horizon)</returns>
+        public static Status GotoLongitude(float satelliteLongitude)
+        {
+            if (satelliteLongitude < -180f || satelliteLongitude > 180f)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeGotoUsals(ToMillidegrees(satelliteLongitude));
+        }
+
+        private static int ToMillidegrees(float degrees)
+        {
+            return (int)(degrees * 1000f + (degrees < 0 ? -0.5f : 0.5f));
+        }
+
         /// <summary>
         /// Transmit raw DiSEqC command bytes
         /// </summary>
@@ -47,7 +138,220 @@ namespace DiSEqC_Control.Native
         }
 
         /// <summary>
-        /// Send halt command to stop rotor movement
+        /// Queue raw DiSEqC command bytes without waiting for the bus.
+        /// Frames are sent back to back with the 15 ms inter-message gap inserted natively.
+        /// </summary>
+        /// <param name="data">Command bytes (1-6 bytes)</param>
+        /// <param name="ticket">Completion ticket, reported by the completion event</param>
+        /// <returns>Status code (Busy when the native queue is full)</returns>
+        public static Status Enqueue(byte[] data, out uint ticket)
+        {
+            ticket = 0;
+
+            if (data == null || data.Length == 0 || data.Length > 6)
+            {
+                return Status.InvalidParam;
+            }
+
+            int result = NativeEnqueue(data);
+            if (result < 0)
+            {
+                return (Status)(-result);
+            }
+
+            ticket = (uint)result;
+            return Status.Ok;
+        }
+
+        /// <summary>
+        /// Ticket of the most recently completed queued frame.
+        /// Every ticket up to and including this value has been transmitted.
+        /// </summary>
+        /// <returns>Completed ticket, 0 if none yet</returns>
+        public static uint GetCompletedSequence()
+        {
+            return NativeGetCompletedSequence();
+        }
+
+        /// <summary>
+        /// Send a DiSEqC 2.x reply-required command (framing 0xE2/0xE3) and read the slave's reply.
+        /// Blocks for the command plus up to the 150 ms reply window.
+        /// </summary>
+        /// <param name="command">Command bytes (1-6 bytes, first byte 0xE2 or 0xE3)</param>
+        /// <param name="reply">Receives the reply, framing byte (0xE4-0xE7) first</param>
+        /// <param name="replyLength">Number of reply bytes received</param>
+        /// <returns>Status code (Timeout when no slave answered, ReplyError on parity errors)</returns>
+        public static Status Query(byte[] command, byte[] reply, out int replyLength)
+        {
+            replyLength = 0;
+
+            if (command == null || command.Length == 0 || command.Length > 6 ||
+                (command[0] != 0xE2 && command[0] != 0xE3) ||
+                reply == null || reply.Length == 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            int result = NativeQuery(command, reply);
+            if (result < 0)
+            {
+                return (Status)(-result);
+            }
+
+            replyLength = result;
+            return Status.Ok;
+        }
+
+        /// <summary>
+        /// Queue a mini-DiSEqC tone burst (SatA unmodulated, SatB modulated)
+        /// </summary>
+        /// <param name="burst">SatA or SatB</param>
+        /// <returns>Status code</returns>
+        public static Status ToneBurst(Burst burst)
+        {
+            if (burst != Burst.SatA && burst != Burst.SatB)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeToneBurst((int)burst);
+        }
+
+        /// <summary>
+        /// Switch multi-LNB feeds in one native call:
+        /// voltage, 15 ms, committed switch, 15 ms, tone burst, 15 ms, continuous tone.
+        /// </summary>
+        /// <param name="port">Committed port 0-3, or -1 to skip the committed frame</param>
+        /// <param name="horizontal">True for 18 V (horizontal), false for 13 V (vertical)</param>
+        /// <param name="burst">Tone burst after the committed frame</param>
+        /// <param name="highBand">True to leave the continuous 22 kHz tone on</param>
+        /// <returns>Status code (LnbError when the LNBH26 write failed)</returns>
+        public static Status Switch(int port, bool horizontal, Burst burst, bool highBand)
+        {
+            if (port < -1 || port > 3)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeSwitch(port, horizontal ? 1 : 0, (int)burst, highBand);
+        }
+
+        /// <summary>
+        /// Drive to a satellite using the native position table (stored slot, Goto NN)
+        /// </summary>
+        /// <param name="id">Satellite id, e.g. "astra_19.2e" (case-insensitive)</param>
+        /// <returns>Status code (NotFound when the satellite has no stored slot)</returns>
+        public static Status GotoSatellite(string id)
+        {
+            if (id == null || id.Length == 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeGotoSatellite(id);
+        }
+
+        /// <summary>
+        /// Store the current dish position in a positioner slot and link it to a satellite
+        /// </summary>
+        /// <param name="id">Satellite id</param>
+        /// <param name="slot">Positioner slot (1-255)</param>
+        /// <returns>Status code</returns>
+        public static Status StoreSatellite(string id, byte slot)
+        {
+            if (id == null || id.Length == 0 || slot == 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeStoreSatellite(id, slot);
+        }
+
+        /// <summary>
+        /// Add or replace a satellite in the native position table without moving the dish
+        /// </summary>
+        /// <param name="id">Satellite id</param>
+        /// <param name="longitude">Orbital longitude in degrees, East positive</param>
+        /// <param name="slot">Positioner slot (0 = none stored)</param>
+        /// <returns>Status code (Busy when the table is full)</returns>
+        public static Status SetSatellite(string id, float longitude, byte slot)
+        {
+            if (id == null || id.Length == 0 || longitude < -180f || longitude > 180f)
+            {
+                return Status.InvalidParam;
+            }
+
+            int tenths = (int)(longitude * 10f + (longitude < 0 ? -0.5f : 0.5f));
+            return (Status)NativeSetSatellite(id, tenths, slot);
+        }
+
+        /// <summary>
+        /// Drive to a stored positioner slot (0 = reference position)
+        /// </summary>
+        /// <param name="slot">Positioner slot</param>
+        /// <returns>Status code</returns>
+        public static Status GotoPosition(byte slot)
+        {
+            return (Status)NativeGotoPosition(slot);
+        }
+
+        /// <summary>
+        /// Store the current dish position in a positioner slot
+        /// </summary>
+        /// <param name="slot">Positioner slot (1-255)</param>
+        /// <returns>Status code</returns>
+        public static Status StorePosition(byte slot)
+        {
+            if (slot == 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeStorePosition(slot);
+        }
+
+        /// <summary>
+        /// Serialise the user satellite table for persistence (e.g. FRAM)
+        /// </summary>
+        /// <param name="buffer">Destination, at least SatelliteTableBlobMax bytes</param>
+        /// <param name="length">Blob length written</param>
+        /// <returns>Status code</returns>
+        public static Status ExportSatelliteTable(byte[] buffer, out int length)
+        {
+            length = 0;
+
+            if (buffer == null)
+            {
+                return Status.InvalidParam;
+            }
+
+            int result = NativeExportSatelliteTable(buffer);
+            if (result < 0)
+            {
+                return (Status)(-result);
+            }
+
+            length = result;
+            return Status.Ok;
+        }
+
+        /// <summary>
+        /// Restore the user satellite table from a blob written by ExportSatelliteTable
+        /// </summary>
+        /// <param name="blob">Persisted blob</param>
+        /// <returns>Status code (InvalidParam on a corrupt blob)</returns>
+        public static Status ImportSatelliteTable(byte[] blob)
+        {
+            if (blob == null)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeImportSatelliteTable(blob);
+        }
+
+        /// <summary>
+        /// Send halt command to stop rotor movement (pre-empts queued and in-flight frames)
         /// </summary>
         /// <returns>Status code</returns>
         public static Status Halt()
@@ -56,6 +360,25 @@ namespace DiSEqC_Control.Native
             return (Status)result;
         }
 
+        /// <summary>
+        /// Abort: flush queued frames and stop the frame on the wire within one bit time
+        /// </summary>
+        /// <param name="sendHalt">Send Halt as the next frame on the bus</param>
+        /// <returns>Status code</returns>
+        public static Status Abort(bool sendHalt)
+        {
+            return (Status)NativeAbort(sendHalt);
+        }
+
+        /// <summary>
+        /// Worst measured abort → carrier-off latency since boot
+        /// </summary>
+        /// <returns>Microseconds</returns>
+        public static uint GetAbortLatencyMicroseconds()
+        {
+            return NativeGetAbortLatency();
+        }
+
         /// <summary>
         /// Drive motor East continuously (call Halt to stop)
         /// </summary>
@@ -99,7 +422,7 @@ namespace DiSEqC_Control.Native
         }
 
         /// <summary>
-        /// Check if DiSEqC transmission is in progress
+        /// Check if DiSEqC transmission is in progress or frames are queued
         /// </summary>
         /// <returns>True if busy</returns>
         public static bool IsBusy()
@@ -108,7 +431,7 @@ namespace DiSEqC_Control.Native
         }
 
         /// <summary>
-        /// Get the last commanded angle
+        /// Get the estimated dish angle (follows the rotor while it moves)
         /// </summary>
         /// <returns>Angle in degrees</returns>
         public static float GetCurrentAngle()
@@ -116,6 +439,40 @@ namespace DiSEqC_Control.Native
             return NativeGetCurrentAngle();
         }
 
+        /// <summary>
+        /// Get the rotor motion estimator state
+        /// </summary>
+        public static Motion GetMotionState()
+        {
+            return (Motion)NativeGetMotionState();
+        }
+
+        /// <summary>
+        /// Estimated time until the dish settles
+        /// </summary>
+        /// <returns>Milliseconds, 0 when settled, -1 while driving continuously</returns>
+        public static int GetMotionEtaMs()
+        {
+            return NativeGetMotionEta();
+        }
+
+        /// <summary>
+        /// Set the rotor profile used by the motion estimator
+        /// </summary>
+        /// <param name="speed">Cruise speed in degrees/second</param>
+        /// <param name="acceleration">Acceleration in degrees/second²</param>
+        /// <param name="backlash">Slack taken up on direction reversal, degrees</param>
+        /// <returns>Status code</returns>
+        public static Status SetMotionProfile(float speed, float acceleration, float backlash)
+        {
+            if (speed <= 0f || acceleration <= 0f || backlash < 0f)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeSetMotionProfile(ToMillidegrees(speed), ToMillidegrees(acceleration), ToMillidegrees(backlash));
+        }
+
         /// <summary>
         /// Set SWD-readable bring-up status word for off-site diagnostics.
         /// </summary>
@@ -141,9 +498,57 @@ namespace DiSEqC_Control.Native
         [MethodImpl(MethodImplOptions.InternalCall)]
         private static extern int NativeTransmit(byte[] data);
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeEnqueue(byte[] data);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern uint NativeGetCompletedSequence();
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeQuery(byte[] command, byte[] reply);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeToneBurst(int burst);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeSwitch(int port, int voltage, int burst, bool tone);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeSetSite(int latitudeMdeg, int longitudeMdeg);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeGotoUsals(int satelliteLongitudeMdeg);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeGotoSatellite(string id);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeStoreSatellite(string id, int slot);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeSetSatellite(string id, int longitudeTenths, int slot);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeGotoPosition(byte slot);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeStorePosition(byte slot);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeExportSatelliteTable(byte[] buffer);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeImportSatelliteTable(byte[] blob);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         private static extern int NativeHalt();
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeAbort(bool sendHalt);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern uint NativeGetAbortLatency();
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         private static extern int NativeDriveEast();
 
@@ -162,6 +567,15 @@ namespace DiSEqC_Control.Native
         [MethodImpl(MethodImplOptions.InternalCall)]
         private static extern float NativeGetCurrentAngle();
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeGetMotionState();
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeGetMotionEta();
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern int NativeSetMotionProfile(int speedMdegS, int accelMdegS2, int backlashMdeg);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         private static extern void NativeSetBringupStatus(uint statusWord);
 
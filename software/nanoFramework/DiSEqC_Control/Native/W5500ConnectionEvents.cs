@@ -0,0 +1,81 @@
+using System;
+using System.Threading;
+using nanoFramework.Runtime.Events;
+
+namespace DiSEqC_Control.Native
+{
+    /// <summary>
+    /// Waits for a supervised W5500 socket to reach a connection state. The native event
+    /// thread posts a CustomEvent (sub-category 0xD6) on every reconnect state change, so
+    /// the caller sleeps until the state moves instead of polling it.
+    /// </summary>
+    public static class W5500ConnectionEvents
+    {
+        /// <summary>
+        /// Longest single wait before the state is read again. Every CustomEvent wakes the
+        /// waiter and only the state read decides, so this only matters if a second waiter
+        /// took the signal.
+        /// </summary>
+        private const int RecheckMs = 1000;
+
+        private static readonly AutoResetEvent StateChanged = new AutoResetEvent(false);
+        private static readonly object SubscribeLock = new object();
+        private static bool _subscribed;
+
+        /// <summary>
+        /// Block until the supervised socket reaches state or timeoutMs expires (Timeout).
+        /// </summary>
+        public static W5500Socket.Status WaitForState(int socketHandle, W5500Socket.ConnectionState state, int timeoutMs)
+        {
+            if (timeoutMs < 0)
+            {
+                return W5500Socket.Status.InvalidParam;
+            }
+
+            EnsureSubscribed();
+
+            DateTime deadline = DateTime.UtcNow.AddMilliseconds(timeoutMs);
+            while (true)
+            {
+                W5500Socket.Status status = W5500Socket.GetConnectionState(socketHandle, out W5500Socket.ConnectionState current, out int connects, out int attempts);
+                if (status != W5500Socket.Status.Ok)
+                {
+                    return status;
+                }
+
+                if (current == state)
+                {
+                    return W5500Socket.Status.Ok;
+                }
+
+                long remainingMs = (deadline - DateTime.UtcNow).Ticks / TimeSpan.TicksPerMillisecond;
+                if (remainingMs <= 0)
+                {
+                    return W5500Socket.Status.Timeout;
+                }
+
+                // An event posted after the state read above stays latched, so it is not lost.
+                StateChanged.WaitOne(remainingMs < RecheckMs ? (int)remainingMs : RecheckMs, false);
+            }
+        }
+
+        private static void EnsureSubscribed()
+        {
+            lock (SubscribeLock)
+            {
+                if (!_subscribed)
+                {
+                    CustomEvent.CustomEventPosted += OnCustomEvent;
+                    _subscribed = true;
+                }
+            }
+        }
+
+        private static void OnCustomEvent(object sender, CustomEventArgs e)
+        {
+            // Other sub-categories (DiSEqC completions) share this event; waking on them
+            // only costs one state read.
+            StateChanged.Set();
+        }
+    }
+}
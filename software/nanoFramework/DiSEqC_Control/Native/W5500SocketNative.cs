@@ -1,5 +1,11 @@
 using System;
 using NativeW5500 = Cubley.Interop.W5500Socket;
+using NativeW5500Rx = Cubley.Interop.W5500SocketRx;
+using NativeW5500Udp = Cubley.Interop.W5500SocketUdp;
+using NativeW5500LinkProbe = Cubley.Interop.W5500LinkProbe;
+using NativeW5500Reconnect = Cubley.Interop.W5500SocketReconnect;
+using NativeW5500Tx = Cubley.Interop.W5500SocketTx;
+using NativeW5500KeepAlive = Cubley.Interop.W5500MqttKeepAlive;
 
 namespace DiSEqC_Control.Native
 {
@@ -13,6 +19,16 @@ namespace DiSEqC_Control.Native
     /// </summary>
     public static class W5500Socket
     {
+        /// <summary>
+        /// Hardware sockets on the W5500. Handles are the socket index + 1.
+        /// </summary>
+        public const int MaxSockets = 8;
+
+        /// <summary>
+        /// Largest UDP payload per datagram (1500-byte MTU, no IP fragmentation).
+        /// </summary>
+        public const int MaxDatagramSize = 1472;
+
         public enum Status
         {
             Ok = 0,
@@ -24,14 +40,35 @@ namespace DiSEqC_Control.Native
             IoError = 6
         }
 
+        /// <summary>
+        /// Supervised connection state, mirrors w5500_conn_state_t.
+        /// </summary>
+        public enum ConnectionState
+        {
+            Closed = 0,
+            Init = 1,
+            SynSent = 2,
+            Established = 3,
+            Backoff = 4
+        }
+
+        /// <summary>
+        /// CustomEvent sub-category posted by native code when a supervised socket changes
+        /// state. data1 is the bit mask of sockets that changed (bit = handle - 1).
+        /// W5500ConnectionEvents waits on it.
+        /// </summary>
+        public const byte ConnectionEventSubCategory = 0xD6;
+
         public static Status Open(out int socketHandle)
         {
             int result = NativeW5500.NativeOpen(out socketHandle);
-            // NativeOpen returns kSingleSocketHandle=1 on success, but BYREF interop
-            // can occasionally drop the out-param write. Mirror the W5500Bringup workaround.
-            if ((Status)result == Status.Ok && socketHandle != 1)
+            // BYREF interop can occasionally drop the out-param write. With several
+            // sockets the handle cannot be guessed, so report the open as failed
+            // rather than drive a socket this caller does not own.
+            if ((Status)result == Status.Ok && (socketHandle < 1 || socketHandle > MaxSockets))
             {
-                socketHandle = 1;
+                socketHandle = -1;
+                return Status.IoError;
             }
             return (Status)result;
         }
@@ -56,6 +93,72 @@ namespace DiSEqC_Control.Native
             return (Status)NativeW5500.NativeConnect(socketHandle, host, port, timeoutMs);
         }
 
+        /// <summary>
+        /// Connect in the background: the native reconnect thread drives the handshake and
+        /// reconnects after every drop, backing off from minBackoffMs to maxBackoffMs with
+        /// jitter. Returns at once; Busy if the socket is already supervised.
+        /// </summary>
+        public static Status StartReconnect(int socketHandle, string host, int port, int connectTimeoutMs, int minBackoffMs, int maxBackoffMs)
+        {
+            if (string.IsNullOrEmpty(host) || port < 1 || port > 65535 || connectTimeoutMs < 1 ||
+                minBackoffMs < 1 || maxBackoffMs < minBackoffMs)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500Reconnect.NativeStart(socketHandle, host, port, connectTimeoutMs, minBackoffMs, maxBackoffMs);
+        }
+
+        /// <summary>
+        /// Stop supervising the socket and disconnect it. Close does this implicitly.
+        /// </summary>
+        public static Status StopReconnect(int socketHandle)
+        {
+            return (Status)NativeW5500Reconnect.NativeStop(socketHandle);
+        }
+
+        /// <summary>
+        /// Supervised state plus successful connects and connect attempts so far.
+        /// Unsupervised sockets report Closed.
+        /// </summary>
+        public static Status GetConnectionState(int socketHandle, out ConnectionState state, out int connects, out int attempts)
+        {
+            int rawState;
+            Status status = (Status)NativeW5500Reconnect.NativeGetState(socketHandle, out rawState, out connects, out attempts);
+            state = (ConnectionState)rawState;
+            return status;
+        }
+
+        /// <summary>
+        /// Hand MQTT keep-alive to the native driver once CONNACK has accepted the session:
+        /// PINGREQ goes out after keepAliveSeconds / 2 without a send, the PINGRESP is
+        /// consumed by <see cref="ReceiveMqttFrame"/>, and an unanswered ping disconnects.
+        /// It stops with the connection, so start it again after every CONNACK.
+        /// </summary>
+        public static Status StartMqttKeepAlive(int socketHandle, int keepAliveSeconds)
+        {
+            if (keepAliveSeconds < 1 || keepAliveSeconds > 65535)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500KeepAlive.NativeStart(socketHandle, keepAliveSeconds);
+        }
+
+        public static Status StopMqttKeepAlive(int socketHandle)
+        {
+            return (Status)NativeW5500KeepAlive.NativeStop(socketHandle);
+        }
+
+        /// <summary>
+        /// Pings sent and answered since the last start, and connections dropped for an
+        /// unanswered one. NotInitialized once keep-alive has stopped (counters still valid).
+        /// </summary>
+        public static Status GetMqttKeepAliveStats(int socketHandle, out uint pingsSent, out uint pingResponses, out uint missed)
+        {
+            return (Status)NativeW5500KeepAlive.NativeGetStats(socketHandle, out pingsSent, out pingResponses, out missed);
+        }
+
         public static Status Send(int socketHandle, byte[] data, int offset, int count, out int sent)
         {
             sent = 0;
@@ -68,6 +171,24 @@ namespace DiSEqC_Control.Native
             return (Status)NativeW5500.NativeSend(socketHandle, data, offset, count, out sent);
         }
 
+        /// <summary>
+        /// Send any amount of data: it is streamed through the socket's TX buffer as space
+        /// frees up, within one overall timeoutMs. With waitForSendOk false the call returns
+        /// once the last chunk is handed to the chip; a failure of that SEND is reported by
+        /// the next send. On Timeout sent holds the bytes already committed.
+        /// </summary>
+        public static Status SendStream(int socketHandle, byte[] data, int offset, int count, int timeoutMs, bool waitForSendOk, out int sent)
+        {
+            sent = 0;
+
+            if (data == null || offset < 0 || count < 0 || offset + count > data.Length || timeoutMs < 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500Tx.NativeSendStream(socketHandle, data, offset, count, timeoutMs, waitForSendOk, out sent);
+        }
+
         public static Status Receive(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received)
         {
             received = 0;
@@ -80,6 +201,151 @@ namespace DiSEqC_Control.Native
             return (Status)NativeW5500.NativeReceive(socketHandle, buffer, offset, count, timeoutMs, out received);
         }
 
+        /// <summary>
+        /// Read exactly count bytes straight into buffer[offset..]. On Timeout (or a
+        /// closed peer) received holds how many bytes did arrive.
+        /// </summary>
+        public static Status ReceiveExact(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received)
+        {
+            received = 0;
+
+            if (buffer == null || offset < 0 || count < 0 || offset + count > buffer.Length || timeoutMs < 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500Rx.NativeReceiveExact(socketHandle, buffer, offset, count, timeoutMs, out received);
+        }
+
+        /// <summary>
+        /// Bytes already waiting on the socket, without consuming them.
+        /// </summary>
+        public static Status PeekAvailable(int socketHandle, out int available)
+        {
+            return (Status)NativeW5500Rx.NativePeekAvailable(socketHandle, out available);
+        }
+
+        /// <summary>
+        /// Read one whole MQTT packet as [fixed header][variable header + payload]; the
+        /// remaining length is decoded natively. On InvalidParam length is the buffer size
+        /// the packet needs (nothing consumed); on Timeout a non-zero length means the body
+        /// was cut short.
+        /// </summary>
+        public static Status ReceiveMqttFrame(int socketHandle, byte[] buffer, int timeoutMs, out int length)
+        {
+            length = 0;
+
+            if (buffer == null || buffer.Length == 0 || timeoutMs < 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500Rx.NativeReceiveMqttFrame(socketHandle, buffer, timeoutMs, out length);
+        }
+
+        /// <summary>
+        /// Put an open socket handle in UDP mode on localPort (0 = any free port). The
+        /// handle is then used with SendTo/ReceiveFrom until it is closed.
+        /// </summary>
+        public static Status Bind(int socketHandle, int localPort)
+        {
+            if (localPort < 0 || localPort > 65535)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500Udp.NativeBind(socketHandle, localPort);
+        }
+
+        /// <summary>
+        /// Send one datagram; no connection and no acknowledgement beyond the frame
+        /// leaving the chip. host "255.255.255.255" broadcasts on the local segment.
+        /// </summary>
+        public static Status SendTo(int socketHandle, string host, int port, byte[] data, int offset, int count)
+        {
+            if (string.IsNullOrEmpty(host) || port < 1 || port > 65535 ||
+                data == null || offset < 0 || count < 1 || count > MaxDatagramSize || offset + count > data.Length)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500Udp.NativeSendTo(socketHandle, host, port, data, offset, count);
+        }
+
+        /// <summary>
+        /// Receive the next datagram into buffer[offset..]; anything past count bytes is
+        /// dropped. remoteHost/remotePort identify the sender so a reply can be sent back.
+        /// </summary>
+        public static Status ReceiveFrom(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs,
+            out int received, out string remoteHost, out int remotePort)
+        {
+            received = 0;
+            remoteHost = null;
+            remotePort = 0;
+
+            if (buffer == null || offset < 0 || count < 0 || offset + count > buffer.Length || timeoutMs < 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            uint remoteAddress;
+            Status status = (Status)NativeW5500Udp.NativeReceiveFrom(
+                socketHandle, buffer, offset, count, timeoutMs, out received, out remoteAddress, out remotePort);
+            if (status == Status.Ok)
+            {
+                remoteHost = FormatIpv4(remoteAddress);
+            }
+
+            return status;
+        }
+
+        /// <summary>
+        /// Dotted quad for an IPv4 address packed big-endian (0xC0A8010A = "192.168.1.10").
+        /// </summary>
+        public static string FormatIpv4(uint address)
+        {
+            return ((address >> 24) & 0xFF).ToString() + "." +
+                   ((address >> 16) & 0xFF).ToString() + "." +
+                   ((address >> 8) & 0xFF).ToString() + "." +
+                   (address & 0xFF).ToString();
+        }
+
+        /// <summary>
+        /// Link probe: socket 0 answers ARP and ping natively so fleet monitoring can
+        /// measure link latency without MQTT. Socket 0 must not be open; while the
+        /// probe runs, Open hands out sockets 1-7 only.
+        /// </summary>
+        public static Status EnableLinkProbe(bool enable)
+        {
+            return (Status)NativeW5500LinkProbe.NativeEnable(enable);
+        }
+
+        /// <summary>
+        /// Answer queued ARP/ping frames, waiting up to timeoutMs for the first. Only
+        /// needed while no other socket call is waiting: every socket wait answers them too.
+        /// </summary>
+        public static Status ServiceLinkProbe(int timeoutMs, out int handled)
+        {
+            handled = 0;
+            if (timeoutMs < 0)
+            {
+                return Status.InvalidParam;
+            }
+
+            return (Status)NativeW5500LinkProbe.NativeService(timeoutMs, out handled);
+        }
+
+        /// <summary>
+        /// Link probe counters since it was enabled. Echo times (us) run from the request
+        /// being read off the chip to the reply leaving it. NotInitialized while disabled.
+        /// </summary>
+        public static Status GetLinkProbeStats(out uint frames, out uint arpReplies, out uint echoReplies,
+            out uint dropped, out uint lastEchoUs, out uint maxEchoUs)
+        {
+            return (Status)NativeW5500LinkProbe.NativeGetStats(
+                out frames, out arpReplies, out echoReplies, out dropped, out lastEchoUs, out maxEchoUs);
+        }
+
         public static Status Close(int socketHandle)
         {
             return (Status)NativeW5500.NativeClose(socketHandle);
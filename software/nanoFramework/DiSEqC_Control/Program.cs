@@ -280,9 +280,14 @@ namespace DiSEqC_Control
 
             try
             {
-                _mqttClient = CreateMqttClient();
-                _mqttClient.MessageReceived += OnMqttMessageReceived;
-                _mqttClient.ConnectionClosed += OnMqttConnectionClosed;
+                // Reused across reconnects: its channel may still hold a socket the native
+                // reconnect thread is bringing back up.
+                if (_mqttClient == null)
+                {
+                    _mqttClient = CreateMqttClient();
+                    _mqttClient.MessageReceived += OnMqttMessageReceived;
+                    _mqttClient.ConnectionClosed += OnMqttConnectionClosed;
+                }
 
                 bool hasCredentials = !string.IsNullOrEmpty(_runtimeConfig.MqttUsername);
                 byte connectResult = MqttPacket.ConnAckServerUnavailable;
@@ -293,6 +298,7 @@ namespace DiSEqC_Control
                 for (int attempt = 1; attempt <= ConnectRetryCount; attempt++)
                 {
                     Beacon(0xB0, (byte)attempt);
+                    bool connectWaitTimedOut = false;
                     try
                     {
                         Debug.WriteLine("[MQTT] Connect attempt " + attempt + "/" + ConnectRetryCount);
@@ -316,6 +322,7 @@ namespace DiSEqC_Control
                     {
                         Debug.WriteLine("[MQTT] Connect attempt " + attempt + " threw: " + cex.Message);
                         connectResult = MqttPacket.ConnAckServerUnavailable;
+                        connectWaitTimedOut = _mqttClient.ConnectWaitTimedOut;
                     }
 
                     Beacon(0xB1, connectResult);
@@ -324,7 +331,9 @@ namespace DiSEqC_Control
                         break;
                     }
 
-                    if (attempt < ConnectRetryCount)
+                    // A connect that waited out the channel timeout has already paused while the
+                    // native thread backed off. Any other failure returned at once and needs one.
+                    if (attempt < ConnectRetryCount && !connectWaitTimedOut)
                     {
                         Thread.Sleep(ConnectRetryDelayMs);
                     }
@@ -619,7 +628,6 @@ namespace DiSEqC_Control
                     }
 
                     Debug.WriteLine("[MQTT] Disconnected. Reconnecting...");
-                    Thread.Sleep(5000);
                     ConnectToMqtt();
                 }
 
@@ -80,6 +80,7 @@
 #define DISEQC_PWM_DRIVER           PWMD4    // TIM4 for DiSEqC carrier
 #define DISEQC_GPT_DRIVER           GPTD5    // TIM5 for bit timing
 #define DISEQC_OUTPUT_LINE          PAL_LINE(GPIOD, 12U)  // PD12 = TIM4_CH1
+#define DISEQC_RX_LINE              PAL_LINE(GPIOA, 15U)  // PA15 = LNBH26 DSQOUT (tone detect, active low)
 
 // Note: No motor enable pin - LNBH26 handles power control automatically
 // DiSEqC commands control rotor movement directly
@@ -43,6 +43,22 @@ HRESULT Library_cubley_interop_StatusLed_NativePulse___STATIC__VOID__I4__I4(CLR_
 HRESULT Library_cubley_interop_UsbCdcConsole_NativeIsEnabled___STATIC__BOOLEAN(CLR_RT_StackFrame& stack);
 HRESULT Library_cubley_interop_UsbCdcConsole_NativeReadByte___STATIC__I4__I4(CLR_RT_StackFrame& stack);
 HRESULT Library_cubley_interop_UsbCdcConsole_NativeWrite___STATIC__I4__STRING(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketRx_NativeReceiveExact___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketRx_NativePeekAvailable___STATIC__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketRx_NativeReceiveMqttFrame___STATIC__I4__I4__SZARRAY_U1__I4__BYREF_I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketUdp_NativeBind___STATIC__I4__I4__I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketUdp_NativeSendTo___STATIC__I4__I4__STRING__I4__SZARRAY_U1__I4__I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketUdp_NativeReceiveFrom___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4__BYREF_U4__BYREF_I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500LinkProbe_NativeEnable___STATIC__I4__BOOLEAN(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500LinkProbe_NativeService___STATIC__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500LinkProbe_NativeGetStats___STATIC__I4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketReconnect_NativeStart___STATIC__I4__I4__STRING__I4__I4__I4__I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketReconnect_NativeStop___STATIC__I4__I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketReconnect_NativeGetState___STATIC__I4__I4__BYREF_I4__BYREF_I4__BYREF_I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500SocketTx_NativeSendStream___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BOOLEAN__BYREF_I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500MqttKeepAlive_NativeStart___STATIC__I4__I4__I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500MqttKeepAlive_NativeStop___STATIC__I4__I4(CLR_RT_StackFrame& stack);
+HRESULT Library_cubley_interop_W5500MqttKeepAlive_NativeGetStats___STATIC__I4__I4__BYREF_U4__BYREF_U4__BYREF_U4(CLR_RT_StackFrame& stack);
 
 // Diagnostics mailboxes. Keep the transient current status in .bss so the linker
 // places it after g_CLR_InteropAssembliesNativeData in .data, which the CLR may
@@ -88,12 +104,28 @@ static const CLR_RT_MethodHandler method_lookup[] =
     Library_cubley_interop_UsbCdcConsole_NativeIsEnabled___STATIC__BOOLEAN,                                  // [31] UsbCdcConsole.NativeIsEnabled
     Library_cubley_interop_UsbCdcConsole_NativeReadByte___STATIC__I4__I4,                                    // [32] UsbCdcConsole.NativeReadByte
     Library_cubley_interop_UsbCdcConsole_NativeWrite___STATIC__I4__STRING,                                   // [33] UsbCdcConsole.NativeWrite
+    Library_cubley_interop_W5500SocketRx_NativeReceiveExact___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4, // [34] W5500SocketRx.NativeReceiveExact
+    Library_cubley_interop_W5500SocketRx_NativePeekAvailable___STATIC__I4__I4__BYREF_I4,                     // [35] W5500SocketRx.NativePeekAvailable
+    Library_cubley_interop_W5500SocketRx_NativeReceiveMqttFrame___STATIC__I4__I4__SZARRAY_U1__I4__BYREF_I4, // [36] W5500SocketRx.NativeReceiveMqttFrame
+    Library_cubley_interop_W5500SocketUdp_NativeBind___STATIC__I4__I4__I4,                                   // [37] W5500SocketUdp.NativeBind
+    Library_cubley_interop_W5500SocketUdp_NativeSendTo___STATIC__I4__I4__STRING__I4__SZARRAY_U1__I4__I4,     // [38] W5500SocketUdp.NativeSendTo
+    Library_cubley_interop_W5500SocketUdp_NativeReceiveFrom___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4__BYREF_U4__BYREF_I4, // [39] W5500SocketUdp.NativeReceiveFrom
+    Library_cubley_interop_W5500LinkProbe_NativeEnable___STATIC__I4__BOOLEAN,                                // [40] W5500LinkProbe.NativeEnable
+    Library_cubley_interop_W5500LinkProbe_NativeService___STATIC__I4__I4__BYREF_I4,                          // [41] W5500LinkProbe.NativeService
+    Library_cubley_interop_W5500LinkProbe_NativeGetStats___STATIC__I4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4, // [42] W5500LinkProbe.NativeGetStats
+    Library_cubley_interop_W5500SocketReconnect_NativeStart___STATIC__I4__I4__STRING__I4__I4__I4__I4,       // [43] W5500SocketReconnect.NativeStart
+    Library_cubley_interop_W5500SocketReconnect_NativeStop___STATIC__I4__I4,                                 // [44] W5500SocketReconnect.NativeStop
+    Library_cubley_interop_W5500SocketReconnect_NativeGetState___STATIC__I4__I4__BYREF_I4__BYREF_I4__BYREF_I4, // [45] W5500SocketReconnect.NativeGetState
+    Library_cubley_interop_W5500SocketTx_NativeSendStream___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BOOLEAN__BYREF_I4, // [46] W5500SocketTx.NativeSendStream
+    Library_cubley_interop_W5500MqttKeepAlive_NativeStart___STATIC__I4__I4__I4,                              // [47] W5500MqttKeepAlive.NativeStart
+    Library_cubley_interop_W5500MqttKeepAlive_NativeStop___STATIC__I4__I4,                                   // [48] W5500MqttKeepAlive.NativeStop
+    Library_cubley_interop_W5500MqttKeepAlive_NativeGetStats___STATIC__I4__I4__BYREF_U4__BYREF_U4__BYREF_U4, // [49] W5500MqttKeepAlive.NativeGetStats
 };
 
 extern const CLR_RT_NativeAssemblyData g_CLR_AssemblyNative_Cubley_Interop =
 {
     "Cubley.Interop",
-    0xC5EF91C9,  // nativeMethodsChecksum from Cubley.Interop.pe (computed by MetaDataProcessor)
+    0xC5EF91C9,  // nativeMethodsChecksum from Cubley.Interop.pe (computed by MetaDataProcessor over method_lookup[0..33])
     method_lookup,
     { 1, 0, 0, 0 }
 };
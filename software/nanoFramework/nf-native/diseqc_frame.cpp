@@ -0,0 +1,88 @@
+/**
+ * @file diseqc_frame.cpp
+ * @brief HAL-independent DiSEqC frame encoding and segment player
+ */
+
+#include "diseqc_frame.h"
+
+/**
+ * @brief Calculate parity bit for transmission
+ */
+uint8_t diseqc_parity_bit(uint8_t byte)
+{
+    uint8_t parity = 0;
+    for (int i = 0; i < 8; i++) {
+        parity ^= (byte >> i) & 1;
+    }
+
+    // DiSEqC uses odd parity: even number of ones → send '1'
+    return parity == 0 ? 1 : 0;
+}
+
+/**
+ * @brief Pack command bytes into a frame
+ */
+diseqc_bits_t diseqc_bits_from_bytes(const uint8_t *data, uint8_t length)
+{
+    diseqc_bits_t frame = {0, 0};
+
+    if (data == NULL || length == 0 || length > DISEQC_MAX_BYTES) {
+        return frame;
+    }
+
+    for (uint8_t i = 0; i < length; i++) {
+        // 8 data bits (MSB first) followed by the parity bit
+        frame.pattern = (frame.pattern << 9) | ((uint64_t)data[i] << 1) | diseqc_parity_bit(data[i]);
+        frame.bit_count += 9;
+    }
+
+    return frame;
+}
+
+uint8_t diseqc_bits_first_byte(diseqc_bits_t bits)
+{
+    if (bits.bit_count < 9) {
+        return 0;
+    }
+
+    // Skip the parity bit trailing the first byte
+    return (uint8_t)(bits.pattern >> (bits.bit_count - 8));
+}
+
+void diseqc_player_load(diseqc_player_t *player, diseqc_bits_t bits, uint16_t carrier_duty)
+{
+    player->bits = bits;
+    player->carrier_duty = carrier_duty;
+    player->count = (uint8_t)(bits.bit_count * 2);
+    player->index = 0;
+}
+
+const diseqc_segment_t *diseqc_player_current(diseqc_player_t *player)
+{
+    if (player->index >= player->count) {
+        return NULL;
+    }
+
+    // Expand packed bit: even index = carrier ON half, odd index = OFF half
+    uint8_t bit_pos = (uint8_t)(player->bits.bit_count - 1 - (player->index >> 1));
+    bool bit_value = ((player->bits.pattern >> bit_pos) & 1) != 0;
+
+    if ((player->index & 1) == 0) {
+        player->expanded.ccr_value = player->carrier_duty;
+        player->expanded.duration_us = bit_value ? DISEQC_BIT1_HIGH_US : DISEQC_BIT0_HIGH_US;
+    } else {
+        player->expanded.ccr_value = 0;
+        player->expanded.duration_us = bit_value ? DISEQC_BIT1_LOW_US : DISEQC_BIT0_LOW_US;
+    }
+
+    return &player->expanded;
+}
+
+const diseqc_segment_t *diseqc_player_advance(diseqc_player_t *player)
+{
+    if (player->index < player->count) {
+        player->index++;
+    }
+
+    return diseqc_player_current(player);
+}
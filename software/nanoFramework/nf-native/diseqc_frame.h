@@ -0,0 +1,172 @@
+/**
+ * @file diseqc_frame.h
+ * @brief HAL-independent DiSEqC frame encoding and segment player
+ *
+ * Everything in this header is free of ChibiOS/HAL dependencies so the exact
+ * encoder and segment-advance logic used on target can also be compiled and
+ * exercised by the host test harness in tests/native/.
+ *
+ * A DiSEqC bit is two segments: carrier ON then carrier OFF.
+ * - Bit 0: 1.0 ms ON, 0.5 ms OFF
+ * - Bit 1: 0.5 ms ON, 1.0 ms OFF
+ * Each byte is sent MSB first followed by an odd-parity bit.
+ *
+ * Frames are held packed (diseqc_bits_t: data + parity bits, at most 54) and
+ * the player expands one segment at a time from the timer path, so no
+ * per-segment buffer is needed. Fixed frames are built at compile time.
+ */
+
+#ifndef DISEQC_FRAME_H
+#define DISEQC_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* DiSEqC Timing */
+#define DISEQC_BIT0_HIGH_US         1000        // Bit 0: 1ms ON
+#define DISEQC_BIT0_LOW_US          500         // Bit 0: 0.5ms OFF
+#define DISEQC_BIT1_HIGH_US         500         // Bit 1: 0.5ms ON
+#define DISEQC_BIT1_LOW_US          1000        // Bit 1: 1ms OFF
+#define DISEQC_MAX_BYTES            6           // Max command bytes
+#define DISEQC_MAX_BITS             (DISEQC_MAX_BYTES * 9)      // 8 data + 1 parity per byte
+#define DISEQC_CARRIER_DUTY         22          // PWM compare for ~50% at period 45
+#define DISEQC_TONE_BURST_US        12500       // Unmodulated burst (mini-DiSEqC SA)
+
+/* Framing Bytes (master commands) */
+#define DISEQC_FRAMING_NO_REPLY     0xE0        // Command from master, no reply required
+#define DISEQC_FRAMING_REPLY        0xE2        // Command from master, reply required
+#define DISEQC_FRAMING_REPLY_REPEAT 0xE3        // As 0xE2, repeated transmission
+
+/* Transmission Segment */
+typedef struct {
+    uint16_t ccr_value;     // PWM duty (0 = OFF, >0 = carrier ON)
+    uint16_t duration_us;   // Segment duration in microseconds
+} diseqc_segment_t;
+
+/* Packed frame: transmitted bits (data + parity), first bit at bit_count-1 */
+typedef struct {
+    uint64_t pattern;
+    uint8_t bit_count;
+} diseqc_bits_t;
+
+/* Segment player cursor shared by the thread and ISR transmit paths */
+typedef struct {
+    diseqc_bits_t bits;                 // Frame being played
+    uint16_t carrier_duty;              // Carrier ON compare value
+    uint8_t count;                      // Total segments (2 per bit)
+    uint8_t index;                      // Current segment
+    diseqc_segment_t expanded;          // Current segment expanded from bits
+} diseqc_player_t;
+
+/**
+ * @brief Parity bit transmitted after a data byte (odd parity over 9 bits)
+ * @param byte Data byte
+ * @return 1 when the byte has an even number of set bits, else 0
+ */
+uint8_t diseqc_parity_bit(uint8_t byte);
+
+/**
+ * @brief Pack command bytes and their parity bits into a frame
+ * @param data Command bytes
+ * @param length Number of bytes (1-6)
+ * @return Packed frame, bit_count 0 on invalid input
+ */
+diseqc_bits_t diseqc_bits_from_bytes(const uint8_t *data, uint8_t length);
+
+/**
+ * @brief First data byte of a packed frame (the framing byte)
+ * @return 0 for an empty frame
+ */
+uint8_t diseqc_bits_first_byte(diseqc_bits_t bits);
+
+/**
+ * @brief Point a player at a packed frame and rewind it
+ */
+void diseqc_player_load(diseqc_player_t *player, diseqc_bits_t bits, uint16_t carrier_duty);
+
+/**
+ * @brief Current segment, or NULL when the frame has finished
+ */
+const diseqc_segment_t *diseqc_player_current(diseqc_player_t *player);
+
+/**
+ * @brief Advance to the next segment
+ * @return Next segment, or NULL when the frame has finished
+ */
+const diseqc_segment_t *diseqc_player_advance(diseqc_player_t *player);
+
+#ifdef __cplusplus
+}
+
+/* Compile-time frame builders (C++ only) */
+
+constexpr uint8_t diseqc_ones(uint8_t byte)
+{
+    return byte == 0 ? 0 : (uint8_t)((byte & 1) + diseqc_ones((uint8_t)(byte >> 1)));
+}
+
+constexpr uint8_t diseqc_parity_bit_c(uint8_t byte)
+{
+    return (diseqc_ones(byte) & 1) == 0 ? 1 : 0;
+}
+
+/**
+ * @brief Append one data byte and its parity bit to a packed frame
+ */
+constexpr diseqc_bits_t diseqc_bits_append(diseqc_bits_t frame, uint8_t byte)
+{
+    return diseqc_bits_t{
+        (frame.pattern << 9) | ((uint64_t)byte << 1) | diseqc_parity_bit_c(byte),
+        (uint8_t)(frame.bit_count + 9)
+    };
+}
+
+constexpr diseqc_bits_t diseqc_bits_make(diseqc_bits_t frame)
+{
+    return frame;
+}
+
+/**
+ * @brief Build a packed frame from command bytes, e.g. diseqc_bits_make({0, 0}, 0xE0, 0x31, 0x60)
+ */
+template <typename... Bytes>
+constexpr diseqc_bits_t diseqc_bits_make(diseqc_bits_t frame, uint8_t byte, Bytes... rest)
+{
+    return diseqc_bits_make(diseqc_bits_append(frame, byte), rest...);
+}
+
+/* Fixed DiSEqC 1.0/1.2 frames (framing E0: master, no reply, first transmission) */
+constexpr diseqc_bits_t DISEQC_BITS_EMPTY           = {0, 0};
+constexpr diseqc_bits_t DISEQC_BITS_RESET           = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x00, 0x00);
+constexpr diseqc_bits_t DISEQC_BITS_CLEAR_RESET     = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x00, 0x01);
+constexpr diseqc_bits_t DISEQC_BITS_STANDBY         = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x00, 0x02);
+constexpr diseqc_bits_t DISEQC_BITS_POWER_ON        = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x00, 0x03);
+constexpr diseqc_bits_t DISEQC_BITS_HALT            = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x60);
+constexpr diseqc_bits_t DISEQC_BITS_LIMITS_OFF      = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x63);
+constexpr diseqc_bits_t DISEQC_BITS_LIMIT_EAST      = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x66);
+constexpr diseqc_bits_t DISEQC_BITS_LIMIT_WEST      = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x67);
+constexpr diseqc_bits_t DISEQC_BITS_DRIVE_EAST      = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x68, 0x00);
+constexpr diseqc_bits_t DISEQC_BITS_DRIVE_WEST      = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x69, 0x00);
+constexpr diseqc_bits_t DISEQC_BITS_GOTO_REFERENCE  = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x6B, 0x00);
+
+/* Mini-DiSEqC modulated burst (SB): nine '1' bits, no parity */
+constexpr diseqc_bits_t DISEQC_BITS_BURST_SB        = {0x1FF, 9};
+
+/* Prefixes for frames with one trailing parameter byte */
+constexpr diseqc_bits_t DISEQC_BITS_STEP_EAST_PREFIX = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x68);
+constexpr diseqc_bits_t DISEQC_BITS_STEP_WEST_PREFIX = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x69);
+constexpr diseqc_bits_t DISEQC_BITS_STORE_PREFIX    = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x6A);
+constexpr diseqc_bits_t DISEQC_BITS_GOTO_PREFIX     = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x31, 0x6B);
+constexpr diseqc_bits_t DISEQC_BITS_COMMITTED_PREFIX = diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0, 0x10, 0x38);
+
+static_assert(DISEQC_BITS_HALT.bit_count == 27, "halt frame is 3 bytes");
+static_assert(DISEQC_MAX_BITS <= 64, "packed frame fits in 64 bits");
+
+#endif /* __cplusplus */
+
+#endif /* DISEQC_FRAME_H */
@@ -2,8 +2,50 @@
 #include <nanoCLR_Interop.h>
 #include <nanoCLR_Runtime.h>
 #include <nanoCLR_Checks.h>
+#include <nanoHAL_v2.h>
 #include "diseqc_native.h"
 
+// Sub-category used for CustomEvent completion notifications
+// (data1 = DISEQC_EVT_* flags, data2 = last completed ticket).
+// DISEQC_EVT_SETTLED marks the end of an estimated rotor move, DISEQC_EVT_ABORTED
+// a flush: tickets dropped by it never report completion.
+#define DISEQC_MANAGED_EVENT_SUBCATEGORY 0xD5
+
+static THD_WORKING_AREA(wa_diseqc_events, 256);
+static thread_t *g_diseqc_event_thread = NULL;
+
+// Forwards driver completion flags to managed code so callers never poll
+// NativeIsBusy. Several frames finishing close together coalesce into one
+// event carrying the newest ticket; every ticket <= data2 is complete.
+static THD_FUNCTION(diseqc_event_thread, arg)
+{
+    (void)arg;
+    event_listener_t listener;
+
+    chRegSetThreadName("diseqc_evt");
+    chEvtRegisterMaskWithFlags(diseqc_get_event_source(), &listener, EVENT_MASK(0),
+                               DISEQC_EVT_FRAME_DONE | DISEQC_EVT_IDLE | DISEQC_EVT_SETTLED |
+                               DISEQC_EVT_ABORTED);
+
+    while (true)
+    {
+        chEvtWaitAny(EVENT_MASK(0));
+        eventflags_t flags = chEvtGetAndClearFlags(&listener);
+
+        PostManagedEvent(EVENT_CUSTOM, DISEQC_MANAGED_EVENT_SUBCATEGORY,
+                         (uint16_t)flags, diseqc_get_completed_sequence());
+    }
+}
+
+static void ensure_event_thread()
+{
+    if (g_diseqc_event_thread == NULL)
+    {
+        g_diseqc_event_thread = chThdCreateStatic(wa_diseqc_events, sizeof(wa_diseqc_events),
+                                                  NORMALPRIO, diseqc_event_thread, NULL);
+    }
+}
+
 // Example: Expose DiSEqC transmit as InternalCall (expand as needed)
 HRESULT Library_diseqc_interop_DiSEqC_NativeTransmit___STATIC__I4__SZARRAY_U1(CLR_RT_StackFrame& stack)
 {
@@ -16,3 +58,269 @@ HRESULT Library_diseqc_interop_DiSEqC_NativeTransmit___STATIC__I4__SZARRAY_U1(CL
     stack.SetResult_I4((int32_t)status);
     NANOCLR_NOCLEANUP_NOLABEL();
 }
+
+// Queue a frame without waiting. Returns the completion ticket (> 0), or the
+// negated diseqc_status_t on failure (-1 queue full, -2 invalid frame).
+HRESULT Library_diseqc_interop_DiSEqC_NativeEnqueue___STATIC__I4__SZARRAY_U1(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    CLR_RT_HeapBlock_Array* arr = stack.Arg0().DereferenceArray();
+    if (!arr) NANOCLR_SET_AND_LEAVE(CLR_E_INVALID_PARAMETER);
+
+    ensure_event_thread();
+
+    uint32_t sequence = 0;
+    diseqc_status_t status = DISEQC_ERROR_INVALID_PARAM;
+
+    if (arr->m_numOfElements <= DISEQC_MAX_BYTES)
+    {
+        diseqc_bits_t frame = diseqc_bits_from_bytes(arr->GetFirstElement(), (uint8_t)arr->m_numOfElements);
+        status = diseqc_enqueue_bits(frame, &sequence);
+    }
+
+    stack.SetResult_I4(status == DISEQC_OK ? (int32_t)sequence : -(int32_t)status);
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+// Send an E2/E3 (reply required) command and wait for the slave's answer.
+// Returns the reply length (framing byte included) or the negated
+// diseqc_status_t (-3 no reply, -4 corrupt reply). Blocks the calling managed
+// thread for up to the 150 ms reply window.
+HRESULT Library_diseqc_interop_DiSEqC_NativeQuery___STATIC__I4__SZARRAY_U1__SZARRAY_U1(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    CLR_RT_HeapBlock_Array* cmd = stack.Arg0().DereferenceArray();
+    CLR_RT_HeapBlock_Array* reply = stack.Arg1().DereferenceArray();
+    if (!cmd || !reply) NANOCLR_SET_AND_LEAVE(CLR_E_INVALID_PARAMETER);
+
+    ensure_event_thread();
+
+    uint8_t reply_length = 0;
+    diseqc_status_t status = DISEQC_ERROR_INVALID_PARAM;
+
+    if (cmd->m_numOfElements <= DISEQC_MAX_BYTES && reply->m_numOfElements > 0)
+    {
+        uint8_t reply_size = reply->m_numOfElements > 255 ? 255 : (uint8_t)reply->m_numOfElements;
+        status = diseqc_query(cmd->GetFirstElement(), (uint8_t)cmd->m_numOfElements,
+                              reply->GetFirstElement(), reply_size, &reply_length);
+    }
+
+    stack.SetResult_I4(status == DISEQC_OK ? (int32_t)reply_length : -(int32_t)status);
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeToneBurst___STATIC__I4__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    int32_t burst = stack.Arg0().NumericByRef().s4;
+    diseqc_status_t status = diseqc_tone_burst((diseqc_burst_t)burst);
+    stack.SetResult_I4((int32_t)status);
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+// Voltage, committed switch, burst and tone in one call (~110 ms, blocking).
+HRESULT Library_diseqc_interop_DiSEqC_NativeSwitch___STATIC__I4__I4__I4__I4__BOOLEAN(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    diseqc_switch_t sw;
+    int32_t port = stack.Arg0().NumericByRef().s4;
+    sw.port = (port < 0) ? DISEQC_SWITCH_NO_COMMITTED : (uint8_t)port;
+    sw.voltage = (lnb_voltage_t)stack.Arg1().NumericByRef().s4;
+    sw.burst = (diseqc_burst_t)stack.Arg2().NumericByRef().s4;
+    sw.tone = stack.Arg3().NumericByRef().u1 != 0;
+    diseqc_status_t status = (port > 3) ? DISEQC_ERROR_INVALID_PARAM : diseqc_switch_sequence(&sw);
+    stack.SetResult_I4((int32_t)status);
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+// Satellite ids are hashed once here; the table and the command path only
+// ever see the 32-bit hash.
+static bool hash_sat_id(CLR_RT_HeapBlock_String* id, uint32_t* hash)
+{
+    const char* text = id->StringText();
+    size_t length = 0;
+
+    while (text[length] != '\0')
+    {
+        if (++length > DISEQC_SAT_ID_MAX)
+        {
+            return false;
+        }
+    }
+
+    if (length == 0)
+    {
+        return false;
+    }
+
+    *hash = diseqc_sat_hash(text, length);
+    return true;
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGotoSatellite___STATIC__I4__STRING(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    CLR_RT_HeapBlock_String* id = stack.Arg0().DereferenceString();
+    FAULT_ON_NULL(id);
+
+    uint32_t hash = 0;
+    diseqc_status_t status = hash_sat_id(id, &hash) ? diseqc_goto_satellite(hash) : DISEQC_ERROR_INVALID_PARAM;
+    stack.SetResult_I4((int32_t)status);
+    NANOCLR_NOCLEANUP();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeStoreSatellite___STATIC__I4__STRING__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    CLR_RT_HeapBlock_String* id = stack.Arg0().DereferenceString();
+    int32_t slot = stack.Arg1().NumericByRef().s4;
+    FAULT_ON_NULL(id);
+
+    uint32_t hash = 0;
+    diseqc_status_t status = DISEQC_ERROR_INVALID_PARAM;
+    if (slot > 0 && slot <= 255 && hash_sat_id(id, &hash))
+    {
+        status = diseqc_store_satellite(hash, (uint8_t)slot);
+    }
+    stack.SetResult_I4((int32_t)status);
+    NANOCLR_NOCLEANUP();
+}
+
+// Add or replace a user table entry without moving the dish.
+HRESULT Library_diseqc_interop_DiSEqC_NativeSetSatellite___STATIC__I4__STRING__I4__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    CLR_RT_HeapBlock_String* id = stack.Arg0().DereferenceString();
+    int32_t longitudeTenths = stack.Arg1().NumericByRef().s4;
+    int32_t slot = stack.Arg2().NumericByRef().s4;
+    FAULT_ON_NULL(id);
+
+    diseqc_status_t status = DISEQC_ERROR_INVALID_PARAM;
+    diseqc_sat_entry_t entry;
+    if (longitudeTenths >= -1800 && longitudeTenths <= 1800 && slot >= 0 && slot <= 255 &&
+        hash_sat_id(id, &entry.id_hash))
+    {
+        entry.longitude_tenths = (int16_t)longitudeTenths;
+        entry.slot = (uint8_t)slot;
+        entry.flags = DISEQC_SAT_FLAG_LONGITUDE;
+        status = diseqc_sat_table_set(diseqc_get_sat_table(), &entry) ? DISEQC_OK : DISEQC_ERROR_BUSY;
+    }
+    stack.SetResult_I4((int32_t)status);
+    NANOCLR_NOCLEANUP();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGotoPosition___STATIC__I4__U1(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    uint8_t slot = stack.Arg0().NumericByRef().u1;
+    stack.SetResult_I4((int32_t)diseqc_goto_position(slot));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeStorePosition___STATIC__I4__U1(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    uint8_t slot = stack.Arg0().NumericByRef().u1;
+    stack.SetResult_I4((int32_t)diseqc_store_position(slot));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+// Serialise the user table for FRAM. Returns the blob length or -status.
+HRESULT Library_diseqc_interop_DiSEqC_NativeExportSatelliteTable___STATIC__I4__SZARRAY_U1(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    CLR_RT_HeapBlock_Array* arr = stack.Arg0().DereferenceArray();
+    if (!arr) NANOCLR_SET_AND_LEAVE(CLR_E_INVALID_PARAMETER);
+
+    size_t length = diseqc_sat_table_export(diseqc_get_sat_table(), arr->GetFirstElement(), arr->m_numOfElements);
+    stack.SetResult_I4(length != 0 ? (int32_t)length : -(int32_t)DISEQC_ERROR_INVALID_PARAM);
+    NANOCLR_NOCLEANUP();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeImportSatelliteTable___STATIC__I4__SZARRAY_U1(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    CLR_RT_HeapBlock_Array* arr = stack.Arg0().DereferenceArray();
+    if (!arr) NANOCLR_SET_AND_LEAVE(CLR_E_INVALID_PARAMETER);
+
+    bool ok = diseqc_sat_table_import(diseqc_get_sat_table(), arr->GetFirstElement(), arr->m_numOfElements);
+    stack.SetResult_I4((int32_t)(ok ? DISEQC_OK : DISEQC_ERROR_INVALID_PARAM));
+    NANOCLR_NOCLEANUP();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeSetSite___STATIC__I4__I4__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    int32_t latMdeg = stack.Arg0().NumericByRef().s4;
+    int32_t lonMdeg = stack.Arg1().NumericByRef().s4;
+    stack.SetResult_I4((int32_t)diseqc_set_site(latMdeg, lonMdeg));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGotoUsals___STATIC__I4__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    int32_t satLonMdeg = stack.Arg0().NumericByRef().s4;
+    stack.SetResult_I4((int32_t)diseqc_goto_usals(satLonMdeg));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGetCompletedSequence___STATIC__U4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    stack.SetResult_U4(diseqc_get_completed_sequence());
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGetCurrentAngle___STATIC__R4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    stack.SetResult_R4(diseqc_get_current_angle());
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGetMotionState___STATIC__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    ensure_event_thread();
+    stack.SetResult_I4((int32_t)diseqc_get_motion(NULL, NULL));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGetMotionEta___STATIC__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    int32_t etaMs = 0;
+    diseqc_get_motion(NULL, &etaMs);
+    stack.SetResult_I4(etaMs);
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeSetMotionProfile___STATIC__I4__I4__I4__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    diseqc_motion_config_t config;
+    config.speed_mdeg_s = stack.Arg0().NumericByRef().s4;
+    config.accel_mdeg_s2 = stack.Arg1().NumericByRef().s4;
+    config.backlash_mdeg = stack.Arg2().NumericByRef().s4;
+    stack.SetResult_I4((int32_t)diseqc_set_motion_profile(&config));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+// Flush the queue, cut the frame on the wire at the next segment edge and
+// (optionally) send Halt first. Never fails with BUSY.
+HRESULT Library_diseqc_interop_DiSEqC_NativeAbort___STATIC__I4__BOOLEAN(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    ensure_event_thread();
+    bool sendHalt = stack.Arg0().NumericByRef().u1 != 0;
+    stack.SetResult_I4((int32_t)diseqc_abort(sendHalt));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_diseqc_interop_DiSEqC_NativeGetAbortLatency___STATIC__U4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+    stack.SetResult_U4(diseqc_get_abort_latency_us(NULL));
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
@@ -0,0 +1,210 @@
+/**
+ * @file diseqc_motion.cpp
+ * @brief HAL-independent rotor motion estimator
+ */
+
+#include "diseqc_motion.h"
+
+static const diseqc_motion_config_t default_config = {
+    DISEQC_MOTION_SPEED_MDEG_S,
+    DISEQC_MOTION_ACCEL_MDEG_S2,
+    DISEQC_MOTION_BACKLASH_MDEG
+};
+
+static int32_t abs32(int32_t value)
+{
+    return value < 0 ? -value : value;
+}
+
+static uint32_t isqrt64(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+void diseqc_motion_init(diseqc_motion_t *motion, const diseqc_motion_config_t *config, int32_t position_mdeg)
+{
+    motion->config = (config != NULL) ? *config : default_config;
+    motion->position_mdeg = position_mdeg;
+    motion->target_mdeg = position_mdeg;
+    motion->velocity_mdeg_s = 0;
+    motion->backlash_left_mdeg = 0;
+    motion->direction = 0;
+    motion->state = DISEQC_MOTION_SETTLED;
+    motion->position_known = true;
+}
+
+static void start_move(diseqc_motion_t *motion, int32_t target_mdeg, uint8_t state)
+{
+    int8_t direction = (target_mdeg > motion->position_mdeg) ? 1 : -1;
+
+    if (target_mdeg == motion->position_mdeg && motion->state == DISEQC_MOTION_SETTLED) {
+        motion->target_mdeg = target_mdeg;
+        return;
+    }
+
+    if (direction != motion->direction) {
+        // Reversal: the motor turns through the slack before the dish moves,
+        // and any speed in the old direction is lost
+        if (motion->direction != 0) {
+            motion->backlash_left_mdeg = motion->config.backlash_mdeg;
+        }
+        motion->velocity_mdeg_s = 0;
+        motion->direction = direction;
+    }
+
+    motion->target_mdeg = target_mdeg;
+    motion->state = state;
+}
+
+void diseqc_motion_goto(diseqc_motion_t *motion, int32_t target_mdeg)
+{
+    motion->position_known = true;
+    start_move(motion, target_mdeg, DISEQC_MOTION_MOVING);
+}
+
+void diseqc_motion_drive(diseqc_motion_t *motion, int8_t direction)
+{
+    start_move(motion, direction > 0 ? DISEQC_MOTION_LIMIT_MDEG : -DISEQC_MOTION_LIMIT_MDEG,
+               DISEQC_MOTION_DRIVING);
+}
+
+void diseqc_motion_halt(diseqc_motion_t *motion)
+{
+    if (motion->state == DISEQC_MOTION_SETTLED) {
+        return;
+    }
+
+    // Stop target = where the dish ends up after spinning down
+    int32_t accel = motion->config.accel_mdeg_s2 > 0 ? motion->config.accel_mdeg_s2 : 1;
+    int64_t v = motion->velocity_mdeg_s;
+    int32_t stopping = (int32_t)((v * v) / (2 * accel));
+    int32_t remaining = abs32(motion->target_mdeg - motion->position_mdeg);
+    if (stopping > remaining) {
+        stopping = remaining;
+    }
+
+    motion->target_mdeg = motion->position_mdeg + motion->direction * stopping;
+    motion->backlash_left_mdeg = 0;
+    motion->state = DISEQC_MOTION_MOVING;
+}
+
+void diseqc_motion_invalidate(diseqc_motion_t *motion)
+{
+    motion->position_known = false;
+    motion->velocity_mdeg_s = 0;
+    motion->backlash_left_mdeg = 0;
+    motion->direction = 0;
+    motion->target_mdeg = motion->position_mdeg;
+    motion->state = DISEQC_MOTION_SETTLED;
+}
+
+bool diseqc_motion_advance(diseqc_motion_t *motion, uint32_t dt_ms)
+{
+    if (motion->state == DISEQC_MOTION_SETTLED || dt_ms == 0) {
+        return false;
+    }
+
+    const diseqc_motion_config_t *cfg = &motion->config;
+    int32_t accel = cfg->accel_mdeg_s2 > 0 ? cfg->accel_mdeg_s2 : 1;
+    int32_t remaining = abs32(motion->target_mdeg - motion->position_mdeg) + motion->backlash_left_mdeg;
+
+    // Trapezoid: brake once the stopping distance reaches what is left
+    int64_t v = motion->velocity_mdeg_s;
+    int64_t stopping = (v * v) / (2 * accel);
+    int64_t dv = ((int64_t)accel * dt_ms) / 1000;
+    int64_t v_next;
+
+    if (stopping >= remaining) {
+        v_next = v - dv;
+    } else {
+        v_next = v + dv;
+        if (v_next > cfg->speed_mdeg_s) {
+            v_next = cfg->speed_mdeg_s;
+        }
+    }
+
+    // Never stall short of the target because of integer rounding
+    if (v_next < dv) {
+        v_next = dv > 0 ? dv : 1;
+    }
+
+    // Distance covered this tick at the average speed
+    int64_t travel = ((v + v_next) * dt_ms) / 2000;
+    if (travel <= 0) {
+        travel = 1;
+    }
+    motion->velocity_mdeg_s = (int32_t)v_next;
+
+    if (travel >= remaining) {
+        motion->position_mdeg = motion->target_mdeg;
+        motion->backlash_left_mdeg = 0;
+        motion->velocity_mdeg_s = 0;
+        motion->state = DISEQC_MOTION_SETTLED;
+        return true;
+    }
+
+    if (motion->backlash_left_mdeg > 0) {
+        int32_t slack = travel < motion->backlash_left_mdeg ? (int32_t)travel : motion->backlash_left_mdeg;
+        motion->backlash_left_mdeg -= slack;
+        travel -= slack;
+    }
+
+    motion->position_mdeg += motion->direction * (int32_t)travel;
+    return false;
+}
+
+int32_t diseqc_motion_eta_ms(const diseqc_motion_t *motion)
+{
+    if (motion->state == DISEQC_MOTION_SETTLED) {
+        return 0;
+    }
+
+    if (motion->state == DISEQC_MOTION_DRIVING) {
+        return -1;
+    }
+
+    const diseqc_motion_config_t *cfg = &motion->config;
+    int64_t a = cfg->accel_mdeg_s2 > 0 ? cfg->accel_mdeg_s2 : 1;
+    int64_t vmax = cfg->speed_mdeg_s > 0 ? cfg->speed_mdeg_s : 1;
+    int64_t v = motion->velocity_mdeg_s;
+    int64_t d = abs32(motion->target_mdeg - motion->position_mdeg) + motion->backlash_left_mdeg;
+
+    if (v * v >= 2 * a * d) {
+        // Already braking: time to spin down over d
+        return (int32_t)(v > 0 ? (2000 * d) / v : 0);
+    }
+
+    // Speed up to vmax (or a triangular peak), cruise, then brake
+    int64_t d_up = (vmax * vmax - v * v) / (2 * a);
+    int64_t d_down = (vmax * vmax) / (2 * a);
+
+    if (d_up + d_down <= d) {
+        int64_t cruise = d - d_up - d_down;
+        return (int32_t)((1000 * (vmax - v)) / a + (1000 * cruise) / vmax + (1000 * vmax) / a);
+    }
+
+    int64_t peak = isqrt64((uint64_t)(a * d + (v * v) / 2));
+    return (int32_t)((1000 * (peak - v)) / a + (1000 * peak) / a);
+}
+
+bool diseqc_motion_busy(const diseqc_motion_t *motion)
+{
+    return motion->state != DISEQC_MOTION_SETTLED;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file diseqc_motion.h
+ * @brief HAL-independent rotor motion estimator
+ *
+ * DiSEqC 1.2 positioners do not report their position, so the driver keeps
+ * a kinematic model of the dish instead: trapezoidal velocity profile
+ * (configured speed and acceleration) plus backlash taken up on every
+ * direction reversal. The model is advanced from a low-rate timer and gives
+ * an estimated angle, an ETA and a "settled" edge when the move completes.
+ *
+ * All quantities are integers: millidegrees, milliseconds, mdeg/s, mdeg/s².
+ * Angles follow the GotoX sign convention (West positive, East negative).
+ */
+
+#ifndef DISEQC_MOTION_H
+#define DISEQC_MOTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default Profile (typical SG-2100 / Stab class motors at 13V-18V) */
+#define DISEQC_MOTION_SPEED_MDEG_S          1800    // Cruise speed
+#define DISEQC_MOTION_ACCEL_MDEG_S2         3600    // Spin-up / spin-down
+#define DISEQC_MOTION_BACKLASH_MDEG         200     // Slack taken up on reversal
+#define DISEQC_MOTION_STEP_MDEG             1000    // One DiSEqC "step" (see diseqc_step_east)
+#define DISEQC_MOTION_LIMIT_MDEG            80000   // Travel limit for continuous drive
+
+/* Motion States */
+typedef enum {
+    DISEQC_MOTION_SETTLED = 0,      // Stationary at position_mdeg
+    DISEQC_MOTION_MOVING = 1,       // Heading for target_mdeg
+    DISEQC_MOTION_DRIVING = 2       // Continuous drive until halt (or the travel limit)
+} diseqc_motion_state_t;
+
+/* Motor Profile */
+typedef struct {
+    int32_t speed_mdeg_s;
+    int32_t accel_mdeg_s2;
+    int32_t backlash_mdeg;
+} diseqc_motion_config_t;
+
+/* Estimator State */
+typedef struct {
+    diseqc_motion_config_t config;
+    int32_t position_mdeg;          // Estimated dish angle
+    int32_t target_mdeg;            // Where the dish is heading
+    int32_t velocity_mdeg_s;        // Current speed (magnitude)
+    int32_t backlash_left_mdeg;     // Motor travel still absorbed by slack
+    int8_t direction;               // +1 West, -1 East, 0 never moved
+    uint8_t state;                  // diseqc_motion_state_t
+    bool position_known;            // False after a move to an unknown target
+} diseqc_motion_t;
+
+/**
+ * @brief Reset to settled at a known angle
+ * @param config Motor profile, NULL for the defaults
+ */
+void diseqc_motion_init(diseqc_motion_t *motion, const diseqc_motion_config_t *config, int32_t position_mdeg);
+
+/**
+ * @brief Start a move to an absolute angle (GotoX, Goto NN with known angle, step)
+ */
+void diseqc_motion_goto(diseqc_motion_t *motion, int32_t target_mdeg);
+
+/**
+ * @brief Start a continuous drive (+1 West, -1 East) until halt
+ */
+void diseqc_motion_drive(diseqc_motion_t *motion, int8_t direction);
+
+/**
+ * @brief Halt: decelerate to a stop from the current speed
+ */
+void diseqc_motion_halt(diseqc_motion_t *motion);
+
+/**
+ * @brief Mark the position as unknown (move to a slot with no known angle)
+ */
+void diseqc_motion_invalidate(diseqc_motion_t *motion);
+
+/**
+ * @brief Advance the model
+ * @param dt_ms Elapsed time since the previous call
+ * @return true exactly once, on the tick the dish settles
+ */
+bool diseqc_motion_advance(diseqc_motion_t *motion, uint32_t dt_ms);
+
+/**
+ * @brief Estimated time until the dish settles
+ * @return Milliseconds, 0 when settled, -1 for a continuous drive
+ */
+int32_t diseqc_motion_eta_ms(const diseqc_motion_t *motion);
+
+/**
+ * @brief True while a move or drive is in progress
+ */
+bool diseqc_motion_busy(const diseqc_motion_t *motion);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISEQC_MOTION_H */
@@ -6,7 +6,6 @@
 #include "diseqc_native.h"
 #include "board_cubley.h"
 #include <string.h>
-#include <math.h>
 
 void ConfigPins_I2C3(void)
 {
@@ -45,11 +44,30 @@ static GPTConfig gpt_config = {
 
 /* Forward declarations */
 static void gpt_callback(GPTDriver *gptp);
-static THD_WORKING_AREA(wa_diseqc_tx, 1024);
+static THD_WORKING_AREA(wa_diseqc_tx, DISEQC_TX_THREAD_WA_SIZE);
 static THD_FUNCTION(diseqc_tx_thread, arg);
-static uint8_t calculate_parity(uint8_t byte);
-static void add_bit(bool bit_value);
-static void add_byte_with_parity(uint8_t byte);
+static void apply_action_s(const diseqc_seq_action_t *action);
+static void rx_edge_callback(void *arg);
+static void kick_sequencer(void);
+static void motion_tick(virtual_timer_t *vtp, void *arg);
+
+static_assert(sizeof(diseqc_handle_t) + sizeof(wa_diseqc_tx) <= DISEQC_RAM_BUDGET_BYTES,
+              "DiSEqC driver exceeds its static RAM budget");
+
+/* Fixed command frames, indexed by diseqc_fixed_cmd_t */
+static const diseqc_bits_t fixed_frames[DISEQC_CMD_COUNT] = {
+    DISEQC_BITS_RESET,
+    DISEQC_BITS_CLEAR_RESET,
+    DISEQC_BITS_STANDBY,
+    DISEQC_BITS_POWER_ON,
+    DISEQC_BITS_HALT,
+    DISEQC_BITS_LIMITS_OFF,
+    DISEQC_BITS_LIMIT_EAST,
+    DISEQC_BITS_LIMIT_WEST,
+    DISEQC_BITS_DRIVE_EAST,
+    DISEQC_BITS_DRIVE_WEST,
+    DISEQC_BITS_GOTO_REFERENCE
+};
 
 /**
  * @brief Initialize DiSEqC driver
@@ -64,12 +82,27 @@ diseqc_status_t diseqc_init(PWMDriver *pwm_driver, GPTDriver *gpt_driver)
     
     g_diseqc.pwm_driver = pwm_driver;
     g_diseqc.gpt_driver = gpt_driver;
-    g_diseqc.carrier_duty = 22;  // ~50% duty cycle at period 45
+    g_diseqc.carrier_duty = DISEQC_CARRIER_DUTY;  // ~50% duty cycle at period 45
     g_diseqc.max_angle = 80.0f;
-    g_diseqc.is_transmitting = false;
+    g_diseqc.tx_mode = DISEQC_DEFAULT_TX_MODE;
+    
+    diseqc_sequencer_init(&g_diseqc.seq, g_diseqc.carrier_duty);
+    diseqc_sat_table_init(&g_diseqc.sats);
+    diseqc_motion_init(&g_diseqc.motion, NULL, 0);
+    chVTObjectInit(&g_diseqc.motion_vt);
     
-    // Initialize semaphore
-    chBSemObjectInit(&g_diseqc.tx_complete_sem, false);
+    // Initialize semaphore (taken: thread waits for the first step) and event source
+    chBSemObjectInit(&g_diseqc.tx_complete_sem, true);
+    chEvtObjectInit(&g_diseqc.tx_event);
+    
+    // Reply receiver: decoder ring fed from tone-detect edges
+    diseqc_rx_init(&g_diseqc.rx);
+    chBSemObjectInit(&g_diseqc.rx_sem, true);
+    g_diseqc.rx_last_cycles = chSysGetRealtimeCounterX();
+    
+    palSetLineMode(DISEQC_RX_LINE, PAL_MODE_INPUT_PULLUP);
+    palEnableLineEvent(DISEQC_RX_LINE, PAL_EVENT_MODE_BOTH_EDGES);
+    palSetLineCallback(DISEQC_RX_LINE, rx_edge_callback, NULL);
     
     // Start PWM driver
     pwmStart(pwm_driver, &pwm_config);
@@ -79,7 +112,7 @@ diseqc_status_t diseqc_init(PWMDriver *pwm_driver, GPTDriver *gpt_driver)
     gpt_config.callback = gpt_callback;
     gptStart(gpt_driver, &gpt_config);
     
-    // Create transmission thread
+    // Create transmission thread (only used in DISEQC_TX_MODE_THREAD)
     g_diseqc.tx_thread = chThdCreateStatic(wa_diseqc_tx, sizeof(wa_diseqc_tx),
                                            NORMALPRIO + 1, diseqc_tx_thread, NULL);
     
@@ -87,77 +120,160 @@ diseqc_status_t diseqc_init(PWMDriver *pwm_driver, GPTDriver *gpt_driver)
 }
 
 /**
- * @brief Calculate even parity bit
+ * @brief Apply a sequencer step to the hardware and publish completions
+ *
+ * Called from the GPT callback (ISR mode) or the diseqc_tx thread (thread
+ * mode), always with the system locked.
  */
-static uint8_t calculate_parity(uint8_t byte)
+static void apply_action_s(const diseqc_seq_action_t *action)
 {
-    uint8_t parity = 0;
-    for (int i = 0; i < 8; i++) {
-        parity ^= (byte >> i) & 1;
+    pwmEnableChannelI(g_diseqc.pwm_driver, 0, action->ccr_value);
+    g_diseqc.carrier_on = action->ccr_value != 0;
+    
+    if (g_diseqc.abort_timing && !g_diseqc.carrier_on) {
+        // First carrier-off after an abort request closes the latency measurement
+        rtcnt_t now = chSysGetRealtimeCounterX();
+        g_diseqc.abort_latency_us = (uint32_t)RTC2US(STM32_HCLK, now - g_diseqc.abort_cycles);
+        if (g_diseqc.abort_latency_us > g_diseqc.abort_latency_max_us) {
+            g_diseqc.abort_latency_max_us = g_diseqc.abort_latency_us;
+        }
+        g_diseqc.abort_timing = false;
+    }
+    
+    if (action->duration_us != 0) {
+        gptStartOneShotI(g_diseqc.gpt_driver, action->duration_us);
+    }
+    
+    eventflags_t flags = 0;
+    if (action->completed != 0) {
+        flags |= DISEQC_EVT_FRAME_DONE;
+    }
+    if (action->idle) {
+        flags |= DISEQC_EVT_IDLE;
+    }
+    
+    if (flags != 0) {
+        chEvtBroadcastFlagsI(&g_diseqc.tx_event, flags);
+        if (g_diseqc.completion_cb != NULL) {
+            g_diseqc.completion_cb(action->completed, (uint32_t)flags);
+        }
     }
-    return parity;
 }
 
 /**
- * @brief Add a bit to transmission buffer
+ * @brief GPT callback - advances the sequencer
+ *
+ * In ISR mode the callback runs the next step itself, so frames and the
+ * inter-message gap play out from the timer interrupt without waking any
+ * thread. In one-shot mode the GPT driver is already back in READY state
+ * here, which makes gptStartOneShotI() legal from the callback.
  */
-static void add_bit(bool bit_value)
+static void gpt_callback(GPTDriver *gptp)
 {
-    uint16_t high_duration, low_duration;
+    (void)gptp;
+    
+    chSysLockFromISR();
     
-    if (bit_value) {
-        // Bit '1': 500µs ON, 1000µs OFF
-        high_duration = DISEQC_BIT1_HIGH_US;
-        low_duration = DISEQC_BIT1_LOW_US;
+    if (g_diseqc.tx_mode == DISEQC_TX_MODE_ISR) {
+        diseqc_seq_action_t action = diseqc_sequencer_step(&g_diseqc.seq);
+        apply_action_s(&action);
     } else {
-        // Bit '0': 1000µs ON, 500µs OFF
-        high_duration = DISEQC_BIT0_HIGH_US;
-        low_duration = DISEQC_BIT0_LOW_US;
+        // Signal transmission thread to run the step
+        chBSemSignalI(&g_diseqc.tx_complete_sem);
     }
     
-    // Add ON segment
-    g_diseqc.segments[g_diseqc.segment_count].ccr_value = g_diseqc.carrier_duty;
-    g_diseqc.segments[g_diseqc.segment_count].duration_us = high_duration;
-    g_diseqc.segment_count++;
-    
-    // Add OFF segment
-    g_diseqc.segments[g_diseqc.segment_count].ccr_value = 0;
-    g_diseqc.segments[g_diseqc.segment_count].duration_us = low_duration;
-    g_diseqc.segment_count++;
+    chSysUnlockFromISR();
 }
 
 /**
- * @brief Add byte with parity to buffer
+ * @brief Tone-detect edge callback - timestamps the edge and feeds the decoder
+ *
+ * Timestamps come from the DWT cycle counter; only the delta since the
+ * previous edge is converted, so the 25 s cycle counter wrap is harmless.
  */
-static void add_byte_with_parity(uint8_t byte)
+static void rx_edge_callback(void *arg)
 {
-    // Add 8 data bits (MSB first)
-    for (int i = 7; i >= 0; i--) {
-        add_bit((byte >> i) & 1);
+    (void)arg;
+    
+    rtcnt_t now = chSysGetRealtimeCounterX();
+    bool tone_on = palReadLine(DISEQC_RX_LINE) == PAL_LOW;
+    
+    chSysLockFromISR();
+    
+    g_diseqc.rx_time_us += (uint32_t)RTC2US(STM32_HCLK, now - g_diseqc.rx_last_cycles);
+    g_diseqc.rx_last_cycles = now;
+    
+    if (diseqc_rx_edge(&g_diseqc.rx, g_diseqc.rx_time_us, tone_on)) {
+        chBSemSignalI(&g_diseqc.rx_sem);
     }
     
-    // Add parity bit (DiSEqC uses odd parity transmission)
-    uint8_t parity = calculate_parity(byte);
-    add_bit(parity == 0 ? 1 : 0);  // Even parity → send '1'
+    chSysUnlockFromISR();
 }
 
 /**
- * @brief GPT callback - advances to next segment
+ * @brief Keep the motion timer running while the estimate is moving (system locked)
  */
-static void gpt_callback(GPTDriver *gptp)
+static void motion_arm_s(void)
 {
-    (void)gptp;
+    if (diseqc_motion_busy(&g_diseqc.motion) && !chVTIsArmedI(&g_diseqc.motion_vt)) {
+        chVTSetI(&g_diseqc.motion_vt, TIME_MS2I(DISEQC_MOTION_TICK_MS), motion_tick, NULL);
+    }
+}
+
+/**
+ * @brief Motion timer - advances the estimate and publishes the settle edge
+ */
+static void motion_tick(virtual_timer_t *vtp, void *arg)
+{
+    (void)vtp;
+    (void)arg;
     
     chSysLockFromISR();
     
-    // Signal transmission thread to continue
-    chBSemSignalI(&g_diseqc.tx_complete_sem);
+    if (diseqc_motion_advance(&g_diseqc.motion, DISEQC_MOTION_TICK_MS)) {
+        chEvtBroadcastFlagsI(&g_diseqc.tx_event, DISEQC_EVT_SETTLED);
+        if (g_diseqc.completion_cb != NULL) {
+            g_diseqc.completion_cb(0, DISEQC_EVT_SETTLED);
+        }
+    }
+    motion_arm_s();
     
     chSysUnlockFromISR();
 }
 
+/* Estimator updates for a command that has been queued */
+typedef enum {
+    MOTION_GOTO,            // arg = target millidegrees
+    MOTION_DRIVE,           // arg = direction (+1 West, -1 East)
+    MOTION_HALT,
+    MOTION_LOST             // Move to a slot with no known angle
+} motion_op_t;
+
+static void motion_command(motion_op_t op, int32_t arg)
+{
+    chSysLock();
+    
+    switch (op) {
+        case MOTION_GOTO:
+            diseqc_motion_goto(&g_diseqc.motion, arg);
+            break;
+        case MOTION_DRIVE:
+            diseqc_motion_drive(&g_diseqc.motion, (int8_t)arg);
+            break;
+        case MOTION_HALT:
+            diseqc_motion_halt(&g_diseqc.motion);
+            break;
+        case MOTION_LOST:
+            diseqc_motion_invalidate(&g_diseqc.motion);
+            break;
+    }
+    motion_arm_s();
+    
+    chSysUnlock();
+}
+
 /**
- * @brief Transmission thread
+ * @brief Transmission thread (DISEQC_TX_MODE_THREAD only)
  */
 static THD_FUNCTION(diseqc_tx_thread, arg)
 {
@@ -166,33 +282,13 @@ static THD_FUNCTION(diseqc_tx_thread, arg)
     chRegSetThreadName("diseqc_tx");
     
     while (true) {
-        // Wait for transmission to start
+        // Woken by a kick from diseqc_enqueue_bits or by each timer expiry
+        chBSemWait(&g_diseqc.tx_complete_sem);
+        
         chSysLock();
-        while (!g_diseqc.is_transmitting) {
-            chSchGoSleepS(CH_STATE_SUSPENDED);
-        }
+        diseqc_seq_action_t action = diseqc_sequencer_step(&g_diseqc.seq);
+        apply_action_s(&action);
         chSysUnlock();
-        
-        // Transmit all segments
-        for (g_diseqc.segment_index = 0; 
-             g_diseqc.segment_index < g_diseqc.segment_count; 
-             g_diseqc.segment_index++) {
-            
-            diseqc_segment_t *seg = &g_diseqc.segments[g_diseqc.segment_index];
-            
-            // Update PWM duty cycle
-            pwmEnableChannel(g_diseqc.pwm_driver, 0, seg->ccr_value);
-            
-            // Start GPT for segment duration
-            gptStartOneShot(g_diseqc.gpt_driver, seg->duration_us);
-            
-            // Wait for segment to complete
-            chBSemWait(&g_diseqc.tx_complete_sem);
-        }
-        
-        // Transmission complete
-        pwmEnableChannel(g_diseqc.pwm_driver, 0, 0);  // Carrier OFF
-        g_diseqc.is_transmitting = false;
     }
 }
 
@@ -205,30 +301,71 @@ diseqc_status_t diseqc_transmit(const uint8_t *data, uint8_t length)
         return DISEQC_ERROR_INVALID_PARAM;
     }
     
-    if (g_diseqc.is_transmitting) {
-        return DISEQC_ERROR_BUSY;
-    }
-    
-    // Build transmission buffer
-    g_diseqc.segment_count = 0;
+    // Pack bytes + parity; the timer path expands segments on the fly
+    diseqc_bits_t frame = diseqc_bits_from_bytes(data, length);
     
-    for (uint8_t i = 0; i < length; i++) {
-        add_byte_with_parity(data[i]);
+    if (frame.bit_count == 0) {
+        return DISEQC_ERROR_INVALID_PARAM;
     }
     
-    if (g_diseqc.segment_count == 0) {
+    return diseqc_enqueue_bits(frame, NULL);
+}
+
+/**
+ * @brief Queue a packed frame
+ */
+diseqc_status_t diseqc_enqueue_bits(diseqc_bits_t frame, uint32_t *sequence)
+{
+    if (frame.bit_count == 0 || frame.bit_count > DISEQC_MAX_BITS) {
         return DISEQC_ERROR_INVALID_PARAM;
     }
     
-    // Start transmission
-    g_diseqc.segment_index = 0;
-    g_diseqc.is_transmitting = true;
+    // Lock-free push; only the idle -> running transition needs the lock
+    if (!diseqc_sequencer_enqueue(&g_diseqc.seq, frame, sequence)) {
+        return DISEQC_ERROR_BUSY;
+    }
     
+    kick_sequencer();
+    return DISEQC_OK;
+}
+
+/**
+ * @brief Start the timer path if the sequencer was idle
+ */
+static void kick_sequencer(void)
+{
     chSysLock();
-    chSchWakeupS(g_diseqc.tx_thread, MSG_OK);
+    if (diseqc_sequencer_kick(&g_diseqc.seq)) {
+        if (g_diseqc.tx_mode == DISEQC_TX_MODE_ISR) {
+            // First segment starts here, the GPT callback plays the rest
+            diseqc_seq_action_t action = diseqc_sequencer_step(&g_diseqc.seq);
+            apply_action_s(&action);
+        } else {
+            chBSemSignalI(&g_diseqc.tx_complete_sem);
+            chSchRescheduleS();
+        }
+    }
     chSysUnlock();
+}
+
+/**
+ * @brief Queue a packed frame
+ */
+diseqc_status_t diseqc_transmit_bits(diseqc_bits_t frame)
+{
+    return diseqc_enqueue_bits(frame, NULL);
+}
+
+/**
+ * @brief Transmit a fixed command
+ */
+diseqc_status_t diseqc_send_fixed(diseqc_fixed_cmd_t cmd)
+{
+    if (cmd >= DISEQC_CMD_COUNT) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
     
-    return DISEQC_OK;
+    return diseqc_transmit_bits(fixed_frames[cmd]);
 }
 
 /**
@@ -236,10 +373,28 @@ diseqc_status_t diseqc_transmit(const uint8_t *data, uint8_t length)
  */
 diseqc_status_t diseqc_goto_angle(float angle)
 {
-    // Clamp angle
+    // Clamp in float: out-of-range angles would overflow int16_t below
+    if (angle != angle) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
     if (angle > g_diseqc.max_angle) angle = g_diseqc.max_angle;
     if (angle < -g_diseqc.max_angle) angle = -g_diseqc.max_angle;
     
+    // Round to GotoX resolution; everything below is integer
+    float scaled = angle * 16.0f;
+    return diseqc_goto_angle16((int16_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f));
+}
+
+/**
+ * @brief Send GotoX command (1/16° units)
+ */
+diseqc_status_t diseqc_goto_angle16(int16_t angle_16)
+{
+    // Clamp angle
+    int16_t max_16 = (int16_t)(g_diseqc.max_angle * 16.0f);
+    if (angle_16 > max_16) angle_16 = max_16;
+    if (angle_16 < -max_16) angle_16 = -max_16;
+    
     // Build DiSEqC 1.2 GotoX command
     uint8_t cmd[5];
     
@@ -247,29 +402,238 @@ diseqc_status_t diseqc_goto_angle(float angle)
     cmd[1] = 0x31;  // Any positioner
     cmd[2] = 0x6E;  // GotoX
     
-    // Calculate position (angle * 16)
-    uint8_t direction = (angle < 0) ? 0xE0 : 0xD0;
-    int16_t angle_16 = (int16_t)(16.0f * fabsf(angle) + 0.5f);
+    // Position: direction nibble, then |angle| * 16
+    uint8_t direction = (angle_16 < 0) ? 0xE0 : 0xD0;
+    uint16_t magnitude = (uint16_t)(angle_16 < 0 ? -angle_16 : angle_16);
     
-    cmd[3] = direction | ((angle_16 >> 8) & 0x0F);
-    cmd[4] = angle_16 & 0xFF;
+    cmd[3] = direction | ((magnitude >> 8) & 0x0F);
+    cmd[4] = magnitude & 0xFF;
     
     diseqc_status_t status = diseqc_transmit(cmd, 5);
     
     if (status == DISEQC_OK) {
-        g_diseqc.current_angle = angle;
+        // 1/16° → millidegrees
+        motion_command(MOTION_GOTO, (int32_t)angle_16 * 125 / 2);
+    }
+    
+    return status;
+}
+
+/**
+ * @brief Set USALS site
+ */
+diseqc_status_t diseqc_set_site(int32_t lat_mdeg, int32_t lon_mdeg)
+{
+    if (lat_mdeg < -90000 || lat_mdeg > 90000 || lon_mdeg < -180000 || lon_mdeg > 180000) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    g_diseqc.site_lat_mdeg = lat_mdeg;
+    g_diseqc.site_lon_mdeg = lon_mdeg;
+    g_diseqc.site_valid = true;
+    
+    return DISEQC_OK;
+}
+
+/**
+ * @brief Drive to a satellite longitude using USALS
+ */
+diseqc_status_t diseqc_goto_usals(int32_t sat_lon_mdeg)
+{
+    if (!g_diseqc.site_valid) {
+        return DISEQC_ERROR_NOT_FOUND;
+    }
+    
+    int16_t angle_16 = 0;
+    if (!diseqc_usals_angle16(g_diseqc.site_lat_mdeg, g_diseqc.site_lon_mdeg, sat_lon_mdeg, &angle_16)) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    return diseqc_goto_angle16(angle_16);
+}
+
+/**
+ * @brief Queue a tone burst
+ */
+static diseqc_status_t enqueue_burst(diseqc_burst_t burst, uint32_t *sequence)
+{
+    if (burst == DISEQC_BURST_SB) {
+        return diseqc_enqueue_bits(DISEQC_BITS_BURST_SB, sequence);
+    }
+    
+    if (burst != DISEQC_BURST_SA) {
+        return DISEQC_ERROR_INVALID_PARAM;
     }
     
+    if (!diseqc_sequencer_enqueue_tone(&g_diseqc.seq, DISEQC_TONE_BURST_US, sequence)) {
+        return DISEQC_ERROR_BUSY;
+    }
+    
+    kick_sequencer();
+    return DISEQC_OK;
+}
+
+/**
+ * @brief Queue a mini-DiSEqC tone burst
+ */
+diseqc_status_t diseqc_tone_burst(diseqc_burst_t burst)
+{
+    return enqueue_burst(burst, NULL);
+}
+
+/**
+ * @brief Block until a queued ticket has left the wire
+ */
+static diseqc_status_t wait_for_ticket(uint32_t ticket)
+{
+    event_listener_t listener;
+    diseqc_status_t status = DISEQC_OK;
+    
+    chEvtRegisterMaskWithFlags(&g_diseqc.tx_event, &listener, EVENT_MASK(0),
+                               DISEQC_EVT_FRAME_DONE | DISEQC_EVT_ABORTED);
+    
+    // Earlier frames may still be queued ahead of this one
+    systime_t start = chVTGetSystemTimeX();
+    while ((int32_t)(g_diseqc.seq.completed_sequence - ticket) < 0) {
+        if (diseqc_sequencer_ticket_aborted(&g_diseqc.seq, ticket)) {
+            status = DISEQC_ERROR_ABORTED;
+            break;
+        }
+        if (chVTTimeElapsedSinceX(start) > TIME_MS2I(DISEQC_QUEUE_DEPTH * 150)) {
+            status = DISEQC_ERROR_TIMEOUT;
+            break;
+        }
+        chEvtWaitAnyTimeout(EVENT_MASK(0), TIME_MS2I(10));
+    }
+    
+    // Halt queued by an abort may already have overtaken the dropped ticket
+    if (status == DISEQC_OK && diseqc_sequencer_ticket_aborted(&g_diseqc.seq, ticket)) {
+        status = DISEQC_ERROR_ABORTED;
+    }
+    
+    chEvtUnregister(&g_diseqc.tx_event, &listener);
     return status;
 }
 
+/**
+ * @brief Run a multi-LNB switch sequence
+ */
+diseqc_status_t diseqc_switch_sequence(const diseqc_switch_t *sw)
+{
+    if (sw == NULL || (sw->port > 3 && sw->port != DISEQC_SWITCH_NO_COMMITTED) ||
+        sw->burst > DISEQC_BURST_NONE) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    lnb_handle_t *hlnb = lnb_get_global_handle();
+    
+    // Continuous tone must be off while the bus carries DiSEqC/burst
+    if (lnb_set_tone(hlnb, false) != LNB_OK || lnb_set_voltage(hlnb, sw->voltage) != LNB_OK) {
+        return DISEQC_ERROR_LNB;
+    }
+    
+    chThdSleepMilliseconds(DISEQC_SWITCH_SETTLE_MS);
+    
+    uint32_t ticket = 0;
+    diseqc_status_t status = DISEQC_OK;
+    
+    if (sw->port != DISEQC_SWITCH_NO_COMMITTED) {
+        // Committed switch data byte: 1111 option position polarization band
+        uint8_t data = (uint8_t)(0xF0 | (sw->port << 2) |
+                                 (sw->voltage == LNB_VOLTAGE_18V ? 0x02 : 0x00) |
+                                 (sw->tone ? 0x01 : 0x00));
+        status = diseqc_enqueue_bits(diseqc_bits_append(DISEQC_BITS_COMMITTED_PREFIX, data), &ticket);
+    }
+    
+    if (status == DISEQC_OK && sw->burst != DISEQC_BURST_NONE) {
+        // Queued behind the committed frame: the sequencer inserts the 15 ms gap
+        status = enqueue_burst(sw->burst, &ticket);
+    }
+    
+    if (status == DISEQC_OK && ticket != 0) {
+        status = wait_for_ticket(ticket);
+        if (status == DISEQC_OK) {
+            chThdSleepMilliseconds(DISEQC_SWITCH_SETTLE_MS);
+        }
+    }
+    
+    if (status != DISEQC_OK) {
+        return status;
+    }
+    
+    if (sw->tone && lnb_set_tone(hlnb, true) != LNB_OK) {
+        return DISEQC_ERROR_LNB;
+    }
+    
+    return DISEQC_OK;
+}
+
 /**
  * @brief Send halt command
  */
 diseqc_status_t diseqc_halt(void)
 {
-    uint8_t cmd[3] = {0xE0, 0x31, 0x60};
-    return diseqc_transmit(cmd, 3);
+    return diseqc_abort(true);
+}
+
+/**
+ * @brief Pre-emptive abort
+ */
+diseqc_status_t diseqc_abort(bool send_halt)
+{
+    chSysLock();
+    
+    g_diseqc.abort_cycles = chSysGetRealtimeCounterX();
+    g_diseqc.abort_timing = true;
+    
+    diseqc_seq_action_t action;
+    diseqc_abort_t result = diseqc_sequencer_abort(&g_diseqc.seq,
+                                                   send_halt ? DISEQC_BITS_HALT : DISEQC_BITS_EMPTY,
+                                                   NULL, &action);
+    
+    if (result == DISEQC_ABORT_RELOAD) {
+        gptStopTimerI(g_diseqc.gpt_driver);
+        apply_action_s(&action);
+    } else if (result == DISEQC_ABORT_START) {
+        if (g_diseqc.tx_mode == DISEQC_TX_MODE_ISR) {
+            action = diseqc_sequencer_step(&g_diseqc.seq);
+            apply_action_s(&action);
+        } else {
+            chBSemSignalI(&g_diseqc.tx_complete_sem);
+        }
+    }
+    
+    if (!g_diseqc.carrier_on && g_diseqc.abort_timing) {
+        // Caught in an OFF half or a gap: the carrier is already down
+        g_diseqc.abort_latency_us = 0;
+        g_diseqc.abort_timing = false;
+    }
+    
+    chEvtBroadcastFlagsI(&g_diseqc.tx_event, DISEQC_EVT_ABORTED);
+    if (g_diseqc.completion_cb != NULL) {
+        g_diseqc.completion_cb(0, DISEQC_EVT_ABORTED);
+    }
+    
+    chSchRescheduleS();
+    chSysUnlock();
+    
+    if (send_halt) {
+        motion_command(MOTION_HALT, 0);
+    }
+    
+    return DISEQC_OK;
+}
+
+/**
+ * @brief Measured abort latency
+ */
+uint32_t diseqc_get_abort_latency_us(uint32_t *last_us)
+{
+    if (last_us != NULL) {
+        *last_us = g_diseqc.abort_latency_us;
+    }
+    
+    return g_diseqc.abort_latency_max_us;
 }
 
 /**
@@ -277,8 +641,13 @@ diseqc_status_t diseqc_halt(void)
  */
 diseqc_status_t diseqc_drive_east(void)
 {
-    uint8_t cmd[4] = {0xE0, 0x31, 0x68, 0x00};  // Drive East, continuous
-    return diseqc_transmit(cmd, 4);
+    diseqc_status_t status = diseqc_transmit_bits(DISEQC_BITS_DRIVE_EAST);  // E0 31 68 00
+    
+    if (status == DISEQC_OK) {
+        motion_command(MOTION_DRIVE, -1);
+    }
+    
+    return status;
 }
 
 /**
@@ -286,8 +655,27 @@ diseqc_status_t diseqc_drive_east(void)
  */
 diseqc_status_t diseqc_drive_west(void)
 {
-    uint8_t cmd[4] = {0xE0, 0x31, 0x69, 0x00};  // Drive West, continuous
-    return diseqc_transmit(cmd, 4);
+    diseqc_status_t status = diseqc_transmit_bits(DISEQC_BITS_DRIVE_WEST);  // E0 31 69 00
+    
+    if (status == DISEQC_OK) {
+        motion_command(MOTION_DRIVE, 1);
+    }
+    
+    return status;
+}
+
+/**
+ * @brief Estimator target after N steps from the current target
+ */
+static int32_t step_target_mdeg(int32_t steps)
+{
+    int32_t limit = (int32_t)(g_diseqc.max_angle * 1000.0f);
+    int32_t target = g_diseqc.motion.target_mdeg + steps * DISEQC_MOTION_STEP_MDEG;
+    
+    if (target > limit) target = limit;
+    if (target < -limit) target = -limit;
+    
+    return target;
 }
 
 /**
@@ -299,8 +687,14 @@ diseqc_status_t diseqc_step_east(uint8_t steps)
         return DISEQC_ERROR_INVALID_PARAM;
     }
 
-    uint8_t cmd[4] = {0xE0, 0x31, 0x68, steps};  // Drive East, N steps
-    return diseqc_transmit(cmd, 4);
+    // Drive East, N steps: precomputed E0 31 68 + parameter byte
+    diseqc_status_t status = diseqc_transmit_bits(diseqc_bits_append(DISEQC_BITS_STEP_EAST_PREFIX, steps));
+    
+    if (status == DISEQC_OK) {
+        motion_command(MOTION_GOTO, step_target_mdeg(-(int32_t)steps));
+    }
+    
+    return status;
 }
 
 /**
@@ -312,8 +706,284 @@ diseqc_status_t diseqc_step_west(uint8_t steps)
         return DISEQC_ERROR_INVALID_PARAM;
     }
 
-    uint8_t cmd[4] = {0xE0, 0x31, 0x69, steps};  // Drive West, N steps
-    return diseqc_transmit(cmd, 4);
+    // Drive West, N steps: precomputed E0 31 69 + parameter byte
+    diseqc_status_t status = diseqc_transmit_bits(diseqc_bits_append(DISEQC_BITS_STEP_WEST_PREFIX, steps));
+    
+    if (status == DISEQC_OK) {
+        motion_command(MOTION_GOTO, step_target_mdeg((int32_t)steps));
+    }
+    
+    return status;
+}
+
+/**
+ * @brief End the reply window early so queued frames can go out
+ */
+static void release_reply_window(void)
+{
+    chSysLock();
+    diseqc_seq_action_t action;
+    if (diseqc_sequencer_end_reply_window(&g_diseqc.seq, &action)) {
+        gptStopTimerI(g_diseqc.gpt_driver);
+        apply_action_s(&action);
+    }
+    chSysUnlock();
+}
+
+/**
+ * @brief Send a reply-required command and collect the reply
+ */
+diseqc_status_t diseqc_query(const uint8_t *cmd, uint8_t length,
+                             uint8_t *reply, uint8_t reply_size, uint8_t *reply_length)
+{
+    if (cmd == NULL || length == 0 || length > DISEQC_MAX_BYTES ||
+        (cmd[0] != DISEQC_FRAMING_REPLY && cmd[0] != DISEQC_FRAMING_REPLY_REPEAT) ||
+        reply == NULL || reply_size == 0 || reply_length == NULL) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    *reply_length = 0;
+    
+    uint32_t ticket = 0;
+    diseqc_status_t status = diseqc_enqueue_bits(diseqc_bits_from_bytes(cmd, length), &ticket);
+    
+    if (status == DISEQC_OK) {
+        // Wait for our own frame to leave the wire
+        status = wait_for_ticket(ticket);
+    }
+    
+    if (status != DISEQC_OK) {
+        return status;
+    }
+    
+    // Our transmission is echoed by tone detect: discard it before listening
+    diseqc_rx_byte_t byte;
+    chSysLock();
+    while (diseqc_rx_pop(&g_diseqc.rx, &byte)) {
+    }
+    chBSemResetI(&g_diseqc.rx_sem, true);
+    chSysUnlock();
+    
+    // First byte may take most of the reply window, the rest follow back to back
+    sysinterval_t timeout = TIME_US2I(DISEQC_REPLY_WINDOW_US);
+    status = DISEQC_ERROR_TIMEOUT;
+    
+    while (*reply_length < reply_size) {
+        if (!diseqc_rx_pop(&g_diseqc.rx, &byte)) {
+            if (chBSemWaitTimeout(&g_diseqc.rx_sem, timeout) != MSG_OK) {
+                break;
+            }
+            continue;
+        }
+        
+        if (*reply_length > 0 && (byte.flags & DISEQC_RX_FLAG_FRAME_START) != 0) {
+            break;  // A second message; the reply ended at the gap
+        }
+        
+        reply[(*reply_length)++] = byte.value;
+        status = (status == DISEQC_ERROR_REPLY || (byte.flags & DISEQC_RX_FLAG_PARITY_ERROR) != 0)
+                 ? DISEQC_ERROR_REPLY : DISEQC_OK;
+        timeout = TIME_MS2I(DISEQC_RX_BYTE_TIMEOUT_MS);
+    }
+    
+    if (status == DISEQC_OK && (reply[0] & 0xFC) != DISEQC_REPLY_OK) {
+        status = DISEQC_ERROR_REPLY;  // Not an E4-E7 reply framing byte
+    }
+    
+    release_reply_window();
+    
+    return status;
+}
+
+/**
+ * @brief Read positioner status
+ */
+diseqc_status_t diseqc_read_positioner_status(uint8_t *status_byte)
+{
+    if (status_byte == NULL) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    static const uint8_t cmd[3] = {DISEQC_FRAMING_REPLY, 0x31, 0x64};
+    uint8_t reply[2];
+    uint8_t length = 0;
+    
+    diseqc_status_t status = diseqc_query(cmd, sizeof(cmd), reply, sizeof(reply), &length);
+    
+    if (status != DISEQC_OK) {
+        return status;
+    }
+    
+    if (reply[0] != DISEQC_REPLY_OK || length < 2) {
+        return DISEQC_ERROR_REPLY;
+    }
+    
+    *status_byte = reply[1];
+    return DISEQC_OK;
+}
+
+/**
+ * @brief Store current position in a slot
+ */
+diseqc_status_t diseqc_store_position(uint8_t slot)
+{
+    if (slot == 0) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    return diseqc_transmit_bits(diseqc_bits_append(DISEQC_BITS_STORE_PREFIX, slot));
+}
+
+/**
+ * @brief Drive to a stored slot
+ */
+diseqc_status_t diseqc_goto_position(uint8_t slot)
+{
+    diseqc_status_t status = diseqc_transmit_bits(diseqc_bits_append(DISEQC_BITS_GOTO_PREFIX, slot));
+    
+    if (status == DISEQC_OK) {
+        // Slot 0 is the reference (0°); other slots hold angles only the positioner knows
+        motion_command(slot == 0 ? MOTION_GOTO : MOTION_LOST, 0);
+    }
+    
+    return status;
+}
+
+/**
+ * @brief Drive to a satellite from the position table
+ */
+diseqc_status_t diseqc_goto_satellite(uint32_t id_hash)
+{
+    diseqc_sat_entry_t entry;
+    
+    if (!diseqc_sat_find(&g_diseqc.sats, id_hash, &entry)) {
+        return DISEQC_ERROR_NOT_FOUND;
+    }
+    
+    if (entry.slot != 0) {
+        diseqc_status_t status = diseqc_goto_position(entry.slot);
+        
+        // A known longitude still lets the estimator follow the move
+        int16_t angle_16 = 0;
+        if (status == DISEQC_OK && (entry.flags & DISEQC_SAT_FLAG_LONGITUDE) != 0 && g_diseqc.site_valid &&
+            diseqc_usals_angle16(g_diseqc.site_lat_mdeg, g_diseqc.site_lon_mdeg,
+                                 (int32_t)entry.longitude_tenths * 100, &angle_16)) {
+            motion_command(MOTION_GOTO, (int32_t)angle_16 * 125 / 2);
+        }
+        
+        return status;
+    }
+    
+    if ((entry.flags & DISEQC_SAT_FLAG_LONGITUDE) == 0 || !g_diseqc.site_valid) {
+        return DISEQC_ERROR_NOT_FOUND;
+    }
+    
+    return diseqc_goto_usals((int32_t)entry.longitude_tenths * 100);
+}
+
+/**
+ * @brief Store the current position for a satellite
+ */
+diseqc_status_t diseqc_store_satellite(uint32_t id_hash, uint8_t slot)
+{
+    if (slot == 0) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    // Keep the built-in longitude (if any) alongside the new slot
+    diseqc_sat_entry_t entry;
+    if (!diseqc_sat_find(&g_diseqc.sats, id_hash, &entry)) {
+        entry.id_hash = id_hash;
+        entry.longitude_tenths = 0;
+        entry.flags = 0;
+    }
+    entry.slot = slot;
+    
+    if (!diseqc_sat_table_set(&g_diseqc.sats, &entry)) {
+        return DISEQC_ERROR_BUSY;
+    }
+    
+    return diseqc_store_position(slot);
+}
+
+/**
+ * @brief User satellite overlay
+ */
+diseqc_sat_table_t *diseqc_get_sat_table(void)
+{
+    return &g_diseqc.sats;
+}
+
+/**
+ * @brief Select transmit mode for subsequent frames
+ */
+diseqc_status_t diseqc_set_tx_mode(diseqc_tx_mode_t mode)
+{
+    if (mode != DISEQC_TX_MODE_THREAD && mode != DISEQC_TX_MODE_ISR) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    diseqc_status_t status = DISEQC_OK;
+    
+    chSysLock();
+    if (diseqc_sequencer_busy(&g_diseqc.seq)) {
+        status = DISEQC_ERROR_BUSY;
+    } else {
+        g_diseqc.tx_mode = mode;
+    }
+    chSysUnlock();
+    
+    return status;
+}
+
+/**
+ * @brief Get transmit mode
+ */
+diseqc_tx_mode_t diseqc_get_tx_mode(void)
+{
+    return g_diseqc.tx_mode;
+}
+
+/**
+ * @brief Static RAM used by the driver
+ */
+uint32_t diseqc_get_ram_usage(uint32_t *handle_bytes, uint32_t *thread_bytes)
+{
+    if (handle_bytes != NULL) {
+        *handle_bytes = sizeof(g_diseqc);
+    }
+    
+    if (thread_bytes != NULL) {
+        *thread_bytes = sizeof(wa_diseqc_tx);
+    }
+    
+    return sizeof(g_diseqc) + sizeof(wa_diseqc_tx);
+}
+
+/**
+ * @brief Completion event source
+ */
+event_source_t *diseqc_get_event_source(void)
+{
+    return &g_diseqc.tx_event;
+}
+
+/**
+ * @brief Install completion hook
+ */
+void diseqc_set_completion_callback(diseqc_completion_cb_t cb)
+{
+    chSysLock();
+    g_diseqc.completion_cb = cb;
+    chSysUnlock();
+}
+
+/**
+ * @brief Last completed ticket
+ */
+uint32_t diseqc_get_completed_sequence(void)
+{
+    return g_diseqc.seq.completed_sequence;
 }
 
 /**
@@ -321,7 +991,7 @@ diseqc_status_t diseqc_step_west(uint8_t steps)
  */
 bool diseqc_is_busy(void)
 {
-    return g_diseqc.is_transmitting;
+    return diseqc_sequencer_busy(&g_diseqc.seq);
 }
 
 /**
@@ -329,5 +999,42 @@ bool diseqc_is_busy(void)
  */
 float diseqc_get_current_angle(void)
 {
-    return g_diseqc.current_angle;
+    return (float)g_diseqc.motion.position_mdeg / 1000.0f;
+}
+
+/**
+ * @brief Set the motion estimator profile
+ */
+diseqc_status_t diseqc_set_motion_profile(const diseqc_motion_config_t *config)
+{
+    if (config == NULL || config->speed_mdeg_s <= 0 || config->accel_mdeg_s2 <= 0 ||
+        config->backlash_mdeg < 0) {
+        return DISEQC_ERROR_INVALID_PARAM;
+    }
+    
+    chSysLock();
+    g_diseqc.motion.config = *config;
+    chSysUnlock();
+    
+    return DISEQC_OK;
+}
+
+/**
+ * @brief Motion estimator snapshot
+ */
+diseqc_motion_state_t diseqc_get_motion(int32_t *angle_mdeg, int32_t *eta_ms)
+{
+    chSysLock();
+    diseqc_motion_t snapshot = g_diseqc.motion;
+    chSysUnlock();
+    
+    if (angle_mdeg != NULL) {
+        *angle_mdeg = snapshot.position_mdeg;
+    }
+    
+    if (eta_ms != NULL) {
+        *eta_ms = diseqc_motion_eta_ms(&snapshot);
+    }
+    
+    return (diseqc_motion_state_t)snapshot.state;
 }
@@ -5,10 +5,16 @@
  * This native driver uses ChibiOS (which nanoFramework is built on) to:
  * - Generate precise 22kHz DiSEqC carrier using TIM4 PWM
  * - Transmit DiSEqC 1.2 protocol commands
+ * - Receive DiSEqC 2.x slave replies (tone detect edges → diseqc_rx decoder)
+ * - Mini-DiSEqC tone bursts and combined multi-LNB switch sequences
+ * - Satellite → stored positioner slot lookup (Goto NN / Store NN)
+ * - USALS GotoX from site coordinates (fixed point, no libm)
+ * - Estimated rotor position/ETA while the dish moves (diseqc_motion)
  * - Expose clean API to C# via nanoFramework interop
  * 
  * Hardware:
  * - PD12 (TIM4_CH1) → LNBH26 DSQIN
+ * - PA15 ← LNBH26 DSQOUT (tone detect, low while 22kHz is present)
  */
 
 #ifndef DISEQC_NATIVE_H
@@ -18,6 +24,13 @@
 #include <ch.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "diseqc_frame.h"
+#include "diseqc_motion.h"
+#include "diseqc_queue.h"
+#include "diseqc_rx.h"
+#include "diseqc_sat_table.h"
+#include "diseqc_usals.h"
+#include "lnbh26_native.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,47 +38,127 @@ extern "C" {
 
 /* DiSEqC Configuration */
 #define DISEQC_CARRIER_FREQ         22000       // 22kHz
-#define DISEQC_BIT0_HIGH_US         1000        // Bit 0: 1ms ON
-#define DISEQC_BIT0_LOW_US          500         // Bit 0: 0.5ms OFF
-#define DISEQC_BIT1_HIGH_US         500         // Bit 1: 0.5ms ON
-#define DISEQC_BIT1_LOW_US          1000        // Bit 1: 1ms OFF
-#define DISEQC_MAX_BYTES            6           // Max command bytes
-#define DISEQC_MAX_SEGMENTS         (DISEQC_MAX_BYTES * 9 * 2)  // 9 bits × 2 segments
 
 #define DISEQC_PWM_DRIVER           PWMD4
 #define DISEQC_GPT_DRIVER           GPTD5
 #define DISEQC_OUTPUT_LINE          PAL_LINE(GPIOD, 12U)
+#define DISEQC_RX_LINE              PAL_LINE(GPIOA, 15U)
+
+/* Reply Reception */
+#define DISEQC_RX_BYTE_TIMEOUT_MS   20          // Max wait between reply bytes (one byte = 13.5 ms)
 
 /* DiSEqC Status Codes */
 typedef enum {
     DISEQC_OK = 0,
     DISEQC_ERROR_BUSY = 1,
     DISEQC_ERROR_INVALID_PARAM = 2,
-    DISEQC_ERROR_TIMEOUT = 3
+    DISEQC_ERROR_TIMEOUT = 3,
+    DISEQC_ERROR_REPLY = 4,         // Reply truncated or failed parity
+    DISEQC_ERROR_LNB = 5,           // LNBH26 voltage/tone write failed
+    DISEQC_ERROR_NOT_FOUND = 6,     // Unknown satellite or no stored position
+    DISEQC_ERROR_ABORTED = 7        // Frame dropped or cut by diseqc_abort()
 } diseqc_status_t;
 
-/* Transmission Segment */
+/* Mini-DiSEqC Tone Burst */
+typedef enum {
+    DISEQC_BURST_SA = 0,        // Unmodulated 12.5 ms burst (satellite A)
+    DISEQC_BURST_SB = 1,        // Modulated burst, nine '1' bits (satellite B)
+    DISEQC_BURST_NONE = 2       // No burst (switch sequence only)
+} diseqc_burst_t;
+
+/* Multi-LNB Switch Sequence */
+#define DISEQC_SWITCH_NO_COMMITTED  0xFF        // Skip the committed-switch frame
+#define DISEQC_SWITCH_SETTLE_MS     15          // Quiet time after voltage / before tone
+
 typedef struct {
-    uint16_t ccr_value;     // PWM duty (0 = OFF, >0 = carrier ON)
-    uint16_t duration_us;   // Segment duration in microseconds
-} diseqc_segment_t;
+    uint8_t port;               // Committed port 0-3 (E0 10 38 Fx), or DISEQC_SWITCH_NO_COMMITTED
+    lnb_voltage_t voltage;      // 13V vertical / 18V horizontal
+    diseqc_burst_t burst;       // Tone burst after the committed frame
+    bool tone;                  // Continuous 22kHz (high band) at the end
+} diseqc_switch_t;
+
+/* Completion Event Flags (broadcast on g_diseqc.tx_event) */
+#define DISEQC_EVT_FRAME_DONE       (1U << 0)   // A queued frame finished (gap started)
+#define DISEQC_EVT_IDLE             (1U << 1)   // Queue drained, bus idle
+#define DISEQC_EVT_SETTLED          (1U << 2)   // Estimated rotor motion finished
+#define DISEQC_EVT_ABORTED          (1U << 3)   // Queue flushed by diseqc_abort()
+
+/* Rotor Motion Estimator */
+#define DISEQC_MOTION_TICK_MS       100         // Model update period while moving
+
+/**
+ * @brief Completion hook, called from the timer ISR / locked context
+ * @param sequence Ticket of the finished frame, 0 for a pure idle notification
+ * @param flags DISEQC_EVT_* flags
+ */
+typedef void (*diseqc_completion_cb_t)(uint32_t sequence, uint32_t flags);
+
+/* Transmit Modes */
+typedef enum {
+    DISEQC_TX_MODE_THREAD = 0,  // diseqc_tx thread runs each sequencer step
+    DISEQC_TX_MODE_ISR = 1      // GPT callback chains segments, no thread wakeups
+} diseqc_tx_mode_t;
+
+/* Fixed Commands (precomputed frames in flash) */
+typedef enum {
+    DISEQC_CMD_RESET = 0,
+    DISEQC_CMD_CLEAR_RESET,
+    DISEQC_CMD_STANDBY,
+    DISEQC_CMD_POWER_ON,
+    DISEQC_CMD_HALT,
+    DISEQC_CMD_LIMITS_OFF,
+    DISEQC_CMD_LIMIT_EAST,
+    DISEQC_CMD_LIMIT_WEST,
+    DISEQC_CMD_DRIVE_EAST,
+    DISEQC_CMD_DRIVE_WEST,
+    DISEQC_CMD_GOTO_REFERENCE,
+    DISEQC_CMD_COUNT
+} diseqc_fixed_cmd_t;
+
+#ifndef DISEQC_DEFAULT_TX_MODE
+#define DISEQC_DEFAULT_TX_MODE      DISEQC_TX_MODE_ISR
+#endif
+
+/* Static RAM budget (handle + diseqc_tx working area), checked at compile time */
+#define DISEQC_TX_THREAD_WA_SIZE    1024
+#define DISEQC_RAM_BUDGET_BYTES     (DISEQC_TX_THREAD_WA_SIZE + 840)
 
 /* DiSEqC Driver Handle */
 typedef struct {
     PWMDriver *pwm_driver;                          // ChibiOS PWM driver (TIM4)
     GPTDriver *gpt_driver;                          // ChibiOS GPT for timing
     
-    diseqc_segment_t segments[DISEQC_MAX_SEGMENTS]; // Transmission buffer
-    volatile uint16_t segment_count;                // Total segments
-    volatile uint16_t segment_index;                // Current segment
+    diseqc_sequencer_t seq;                         // Frame queue + segment player
     
     uint16_t carrier_duty;                          // PWM duty for carrier
     
-    volatile bool is_transmitting;                  // Transmission in progress
+    diseqc_tx_mode_t tx_mode;                       // Transmit mode (changed only when idle)
     thread_t *tx_thread;                            // Transmission thread
-    binary_semaphore_t tx_complete_sem;             // Completion semaphore
+    binary_semaphore_t tx_complete_sem;             // Step semaphore (thread mode)
+    
+    event_source_t tx_event;                        // DISEQC_EVT_* completion flags
+    diseqc_completion_cb_t completion_cb;           // Optional ISR-context hook
+    
+    bool carrier_on;                                // Last applied compare was non-zero
+    bool abort_timing;                              // Waiting for the carrier to drop after an abort
+    rtcnt_t abort_cycles;                           // Realtime counter at the abort request
+    uint32_t abort_latency_us;                      // Last measured abort → carrier off
+    uint32_t abort_latency_max_us;                  // Worst measured since init
+    
+    diseqc_rx_decoder_t rx;                         // Reply decoder (fed from the edge ISR)
+    binary_semaphore_t rx_sem;                      // Signalled per decoded reply byte
+    rtcnt_t rx_last_cycles;                         // Realtime counter at the last edge
+    uint32_t rx_time_us;                            // Running µs timestamp fed to the decoder
+    
+    diseqc_sat_table_t sats;                        // User satellite/slot overlay (caller thread only)
+    
+    int32_t site_lat_mdeg;                          // USALS site latitude (North positive)
+    int32_t site_lon_mdeg;                          // USALS site longitude (East positive)
+    bool site_valid;                                // diseqc_set_site() called
+    
+    diseqc_motion_t motion;                         // Rotor position estimate (system locked)
+    virtual_timer_t motion_vt;                      // Advances the estimate while moving
     
-    float current_angle;                            // Last commanded angle
     float max_angle;                                // Maximum allowed angle
     
 } diseqc_handle_t;
@@ -84,26 +177,95 @@ extern diseqc_handle_t g_diseqc;
 diseqc_status_t diseqc_init(PWMDriver *pwm_driver, GPTDriver *gpt_driver);
 
 /**
- * @brief Transmit DiSEqC command bytes
+ * @brief Queue DiSEqC command bytes for transmission
  * @param data Command bytes
  * @param length Number of bytes (1-6)
- * @return DISEQC_OK on success
+ * @return DISEQC_OK when queued, DISEQC_ERROR_BUSY when the queue is full
  */
 diseqc_status_t diseqc_transmit(const uint8_t *data, uint8_t length);
 
 /**
- * @brief Send GotoX command
- * @param angle Target angle in degrees (-80 to +80)
+ * @brief Queue a packed frame and return its completion ticket
+ * @param frame Packed data + parity bits
+ * @param sequence Receives the ticket reported on completion (may be NULL)
+ * @return DISEQC_OK when queued, DISEQC_ERROR_BUSY when the queue is full
+ *
+ * Frames are sent back to back with the DISEQC_GAP_US quiet time inserted
+ * automatically. Completion is broadcast on diseqc_get_event_source().
+ */
+diseqc_status_t diseqc_enqueue_bits(diseqc_bits_t frame, uint32_t *sequence);
+
+/**
+ * @brief Queue a packed frame without re-encoding it
+ * @param frame Packed data + parity bits (see diseqc_frame.h)
+ * @return DISEQC_OK when queued
+ */
+diseqc_status_t diseqc_transmit_bits(diseqc_bits_t frame);
+
+/**
+ * @brief Transmit one of the fixed DiSEqC 1.0/1.2 commands
+ * @param cmd Command identifier
  * @return DISEQC_OK on success
  */
+diseqc_status_t diseqc_send_fixed(diseqc_fixed_cmd_t cmd);
+
+/**
+ * @brief Send GotoX command
+ * @param angle Target angle in degrees, clamped to the configured limit
+ * @return DISEQC_OK on success, DISEQC_ERROR_INVALID_PARAM for NaN
+ */
 diseqc_status_t diseqc_goto_angle(float angle);
 
 /**
- * @brief Send halt command
+ * @brief Send GotoX command with a fixed-point angle
+ * @param angle_16 Motor angle in 1/16° (West positive, East negative)
+ * @return DISEQC_OK on success
+ */
+diseqc_status_t diseqc_goto_angle16(int16_t angle_16);
+
+/**
+ * @brief Set the site used for USALS calculations
+ * @param lat_mdeg Latitude in millidegrees (North positive, ±90000)
+ * @param lon_mdeg Longitude in millidegrees (East positive, ±180000)
  * @return DISEQC_OK on success
  */
+diseqc_status_t diseqc_set_site(int32_t lat_mdeg, int32_t lon_mdeg);
+
+/**
+ * @brief Drive to a satellite longitude using USALS
+ * @param sat_lon_mdeg Satellite longitude in millidegrees (East positive)
+ * @return DISEQC_OK when queued, DISEQC_ERROR_NOT_FOUND without a site,
+ *         DISEQC_ERROR_INVALID_PARAM when the satellite is below the horizon
+ */
+diseqc_status_t diseqc_goto_usals(int32_t sat_lon_mdeg);
+
+/**
+ * @brief Send halt command, pre-empting anything queued or on the wire
+ * @return DISEQC_OK on success
+ *
+ * Same as diseqc_abort(true): Halt never waits behind other traffic.
+ */
 diseqc_status_t diseqc_halt(void);
 
+/**
+ * @brief Pre-emptive abort: flush the queue, cut the current frame, optionally send Halt
+ * @param send_halt Queue Halt (E0 31 60) as the next frame on the bus
+ * @return DISEQC_OK
+ *
+ * The frame on the wire is stopped at its next segment edge, so the carrier
+ * is off within one bit time (an SA burst is stopped at once). Halt follows
+ * after the 15 ms quiet time. Dropped tickets complete with
+ * DISEQC_ERROR_ABORTED and DISEQC_EVT_ABORTED is broadcast.
+ */
+diseqc_status_t diseqc_abort(bool send_halt);
+
+/**
+ * @brief Measured abort → carrier-off latency
+ * @param last_us Receives the latency of the most recent abort (may be NULL)
+ * @return Worst latency since init, in microseconds
+ */
+uint32_t diseqc_get_abort_latency_us(uint32_t *last_us);
+
 /**
  * @brief Drive motor East (continuous movement until halt)
  * @return DISEQC_OK on success
@@ -130,18 +292,153 @@ diseqc_status_t diseqc_step_east(uint8_t steps);
  */
 diseqc_status_t diseqc_step_west(uint8_t steps);
 
+/**
+ * @brief Queue a mini-DiSEqC tone burst
+ * @param burst DISEQC_BURST_SA or DISEQC_BURST_SB
+ * @return DISEQC_OK when queued, DISEQC_ERROR_BUSY when the queue is full
+ *
+ * Played on the same TIM4/TIM5 path as frames, with the 15 ms gap before
+ * and after handled by the sequencer.
+ */
+diseqc_status_t diseqc_tone_burst(diseqc_burst_t burst);
+
+/**
+ * @brief Run a complete multi-LNB switch sequence as one native job
+ * @param sw Target voltage, committed port, burst and tone
+ * @return DISEQC_OK, DISEQC_ERROR_LNB on an LNBH26 write failure,
+ *         DISEQC_ERROR_TIMEOUT if the bus never drained
+ *
+ * Voltage (continuous tone off) → 15 ms → committed frame → 15 ms →
+ * burst → 15 ms → continuous tone. The committed frame and burst are
+ * queued back to back so their spacing is set by the timer path; the
+ * caller blocks for roughly 110 ms.
+ */
+diseqc_status_t diseqc_switch_sequence(const diseqc_switch_t *sw);
+
+/**
+ * @brief Send a reply-required command and collect the slave's answer
+ * @param cmd Command bytes, framing byte 0xE2 or 0xE3
+ * @param length Number of command bytes (1-6)
+ * @param reply Receives the reply, framing byte (0xE4-0xE7) first
+ * @param reply_size Size of the reply buffer
+ * @param reply_length Receives the number of reply bytes
+ * @return DISEQC_OK, DISEQC_ERROR_TIMEOUT when no slave answered,
+ *         DISEQC_ERROR_REPLY on parity errors or a truncated reply
+ *
+ * Blocks the caller for the command plus up to DISEQC_REPLY_WINDOW_US.
+ * The bus is released for the next queued frame as soon as the reply ends.
+ */
+diseqc_status_t diseqc_query(const uint8_t *cmd, uint8_t length,
+                             uint8_t *reply, uint8_t reply_size, uint8_t *reply_length);
+
+/**
+ * @brief Read positioner status (E2 31 64)
+ * @param status Receives the status byte of an E4 reply
+ * @return DISEQC_OK on success, see diseqc_query()
+ */
+diseqc_status_t diseqc_read_positioner_status(uint8_t *status);
+
+/**
+ * @brief Store the current position in a positioner slot (E0 31 6A NN)
+ * @param slot Slot 1-255
+ * @return DISEQC_OK when queued
+ */
+diseqc_status_t diseqc_store_position(uint8_t slot);
+
+/**
+ * @brief Drive to a stored positioner slot (E0 31 6B NN)
+ * @param slot Slot 1-255, 0 = reference position
+ * @return DISEQC_OK when queued
+ */
+diseqc_status_t diseqc_goto_position(uint8_t slot);
+
+/**
+ * @brief Drive to a satellite from the position table
+ * @param id_hash diseqc_sat_hash() of the satellite id
+ * @return DISEQC_OK when queued, DISEQC_ERROR_NOT_FOUND when the satellite
+ *         is unknown, or has neither a stored slot nor a longitude + site
+ *
+ * A stored slot wins (Goto NN); otherwise the longitude is driven by USALS.
+ */
+diseqc_status_t diseqc_goto_satellite(uint32_t id_hash);
+
+/**
+ * @brief Store the current position for a satellite and remember its slot
+ * @param id_hash diseqc_sat_hash() of the satellite id
+ * @param slot Slot 1-255
+ * @return DISEQC_OK when queued, DISEQC_ERROR_BUSY when the table is full
+ */
+diseqc_status_t diseqc_store_satellite(uint32_t id_hash, uint8_t slot);
+
+/**
+ * @brief User satellite overlay (persist with diseqc_sat_table_export/import)
+ */
+diseqc_sat_table_t *diseqc_get_sat_table(void);
+
+/**
+ * @brief Select how segments are played out
+ * @param mode DISEQC_TX_MODE_THREAD or DISEQC_TX_MODE_ISR
+ * @return DISEQC_ERROR_BUSY while a frame is being transmitted
+ */
+diseqc_status_t diseqc_set_tx_mode(diseqc_tx_mode_t mode);
+
+/**
+ * @brief Get the transmit mode used for the next frame
+ */
+diseqc_tx_mode_t diseqc_get_tx_mode(void);
+
+/**
+ * @brief Static RAM used by the driver
+ * @param handle_bytes Size of g_diseqc (may be NULL)
+ * @param thread_bytes Size of the diseqc_tx working area (may be NULL)
+ * @return Total bytes, always <= DISEQC_RAM_BUDGET_BYTES
+ */
+uint32_t diseqc_get_ram_usage(uint32_t *handle_bytes, uint32_t *thread_bytes);
+
+/**
+ * @brief Event source broadcasting DISEQC_EVT_* flags on completion
+ */
+event_source_t *diseqc_get_event_source(void);
+
+/**
+ * @brief Install a completion hook (NULL to remove)
+ */
+void diseqc_set_completion_callback(diseqc_completion_cb_t cb);
+
+/**
+ * @brief Ticket of the most recently completed frame
+ */
+uint32_t diseqc_get_completed_sequence(void);
+
 /**
  * @brief Check if transmission is in progress
- * @return true if busy
+ * @return true while a frame or gap is on the bus or frames are queued
  */
 bool diseqc_is_busy(void);
 
 /**
  * @brief Get current angle
- * @return Current angle in degrees
+ * @return Estimated dish angle in degrees (moves with the rotor, not the command)
  */
 float diseqc_get_current_angle(void);
 
+/**
+ * @brief Set the rotor profile used by the motion estimator
+ * @param config Speed, acceleration and backlash (all > 0, backlash >= 0)
+ * @return DISEQC_OK, DISEQC_ERROR_INVALID_PARAM on a bad profile
+ *
+ * Applies immediately, including to a move already in progress.
+ */
+diseqc_status_t diseqc_set_motion_profile(const diseqc_motion_config_t *config);
+
+/**
+ * @brief Snapshot of the motion estimator
+ * @param angle_mdeg Receives the estimated angle in millidegrees (may be NULL)
+ * @param eta_ms Receives ms until settled, -1 while driving continuously (may be NULL)
+ * @return Current diseqc_motion_state_t; DISEQC_EVT_SETTLED fires when it returns to SETTLED
+ */
+diseqc_motion_state_t diseqc_get_motion(int32_t *angle_mdeg, int32_t *eta_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,277 @@
+/**
+ * @file diseqc_queue.cpp
+ * @brief HAL-independent DiSEqC frame queue and transmit sequencer
+ */
+
+#include "diseqc_queue.h"
+#include <string.h>
+
+#define QUEUE_MASK  (DISEQC_QUEUE_DEPTH - 1)
+
+void diseqc_queue_init(diseqc_queue_t *queue)
+{
+    memset(queue, 0, sizeof(*queue));
+}
+
+bool diseqc_queue_push(diseqc_queue_t *queue, const diseqc_queue_entry_t *entry)
+{
+    uint8_t tail = queue->tail;
+    uint8_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    if ((uint8_t)(tail - head) >= DISEQC_QUEUE_DEPTH) {
+        return false;
+    }
+
+    queue->entries[tail & QUEUE_MASK] = *entry;
+
+    // Publish the entry before the new tail becomes visible to the consumer
+    __atomic_store_n(&queue->tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+bool diseqc_queue_pop(diseqc_queue_t *queue, diseqc_queue_entry_t *entry)
+{
+    uint8_t head = queue->head;
+    uint8_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *entry = queue->entries[head & QUEUE_MASK];
+
+    // Release the slot only after it has been copied out
+    __atomic_store_n(&queue->head, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+uint8_t diseqc_queue_count(const diseqc_queue_t *queue)
+{
+    uint8_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    uint8_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    return (uint8_t)(tail - head);
+}
+
+void diseqc_sequencer_init(diseqc_sequencer_t *seq, uint16_t carrier_duty)
+{
+    memset(seq, 0, sizeof(*seq));
+    diseqc_queue_init(&seq->queue);
+    seq->carrier_duty = carrier_duty;
+    seq->state = DISEQC_SEQ_IDLE;
+    seq->next_sequence = 1;
+}
+
+static bool enqueue_entry(diseqc_sequencer_t *seq, diseqc_queue_entry_t *entry, uint32_t *sequence)
+{
+    entry->sequence = seq->next_sequence;
+
+    if (!diseqc_queue_push(&seq->queue, entry)) {
+        return false;
+    }
+
+    // Ticket 0 is reserved for "none"
+    seq->next_sequence++;
+    if (seq->next_sequence == 0) {
+        seq->next_sequence = 1;
+    }
+
+    if (sequence != NULL) {
+        *sequence = entry->sequence;
+    }
+
+    return true;
+}
+
+bool diseqc_sequencer_enqueue(diseqc_sequencer_t *seq, diseqc_bits_t frame, uint32_t *sequence)
+{
+    diseqc_queue_entry_t entry;
+    entry.frame = frame;
+    entry.tone_us = 0;
+
+    return enqueue_entry(seq, &entry, sequence);
+}
+
+bool diseqc_sequencer_enqueue_tone(diseqc_sequencer_t *seq, uint16_t duration_us, uint32_t *sequence)
+{
+    if (duration_us == 0) {
+        return false;
+    }
+
+    diseqc_queue_entry_t entry;
+    entry.frame = DISEQC_BITS_EMPTY;
+    entry.tone_us = duration_us;
+
+    return enqueue_entry(seq, &entry, sequence);
+}
+
+bool diseqc_sequencer_kick(diseqc_sequencer_t *seq)
+{
+    if (seq->state != DISEQC_SEQ_IDLE) {
+        return false;
+    }
+
+    // An elapsed gap and "start pending" are the same thing: pop on next step
+    seq->state = DISEQC_SEQ_GAP;
+    return true;
+}
+
+diseqc_seq_action_t diseqc_sequencer_step(diseqc_sequencer_t *seq)
+{
+    diseqc_seq_action_t action = {0, 0, 0, false};
+
+    if (seq->state == DISEQC_SEQ_FRAME && seq->abort_pending) {
+        // Cut at this segment edge: carrier off, then the quiet time a truncated frame still needs
+        seq->abort_pending = false;
+        seq->tone_active = false;
+        seq->reply_window = false;
+        seq->state = DISEQC_SEQ_GAP;
+        action.duration_us = DISEQC_GAP_US;
+        return action;
+    }
+
+    if (seq->state == DISEQC_SEQ_FRAME) {
+        const diseqc_segment_t *segment = diseqc_player_advance(&seq->player);
+
+        if (segment != NULL) {
+            action.ccr_value = segment->ccr_value;
+            action.duration_us = segment->duration_us;
+            return action;
+        }
+
+        // Frame finished: hold the bus quiet for the gap (or the reply window)
+        uint8_t framing = diseqc_bits_first_byte(seq->player.bits);
+        seq->reply_window = (framing == DISEQC_FRAMING_REPLY || framing == DISEQC_FRAMING_REPLY_REPEAT);
+        seq->tone_active = false;
+        seq->completed_sequence = seq->current_sequence;
+        seq->state = DISEQC_SEQ_GAP;
+        action.completed = seq->current_sequence;
+        action.duration_us = seq->reply_window ? DISEQC_REPLY_WINDOW_US : DISEQC_GAP_US;
+        return action;
+    }
+
+    if (seq->state == DISEQC_SEQ_GAP) {
+        diseqc_queue_entry_t entry;
+        seq->reply_window = false;
+
+        if (diseqc_queue_pop(&seq->queue, &entry)) {
+            diseqc_player_load(&seq->player, entry.frame, seq->carrier_duty);
+
+            if (entry.tone_us != 0) {
+                // Empty player: the next step finishes the "frame" and starts the gap
+                seq->current_sequence = entry.sequence;
+                seq->state = DISEQC_SEQ_FRAME;
+                seq->tone_active = true;
+                action.ccr_value = seq->carrier_duty;
+                action.duration_us = entry.tone_us;
+                return action;
+            }
+
+            const diseqc_segment_t *segment = diseqc_player_current(&seq->player);
+
+            if (segment != NULL) {
+                seq->current_sequence = entry.sequence;
+                seq->state = DISEQC_SEQ_FRAME;
+                action.ccr_value = segment->ccr_value;
+                action.duration_us = segment->duration_us;
+                return action;
+            }
+        }
+
+        seq->state = DISEQC_SEQ_IDLE;
+        action.idle = true;
+        return action;
+    }
+
+    action.idle = true;
+    return action;
+}
+
+bool diseqc_sequencer_end_reply_window(diseqc_sequencer_t *seq, diseqc_seq_action_t *action)
+{
+    if (seq->state != DISEQC_SEQ_GAP || !seq->reply_window) {
+        return false;
+    }
+
+    // Reply received: the bus still needs the normal quiet time after it
+    seq->reply_window = false;
+    action->ccr_value = 0;
+    action->duration_us = DISEQC_GAP_US;
+    action->completed = 0;
+    action->idle = false;
+    return true;
+}
+
+diseqc_abort_t diseqc_sequencer_abort(diseqc_sequencer_t *seq, diseqc_bits_t frame, uint32_t *sequence,
+                                      diseqc_seq_action_t *action)
+{
+    action->ccr_value = 0;
+    action->duration_us = 0;
+    action->completed = 0;
+    action->idle = false;
+
+    // Dropped range: the frame on the wire (if any) through the newest queued ticket
+    uint32_t first = 0;
+    if (seq->state == DISEQC_SEQ_FRAME) {
+        first = seq->current_sequence;
+    } else if (diseqc_queue_count(&seq->queue) != 0) {
+        first = seq->queue.entries[seq->queue.head & QUEUE_MASK].sequence;
+    }
+
+    if (first != 0) {
+        seq->abort_first = first;
+        seq->abort_last = (seq->next_sequence == 1) ? 0xFFFFFFFFu : seq->next_sequence - 1;
+    }
+
+    // Timer path is locked out, so the producer may move the consumer index here
+    __atomic_store_n(&seq->queue.head, seq->queue.tail, __ATOMIC_RELEASE);
+
+    bool queued = false;
+    if (frame.bit_count != 0) {
+        diseqc_queue_entry_t entry;
+        entry.frame = frame;
+        entry.tone_us = 0;
+        queued = enqueue_entry(seq, &entry, sequence);
+    }
+
+    switch (seq->state) {
+        case DISEQC_SEQ_IDLE:
+            if (!queued) {
+                return DISEQC_ABORT_NONE;
+            }
+            seq->state = DISEQC_SEQ_GAP;
+            return DISEQC_ABORT_START;
+
+        case DISEQC_SEQ_FRAME:
+            if (seq->tone_active) {
+                // A plain carrier burst has no bit boundaries to wait for
+                seq->tone_active = false;
+                seq->state = DISEQC_SEQ_GAP;
+                action->duration_us = DISEQC_GAP_US;
+                return DISEQC_ABORT_RELOAD;
+            }
+            seq->abort_pending = true;
+            return DISEQC_ABORT_NONE;
+
+        default:
+            if (seq->reply_window) {
+                seq->reply_window = false;
+                action->duration_us = DISEQC_GAP_US;
+                return DISEQC_ABORT_RELOAD;
+            }
+            return DISEQC_ABORT_NONE;
+    }
+}
+
+bool diseqc_sequencer_ticket_aborted(const diseqc_sequencer_t *seq, uint32_t sequence)
+{
+    if (seq->abort_first == 0 || sequence == 0) {
+        return false;
+    }
+
+    return (int32_t)(sequence - seq->abort_first) >= 0 && (int32_t)(seq->abort_last - sequence) >= 0;
+}
+
+bool diseqc_sequencer_busy(const diseqc_sequencer_t *seq)
+{
+    return seq->state != DISEQC_SEQ_IDLE || diseqc_queue_count(&seq->queue) != 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file diseqc_queue.h
+ * @brief HAL-independent DiSEqC frame queue and transmit sequencer
+ *
+ * The queue is single-producer (caller thread enqueuing frames) /
+ * single-consumer (the transmit timer path) and lock-free: each side only
+ * writes its own index and publishes it with release ordering.
+ *
+ * The sequencer is the state machine run on every timer expiry. It plays the
+ * current frame segment by segment, inserts the mandatory quiet gap after each
+ * frame, then pulls the next frame from the queue or goes idle. Frames
+ * framed E2/E3 (reply required) get a longer gap so the slave can answer on
+ * the otherwise idle bus; the receiver ends it early once the reply is in.
+ * Unmodulated tone bursts are queued as entries with tone_us set and get the
+ * same gap handling as frames.
+ *
+ * An abort flushes the queue and cuts the frame on the wire at its next
+ * segment edge. A bit's value is carried by its carrier-ON length, so
+ * stopping at a segment edge never leaves a malformed bit; the carrier is
+ * off within one ON half (<= 1 ms, less than one 1.5 ms bit time). The cut
+ * frame is followed by the normal gap before the replacement (Halt) goes out.
+ */
+
+#ifndef DISEQC_QUEUE_H
+#define DISEQC_QUEUE_H
+
+#include "diseqc_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISEQC_QUEUE_DEPTH          8           // Frames; must be a power of two
+#define DISEQC_GAP_US               15000       // Quiet bus time between messages
+#define DISEQC_REPLY_WINDOW_US      150000      // Bus held for a slave reply after E2/E3
+
+#if (DISEQC_QUEUE_DEPTH & (DISEQC_QUEUE_DEPTH - 1)) != 0
+#error "DISEQC_QUEUE_DEPTH must be a power of two"
+#endif
+
+/* Queued Frame */
+typedef struct {
+    diseqc_bits_t frame;
+    uint32_t sequence;      // Completion ticket reported back to the caller
+    uint16_t tone_us;       // Unmodulated burst length; frame ignored when non-zero
+} diseqc_queue_entry_t;
+
+/* SPSC Frame Queue */
+typedef struct {
+    diseqc_queue_entry_t entries[DISEQC_QUEUE_DEPTH];
+    uint8_t head;           // Next entry to pop (written by consumer only)
+    uint8_t tail;           // Next free slot (written by producer only)
+} diseqc_queue_t;
+
+/* Sequencer States */
+typedef enum {
+    DISEQC_SEQ_IDLE = 0,    // Bus quiet, nothing queued, timer stopped
+    DISEQC_SEQ_FRAME = 1,   // Playing segments of the current frame
+    DISEQC_SEQ_GAP = 2      // Inter-message gap running (or start pending)
+} diseqc_seq_state_t;
+
+/* What the timer path must do after a sequencer step */
+typedef struct {
+    uint16_t ccr_value;     // PWM compare to apply now (0 = carrier OFF)
+    uint32_t duration_us;   // Arm one-shot for this long, 0 = leave timer stopped
+    uint32_t completed;     // Sequence of the frame that just finished, 0 if none
+    bool idle;              // Sequencer went idle with this step
+} diseqc_seq_action_t;
+
+/* What the caller must do after diseqc_sequencer_abort() */
+typedef enum {
+    DISEQC_ABORT_NONE = 0,      // Nothing now: frame is cut at the next step, or a gap is running
+    DISEQC_ABORT_START = 1,     // Sequencer was idle: run the first step now (as after a kick)
+    DISEQC_ABORT_RELOAD = 2     // Stop the running one-shot and apply the returned action now
+} diseqc_abort_t;
+
+/* Transmit Sequencer */
+typedef struct {
+    diseqc_queue_t queue;
+    diseqc_player_t player;
+    uint16_t carrier_duty;
+    volatile uint8_t state;         // diseqc_seq_state_t
+    volatile bool reply_window;     // Current gap is a reply window
+    volatile bool abort_pending;    // Cut the current frame at the next step
+    bool tone_active;               // Current FRAME entry is an unmodulated burst
+    uint32_t current_sequence;      // Frame on the wire
+    volatile uint32_t completed_sequence;   // Last frame fully transmitted
+    uint32_t next_sequence;         // Producer-side ticket counter
+    uint32_t abort_first;           // Tickets dropped by the last abort (0 = none)
+    uint32_t abort_last;
+} diseqc_sequencer_t;
+
+/**
+ * @brief Reset a queue to empty
+ */
+void diseqc_queue_init(diseqc_queue_t *queue);
+
+/**
+ * @brief Append an entry (producer side)
+ * @return false when the queue is full
+ */
+bool diseqc_queue_push(diseqc_queue_t *queue, const diseqc_queue_entry_t *entry);
+
+/**
+ * @brief Remove the oldest entry (consumer side)
+ * @return false when the queue is empty
+ */
+bool diseqc_queue_pop(diseqc_queue_t *queue, diseqc_queue_entry_t *entry);
+
+/**
+ * @brief Number of queued entries
+ */
+uint8_t diseqc_queue_count(const diseqc_queue_t *queue);
+
+/**
+ * @brief Reset a sequencer to idle with an empty queue
+ */
+void diseqc_sequencer_init(diseqc_sequencer_t *seq, uint16_t carrier_duty);
+
+/**
+ * @brief Queue a frame (producer side)
+ * @param seq Sequencer
+ * @param frame Packed frame
+ * @param sequence Receives the completion ticket (may be NULL)
+ * @return false when the queue is full
+ */
+bool diseqc_sequencer_enqueue(diseqc_sequencer_t *seq, diseqc_bits_t frame, uint32_t *sequence);
+
+/**
+ * @brief Queue an unmodulated carrier burst (producer side)
+ * @param seq Sequencer
+ * @param duration_us Burst length (e.g. DISEQC_TONE_BURST_US), non-zero
+ * @param sequence Receives the completion ticket (may be NULL)
+ * @return false when the queue is full or duration_us is 0
+ */
+bool diseqc_sequencer_enqueue_tone(diseqc_sequencer_t *seq, uint16_t duration_us, uint32_t *sequence);
+
+/**
+ * @brief Mark an idle sequencer as pending so the next step starts a frame
+ * @return true when the caller must run the first step (sequencer was idle)
+ *
+ * Must be called with the timer path locked out.
+ */
+bool diseqc_sequencer_kick(diseqc_sequencer_t *seq);
+
+/**
+ * @brief Advance the state machine (timer expiry, or after a kick)
+ */
+diseqc_seq_action_t diseqc_sequencer_step(diseqc_sequencer_t *seq);
+
+/**
+ * @brief Cut a running reply window down to the normal inter-message gap
+ * @param seq Sequencer
+ * @param action Receives the timer reload to apply (carrier OFF, DISEQC_GAP_US)
+ * @return false when no reply window is running
+ *
+ * Must be called with the timer path locked out; the caller stops the
+ * running one-shot before applying the action.
+ */
+bool diseqc_sequencer_end_reply_window(diseqc_sequencer_t *seq, diseqc_seq_action_t *action);
+
+/**
+ * @brief Pre-empt the bus: drop queued frames, cut the current one, queue a replacement
+ * @param seq Sequencer
+ * @param frame Frame to send once the bus is quiet (e.g. Halt), bit_count 0 for none
+ * @param sequence Receives the replacement's ticket (may be NULL)
+ * @param action Receives the timer reload for DISEQC_ABORT_RELOAD
+ * @return What the caller must apply now
+ *
+ * Must be called with the timer path locked out: unlike the normal producer
+ * path it also moves the consumer index. A running unmodulated burst has no
+ * bit structure and is cut immediately; a running reply window is shortened
+ * to the normal gap.
+ */
+diseqc_abort_t diseqc_sequencer_abort(diseqc_sequencer_t *seq, diseqc_bits_t frame, uint32_t *sequence,
+                                      diseqc_seq_action_t *action);
+
+/**
+ * @brief True when a ticket was dropped or cut by the most recent abort
+ */
+bool diseqc_sequencer_ticket_aborted(const diseqc_sequencer_t *seq, uint32_t sequence);
+
+/**
+ * @brief True while a frame or gap is in progress or frames are queued
+ */
+bool diseqc_sequencer_busy(const diseqc_sequencer_t *seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISEQC_QUEUE_H */
@@ -0,0 +1,120 @@
+/**
+ * @file diseqc_rx.cpp
+ * @brief HAL-independent DiSEqC 2.x reply decoder
+ */
+
+#include "diseqc_rx.h"
+#include <string.h>
+
+#define RING_MASK   (DISEQC_RX_RING_SIZE - 1)
+
+void diseqc_rx_init(diseqc_rx_decoder_t *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->pending_flags = DISEQC_RX_FLAG_FRAME_START;
+}
+
+static bool push_byte(diseqc_rx_decoder_t *dec, uint8_t value, uint8_t flags)
+{
+    uint8_t tail = dec->tail;
+    uint8_t head = __atomic_load_n(&dec->head, __ATOMIC_ACQUIRE);
+
+    if ((uint8_t)(tail - head) >= DISEQC_RX_RING_SIZE) {
+        dec->overruns++;
+        dec->pending_flags |= DISEQC_RX_FLAG_OVERRUN;
+        return false;
+    }
+
+    dec->ring[tail & RING_MASK].value = value;
+    dec->ring[tail & RING_MASK].flags = flags;
+    __atomic_store_n(&dec->tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+bool diseqc_rx_pulse(diseqc_rx_decoder_t *dec, uint32_t on_us, uint32_t silence_before_us)
+{
+    if (silence_before_us >= DISEQC_RX_FRAME_GAP_US) {
+        // New message: drop any incomplete byte from the previous one
+        if (dec->bit_count != 0) {
+            dec->glitches++;
+        }
+        dec->shift = 0;
+        dec->bit_count = 0;
+        dec->pending_flags = (uint8_t)((dec->pending_flags & DISEQC_RX_FLAG_OVERRUN) | DISEQC_RX_FLAG_FRAME_START);
+    }
+
+    if (on_us < DISEQC_RX_ON_MIN_US || on_us > DISEQC_RX_ON_MAX_US) {
+        // Not a data bit: lose byte alignment until the next frame gap
+        dec->glitches++;
+        dec->shift = 0;
+        dec->bit_count = 0;
+        return false;
+    }
+
+    // Short burst = 1, long burst = 0 (MSB first, parity last)
+    dec->shift = (uint16_t)((dec->shift << 1) | (on_us <= DISEQC_RX_BIT1_MAX_ON_US ? 1 : 0));
+    dec->bit_count++;
+
+    if (dec->bit_count < 9) {
+        return false;
+    }
+
+    uint8_t value = (uint8_t)(dec->shift >> 1);
+    uint8_t parity = (uint8_t)(dec->shift & 1);
+    uint8_t flags = dec->pending_flags;
+
+    if (parity != diseqc_parity_bit(value)) {
+        flags |= DISEQC_RX_FLAG_PARITY_ERROR;
+    }
+
+    dec->shift = 0;
+    dec->bit_count = 0;
+
+    if (!push_byte(dec, value, flags)) {
+        return false;
+    }
+
+    dec->pending_flags = 0;
+    return true;
+}
+
+bool diseqc_rx_edge(diseqc_rx_decoder_t *dec, uint32_t timestamp_us, bool tone_on)
+{
+    bool completed = false;
+    uint32_t elapsed = timestamp_us - dec->last_edge_us;
+
+    if (tone_on == dec->tone_on && dec->have_edge) {
+        // Missed an edge: resynchronise on this one
+        dec->glitches++;
+    } else if (tone_on) {
+        dec->silence_us = dec->have_edge ? elapsed : DISEQC_RX_FRAME_GAP_US;
+    } else if (dec->have_edge) {
+        completed = diseqc_rx_pulse(dec, elapsed, dec->silence_us);
+    }
+
+    dec->tone_on = tone_on;
+    dec->last_edge_us = timestamp_us;
+    dec->have_edge = true;
+    return completed;
+}
+
+bool diseqc_rx_pop(diseqc_rx_decoder_t *dec, diseqc_rx_byte_t *out)
+{
+    uint8_t head = dec->head;
+    uint8_t tail = __atomic_load_n(&dec->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *out = dec->ring[head & RING_MASK];
+    __atomic_store_n(&dec->head, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+uint8_t diseqc_rx_available(const diseqc_rx_decoder_t *dec)
+{
+    uint8_t tail = __atomic_load_n(&dec->tail, __ATOMIC_ACQUIRE);
+    uint8_t head = __atomic_load_n(&dec->head, __ATOMIC_ACQUIRE);
+    return (uint8_t)(tail - head);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file diseqc_rx.h
+ * @brief HAL-independent DiSEqC 2.x reply decoder
+ *
+ * The slave answers with the same PWK bit encoding the master uses: a 22 kHz
+ * burst of ~0.5 ms (bit 1) or ~1.0 ms (bit 0) inside a 1.5 ms bit cell, each
+ * byte followed by an odd-parity bit. The decoder works on tone envelope
+ * edges (timestamps in µs), so any front end can feed it: an edge interrupt,
+ * a timer input-capture channel, or a recorded trace in the host tests.
+ *
+ * Decoded bytes go into a small SPSC ring: the edge ISR produces, the thread
+ * waiting for the reply consumes.
+ */
+
+#ifndef DISEQC_RX_H
+#define DISEQC_RX_H
+
+#include "diseqc_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Decoder Timing */
+#define DISEQC_RX_ON_MIN_US         250         // Shorter bursts are glitches
+#define DISEQC_RX_BIT1_MAX_ON_US    750         // Split between 0.5 ms and 1.0 ms bursts
+#define DISEQC_RX_ON_MAX_US         1500        // Longer bursts are continuous tone
+#define DISEQC_RX_FRAME_GAP_US      3000        // Silence that starts a new message
+
+#define DISEQC_RX_RING_SIZE         32          // Bytes; must be a power of two
+
+#if (DISEQC_RX_RING_SIZE & (DISEQC_RX_RING_SIZE - 1)) != 0
+#error "DISEQC_RX_RING_SIZE must be a power of two"
+#endif
+
+/* Byte Flags */
+#define DISEQC_RX_FLAG_FRAME_START  0x01        // First byte after a frame gap
+#define DISEQC_RX_FLAG_PARITY_ERROR 0x02        // Parity bit did not give odd parity
+#define DISEQC_RX_FLAG_OVERRUN      0x04        // Bytes were dropped before this one
+
+/* Reply Framing Bytes */
+#define DISEQC_REPLY_OK             0xE4        // Reply, no errors
+#define DISEQC_REPLY_NOT_SUPPORTED  0xE5        // Command not supported by slave
+#define DISEQC_REPLY_PARITY_ERROR   0xE6        // Parity error, repeat command
+#define DISEQC_REPLY_UNKNOWN        0xE7        // Command not recognised
+
+/* Decoded Byte */
+typedef struct {
+    uint8_t value;
+    uint8_t flags;          // DISEQC_RX_FLAG_*
+} diseqc_rx_byte_t;
+
+/* Decoder State */
+typedef struct {
+    diseqc_rx_byte_t ring[DISEQC_RX_RING_SIZE];
+    uint8_t head;           // Consumer index
+    uint8_t tail;           // Producer index
+
+    uint32_t last_edge_us;  // Timestamp of the previous edge
+    uint32_t silence_us;    // Silence preceding the current burst
+    bool tone_on;           // Current envelope level
+    bool have_edge;         // last_edge_us is valid
+
+    uint16_t shift;         // Bits of the byte being received, parity in bit 0
+    uint8_t bit_count;
+    uint8_t pending_flags;  // Flags for the next byte pushed
+
+    uint32_t glitches;      // Bursts outside the valid bit windows
+    uint32_t overruns;      // Bytes lost to a full ring
+} diseqc_rx_decoder_t;
+
+/**
+ * @brief Reset decoder state and empty the ring
+ */
+void diseqc_rx_init(diseqc_rx_decoder_t *dec);
+
+/**
+ * @brief Feed one tone envelope edge (producer side)
+ * @param dec Decoder
+ * @param timestamp_us Free-running µs timestamp (wraps)
+ * @param tone_on true on tone start, false on tone end
+ * @return true when the edge completed a byte
+ */
+bool diseqc_rx_edge(diseqc_rx_decoder_t *dec, uint32_t timestamp_us, bool tone_on);
+
+/**
+ * @brief Feed one measured burst (producer side)
+ * @param dec Decoder
+ * @param on_us Burst length
+ * @param silence_before_us Silence since the previous burst
+ * @return true when the burst completed a byte
+ */
+bool diseqc_rx_pulse(diseqc_rx_decoder_t *dec, uint32_t on_us, uint32_t silence_before_us);
+
+/**
+ * @brief Take the oldest decoded byte (consumer side)
+ * @return false when the ring is empty
+ */
+bool diseqc_rx_pop(diseqc_rx_decoder_t *dec, diseqc_rx_byte_t *out);
+
+/**
+ * @brief Number of decoded bytes waiting in the ring
+ */
+uint8_t diseqc_rx_available(const diseqc_rx_decoder_t *dec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISEQC_RX_H */
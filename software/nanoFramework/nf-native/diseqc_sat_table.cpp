@@ -0,0 +1,224 @@
+/**
+ * @file diseqc_sat_table.cpp
+ * @brief HAL-independent satellite / positioner slot table
+ */
+
+#include "diseqc_sat_table.h"
+#include <string.h>
+
+#define SAT(id, longitude_tenths) \
+    { diseqc_sat_hash_c(id), (int16_t)(longitude_tenths), 0, DISEQC_SAT_FLAG_LONGITUDE }
+
+/* Built-in satellites, listed in ascending hash order */
+static constexpr diseqc_sat_entry_t builtin[] = {
+    SAT("astra_19.2e",   192),
+    SAT("hispasat_30w", -300),
+    SAT("amos_4w",       -40),
+    SAT("astra_28.2e",   282),
+    SAT("astra_23.5e",   235),
+    SAT("eutelsat_7e",    70),
+    SAT("eutelsat_9e",    90),
+    SAT("eutelsat_36e",  360),
+    SAT("eutelsat_5w",   -50),
+    SAT("thor_0.8w",      -8),
+    SAT("hotbird_13e",   130),
+    SAT("turksat_42e",   420),
+    SAT("eutelsat_16e",  160),
+};
+
+#define BUILTIN_COUNT   (sizeof(builtin) / sizeof(builtin[0]))
+
+constexpr bool builtin_sorted(size_t i)
+{
+    return i + 1 >= BUILTIN_COUNT ? true
+        : (builtin[i].id_hash < builtin[i + 1].id_hash && builtin_sorted(i + 1));
+}
+
+static_assert(builtin_sorted(0), "built-in satellites must be in ascending, unique hash order");
+static_assert(sizeof(diseqc_sat_entry_t) == DISEQC_SAT_BLOB_ENTRY, "entry is packed 8 bytes");
+
+uint32_t diseqc_sat_hash(const char *id, size_t length)
+{
+    uint32_t hash = 0x811C9DC5u;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)diseqc_sat_lower(id[i]);
+        hash *= 0x01000193u;
+    }
+
+    return hash;
+}
+
+void diseqc_sat_table_init(diseqc_sat_table_t *table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * @brief Lower-bound binary search
+ * @return Index of the first entry with hash >= id_hash
+ */
+static size_t lower_bound(const diseqc_sat_entry_t *entries, size_t count, uint32_t id_hash)
+{
+    size_t low = 0;
+    size_t high = count;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (entries[mid].id_hash < id_hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+bool diseqc_sat_find(const diseqc_sat_table_t *table, uint32_t id_hash, diseqc_sat_entry_t *out)
+{
+    if (table != NULL) {
+        size_t i = lower_bound(table->entries, table->count, id_hash);
+        if (i < table->count && table->entries[i].id_hash == id_hash) {
+            *out = table->entries[i];
+            return true;
+        }
+    }
+
+    size_t i = lower_bound(builtin, BUILTIN_COUNT, id_hash);
+    if (i < BUILTIN_COUNT && builtin[i].id_hash == id_hash) {
+        *out = builtin[i];
+        return true;
+    }
+
+    return false;
+}
+
+bool diseqc_sat_table_set(diseqc_sat_table_t *table, const diseqc_sat_entry_t *entry)
+{
+    size_t i = lower_bound(table->entries, table->count, entry->id_hash);
+
+    if (i < table->count && table->entries[i].id_hash == entry->id_hash) {
+        table->entries[i] = *entry;
+        return true;
+    }
+
+    if (table->count >= DISEQC_SAT_TABLE_MAX) {
+        return false;
+    }
+
+    memmove(&table->entries[i + 1], &table->entries[i], (table->count - i) * sizeof(diseqc_sat_entry_t));
+    table->entries[i] = *entry;
+    table->count++;
+    return true;
+}
+
+bool diseqc_sat_table_remove(diseqc_sat_table_t *table, uint32_t id_hash)
+{
+    size_t i = lower_bound(table->entries, table->count, id_hash);
+
+    if (i >= table->count || table->entries[i].id_hash != id_hash) {
+        return false;
+    }
+
+    table->count--;
+    memmove(&table->entries[i], &table->entries[i + 1], (table->count - i) * sizeof(diseqc_sat_entry_t));
+    return true;
+}
+
+static void put_entry(uint8_t *p, const diseqc_sat_entry_t *entry)
+{
+    p[0] = (uint8_t)(entry->id_hash);
+    p[1] = (uint8_t)(entry->id_hash >> 8);
+    p[2] = (uint8_t)(entry->id_hash >> 16);
+    p[3] = (uint8_t)(entry->id_hash >> 24);
+    p[4] = (uint8_t)((uint16_t)entry->longitude_tenths);
+    p[5] = (uint8_t)((uint16_t)entry->longitude_tenths >> 8);
+    p[6] = entry->slot;
+    p[7] = entry->flags;
+}
+
+static void get_entry(const uint8_t *p, diseqc_sat_entry_t *entry)
+{
+    entry->id_hash = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    entry->longitude_tenths = (int16_t)((uint16_t)p[4] | ((uint16_t)p[5] << 8));
+    entry->slot = p[6];
+    entry->flags = p[7];
+}
+
+static uint16_t checksum(const uint8_t *data, size_t length)
+{
+    // Same byte-sum as the managed FRAM configuration block
+    uint32_t sum = 0;
+    for (size_t i = 0; i < length; i++) {
+        sum += data[i];
+    }
+    return (uint16_t)sum;
+}
+
+size_t diseqc_sat_table_export(const diseqc_sat_table_t *table, uint8_t *buffer, size_t size)
+{
+    size_t length = DISEQC_SAT_BLOB_HEADER + (size_t)table->count * DISEQC_SAT_BLOB_ENTRY;
+
+    if (buffer == NULL || size < length) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < table->count; i++) {
+        put_entry(&buffer[DISEQC_SAT_BLOB_HEADER + i * DISEQC_SAT_BLOB_ENTRY], &table->entries[i]);
+    }
+
+    uint16_t sum = checksum(&buffer[DISEQC_SAT_BLOB_HEADER], length - DISEQC_SAT_BLOB_HEADER);
+    buffer[0] = 'D';
+    buffer[1] = 'S';
+    buffer[2] = 'A';
+    buffer[3] = 'T';
+    buffer[4] = DISEQC_SAT_BLOB_VERSION;
+    buffer[5] = table->count;
+    buffer[6] = (uint8_t)sum;
+    buffer[7] = (uint8_t)(sum >> 8);
+
+    return length;
+}
+
+bool diseqc_sat_table_import(diseqc_sat_table_t *table, const uint8_t *buffer, size_t length)
+{
+    if (buffer == NULL || length < DISEQC_SAT_BLOB_HEADER ||
+        buffer[0] != 'D' || buffer[1] != 'S' || buffer[2] != 'A' || buffer[3] != 'T' ||
+        buffer[4] != DISEQC_SAT_BLOB_VERSION || buffer[5] > DISEQC_SAT_TABLE_MAX) {
+        return false;
+    }
+
+    uint8_t count = buffer[5];
+    size_t payload = (size_t)count * DISEQC_SAT_BLOB_ENTRY;
+
+    if (length < DISEQC_SAT_BLOB_HEADER + payload) {
+        return false;
+    }
+
+    uint16_t sum = (uint16_t)(buffer[6] | (buffer[7] << 8));
+    if (checksum(&buffer[DISEQC_SAT_BLOB_HEADER], payload) != sum) {
+        return false;
+    }
+
+    diseqc_sat_table_t loaded;
+    diseqc_sat_table_init(&loaded);
+
+    for (uint8_t i = 0; i < count; i++) {
+        get_entry(&buffer[DISEQC_SAT_BLOB_HEADER + i * DISEQC_SAT_BLOB_ENTRY], &loaded.entries[i]);
+
+        // Lookups rely on strictly ascending hashes
+        if (i > 0 && loaded.entries[i].id_hash <= loaded.entries[i - 1].id_hash) {
+            return false;
+        }
+    }
+
+    loaded.count = count;
+    *table = loaded;
+    return true;
+}
+
+size_t diseqc_sat_builtin_count(void)
+{
+    return BUILTIN_COUNT;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file diseqc_sat_table.h
+ * @brief HAL-independent satellite / positioner slot table
+ *
+ * Satellites are identified by the FNV-1a hash of their lower-case id
+ * ("astra_19.2e"), so the CLR hands over the id once and native code never
+ * handles strings on the retune path.
+ *
+ * Two sorted arrays are searched by binary search on the hash:
+ * - a built-in table in flash (orbital longitudes of common satellites,
+ *   sorted at authoring time, order checked by static_assert)
+ * - a RAM overlay of user entries (stored positioner slots, custom
+ *   satellites) that overrides the built-in table and is persisted to FRAM
+ *   by the owner as an opaque blob (diseqc_sat_table_export/import).
+ */
+
+#ifndef DISEQC_SAT_TABLE_H
+#define DISEQC_SAT_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISEQC_SAT_TABLE_MAX        24          // User entries in the RAM overlay
+#define DISEQC_SAT_ID_MAX           32          // Longest accepted satellite id
+
+/* Entry Flags */
+#define DISEQC_SAT_FLAG_LONGITUDE   0x01        // longitude_tenths is valid
+
+/* Persisted Blob Layout */
+#define DISEQC_SAT_BLOB_VERSION     1
+#define DISEQC_SAT_BLOB_HEADER      8           // 'D' 'S' 'A' 'T', version, count, checksum (LE)
+#define DISEQC_SAT_BLOB_ENTRY       8
+#define DISEQC_SAT_BLOB_MAX         (DISEQC_SAT_BLOB_HEADER + DISEQC_SAT_TABLE_MAX * DISEQC_SAT_BLOB_ENTRY)
+
+/* Table Entry */
+typedef struct {
+    uint32_t id_hash;           // diseqc_sat_hash() of the satellite id
+    int16_t longitude_tenths;   // Orbital position, 0.1° units, East positive
+    uint8_t slot;               // Positioner slot for Goto NN, 0 = none stored
+    uint8_t flags;              // DISEQC_SAT_FLAG_*
+} diseqc_sat_entry_t;
+
+/* RAM Overlay (sorted by id_hash) */
+typedef struct {
+    diseqc_sat_entry_t entries[DISEQC_SAT_TABLE_MAX];
+    uint8_t count;
+} diseqc_sat_table_t;
+
+/**
+ * @brief Case-insensitive FNV-1a hash of a satellite id
+ * @param id Id characters (need not be terminated)
+ * @param length Number of characters
+ */
+uint32_t diseqc_sat_hash(const char *id, size_t length);
+
+/**
+ * @brief Empty the overlay
+ */
+void diseqc_sat_table_init(diseqc_sat_table_t *table);
+
+/**
+ * @brief Find a satellite, overlay first, then the built-in table
+ * @return false when the hash is unknown
+ */
+bool diseqc_sat_find(const diseqc_sat_table_t *table, uint32_t id_hash, diseqc_sat_entry_t *out);
+
+/**
+ * @brief Insert or replace an overlay entry
+ * @return false when the overlay is full
+ */
+bool diseqc_sat_table_set(diseqc_sat_table_t *table, const diseqc_sat_entry_t *entry);
+
+/**
+ * @brief Remove an overlay entry (built-in entries are unaffected)
+ * @return false when the hash is not in the overlay
+ */
+bool diseqc_sat_table_remove(diseqc_sat_table_t *table, uint32_t id_hash);
+
+/**
+ * @brief Serialise the overlay for FRAM
+ * @param buffer Destination, DISEQC_SAT_BLOB_MAX bytes is always enough
+ * @return Bytes written, 0 when the buffer is too small
+ */
+size_t diseqc_sat_table_export(const diseqc_sat_table_t *table, uint8_t *buffer, size_t size);
+
+/**
+ * @brief Replace the overlay with a blob written by diseqc_sat_table_export()
+ * @return false on a bad header, checksum or ordering (overlay left unchanged)
+ */
+bool diseqc_sat_table_import(diseqc_sat_table_t *table, const uint8_t *buffer, size_t length);
+
+/**
+ * @brief Number of entries in the built-in table
+ */
+size_t diseqc_sat_builtin_count(void);
+
+#ifdef __cplusplus
+}
+
+/* Compile-time id hashing (C++ only) */
+
+constexpr char diseqc_sat_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+constexpr uint32_t diseqc_sat_hash_c(const char *id, uint32_t hash = 0x811C9DC5u)
+{
+    return *id == '\0' ? hash
+        : diseqc_sat_hash_c(id + 1, (uint32_t)((hash ^ (uint8_t)diseqc_sat_lower(*id)) * 0x01000193ull));
+}
+
+#endif /* __cplusplus */
+
+#endif /* DISEQC_SAT_TABLE_H */
@@ -0,0 +1,114 @@
+/**
+ * @file diseqc_usals.cpp
+ * @brief HAL-independent fixed-point USALS motor angle calculation
+ */
+
+#include "diseqc_usals.h"
+
+#define CORDIC_ITERATIONS   30
+#define CORDIC_GAIN_Q30     652032874   // Product of 1/sqrt(1 + 2^-2i), Q30
+
+/* atan(2^-i) as binary angles */
+static const int32_t cordic_atan[CORDIC_ITERATIONS] = {
+    536870912, 316933406, 167458907, 85004756, 42667331, 21354465,
+    10679838, 5340245, 2670163, 1335087, 667544, 333772,
+    166886, 83443, 41722, 20861, 10430, 5215,
+    2608, 1304, 652, 326, 163, 81,
+    41, 20, 10, 5, 3, 1
+};
+
+int32_t diseqc_usals_mdeg_to_bam(int32_t mdeg)
+{
+    // 2^32 / 360000 in Q24; product fits comfortably in 64 bits
+    return (int32_t)(uint32_t)(((int64_t)mdeg * 200159983439LL) >> 24);
+}
+
+void diseqc_usals_sincos(int32_t bam, int32_t *sin_q30, int32_t *cos_q30)
+{
+    // CORDIC converges for |angle| <= ~99°: fold the other half-plane over
+    bool negate = false;
+    if (bam > (int32_t)DISEQC_USALS_BAM_90 || bam < -(int32_t)DISEQC_USALS_BAM_90) {
+        bam = (int32_t)((uint32_t)bam + 0x80000000u);
+        negate = true;
+    }
+
+    int32_t x = CORDIC_GAIN_Q30;
+    int32_t y = 0;
+    int32_t z = bam;
+
+    for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+        int32_t dx = y >> i;
+        int32_t dy = x >> i;
+        if (z >= 0) {
+            x -= dx;
+            y += dy;
+            z -= cordic_atan[i];
+        } else {
+            x += dx;
+            y -= dy;
+            z += cordic_atan[i];
+        }
+    }
+
+    *cos_q30 = negate ? -x : x;
+    *sin_q30 = negate ? -y : y;
+}
+
+int32_t diseqc_usals_atan2(int32_t y, int32_t x)
+{
+    // Rotate the left half-plane by 180° first; binary angles wrap for free
+    uint32_t z = 0;
+    if (x < 0) {
+        x = -x;
+        y = -y;
+        z = 0x80000000u;
+    }
+
+    // Headroom for the ~1.65 CORDIC gain
+    x >>= 1;
+    y >>= 1;
+
+    for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+        int32_t dx = y >> i;
+        int32_t dy = x >> i;
+        if (y > 0) {
+            x += dx;
+            y -= dy;
+            z += (uint32_t)cordic_atan[i];
+        } else {
+            x -= dx;
+            y += dy;
+            z -= (uint32_t)cordic_atan[i];
+        }
+    }
+
+    return (int32_t)z;
+}
+
+bool diseqc_usals_angle16(int32_t site_lat_mdeg, int32_t site_lon_mdeg,
+                          int32_t sat_lon_mdeg, int16_t *angle_16)
+{
+    int32_t sin_lat, cos_lat, sin_d, cos_d;
+
+    diseqc_usals_sincos(diseqc_usals_mdeg_to_bam(site_lat_mdeg), &sin_lat, &cos_lat);
+    diseqc_usals_sincos(diseqc_usals_mdeg_to_bam(sat_lon_mdeg - site_lon_mdeg), &sin_d, &cos_d);
+
+    // Visible when the satellite is above the horizon: cos d · cos lat > r
+    int32_t cos_central = (int32_t)(((int64_t)cos_d * cos_lat) >> 30);
+    if (cos_central <= DISEQC_USALS_EARTH_RATIO_Q30) {
+        return false;
+    }
+
+    int32_t r_cos_lat = (int32_t)(((int64_t)DISEQC_USALS_EARTH_RATIO_Q30 * cos_lat) >> 30);
+    int32_t hour_angle = diseqc_usals_atan2(sin_d, cos_d - r_cos_lat);
+
+    // Satellite East of the site (positive hour angle) is a GotoX East move
+    // (negative) in the northern hemisphere, mirrored in the southern one
+    if (site_lat_mdeg >= 0) {
+        hour_angle = -hour_angle;
+    }
+
+    // Binary angle to 1/16°, rounded
+    *angle_16 = (int16_t)((((int64_t)hour_angle * 5760) + (1LL << 31)) >> 32);
+    return true;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file diseqc_usals.h
+ * @brief HAL-independent fixed-point USALS motor angle calculation
+ *
+ * Computes the GotoX motor angle for a satellite from the site position,
+ * without floating point or libm. Angles are handled as 32-bit binary
+ * angles (2^32 = 360°) and trig is done by CORDIC with a precomputed
+ * arctangent table, so the cost is a fixed ~60 shift/add iterations.
+ *
+ * Model: spherical Earth, motor axis parallel to the polar axis. For a
+ * longitude difference d (satellite minus site, East positive) and site
+ * latitude lat, the hour angle is
+ *     atan2(sin d, cos d - r·cos lat),  r = Earth radius / GEO radius
+ * which is the angle USALS motors expect for their modified polar mount.
+ */
+
+#ifndef DISEQC_USALS_H
+#define DISEQC_USALS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISEQC_USALS_Q30_ONE        (1L << 30)
+#define DISEQC_USALS_EARTH_RATIO_Q30 162423976  // 6378.137 km / 42164.172 km in Q30
+#define DISEQC_USALS_BAM_90         0x40000000u // Binary angle of 90°
+
+/**
+ * @brief Convert millidegrees to a 32-bit binary angle (wraps at ±180°)
+ */
+int32_t diseqc_usals_mdeg_to_bam(int32_t mdeg);
+
+/**
+ * @brief CORDIC sine/cosine of a binary angle
+ * @param bam Angle, 2^32 = 360°
+ * @param sin_q30 Receives sin in Q30
+ * @param cos_q30 Receives cos in Q30
+ */
+void diseqc_usals_sincos(int32_t bam, int32_t *sin_q30, int32_t *cos_q30);
+
+/**
+ * @brief CORDIC atan2 (inputs in the same fixed-point scale, |x|,|y| < 2^30)
+ * @return Binary angle of (x, y)
+ */
+int32_t diseqc_usals_atan2(int32_t y, int32_t x);
+
+/**
+ * @brief Motor angle for a satellite
+ * @param site_lat_mdeg Site latitude, millidegrees, North positive
+ * @param site_lon_mdeg Site longitude, millidegrees, East positive
+ * @param sat_lon_mdeg Satellite longitude, millidegrees, East positive
+ * @param angle_16 Receives the motor angle in 1/16° (GotoX units),
+ *                 West positive / East negative like diseqc_goto_angle()
+ * @return false when the satellite is below the site's horizon
+ *
+ * In the southern hemisphere the motor faces north, so East and West are
+ * mirrored relative to the satellite's geographic direction.
+ */
+bool diseqc_usals_angle16(int32_t site_lat_mdeg, int32_t site_lon_mdeg,
+                          int32_t sat_lon_mdeg, int16_t *angle_16);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISEQC_USALS_H */
@@ -6,1395 +6,1048 @@
 #include <nanoCLR_Interop.h>
 #include <nanoCLR_Runtime.h>
 #include <nanoCLR_Checks.h>
-#include <hal.h>
-#include <string.h>
-#include <stdlib.h>
-#include "board_cubley.h"
+#include <nanoHAL_v2.h>
+#include "w5500_native.h"
 
-extern volatile uint32_t g_cubley_diag_current_status;
 extern volatile uint32_t g_cubley_diag_last_error;
 
-enum w5500_socket_status_t
-{
-    W5500_SOCKET_OK = 0,
-    W5500_SOCKET_INVALID_PARAM = 1,
-    W5500_SOCKET_NOT_INITIALIZED = 2,
-    W5500_SOCKET_BUSY = 3,
-    W5500_SOCKET_TIMEOUT = 4,
-    W5500_SOCKET_NOT_SUPPORTED = 5,
-    W5500_SOCKET_IO_ERROR = 6
-};
-
-static const int32_t kSingleSocketHandle = 1;
-static const uint8_t kSocketIndex = 0;
-
-static const uint8_t W5500_MR = 0x0000;
-static const uint8_t W5500_GAR = 0x0001;
-static const uint8_t W5500_SUBR = 0x0005;
-static const uint8_t W5500_SHAR = 0x0009;
-static const uint8_t W5500_SIPR = 0x000F;
-static const uint8_t W5500_RTR = 0x0019;
-static const uint8_t W5500_RCR = 0x001B;
-static const uint16_t W5500_PHYCFGR = 0x002E;
-static const uint8_t W5500_VERSIONR = 0x0039;
-
-static const uint8_t W5500_PHYCFGR_LNK = 0x01;
-static const uint8_t W5500_PHYCFGR_SPD = 0x02;
-static const uint8_t W5500_PHYCFGR_DPX = 0x04;
-static const uint8_t W5500_PHYCFGR_OPMDC_MASK = 0x38;
-static const uint8_t W5500_PHYCFGR_OPMD = 0x40;
-static const uint8_t W5500_PHYCFGR_RST = 0x80;
-// W5500 PHYCFGR.OPMDC[5:3] encoding (datasheet rev 1.0.6, table on PHYCFGR):
-//   000 10BT-HD       001 10BT-FD       010 100BT-HD (no AN)  011 100BT-FD (no AN)
-//   100 100BT-HD AN   101 Power Down    110 All-capable AN    111 reserved/not used
-// "All capable, auto-negotiation enabled" = OPMDC = 0b110 -> bits[5:3]=110 -> 0x30.
-// (Earlier value 0x38 set OPMDC=0b111 which is reserved; the analog TX block treated
-// it as power-down equivalent, leaving TD+ pinned at +3V3 via R28 with no FLPs.)
-static const uint8_t W5500_PHYCFGR_OPMDC_ALL_AUTO = 0x30;
-
-static const uint16_t Sn_MR = 0x0000;
-static const uint16_t Sn_CR = 0x0001;
-static const uint16_t Sn_IR = 0x0002;
-static const uint16_t Sn_SR = 0x0003;
-static const uint16_t Sn_PORT = 0x0004;
-static const uint16_t Sn_DIPR = 0x000C;
-static const uint16_t Sn_DPORT = 0x0010;
-static const uint16_t Sn_TX_FSR = 0x0020;
-static const uint16_t Sn_TX_WR = 0x0024;
-static const uint16_t Sn_RX_RSR = 0x0026;
-static const uint16_t Sn_RX_RD = 0x0028;
-static const uint16_t Sn_RXBUF_SIZE = 0x001E;
-static const uint16_t Sn_TXBUF_SIZE = 0x001F;
-
-static const uint8_t W5500_SOCK_MODE_TCP = 0x01;
-static const uint8_t W5500_CMD_OPEN = 0x01;
-static const uint8_t W5500_CMD_CONNECT = 0x04;
-static const uint8_t W5500_CMD_DISCON = 0x08;
-static const uint8_t W5500_CMD_CLOSE = 0x10;
-static const uint8_t W5500_CMD_SEND = 0x20;
-static const uint8_t W5500_CMD_RECV = 0x40;
-
-static const uint8_t W5500_SOCK_CLOSED = 0x00;
-static const uint8_t W5500_SOCK_INIT = 0x13;
-static const uint8_t W5500_SOCK_ESTABLISHED = 0x17;
-static const uint8_t W5500_SOCK_CLOSE_WAIT = 0x1C;
-
-static const uint8_t W5500_IR_CON = 0x01;
-static const uint8_t W5500_IR_TIMEOUT = 0x08;
-static const uint8_t W5500_IR_SENDOK = 0x10;
-static const uint8_t W5500_IR_RECV = 0x04;
-
-static const uint8_t W5500_BSB_COMMON = 0x00;
-static const uint8_t W5500_BSB_SOCKET_REG = 0x01;
-static const uint8_t W5500_BSB_SOCKET_TX = 0x02;
-static const uint8_t W5500_BSB_SOCKET_RX = 0x03;
-
-static const uint16_t kDefaultSourcePort = 50000;
-static const uint16_t kDefaultRetryTime = 2000;
-static const uint8_t kDefaultRetryCount = 3;
-
-static uint8_t g_networkMac[6] = {0x02, 0x08, 0xDC, 0x00, 0x00, 0x01};
-static uint8_t g_networkGateway[4] = {192, 168, 1, 1};
-static uint8_t g_networkSubnet[4] = {255, 255, 255, 0};
-static uint8_t g_networkIp[4] = {192, 168, 1, 123};
-
-static bool g_initialized = false;
-static bool g_socketAllocated = false;
-static bool g_socketConnected = false;
-static uint16_t g_nextSourcePort = kDefaultSourcePort;
-
-static inline void set_w5500_bringup_status(uint8_t stage, uint8_t result, uint8_t detail)
-{
-    g_cubley_diag_current_status = ((uint32_t)0xD5 << 24) | ((uint32_t)stage << 16) | ((uint32_t)result << 8) | (uint32_t)detail;
-}
+// Managed socket handles are the W5500 socket index + 1, so 0 is never valid.
+static bool g_socketConnected[W5500_SOCKET_COUNT];
+// Set once W5500SocketUdp.NativeBind has put the socket in UDP mode.
+static bool g_socketUdp[W5500_SOCKET_COUNT];
 
-static inline void set_w5500_last_native_error(uint8_t op, uint8_t code, uint8_t detail)
+static bool w5500_handle_to_socket(int32_t socketHandle, uint8_t* outSocket)
 {
-    // 0xE1 marker | op | code | detail (sticky until next update).
-    g_cubley_diag_last_error = ((uint32_t)0xE1 << 24) | ((uint32_t)op << 16) | ((uint32_t)code << 8) | (uint32_t)detail;
-}
+    if (socketHandle < 1 || socketHandle > W5500_SOCKET_COUNT)
+    {
+        return false;
+    }
 
-// Hardware SPI2 for W5500: PB12=NSS, PB13=SCK, PB14=MISO, PB15=MOSI (all AF5).
-// APB1=42 MHz; BR[2:0]=010 -> fPCLK/8 ~5.25 MHz, mode 0 (CPOL=0 CPHA=0).
-static SPIConfig g_spi2cfg;
-static bool g_spi2cfg_initialized = false;
-// SPI DMA on STM32F4 cannot access CCM stack (0x1000xxxx), so keep transfer
-// buffers in static SRAM-backed storage.
-static uint8_t g_w5500_spi_tx4[4];
-static uint8_t g_w5500_spi_rx4[4];
-static uint8_t g_w5500_spi_hdr3[3];
-static uint8_t g_w5500_spi_word2[2];
-static uint8_t g_w5500_last_spi_rx0 = 0;
-static uint8_t g_w5500_last_spi_rx1 = 0;
-static uint8_t g_w5500_last_spi_ctrl = 0;
-static uint8_t g_w5500_last_spi_data = 0;
-// CS transition bits sampled around a 4-byte read transaction:
-// bit3=before select, bit2=after select, bit1=before unselect, bit0=after unselect.
-// Expected for active-low CS is 0b1001 (0x9).
-static uint8_t g_w5500_last_cs_bits = 0;
-// PB12 high->low->high GPIO sanity code from w5500_hw_init() (expected 0b101 = 0x5).
-static uint8_t g_w5500_cs_gpio_code = 0;
-
-static inline void w5500_cs_gpio_assert(void)
-{
-    palClearLine(W5500_CS_LINE);
+    *outSocket = (uint8_t)(socketHandle - 1);
+    return w5500_socket_is_open(*outSocket);
 }
 
-static inline void w5500_cs_gpio_release(void)
-{
-    palSetLine(W5500_CS_LINE);
-}
+// Sub-category used for CustomEvent connection notifications
+// (data1 = bit mask of sockets whose supervised state changed, data2 = 0).
+// Managed code reads the new state with W5500SocketReconnect.NativeGetState.
+#define W5500_MANAGED_EVENT_SUBCATEGORY 0xD6
 
-static inline void w5500_spi_select(void)
-{
-    spiSelect(&SPID2);
-}
+static THD_WORKING_AREA(wa_w5500_events, 256);
+static thread_t *g_w5500_event_thread = NULL;
 
-static inline void w5500_spi_unselect(void)
+// Forwards reconnect state changes to managed code. Changes close together
+// coalesce into one event carrying every socket that moved.
+static THD_FUNCTION(w5500_event_thread, arg)
 {
-    spiUnselect(&SPID2);
-}
+    (void)arg;
+    event_listener_t listener;
 
-static void w5500_spi_prepare_config(void)
-{
-    if (g_spi2cfg_initialized)
+    chRegSetThreadName("w5500_evt");
+    chEvtRegisterMaskWithFlags(w5500_reconnect_get_event_source(), &listener, EVENT_MASK(0),
+                               (eventflags_t)((1U << W5500_SOCKET_COUNT) - 1U));
+
+    while (true)
     {
-        return;
-    }
+        chEvtWaitAny(EVENT_MASK(0));
+        eventflags_t flags = chEvtGetAndClearFlags(&listener);
 
-    memset(&g_spi2cfg, 0, sizeof(g_spi2cfg));
-
-#if (SPI_SUPPORTS_CIRCULAR == TRUE)
-    g_spi2cfg.circular = false;
-#endif
-
-#if defined(HAL_LLD_SELECT_SPI_V2)
-#if (SPI_SUPPORTS_SLAVE_MODE == TRUE)
-    g_spi2cfg.slave = false;
-#endif
-    g_spi2cfg.data_cb = NULL;
-    g_spi2cfg.error_cb = NULL;
-#else
-    g_spi2cfg.end_cb = NULL;
-#endif
-
-#if (SPI_SELECT_MODE == SPI_SELECT_MODE_LINE)
-    g_spi2cfg.ssline = W5500_CS_LINE;
-#elif (SPI_SELECT_MODE == SPI_SELECT_MODE_PORT)
-    g_spi2cfg.ssport = GPIOB;
-    g_spi2cfg.ssmask = (ioportmask_t)(1U << 12U);
-#elif (SPI_SELECT_MODE == SPI_SELECT_MODE_PAD)
-    g_spi2cfg.ssport = GPIOB;
-    g_spi2cfg.sspad = 12U;
-#else
-#error Unsupported SPI_SELECT_MODE for W5500 SPI config
-#endif
-
-    g_spi2cfg.cr1 = SPI_CR1_BR_1;
-    g_spi2cfg.cr2 = 0U;
-    g_spi2cfg_initialized = true;
+        PostManagedEvent(EVENT_CUSTOM, W5500_MANAGED_EVENT_SUBCATEGORY, (uint16_t)flags, 0);
+    }
 }
 
-static void w5500_spi_start(void)
+static void ensure_event_thread()
 {
-    w5500_spi_prepare_config();
-    // Early init can run before scheduler start; avoid mutex-based bus acquire there.
-    spiStart(&SPID2, &g_spi2cfg);
+    if (g_w5500_event_thread == NULL)
+    {
+        g_w5500_event_thread = chThdCreateStatic(wa_w5500_events, sizeof(wa_w5500_events),
+                                                 NORMALPRIO, w5500_event_thread, NULL);
+    }
 }
 
-static void w5500_spi_set_cr1(uint16_t cr1)
+HRESULT Library_cubley_interop_W5500Socket_NativeOpen___STATIC__I4__BYREF_I4(CLR_RT_StackFrame& stack)
 {
-    g_spi2cfg.cr1 = cr1;
-    spiStop(&SPID2);
-    spiStart(&SPID2, &g_spi2cfg);
-}
+    NANOCLR_HEADER();
 
-static void w5500_scope_spi_clock_burst()
-{
-    // Scope-assist for low-end DSO capture: emit repeated, slow SPI bursts with CS low.
-    static uint8_t tx[32];
-    static uint8_t rx[32];
+    uint8_t socket = 0;
+    w5500_socket_status_t openStatus = W5500_SOCKET_IO_ERROR;
 
-    for (size_t i = 0; i < sizeof(tx); i++)
+    set_w5500_bringup_status(2, 0, 0);
+    set_w5500_last_native_error(0x10, 0x00, 0x00);
+
+    if (!w5500_is_initialized())
     {
-        tx[i] = (uint8_t)((i & 1U) != 0U ? 0xAAU : 0x55U);
+        w5500_socket_status_t initStatus = w5500_init();
+        if (initStatus != W5500_SOCKET_OK)
+        {
+            stack.Arg0().NumericByRef().s4 = -1;
+            stack.SetResult_I4((int32_t)initStatus);
+            set_w5500_bringup_status(2, 14, (uint8_t)initStatus);
+            // Preserve low-byte context from the last native probe record so SWD
+            // diagnostics can still infer which init probe failed.
+            set_w5500_last_native_error(0x11, (uint8_t)initStatus, (uint8_t)(g_cubley_diag_last_error & 0xFFU));
+            NANOCLR_SET_AND_LEAVE(S_OK);
+        }
     }
 
-    // Slowest prescaler gives the widest pulses for easy visual confirmation.
-    w5500_spi_set_cr1((uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0));
-
-    for (int burst = 0; burst < 12; burst++)
+    openStatus = w5500_socket_open(&socket);
+    if (openStatus != W5500_SOCKET_OK)
     {
-        memset(rx, 0, sizeof(rx));
-        w5500_spi_select();
-        spiExchange(&SPID2, sizeof(tx), tx, rx);
-        w5500_spi_unselect();
-        chThdSleepMilliseconds(20);
+        stack.Arg0().NumericByRef().s4 = -1;
+        stack.SetResult_I4((int32_t)openStatus);
+        set_w5500_bringup_status(2, 14, (uint8_t)openStatus);
+        set_w5500_last_native_error(0x12, (uint8_t)openStatus, 0x00);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    // Restore default probe baseline before entering normal init sequence.
-    w5500_spi_set_cr1(SPI_CR1_BR_1);
+    g_socketConnected[socket] = false;
+    g_socketUdp[socket] = false;
+    stack.Arg0().NumericByRef().s4 = (int32_t)socket + 1;
+    stack.SetResult_I4((int32_t)W5500_SOCKET_OK);
+    set_w5500_bringup_status(2, 1, socket);
+    set_w5500_last_native_error(0x13, (uint8_t)W5500_SOCKET_OK, socket);
+
+    NANOCLR_NOCLEANUP();
 }
 
-static void w5500_scope_versionr_stream(uint8_t *lastVersion, uint8_t *nonZeroCount)
+HRESULT Library_cubley_interop_W5500Socket_NativeConfigureNetwork___STATIC__I4__STRING__STRING__STRING__STRING(CLR_RT_StackFrame& stack)
 {
-    static uint8_t tx4[4];
-    static uint8_t rx4[4];
-
-    tx4[0] = (uint8_t)(W5500_VERSIONR >> 8);
-    tx4[1] = (uint8_t)(W5500_VERSIONR & 0xFF);
-    tx4[2] = (uint8_t)((W5500_BSB_COMMON << 3) | 0x00);
-    tx4[3] = 0x00;
+    NANOCLR_HEADER();
 
-    uint8_t last = 0;
-    uint8_t nonZero = 0;
+    set_w5500_bringup_status(3, 0, 0);
 
-    // Slow, repeated valid reads to make MISO transitions visible on entry-level scopes.
-    w5500_spi_set_cr1((uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0));
+    CLR_RT_HeapBlock* ipArg = &(stack.Arg0());
+    CLR_RT_HeapBlock* subnetArg = &(stack.Arg1());
+    CLR_RT_HeapBlock* gatewayArg = &(stack.Arg2());
+    CLR_RT_HeapBlock* macArg = &(stack.Arg3());
 
-    for (int i = 0; i < 48; i++)
-    {
-        memset(rx4, 0, sizeof(rx4));
-        w5500_spi_select();
-        spiExchange(&SPID2, 4U, tx4, rx4);
-        w5500_spi_unselect();
+    CLR_RT_HeapBlock_String* ip = NULL;
+    CLR_RT_HeapBlock_String* subnet = NULL;
+    CLR_RT_HeapBlock_String* gateway = NULL;
+    CLR_RT_HeapBlock_String* mac = NULL;
 
-        last = rx4[3];
-        if (rx4[3] != 0)
-        {
-            nonZero++;
-        }
+    uint8_t parsedIp[4] = {0};
+    uint8_t parsedSubnet[4] = {0};
+    uint8_t parsedGateway[4] = {0};
+    uint8_t parsedMac[6] = {0};
 
-        chThdSleepMilliseconds(8);
-    }
+    ip = ipArg->DereferenceString();
+    subnet = subnetArg->DereferenceString();
+    gateway = gatewayArg->DereferenceString();
+    mac = macArg->DereferenceString();
 
-    w5500_spi_set_cr1(SPI_CR1_BR_1);
+    FAULT_ON_NULL(ip);
+    FAULT_ON_NULL(subnet);
+    FAULT_ON_NULL(gateway);
+    FAULT_ON_NULL(mac);
 
-    if (lastVersion != NULL)
+    if (!w5500_parse_ipv4(ip->StringText(), parsedIp) ||
+        !w5500_parse_ipv4(subnet->StringText(), parsedSubnet) ||
+        !w5500_parse_ipv4(gateway->StringText(), parsedGateway) ||
+        !w5500_parse_mac(mac->StringText(), parsedMac))
     {
-        *lastVersion = last;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(3, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    if (nonZeroCount != NULL)
-    {
-        *nonZeroCount = nonZero;
-    }
-}
+    w5500_set_network(parsedIp, parsedSubnet, parsedGateway, parsedMac);
 
+    stack.SetResult_I4((int32_t)W5500_SOCKET_OK);
+    set_w5500_bringup_status(3, 1, 0);
 
-static inline uint8_t socket_reg_bsb(uint8_t socket)
-{
-    return (uint8_t)(W5500_BSB_SOCKET_REG + (socket * 4));
+    NANOCLR_NOCLEANUP();
 }
 
-static inline uint8_t socket_tx_bsb(uint8_t socket)
+HRESULT Library_cubley_interop_W5500Socket_NativeConnect___STATIC__I4__I4__STRING__I4__I4(CLR_RT_StackFrame& stack)
 {
-    return (uint8_t)(W5500_BSB_SOCKET_TX + (socket * 4));
-}
+    NANOCLR_HEADER();
 
-static inline uint8_t socket_rx_bsb(uint8_t socket)
-{
-    return (uint8_t)(W5500_BSB_SOCKET_RX + (socket * 4));
-}
+    set_w5500_bringup_status(4, 0, 0);
 
-// Hardware SPI transaction helpers.
-// The W5500 frame format is: [ADDR_HI][ADDR_LO][BSB|RW] followed by data bytes.
-// Use ChibiOS select/unselect so CS handling follows SPIConfig behavior.
-static uint8_t w5500_read8(uint16_t address, uint8_t bsb)
-{
-    g_w5500_spi_tx4[0] = (uint8_t)(address >> 8);
-    g_w5500_spi_tx4[1] = (uint8_t)(address & 0xFF);
-    g_w5500_spi_tx4[2] = (uint8_t)((bsb << 3) | 0x00);
-    g_w5500_spi_tx4[3] = 0x00;
-
-    g_w5500_spi_rx4[0] = 0;
-    g_w5500_spi_rx4[1] = 0;
-    g_w5500_spi_rx4[2] = 0;
-    g_w5500_spi_rx4[3] = 0;
-
-    uint8_t csBits = 0;
-    if (palReadLine(W5500_CS_LINE) != 0)
-    {
-        csBits |= 0x08;
-    }
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    CLR_RT_HeapBlock* hostArg = &(stack.Arg1());
+    int32_t port = stack.Arg2().NumericByRef().s4;
+    int32_t timeoutMs = stack.Arg3().NumericByRef().s4;
+    CLR_RT_HeapBlock_String* host = NULL;
+    uint8_t remoteIp[4] = {0};
+    uint8_t socket = 0;
+    w5500_socket_status_t connectStatus = W5500_SOCKET_IO_ERROR;
 
-    w5500_spi_select();
-    if (palReadLine(W5500_CS_LINE) != 0)
+    host = hostArg->DereferenceString();
+    FAULT_ON_NULL(host);
+
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !w5500_is_initialized())
     {
-        csBits |= 0x04;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(4, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    spiExchange(&SPID2, 4U, g_w5500_spi_tx4, g_w5500_spi_rx4);
-
-    if (palReadLine(W5500_CS_LINE) != 0)
+    if (port < 1 || port > 65535 || timeoutMs < 0)
     {
-        csBits |= 0x02;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(4, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    w5500_spi_unselect();
-    if (palReadLine(W5500_CS_LINE) != 0)
+    if (!w5500_parse_ipv4(host->StringText(), remoteIp))
     {
-        csBits |= 0x01;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_SUPPORTED);
+        set_w5500_bringup_status(4, 14, (uint8_t)W5500_SOCKET_NOT_SUPPORTED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    // Keep latest raw response bytes for SWD diagnostics.
-    g_w5500_last_spi_rx0 = g_w5500_spi_rx4[0];
-    g_w5500_last_spi_rx1 = g_w5500_spi_rx4[1];
-    g_w5500_last_spi_ctrl = g_w5500_spi_rx4[2];
-    g_w5500_last_spi_data = g_w5500_spi_rx4[3];
-    g_w5500_last_cs_bits = csBits;
+    // Connecting reopens the socket in TCP mode.
+    g_socketUdp[socket] = false;
+    connectStatus = w5500_connect(socket, remoteIp, (uint16_t)port, timeoutMs);
+    g_socketConnected[socket] = (connectStatus == W5500_SOCKET_OK);
+    stack.SetResult_I4((int32_t)connectStatus);
+    set_w5500_bringup_status(4, connectStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)connectStatus);
 
-    return g_w5500_spi_rx4[3];
+    NANOCLR_NOCLEANUP();
 }
 
-static void w5500_write8(uint16_t address, uint8_t bsb, uint8_t value)
+HRESULT Library_cubley_interop_W5500Socket_NativeSend___STATIC__I4__I4__SZARRAY_U1__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack)
 {
-    g_w5500_spi_tx4[0] = (uint8_t)(address >> 8);
-    g_w5500_spi_tx4[1] = (uint8_t)(address & 0xFF);
-    g_w5500_spi_tx4[2] = (uint8_t)((bsb << 3) | 0x04);
-    g_w5500_spi_tx4[3] = value;
-
-    w5500_spi_select();
-    spiSend(&SPID2, 4U, g_w5500_spi_tx4);
-    w5500_spi_unselect();
-}
+    NANOCLR_HEADER();
 
-static void w5500_read_buf(uint16_t address, uint8_t bsb, uint8_t* out, uint16_t length)
-{
-    g_w5500_spi_hdr3[0] = (uint8_t)(address >> 8);
-    g_w5500_spi_hdr3[1] = (uint8_t)(address & 0xFF);
-    g_w5500_spi_hdr3[2] = (uint8_t)((bsb << 3) | 0x00);
-
-    w5500_spi_select();
-    spiSend(&SPID2, 3U, g_w5500_spi_hdr3);
-    spiReceive(&SPID2, (size_t)length, out);
-    w5500_spi_unselect();
-}
+    set_w5500_bringup_status(6, 0, 0);
 
-static void w5500_write_buf(uint16_t address, uint8_t bsb, const uint8_t* data, uint16_t length)
-{
-    g_w5500_spi_hdr3[0] = (uint8_t)(address >> 8);
-    g_w5500_spi_hdr3[1] = (uint8_t)(address & 0xFF);
-    g_w5500_spi_hdr3[2] = (uint8_t)((bsb << 3) | 0x04);
-
-    w5500_spi_select();
-    spiSend(&SPID2, 3U, g_w5500_spi_hdr3);
-    spiSend(&SPID2, (size_t)length, data);
-    w5500_spi_unselect();
-}
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    CLR_RT_HeapBlock_Array* dataArray = stack.Arg1().DereferenceArray();
+    int32_t offset = stack.Arg2().NumericByRef().s4;
+    int32_t count = stack.Arg3().NumericByRef().s4;
+    uint8_t* payload = NULL;
+    uint8_t socket = 0;
+    w5500_socket_status_t sendStatus = W5500_SOCKET_IO_ERROR;
 
-static uint16_t w5500_read16(uint16_t address, uint8_t bsb)
-{
-    w5500_read_buf(address, bsb, g_w5500_spi_word2, 2);
-    return (uint16_t)((g_w5500_spi_word2[0] << 8) | g_w5500_spi_word2[1]);
-}
+    FAULT_ON_NULL(dataArray);
 
-static void w5500_write16(uint16_t address, uint8_t bsb, uint16_t value)
-{
-    g_w5500_spi_word2[0] = (uint8_t)(value >> 8);
-    g_w5500_spi_word2[1] = (uint8_t)(value & 0xFF);
-    w5500_write_buf(address, bsb, g_w5500_spi_word2, 2);
-}
+    stack.Arg4().NumericByRef().s4 = 0;
 
-static bool w5500_wait_command_done(uint8_t socket, int32_t timeoutMs)
-{
-    int32_t elapsed = 0;
-    while (w5500_read8(Sn_CR, socket_reg_bsb(socket)) != 0)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketConnected[socket] || !w5500_is_initialized())
     {
-        if (elapsed >= timeoutMs)
-        {
-            return false;
-        }
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(6, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
+    }
 
-        chThdSleepMilliseconds(1);
-        elapsed++;
+    if (offset < 0 || count < 0 || (uint32_t)(offset + count) > dataArray->m_numOfElements)
+    {
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(6, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    return true;
-}
+    payload = (uint8_t*)dataArray->GetFirstElement();
+    sendStatus = w5500_send(socket, payload + offset, (uint16_t)count);
+    if (sendStatus == W5500_SOCKET_OK)
+    {
+        stack.Arg4().NumericByRef().s4 = count;
+    }
 
-static bool w5500_issue_socket_command(uint8_t socket, uint8_t command, int32_t timeoutMs)
-{
-    w5500_write8(Sn_CR, socket_reg_bsb(socket), command);
-    return w5500_wait_command_done(socket, timeoutMs);
-}
+    stack.SetResult_I4((int32_t)sendStatus);
+    set_w5500_bringup_status(6, sendStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)sendStatus);
 
-static void w5500_socket_close(uint8_t socket)
-{
-    w5500_issue_socket_command(socket, W5500_CMD_CLOSE, 50);
-    w5500_write8(Sn_IR, socket_reg_bsb(socket), 0xFF);
+    NANOCLR_NOCLEANUP();
 }
 
-static bool parse_ipv4(const char* text, uint8_t out[4])
+HRESULT Library_cubley_interop_W5500Socket_NativeReceive___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack)
 {
-    if (text == NULL)
-    {
-        return false;
-    }
-
-    int idx = 0;
-    int value = 0;
-    bool hasDigit = false;
-
-    for (const char* p = text; ; ++p)
-    {
-        char c = *p;
+    NANOCLR_HEADER();
 
-        if (c >= '0' && c <= '9')
-        {
-            value = (value * 10) + (c - '0');
-            if (value > 255)
-            {
-                return false;
-            }
-            hasDigit = true;
-            continue;
-        }
+    set_w5500_bringup_status(7, 0, 0);
 
-        if (c == '.' || c == '\0')
-        {
-            if (!hasDigit || idx > 3)
-            {
-                return false;
-            }
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    CLR_RT_HeapBlock_Array* bufferArray = stack.Arg1().DereferenceArray();
+    int32_t offset = stack.Arg2().NumericByRef().s4;
+    int32_t count = stack.Arg3().NumericByRef().s4;
+    int32_t timeoutMs = stack.Arg4().NumericByRef().s4;
+    uint8_t* rx = NULL;
+    uint16_t received = 0;
+    uint8_t socket = 0;
+    w5500_socket_status_t rxStatus = W5500_SOCKET_IO_ERROR;
 
-            out[idx++] = (uint8_t)value;
-            value = 0;
-            hasDigit = false;
+    FAULT_ON_NULL(bufferArray);
 
-            if (c == '\0')
-            {
-                break;
-            }
+    stack.Arg5().NumericByRef().s4 = 0;
 
-            continue;
-        }
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketConnected[socket] || !w5500_is_initialized())
+    {
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(7, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
+    }
 
-        return false;
+    if (offset < 0 || count < 0 || timeoutMs < 0 || (uint32_t)(offset + count) > bufferArray->m_numOfElements)
+    {
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(7, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    return idx == 4;
-}
+    rx = (uint8_t*)bufferArray->GetFirstElement();
+    rxStatus = w5500_receive(socket, rx + offset, (uint16_t)count, timeoutMs, &received);
+    stack.Arg5().NumericByRef().s4 = received;
 
-static int hex_nibble(char c)
-{
-    if (c >= '0' && c <= '9')
+    if (rxStatus == W5500_SOCKET_NOT_INITIALIZED)
     {
-        return c - '0';
+        g_socketConnected[socket] = false;
     }
 
-    if (c >= 'A' && c <= 'F')
+    stack.SetResult_I4((int32_t)rxStatus);
+    if (rxStatus == W5500_SOCKET_TIMEOUT)
     {
-        return 10 + (c - 'A');
+        set_w5500_bringup_status(7, 2, (uint8_t)rxStatus);
     }
-
-    if (c >= 'a' && c <= 'f')
+    else
     {
-        return 10 + (c - 'a');
+        set_w5500_bringup_status(7, rxStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)rxStatus);
     }
 
-    return -1;
+    NANOCLR_NOCLEANUP();
 }
 
-static bool parse_mac(const char* text, uint8_t out[6])
+HRESULT Library_cubley_interop_W5500Socket_NativeClose___STATIC__I4__I4(CLR_RT_StackFrame& stack)
 {
-    if (text == NULL)
-    {
-        return false;
-    }
-
-    for (int i = 0; i < 6; i++)
-    {
-        int hi = hex_nibble(*text++);
-        int lo = hex_nibble(*text++);
+    NANOCLR_HEADER();
 
-        if (hi < 0 || lo < 0)
-        {
-            return false;
-        }
+    set_w5500_bringup_status(8, 0, 0);
 
-        out[i] = (uint8_t)((hi << 4) | lo);
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    uint8_t socket = 0;
 
-        if (i < 5)
-        {
-            if (*text++ != ':')
-            {
-                return false;
-            }
-        }
+    if (!w5500_handle_to_socket(socketHandle, &socket))
+    {
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(8, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    return *text == '\0';
-}
+    // Disconnects the socket when the chip is up and returns it to the pool.
+    w5500_socket_release(socket);
 
-static void w5500_apply_network_settings()
-{
-    w5500_write_buf(W5500_GAR, W5500_BSB_COMMON, g_networkGateway, 4);
-    w5500_write_buf(W5500_SUBR, W5500_BSB_COMMON, g_networkSubnet, 4);
-    w5500_write_buf(W5500_SHAR, W5500_BSB_COMMON, g_networkMac, 6);
-    w5500_write_buf(W5500_SIPR, W5500_BSB_COMMON, g_networkIp, 4);
+    g_socketConnected[socket] = false;
+    g_socketUdp[socket] = false;
+    stack.SetResult_I4((int32_t)W5500_SOCKET_OK);
+    set_w5500_bringup_status(8, 1, 0);
+
+    NANOCLR_NOCLEANUP();
 }
 
-static uint8_t w5500_probe_version_minimal(uint8_t *outPhyCfgr)
+HRESULT Library_cubley_interop_W5500Socket_NativeIsConnected___STATIC__BOOLEAN__I4(CLR_RT_StackFrame& stack)
 {
-    // Presence-only probe: configure pins/SPI, read VERSIONR and PHYCFGR, and
-    // avoid socket allocation and full hardware init side effects.
-    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_ALTERNATE(5));
-    palSetLineMode(PAL_LINE(GPIOB, 14U), PAL_MODE_ALTERNATE(5));
-    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_ALTERNATE(5));
-    palSetLineMode(W5500_CS_LINE, PAL_MODE_OUTPUT_PUSHPULL);
-    w5500_cs_gpio_release();
-    palSetLineMode(W5500_RESET_LINE, PAL_MODE_OUTPUT_PUSHPULL);
-    palSetLine(W5500_RESET_LINE);
-    palSetLineMode(W5500_INT_LINE, PAL_MODE_INPUT_PULLUP);
-
-    w5500_spi_start();
-    w5500_spi_set_cr1((uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0));
+    NANOCLR_HEADER();
 
-    uint8_t version = 0;
-    for (int i = 0; i < 3; i++)
-    {
-        version = w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
-        if (version == 0x04)
-        {
-            break;
-        }
-        chThdSleepMilliseconds(1);
-    }
+    set_w5500_bringup_status(5, 0, 0);
 
-    const uint8_t phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-    w5500_spi_set_cr1(SPI_CR1_BR_1);
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    uint8_t socket = 0;
+    bool connected = false;
 
-    if (outPhyCfgr != NULL)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !w5500_is_initialized())
     {
-        *outPhyCfgr = phycfgr;
+        stack.SetResult_Boolean(false);
+        set_w5500_bringup_status(5, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    set_w5500_last_native_error(0x56, version, phycfgr);
-    return version;
+    connected = w5500_socket_is_connected(socket);
+    g_socketConnected[socket] = connected;
+    stack.SetResult_Boolean(connected);
+    set_w5500_bringup_status(5, connected ? 1 : 14, connected ? 0 : 1);
+
+    NANOCLR_NOCLEANUP();
 }
 
-static w5500_socket_status_t w5500_hw_init()
+HRESULT Library_cubley_interop_W5500Socket_NativeGetPhyStatus___STATIC__U4(CLR_RT_StackFrame& stack)
 {
-    set_w5500_last_native_error(0x40, 0x00, 0x00);
-
-    // Configure W5500 control pins.
-    // SPI2 pins (PB12-PB15) are already AF5 via board_cubley.h; no palSetLineMode needed.
-    // But explicitly enforce AF5 at runtime to catch any mux config issues.
-    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_ALTERNATE(5));  // SCK
-    palSetLineMode(PAL_LINE(GPIOB, 14U), PAL_MODE_ALTERNATE(5));  // MISO
-    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_ALTERNATE(5));  // MOSI
-    palSetLineMode(W5500_CS_LINE, PAL_MODE_OUTPUT_PUSHPULL);
-    w5500_cs_gpio_release();
-    palSetLineMode(W5500_RESET_LINE, PAL_MODE_OUTPUT_PUSHPULL);
-    palSetLineMode(W5500_INT_LINE, PAL_MODE_INPUT_PULLUP);
-
-    // Scope-assist: Drive PB13 and PB15 as slow GPIO pulses for 500 ms so single-channel scope can catch them.
-    // This proves the physical probe paths and GPIO control work before enabling SPI peripheral.
-    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_OUTPUT_PUSHPULL);
-    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_OUTPUT_PUSHPULL);
-    for (int pulse = 0; pulse < 20; pulse++)
-    {
-        palSetLine(PAL_LINE(GPIOB, 13U));
-        palSetLine(PAL_LINE(GPIOB, 15U));
-        chThdSleepMilliseconds(12);
-        palClearLine(PAL_LINE(GPIOB, 13U));
-        palClearLine(PAL_LINE(GPIOB, 15U));
-        chThdSleepMilliseconds(12);
-    }
-    // Now switch back to AF5 for real SPI use.
-    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_ALTERNATE(5));  // SCK
-    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_ALTERNATE(5));  // MOSI
-
-    // op 0x49: PB12 software-drive sanity check (high->low->high).
-    // code bits: b2=readback after first high, b1=after low, b0=after final high.
-    // detail bits: high nibble=ODR snapshots (same phase order), low nibble=IDR snapshots.
-    uint8_t cs_hi1 = (palReadLine(W5500_CS_LINE) != 0) ? 1U : 0U;
-    w5500_cs_gpio_assert();
-    uint8_t cs_lo = (palReadLine(W5500_CS_LINE) != 0) ? 1U : 0U;
-    w5500_cs_gpio_release();
-    uint8_t cs_hi2 = (palReadLine(W5500_CS_LINE) != 0) ? 1U : 0U;
-    uint8_t odr_hi1 = (uint8_t)((GPIOB->ODR & (1U << 12U)) ? 1U : 0U);
-    w5500_cs_gpio_assert();
-    uint8_t odr_lo = (uint8_t)((GPIOB->ODR & (1U << 12U)) ? 1U : 0U);
-    w5500_cs_gpio_release();
-    uint8_t odr_hi2 = (uint8_t)((GPIOB->ODR & (1U << 12U)) ? 1U : 0U);
-    g_w5500_cs_gpio_code = (uint8_t)((cs_hi1 << 2) | (cs_lo << 1) | cs_hi2);
-    set_w5500_last_native_error(
-        0x49,
-        g_w5500_cs_gpio_code,
-        (uint8_t)(((odr_hi1 << 6) | (odr_lo << 5) | (odr_hi2 << 4)) | g_w5500_cs_gpio_code));
-
-    // Start hardware SPI2 driver (acquires bus, applies g_spi2cfg).
-    w5500_spi_start();
-
-    // op 0x4B: SPI2 register state after start (CR1 high nibble, SR low nibble).
-    // If CR1 is 0, SPI2 likely never started.  SR bit 1 (TXE)=1 means TX buffer empty.
-    uint8_t cr1_bits = (uint8_t)((SPID2.config->cr1 & 0xF0) >> 4);
-    uint8_t sr_bits = (uint8_t)(SPI2->SR & 0x0F);
-    set_w5500_last_native_error(0x4B, cr1_bits, sr_bits);
-
-    // op 0x4C: run a long, slow SPI burst to make SCK/MOSI/CS visible on low-cost scopes.
-    set_w5500_last_native_error(0x4C, 0x01, 0x00);
-    w5500_scope_spi_clock_burst();
-    set_w5500_last_native_error(0x4C, 0x02, 0x00);
-
-    // Hardware reset: assert for 20 ms, then release and wait 50 ms for W5500 POR.
-    palClearLine(W5500_RESET_LINE);
-    chThdSleepMilliseconds(20);
-    palSetLine(W5500_RESET_LINE);
-    chThdSleepMilliseconds(50);
-
-    // op 0x4D: slow repeated VERSIONR stream summary for scope-limited MISO diagnosis.
-    // code=last VERSIONR byte seen, detail=count of non-zero VERSIONR samples across stream.
-    uint8_t streamLastVersion = 0;
-    uint8_t streamNonZeroCount = 0;
-    w5500_scope_versionr_stream(&streamLastVersion, &streamNonZeroCount);
-    set_w5500_last_native_error(0x4D, streamLastVersion, streamNonZeroCount);
-
-    // Probe SPI mode/speed combinations to isolate board-level timing/phase issues.
-    // code 0x00: mode0 fast  (~5.25 MHz)
-    // code 0x01: mode0 slow  (~164 kHz)
-    // code 0x02: mode3 slow  (~164 kHz)
-    // code 0x03: mode3 fast  (~5.25 MHz)
-    static const uint16_t kProbeCr1[] = {
-        SPI_CR1_BR_1,
-        (uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0),
-        (uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0 | SPI_CR1_CPOL | SPI_CR1_CPHA),
-        (uint16_t)(SPI_CR1_BR_1 | SPI_CR1_CPOL | SPI_CR1_CPHA)
-    };
-
-    static const uint8_t kProbeCode[] = {0x00, 0x01, 0x02, 0x03};
+    NANOCLR_HEADER();
 
-    uint8_t version = 0;
-    uint8_t selectedProbeCode = 0xFF;
+    uint8_t phycfgr = 0;
 
-    for (size_t p = 0; p < (sizeof(kProbeCr1) / sizeof(kProbeCr1[0])); p++)
+    if (!w5500_is_initialized())
     {
-        w5500_spi_set_cr1(kProbeCr1[p]);
-        chThdSleepMilliseconds(2);
-
-        for (int i = 0; i < 3; i++)
-        {
-            version = w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
-            if (version == 0x04)
-            {
-                selectedProbeCode = kProbeCode[p];
-                break;
-            }
-            chThdSleepMilliseconds(2);
-        }
+        stack.SetResult_U4(0);
+        set_w5500_last_native_error(0x50, (uint8_t)W5500_SOCKET_NOT_INITIALIZED, 0x00);
+        NANOCLR_SET_AND_LEAVE(S_OK);
+    }
 
-        // op 0x47: per-probe VERSIONR sample.
-        // detail high nibble=CS transition bits, low nibble=raw SPI control echo low nibble.
-        set_w5500_last_native_error(
-            0x47,
-            (uint8_t)((kProbeCode[p] << 4) | (version & 0x0F)),
-            (uint8_t)((g_w5500_last_cs_bits << 4) | (g_w5500_cs_gpio_code & 0x0F)));
+    phycfgr = w5500_read_phycfgr();
+    stack.SetResult_U4((uint32_t)phycfgr);
 
-        if (version == 0x04)
-        {
-            break;
-        }
-    }
+    // Surface link state snapshots through bringup status for SWD mailbox visibility.
+    set_w5500_bringup_status(5, (phycfgr & 0x01) != 0 ? 1 : 14, phycfgr);
+    set_w5500_last_native_error(0x51, (phycfgr & 0x01) != 0 ? 0x00 : 0x01, phycfgr);
 
-    if (selectedProbeCode != 0xFF)
-    {
-        // op 0x48: selected working probe code in detail.
-        set_w5500_last_native_error(0x48, 0x04, selectedProbeCode);
-    }
+    NANOCLR_NOCLEANUP();
+}
 
-    // Always capture PHY config register for diagnostic mailbox.
-    uint8_t phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+HRESULT Library_cubley_interop_W5500Socket_NativeGetVersion___STATIC__U4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
 
-    if (version != 0x04)
-    {
-        // Report raw VERSIONR and PHYCFGR for board-level diagnostics.
-        set_w5500_bringup_status(0xA0, version, phycfgr);
-        // op 0x41: code=VERSIONR read.
-        // detail high nibble=CS transition bits, low nibble=raw SPI control echo low nibble.
-        set_w5500_last_native_error(
-            0x41,
-            version,
-            (uint8_t)((g_w5500_last_cs_bits << 4) | (g_w5500_cs_gpio_code & 0x0F)));
-        // op 0x4A: raw RX bytes from last VERSIONR 4-byte frame.
-        // code=rx0, detail=rx1 (rx2/rx3 remain available via existing globals and op 0x41 context).
-        set_w5500_last_native_error(0x4A, g_w5500_last_spi_rx0, g_w5500_last_spi_rx1);
-        return (w5500_socket_status_t)(0x20 | (version & 0x0F));
-    }
+    uint8_t version = 0;
+    uint8_t phycfgr = 0;
 
-    // Capture PHY mode immediately after hardware reset/probe, before MR software reset.
-    // Note: when OPMD=0 (HW mode), OPMDC field interpretation is limited; do not infer exact
-    // PMODE pin levels from OPMDC alone without physical measurement.
-    set_w5500_last_native_error(
-        0x44,
-        (uint8_t)((phycfgr & W5500_PHYCFGR_OPMDC_MASK) >> 3),
-        phycfgr);
-
-    w5500_write8(W5500_MR, W5500_BSB_COMMON, 0x80);
-    // Allow enough time for MR software reset to complete before touching PHYCFGR.
-    chThdSleepMilliseconds(50);
-
-    // Step 1: Write desired SW configuration with RST deasserted (bit7=1, active-low reset).
-    // Keep PHY out of reset while establishing OPMD/OPMDC.
-    w5500_write8(
-        W5500_PHYCFGR,
-        W5500_BSB_COMMON,
-        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | W5500_PHYCFGR_OPMDC_ALL_AUTO));
-    chThdSleepMilliseconds(10);
-
-    // op 0x46: readback after step-1 write. If OPMD=0 here, SW-mode write did not stick.
-    // Expected high bits: PHYCFGR[7:3]=11110b (RST=1, OPMD=1, OPMDC=6 = all-capable AN).
-    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-    set_w5500_last_native_error(0x46, (uint8_t)((phycfgr & W5500_PHYCFGR_OPMD) != 0 ? 0xA1 : 0xA0), phycfgr);
-
-    // Step 2: Trigger PHY reset (active-low): drive RST bit low while preserving SW mode bits.
-    w5500_write8(
-        W5500_PHYCFGR,
-        W5500_BSB_COMMON,
-        (uint8_t)(W5500_PHYCFGR_OPMD | W5500_PHYCFGR_OPMDC_ALL_AUTO));
-    chThdSleepMilliseconds(50);
-
-    // Intermediate readback (op 0x43): may still show RST=0 while reset is in progress.
-    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-    set_w5500_last_native_error(0x43, (uint8_t)((phycfgr & W5500_PHYCFGR_OPMD) != 0 ? 0xA1 : 0xA0), phycfgr);
-
-    // Poll until RST bit self-clears back to 1 (datasheet: ~3ms; observed to take longer in some runs).
-    // Timeout after 3 seconds, then continue. We always re-assert SW mode afterward.
-    for (int rst_poll = 0; rst_poll < 300; rst_poll++)
+    if (!w5500_is_initialized())
     {
-        chThdSleepMilliseconds(10);
-        phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-        if ((phycfgr & W5500_PHYCFGR_RST) != 0)
-        {
-            break;
-        }
+        version = w5500_probe_version_minimal(&phycfgr);
+        stack.SetResult_U4((uint32_t)version);
+        set_w5500_bringup_status(5, version == 0x04 ? 1 : 14, version);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    // Re-assert SW all-auto mode regardless of poll outcome to avoid depending on previous
-    // reset timing behavior.
-    w5500_write8(
-        W5500_PHYCFGR,
-        W5500_BSB_COMMON,
-        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | W5500_PHYCFGR_OPMDC_ALL_AUTO));
-    chThdSleepMilliseconds(5);
-    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-
-    // op 0x45: post-reset settled state after explicit SW-mode re-assert.
-    set_w5500_last_native_error(0x45, (uint8_t)((phycfgr & W5500_PHYCFGR_OPMD) != 0 ? 0xA1 : 0xA0), phycfgr);
-
-    w5500_apply_network_settings();
-    w5500_write16(W5500_RTR, W5500_BSB_COMMON, kDefaultRetryTime);
-    w5500_write8(W5500_RCR, W5500_BSB_COMMON, kDefaultRetryCount);
+    version = w5500_read_version();
+    phycfgr = w5500_read_phycfgr();
+    stack.SetResult_U4((uint32_t)version);
 
-    w5500_socket_close(kSocketIndex);
-    w5500_write8(Sn_RXBUF_SIZE, socket_reg_bsb(kSocketIndex), 2);
-    w5500_write8(Sn_TXBUF_SIZE, socket_reg_bsb(kSocketIndex), 2);
+    // Surface VERSIONR and PHYCFGR together for SWD-only diagnostics.
+    set_w5500_bringup_status(5, version == 0x04 ? 1 : 14, version);
+    set_w5500_last_native_error(0x53, version, phycfgr);
 
-    return W5500_SOCKET_OK;
+    NANOCLR_NOCLEANUP();
 }
 
-extern "C" int cubley_w5500_early_init(void)
+HRESULT Library_cubley_interop_W5500Socket_NativeGetVersionPhyStatus___STATIC__U4(CLR_RT_StackFrame& stack)
 {
-    if (g_initialized)
-    {
-        return (int)W5500_SOCKET_OK;
-    }
+    NANOCLR_HEADER();
 
-    w5500_socket_status_t initStatus = w5500_hw_init();
-    if (initStatus == W5500_SOCKET_OK)
+    uint8_t version = 0;
+    uint8_t phycfgr = 0;
+    uint32_t packed = 0;
+
+    if (!w5500_is_initialized())
     {
-        g_initialized = true;
+        stack.SetResult_U4(0);
+        set_w5500_last_native_error(0x54, (uint8_t)W5500_SOCKET_NOT_INITIALIZED, 0x00);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    return (int)initStatus;
+    version = w5500_read_version();
+    phycfgr = w5500_read_phycfgr();
+    packed = (((uint32_t)version) << 8) | (uint32_t)phycfgr;
+    stack.SetResult_U4(packed);
+
+    set_w5500_bringup_status(5, (phycfgr & 0x01) != 0 ? 1 : 14, phycfgr);
+    set_w5500_last_native_error(0x54, version, phycfgr);
+
+    NANOCLR_NOCLEANUP();
 }
 
-static w5500_socket_status_t w5500_connect(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort, int32_t timeoutMs)
+HRESULT Library_cubley_interop_W5500Socket_NativeSetPhyMode___STATIC__U4__I4(CLR_RT_StackFrame& stack)
 {
-    if (!w5500_issue_socket_command(socket, W5500_CMD_CLOSE, 100))
-    {
-        return W5500_SOCKET_TIMEOUT;
-    }
+    NANOCLR_HEADER();
 
-    w5500_write8(Sn_MR, socket_reg_bsb(socket), W5500_SOCK_MODE_TCP);
-    w5500_write16(Sn_PORT, socket_reg_bsb(socket), g_nextSourcePort++);
+    int32_t modeCode = stack.Arg0().NumericByRef().s4;
+    uint8_t opmdc = 0;
+    uint8_t phycfgr = 0;
 
-    if (!w5500_issue_socket_command(socket, W5500_CMD_OPEN, 200))
+    if (!w5500_is_initialized())
     {
-        return W5500_SOCKET_TIMEOUT;
+        stack.SetResult_U4(0);
+        set_w5500_last_native_error(0x55, (uint8_t)W5500_SOCKET_NOT_INITIALIZED, 0x00);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    if (w5500_read8(Sn_SR, socket_reg_bsb(socket)) != W5500_SOCK_INIT)
+    if (modeCode < 0 || modeCode > 7)
     {
-        return W5500_SOCKET_IO_ERROR;
+        stack.SetResult_U4(0);
+        set_w5500_last_native_error(0x55, (uint8_t)W5500_SOCKET_INVALID_PARAM, 0xFF);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    w5500_write_buf(Sn_DIPR, socket_reg_bsb(socket), remoteIp, 4);
-    w5500_write16(Sn_DPORT, socket_reg_bsb(socket), remotePort);
-    w5500_write8(Sn_IR, socket_reg_bsb(socket), 0xFF);
+    opmdc = (uint8_t)(modeCode & 0x07);
+    phycfgr = w5500_set_phy_mode(opmdc);
 
-    if (!w5500_issue_socket_command(socket, W5500_CMD_CONNECT, 200))
-    {
-        return W5500_SOCKET_TIMEOUT;
-    }
+    stack.SetResult_U4((uint32_t)phycfgr);
+    set_w5500_last_native_error(0x55, opmdc, phycfgr);
 
-    int32_t elapsed = 0;
-    while (elapsed < timeoutMs)
-    {
-        uint8_t status = w5500_read8(Sn_SR, socket_reg_bsb(socket));
-        uint8_t ir = w5500_read8(Sn_IR, socket_reg_bsb(socket));
+    NANOCLR_NOCLEANUP();
+}
 
-        if (status == W5500_SOCK_ESTABLISHED)
-        {
-            w5500_write8(Sn_IR, socket_reg_bsb(socket), W5500_IR_CON);
-            return W5500_SOCKET_OK;
-        }
+HRESULT Library_cubley_interop_W5500SocketRx_NativeReceiveExact___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
 
-        if ((ir & W5500_IR_TIMEOUT) != 0 || status == W5500_SOCK_CLOSED)
-        {
-            w5500_write8(Sn_IR, socket_reg_bsb(socket), W5500_IR_TIMEOUT);
-            return W5500_SOCKET_TIMEOUT;
-        }
+    set_w5500_bringup_status(7, 0, 0);
 
-        chThdSleepMilliseconds(1);
-        elapsed++;
-    }
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    CLR_RT_HeapBlock_Array* bufferArray = stack.Arg1().DereferenceArray();
+    int32_t offset = stack.Arg2().NumericByRef().s4;
+    int32_t count = stack.Arg3().NumericByRef().s4;
+    int32_t timeoutMs = stack.Arg4().NumericByRef().s4;
+    uint8_t* rx = NULL;
+    uint16_t received = 0;
+    uint8_t socket = 0;
+    w5500_socket_status_t rxStatus = W5500_SOCKET_IO_ERROR;
 
-    return W5500_SOCKET_TIMEOUT;
-}
+    FAULT_ON_NULL(bufferArray);
 
-static w5500_socket_status_t w5500_send(uint8_t socket, const uint8_t* data, uint16_t length)
-{
-    uint8_t status = w5500_read8(Sn_SR, socket_reg_bsb(socket));
-    if (status != W5500_SOCK_ESTABLISHED && status != W5500_SOCK_CLOSE_WAIT)
+    stack.Arg5().NumericByRef().s4 = 0;
+
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketConnected[socket] || !w5500_is_initialized())
     {
-        return W5500_SOCKET_NOT_INITIALIZED;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(7, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    int32_t elapsed = 0;
-    while (w5500_read16(Sn_TX_FSR, socket_reg_bsb(socket)) < length)
+    if (offset < 0 || count < 0 || count > 0xFFFF || timeoutMs < 0 || (uint32_t)(offset + count) > bufferArray->m_numOfElements)
     {
-        if (elapsed >= 2000)
-        {
-            return W5500_SOCKET_TIMEOUT;
-        }
-        chThdSleepMilliseconds(1);
-        elapsed++;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(7, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    uint16_t writePtr = w5500_read16(Sn_TX_WR, socket_reg_bsb(socket));
-    w5500_write_buf(writePtr, socket_tx_bsb(socket), data, length);
-    w5500_write16(Sn_TX_WR, socket_reg_bsb(socket), (uint16_t)(writePtr + length));
+    // Straight into the managed array: no intermediate buffer on either side.
+    rx = (uint8_t*)bufferArray->GetFirstElement();
+    rxStatus = w5500_receive_exact(socket, rx + offset, (uint16_t)count, timeoutMs, &received);
+    stack.Arg5().NumericByRef().s4 = received;
 
-    if (!w5500_issue_socket_command(socket, W5500_CMD_SEND, 200))
+    if (rxStatus == W5500_SOCKET_NOT_INITIALIZED)
     {
-        return W5500_SOCKET_TIMEOUT;
+        g_socketConnected[socket] = false;
     }
 
-    elapsed = 0;
-    while (elapsed < 2000)
+    stack.SetResult_I4((int32_t)rxStatus);
+    if (rxStatus == W5500_SOCKET_TIMEOUT)
     {
-        uint8_t ir = w5500_read8(Sn_IR, socket_reg_bsb(socket));
-        if ((ir & W5500_IR_SENDOK) != 0)
-        {
-            w5500_write8(Sn_IR, socket_reg_bsb(socket), W5500_IR_SENDOK);
-            return W5500_SOCKET_OK;
-        }
-
-        if ((ir & W5500_IR_TIMEOUT) != 0)
-        {
-            w5500_write8(Sn_IR, socket_reg_bsb(socket), W5500_IR_TIMEOUT);
-            return W5500_SOCKET_TIMEOUT;
-        }
-
-        chThdSleepMilliseconds(1);
-        elapsed++;
+        set_w5500_bringup_status(7, 2, (uint8_t)rxStatus);
     }
-
-    return W5500_SOCKET_TIMEOUT;
-}
-
-static w5500_socket_status_t w5500_receive(uint8_t socket, uint8_t* buffer, uint16_t maxLength, int32_t timeoutMs, uint16_t* outReceived)
-{
-    *outReceived = 0;
-
-    int32_t elapsed = 0;
-    while (elapsed < timeoutMs)
+    else
     {
-        uint16_t available = w5500_read16(Sn_RX_RSR, socket_reg_bsb(socket));
-        if (available > 0)
-        {
-            uint16_t toRead = available;
-            if (toRead > maxLength)
-            {
-                toRead = maxLength;
-            }
-
-            uint16_t readPtr = w5500_read16(Sn_RX_RD, socket_reg_bsb(socket));
-            w5500_read_buf(readPtr, socket_rx_bsb(socket), buffer, toRead);
-            w5500_write16(Sn_RX_RD, socket_reg_bsb(socket), (uint16_t)(readPtr + toRead));
-
-            if (!w5500_issue_socket_command(socket, W5500_CMD_RECV, 100))
-            {
-                return W5500_SOCKET_TIMEOUT;
-            }
-
-            *outReceived = toRead;
-            return W5500_SOCKET_OK;
-        }
-
-        uint8_t status = w5500_read8(Sn_SR, socket_reg_bsb(socket));
-        if (status == W5500_SOCK_CLOSED)
-        {
-            return W5500_SOCKET_NOT_INITIALIZED;
-        }
-
-        uint8_t ir = w5500_read8(Sn_IR, socket_reg_bsb(socket));
-        if ((ir & W5500_IR_RECV) != 0)
-        {
-            w5500_write8(Sn_IR, socket_reg_bsb(socket), W5500_IR_RECV);
-        }
-
-        chThdSleepMilliseconds(1);
-        elapsed++;
+        set_w5500_bringup_status(7, rxStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)rxStatus);
     }
 
-    return W5500_SOCKET_TIMEOUT;
+    NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeOpen___STATIC__I4__BYREF_I4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketRx_NativePeekAvailable___STATIC__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    set_w5500_bringup_status(2, 0, 0);
-    set_w5500_last_native_error(0x10, 0x00, 0x00);
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    uint16_t available = 0;
+    uint8_t socket = 0;
+    w5500_socket_status_t peekStatus = W5500_SOCKET_IO_ERROR;
+
+    stack.Arg1().NumericByRef().s4 = 0;
 
-    if (!g_initialized)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketConnected[socket] || !w5500_is_initialized())
     {
-        w5500_socket_status_t initStatus = w5500_hw_init();
-        if (initStatus != W5500_SOCKET_OK)
-        {
-            stack.Arg0().NumericByRef().s4 = -1;
-            stack.SetResult_I4((int32_t)initStatus);
-            set_w5500_bringup_status(2, 14, (uint8_t)initStatus);
-            // Preserve low-byte context from the last native probe record so SWD
-            // diagnostics can still infer which init probe failed.
-            set_w5500_last_native_error(0x11, (uint8_t)initStatus, (uint8_t)(g_cubley_diag_last_error & 0xFFU));
-            NANOCLR_SET_AND_LEAVE(S_OK);
-        }
-
-        g_initialized = true;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(9, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    if (g_socketAllocated)
+    peekStatus = w5500_peek_available(socket, &available);
+    stack.Arg1().NumericByRef().s4 = available;
+
+    if (peekStatus == W5500_SOCKET_NOT_INITIALIZED)
     {
-        stack.Arg0().NumericByRef().s4 = -1;
-        stack.SetResult_I4((int32_t)W5500_SOCKET_BUSY);
-        set_w5500_bringup_status(2, 14, (uint8_t)W5500_SOCKET_BUSY);
-        set_w5500_last_native_error(0x12, (uint8_t)W5500_SOCKET_BUSY, 0x00);
-        NANOCLR_SET_AND_LEAVE(S_OK);
+        g_socketConnected[socket] = false;
     }
 
-    g_socketAllocated = true;
-    g_socketConnected = false;
-    stack.Arg0().NumericByRef().s4 = kSingleSocketHandle;
-    stack.SetResult_I4((int32_t)W5500_SOCKET_OK);
-    set_w5500_bringup_status(2, 1, 0);
-    set_w5500_last_native_error(0x13, (uint8_t)W5500_SOCKET_OK, 0x00);
+    stack.SetResult_I4((int32_t)peekStatus);
+    set_w5500_bringup_status(9, peekStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)peekStatus);
 
     NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeConfigureNetwork___STATIC__I4__STRING__STRING__STRING__STRING(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketRx_NativeReceiveMqttFrame___STATIC__I4__I4__SZARRAY_U1__I4__BYREF_I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    set_w5500_bringup_status(3, 0, 0);
-
-    CLR_RT_HeapBlock* ipArg = &(stack.Arg0());
-    CLR_RT_HeapBlock* subnetArg = &(stack.Arg1());
-    CLR_RT_HeapBlock* gatewayArg = &(stack.Arg2());
-    CLR_RT_HeapBlock* macArg = &(stack.Arg3());
+    set_w5500_bringup_status(10, 0, 0);
 
-    CLR_RT_HeapBlock_String* ip = NULL;
-    CLR_RT_HeapBlock_String* subnet = NULL;
-    CLR_RT_HeapBlock_String* gateway = NULL;
-    CLR_RT_HeapBlock_String* mac = NULL;
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    CLR_RT_HeapBlock_Array* bufferArray = stack.Arg1().DereferenceArray();
+    int32_t timeoutMs = stack.Arg2().NumericByRef().s4;
+    uint32_t capacity = 0;
+    uint16_t length = 0;
+    uint8_t socket = 0;
+    w5500_socket_status_t rxStatus = W5500_SOCKET_IO_ERROR;
 
-    uint8_t parsedIp[4] = {0};
-    uint8_t parsedSubnet[4] = {0};
-    uint8_t parsedGateway[4] = {0};
-    uint8_t parsedMac[6] = {0};
+    FAULT_ON_NULL(bufferArray);
 
-    ip = ipArg->DereferenceString();
-    subnet = subnetArg->DereferenceString();
-    gateway = gatewayArg->DereferenceString();
-    mac = macArg->DereferenceString();
+    stack.Arg3().NumericByRef().s4 = 0;
 
-    FAULT_ON_NULL(ip);
-    FAULT_ON_NULL(subnet);
-    FAULT_ON_NULL(gateway);
-    FAULT_ON_NULL(mac);
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketConnected[socket] || !w5500_is_initialized())
+    {
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(10, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
+    }
 
-    if (!parse_ipv4(ip->StringText(), parsedIp) ||
-        !parse_ipv4(subnet->StringText(), parsedSubnet) ||
-        !parse_ipv4(gateway->StringText(), parsedGateway) ||
-        !parse_mac(mac->StringText(), parsedMac))
+    capacity = bufferArray->m_numOfElements;
+    if (capacity == 0 || timeoutMs < 0)
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
-        set_w5500_bringup_status(3, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(10, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    memcpy(g_networkIp, parsedIp, sizeof(g_networkIp));
-    memcpy(g_networkSubnet, parsedSubnet, sizeof(g_networkSubnet));
-    memcpy(g_networkGateway, parsedGateway, sizeof(g_networkGateway));
-    memcpy(g_networkMac, parsedMac, sizeof(g_networkMac));
+    // Header parsed from the W5500 RX buffer, body read straight into the managed array.
+    rxStatus = w5500_receive_mqtt_frame(
+        socket,
+        (uint8_t*)bufferArray->GetFirstElement(),
+        (uint16_t)(capacity > 0xFFFF ? 0xFFFF : capacity),
+        timeoutMs,
+        &length);
+    stack.Arg3().NumericByRef().s4 = length;
 
-    if (g_initialized)
+    if (rxStatus == W5500_SOCKET_NOT_INITIALIZED)
     {
-        w5500_apply_network_settings();
+        g_socketConnected[socket] = false;
     }
 
-    stack.SetResult_I4((int32_t)W5500_SOCKET_OK);
-    set_w5500_bringup_status(3, 1, 0);
+    stack.SetResult_I4((int32_t)rxStatus);
+    if (rxStatus == W5500_SOCKET_TIMEOUT)
+    {
+        set_w5500_bringup_status(10, 2, (uint8_t)rxStatus);
+    }
+    else
+    {
+        set_w5500_bringup_status(10, rxStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)rxStatus);
+    }
 
     NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeConnect___STATIC__I4__I4__STRING__I4__I4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketUdp_NativeBind___STATIC__I4__I4__I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    set_w5500_bringup_status(4, 0, 0);
+    set_w5500_bringup_status(11, 0, 0);
 
     int32_t socketHandle = stack.Arg0().NumericByRef().s4;
-    CLR_RT_HeapBlock* hostArg = &(stack.Arg1());
-    int32_t port = stack.Arg2().NumericByRef().s4;
-    int32_t timeoutMs = stack.Arg3().NumericByRef().s4;
-    CLR_RT_HeapBlock_String* host = NULL;
-    uint8_t remoteIp[4] = {0};
-    w5500_socket_status_t connectStatus = W5500_SOCKET_IO_ERROR;
-
-    host = hostArg->DereferenceString();
-    FAULT_ON_NULL(host);
+    int32_t localPort = stack.Arg1().NumericByRef().s4;
+    uint8_t socket = 0;
+    w5500_socket_status_t bindStatus = W5500_SOCKET_IO_ERROR;
 
-    if (socketHandle != kSingleSocketHandle || !g_socketAllocated || !g_initialized)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !w5500_is_initialized())
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
-        set_w5500_bringup_status(4, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(11, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    if (port < 1 || port > 65535 || timeoutMs < 0)
+    if (localPort < 0 || localPort > 65535)
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
-        set_w5500_bringup_status(4, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
-        NANOCLR_SET_AND_LEAVE(S_OK);
-    }
-
-    if (!parse_ipv4(host->StringText(), remoteIp))
-    {
-        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_SUPPORTED);
-        set_w5500_bringup_status(4, 14, (uint8_t)W5500_SOCKET_NOT_SUPPORTED);
+        set_w5500_bringup_status(11, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    connectStatus = w5500_connect(kSocketIndex, remoteIp, (uint16_t)port, timeoutMs);
-    g_socketConnected = (connectStatus == W5500_SOCKET_OK);
-    stack.SetResult_I4((int32_t)connectStatus);
-    set_w5500_bringup_status(4, connectStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)connectStatus);
+    // Rebinding drops any TCP connection the handle had.
+    g_socketConnected[socket] = false;
+    bindStatus = w5500_udp_open(socket, (uint16_t)localPort);
+    g_socketUdp[socket] = (bindStatus == W5500_SOCKET_OK);
+    stack.SetResult_I4((int32_t)bindStatus);
+    set_w5500_bringup_status(11, bindStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)bindStatus);
 
     NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeSend___STATIC__I4__I4__SZARRAY_U1__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketUdp_NativeSendTo___STATIC__I4__I4__STRING__I4__SZARRAY_U1__I4__I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    set_w5500_bringup_status(6, 0, 0);
+    set_w5500_bringup_status(12, 0, 0);
 
     int32_t socketHandle = stack.Arg0().NumericByRef().s4;
-    CLR_RT_HeapBlock_Array* dataArray = stack.Arg1().DereferenceArray();
-    int32_t offset = stack.Arg2().NumericByRef().s4;
-    int32_t count = stack.Arg3().NumericByRef().s4;
-    uint8_t* payload = NULL;
+    CLR_RT_HeapBlock_String* host = stack.Arg1().DereferenceString();
+    int32_t port = stack.Arg2().NumericByRef().s4;
+    CLR_RT_HeapBlock_Array* dataArray = stack.Arg3().DereferenceArray();
+    int32_t offset = stack.Arg4().NumericByRef().s4;
+    int32_t count = stack.Arg5().NumericByRef().s4;
+    uint8_t remoteIp[4] = {0};
+    uint8_t socket = 0;
     w5500_socket_status_t sendStatus = W5500_SOCKET_IO_ERROR;
 
+    FAULT_ON_NULL(host);
     FAULT_ON_NULL(dataArray);
 
-    stack.Arg4().NumericByRef().s4 = 0;
-
-    if (socketHandle != kSingleSocketHandle || !g_socketAllocated || !g_socketConnected || !g_initialized)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketUdp[socket] || !w5500_is_initialized())
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
-        set_w5500_bringup_status(6, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(12, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    if (offset < 0 || count < 0 || (uint32_t)(offset + count) > dataArray->m_numOfElements)
+    if (port < 1 || port > 65535 || offset < 0 || count < 1 || count > W5500_UDP_MAX_PAYLOAD ||
+        (uint32_t)(offset + count) > dataArray->m_numOfElements)
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
-        set_w5500_bringup_status(6, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(12, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    payload = (uint8_t*)dataArray->GetFirstElement();
-    sendStatus = w5500_send(kSocketIndex, payload + offset, (uint16_t)count);
-    if (sendStatus == W5500_SOCKET_OK)
+    if (!w5500_parse_ipv4(host->StringText(), remoteIp))
     {
-        stack.Arg4().NumericByRef().s4 = count;
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_SUPPORTED);
+        set_w5500_bringup_status(12, 14, (uint8_t)W5500_SOCKET_NOT_SUPPORTED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
+    }
+
+    sendStatus = w5500_udp_send_to(
+        socket,
+        remoteIp,
+        (uint16_t)port,
+        (uint8_t*)dataArray->GetFirstElement() + offset,
+        (uint16_t)count);
+    if (sendStatus == W5500_SOCKET_NOT_INITIALIZED)
+    {
+        g_socketUdp[socket] = false;
     }
 
     stack.SetResult_I4((int32_t)sendStatus);
-    set_w5500_bringup_status(6, sendStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)sendStatus);
+    set_w5500_bringup_status(12, sendStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)sendStatus);
 
     NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeReceive___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketUdp_NativeReceiveFrom___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BYREF_I4__BYREF_U4__BYREF_I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    set_w5500_bringup_status(7, 0, 0);
+    set_w5500_bringup_status(13, 0, 0);
 
     int32_t socketHandle = stack.Arg0().NumericByRef().s4;
     CLR_RT_HeapBlock_Array* bufferArray = stack.Arg1().DereferenceArray();
     int32_t offset = stack.Arg2().NumericByRef().s4;
     int32_t count = stack.Arg3().NumericByRef().s4;
     int32_t timeoutMs = stack.Arg4().NumericByRef().s4;
-    uint8_t* rx = NULL;
+    uint8_t remoteIp[4] = {0};
+    uint16_t remotePort = 0;
     uint16_t received = 0;
+    uint8_t socket = 0;
     w5500_socket_status_t rxStatus = W5500_SOCKET_IO_ERROR;
 
     FAULT_ON_NULL(bufferArray);
 
     stack.Arg5().NumericByRef().s4 = 0;
+    stack.Arg6().NumericByRef().u4 = 0;
+    stack.Arg7().NumericByRef().s4 = 0;
 
-    if (socketHandle != kSingleSocketHandle || !g_socketAllocated || !g_socketConnected || !g_initialized)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketUdp[socket] || !w5500_is_initialized())
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
-        set_w5500_bringup_status(7, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(13, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    if (offset < 0 || count < 0 || timeoutMs < 0 || (uint32_t)(offset + count) > bufferArray->m_numOfElements)
+    if (offset < 0 || count < 0 || count > 0xFFFF || timeoutMs < 0 || (uint32_t)(offset + count) > bufferArray->m_numOfElements)
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
-        set_w5500_bringup_status(7, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(13, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    rx = (uint8_t*)bufferArray->GetFirstElement();
-    rxStatus = w5500_receive(kSocketIndex, rx + offset, (uint16_t)count, timeoutMs, &received);
-    stack.Arg5().NumericByRef().s4 = received;
-
+    rxStatus = w5500_udp_receive_from(
+        socket,
+        (uint8_t*)bufferArray->GetFirstElement() + offset,
+        (uint16_t)count,
+        timeoutMs,
+        remoteIp,
+        &remotePort,
+        &received);
     if (rxStatus == W5500_SOCKET_NOT_INITIALIZED)
     {
-        g_socketConnected = false;
+        g_socketUdp[socket] = false;
     }
 
+    // Source address packed big-endian: a.b.c.d -> 0xAABBCCDD.
+    stack.Arg5().NumericByRef().s4 = received;
+    stack.Arg6().NumericByRef().u4 =
+        ((uint32_t)remoteIp[0] << 24) | ((uint32_t)remoteIp[1] << 16) | ((uint32_t)remoteIp[2] << 8) | (uint32_t)remoteIp[3];
+    stack.Arg7().NumericByRef().s4 = remotePort;
+
     stack.SetResult_I4((int32_t)rxStatus);
     if (rxStatus == W5500_SOCKET_TIMEOUT)
     {
-        set_w5500_bringup_status(7, 2, (uint8_t)rxStatus);
+        set_w5500_bringup_status(13, 2, (uint8_t)rxStatus);
     }
     else
     {
-        set_w5500_bringup_status(7, rxStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)rxStatus);
+        set_w5500_bringup_status(13, rxStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)rxStatus);
     }
 
     NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeClose___STATIC__I4__I4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500LinkProbe_NativeEnable___STATIC__I4__BOOLEAN(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    set_w5500_bringup_status(8, 0, 0);
+    set_w5500_bringup_status(14, 0, 0);
+
+    bool enable = stack.Arg0().NumericByRef().u1 != 0;
+    w5500_socket_status_t enableStatus = w5500_link_probe_enable(enable);
+
+    stack.SetResult_I4((int32_t)enableStatus);
+    set_w5500_bringup_status(14, enableStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)enableStatus);
+
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_cubley_interop_W5500LinkProbe_NativeService___STATIC__I4__I4__BYREF_I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+
+    int32_t timeoutMs = stack.Arg0().NumericByRef().s4;
+    uint16_t handled = 0;
+    w5500_socket_status_t serviceStatus = W5500_SOCKET_INVALID_PARAM;
+
+    if (timeoutMs >= 0)
+    {
+        serviceStatus = w5500_link_probe_service(timeoutMs, &handled);
+    }
+
+    stack.Arg1().NumericByRef().s4 = handled;
+    stack.SetResult_I4((int32_t)serviceStatus);
+
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_cubley_interop_W5500LinkProbe_NativeGetStats___STATIC__I4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4__BYREF_U4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+
+    w5500_link_probe_stats_t stats;
+    w5500_link_probe_get_stats(&stats);
+
+    stack.Arg0().NumericByRef().u4 = stats.frames;
+    stack.Arg1().NumericByRef().u4 = stats.arpReplies;
+    stack.Arg2().NumericByRef().u4 = stats.echoReplies;
+    stack.Arg3().NumericByRef().u4 = stats.dropped;
+    stack.Arg4().NumericByRef().u4 = stats.lastEchoUs;
+    stack.Arg5().NumericByRef().u4 = stats.maxEchoUs;
+    stack.SetResult_I4((int32_t)(w5500_link_probe_is_enabled() ? W5500_SOCKET_OK : W5500_SOCKET_NOT_INITIALIZED));
+
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
+
+HRESULT Library_cubley_interop_W5500SocketReconnect_NativeStart___STATIC__I4__I4__STRING__I4__I4__I4__I4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
+
+    set_w5500_bringup_status(15, 0, 0);
 
     int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    CLR_RT_HeapBlock* hostArg = &(stack.Arg1());
+    int32_t port = stack.Arg2().NumericByRef().s4;
+    int32_t connectTimeoutMs = stack.Arg3().NumericByRef().s4;
+    int32_t minBackoffMs = stack.Arg4().NumericByRef().s4;
+    int32_t maxBackoffMs = stack.Arg5().NumericByRef().s4;
+    CLR_RT_HeapBlock_String* host = NULL;
+    uint8_t remoteIp[4] = {0};
+    uint8_t socket = 0;
+    w5500_reconnect_policy_t policy;
+    w5500_socket_status_t startStatus = W5500_SOCKET_IO_ERROR;
+
+    host = hostArg->DereferenceString();
+    FAULT_ON_NULL(host);
 
-    if (socketHandle != kSingleSocketHandle || !g_socketAllocated)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !w5500_is_initialized() ||
+        port < 1 || port > 65535 || connectTimeoutMs < 1 || minBackoffMs < 1 || maxBackoffMs < minBackoffMs)
     {
         stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
-        set_w5500_bringup_status(8, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(15, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    if (g_initialized)
+    if (!w5500_parse_ipv4(host->StringText(), remoteIp))
     {
-        w5500_issue_socket_command(kSocketIndex, W5500_CMD_DISCON, 100);
-        w5500_socket_close(kSocketIndex);
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_SUPPORTED);
+        set_w5500_bringup_status(15, 14, (uint8_t)W5500_SOCKET_NOT_SUPPORTED);
+        NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    g_socketConnected = false;
-    g_socketAllocated = false;
-    stack.SetResult_I4((int32_t)W5500_SOCKET_OK);
-    set_w5500_bringup_status(8, 1, 0);
+    policy.connectTimeoutMs = (uint32_t)connectTimeoutMs;
+    policy.minBackoffMs = (uint32_t)minBackoffMs;
+    policy.maxBackoffMs = (uint32_t)maxBackoffMs;
+
+    // The driver owns the connection from here; NativeGetState reports when it is usable.
+    ensure_event_thread();
+    g_socketUdp[socket] = false;
+    g_socketConnected[socket] = false;
+    startStatus = w5500_reconnect_start(socket, remoteIp, (uint16_t)port, &policy);
+    stack.SetResult_I4((int32_t)startStatus);
+    set_w5500_bringup_status(15, startStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)startStatus);
 
     NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeIsConnected___STATIC__BOOLEAN__I4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketReconnect_NativeStop___STATIC__I4__I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    set_w5500_bringup_status(5, 0, 0);
+    set_w5500_bringup_status(16, 0, 0);
 
     int32_t socketHandle = stack.Arg0().NumericByRef().s4;
-    uint8_t status = W5500_SOCK_CLOSED;
-    bool connected = false;
+    uint8_t socket = 0;
+    w5500_socket_status_t stopStatus = W5500_SOCKET_INVALID_PARAM;
 
-    if (socketHandle != kSingleSocketHandle || !g_socketAllocated || !g_initialized)
+    if (w5500_handle_to_socket(socketHandle, &socket))
     {
-        stack.SetResult_Boolean(false);
-        set_w5500_bringup_status(5, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
-        NANOCLR_SET_AND_LEAVE(S_OK);
+        stopStatus = w5500_reconnect_stop(socket);
+        g_socketConnected[socket] = false;
     }
 
-    status = w5500_read8(Sn_SR, socket_reg_bsb(kSocketIndex));
-    connected = (status == W5500_SOCK_ESTABLISHED || status == W5500_SOCK_CLOSE_WAIT);
-    g_socketConnected = connected;
-    stack.SetResult_Boolean(connected);
-    set_w5500_bringup_status(5, connected ? 1 : 14, connected ? 0 : 1);
+    stack.SetResult_I4((int32_t)stopStatus);
+    set_w5500_bringup_status(16, stopStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)stopStatus);
 
-    NANOCLR_NOCLEANUP();
+    NANOCLR_NOCLEANUP_NOLABEL();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeGetPhyStatus___STATIC__U4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketReconnect_NativeGetState___STATIC__I4__I4__BYREF_I4__BYREF_I4__BYREF_I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    uint8_t phycfgr = 0;
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    uint8_t socket = 0;
+    w5500_reconnect_status_t status = {};
+    w5500_socket_status_t getStatus = W5500_SOCKET_INVALID_PARAM;
 
-    if (!g_initialized)
+    if (w5500_handle_to_socket(socketHandle, &socket))
     {
-        stack.SetResult_U4(0);
-        set_w5500_last_native_error(0x50, (uint8_t)W5500_SOCKET_NOT_INITIALIZED, 0x00);
-        NANOCLR_SET_AND_LEAVE(S_OK);
-    }
+        w5500_reconnect_get_status(socket, &status);
+        getStatus = W5500_SOCKET_OK;
 
-    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-    stack.SetResult_U4((uint32_t)phycfgr);
+        // Send/receive follow the supervised state, so the handle is usable again after
+        // every reconnect. Unsupervised sockets report Closed and keep their own flag.
+        if (status.state != W5500_CONN_CLOSED)
+        {
+            g_socketConnected[socket] = (status.state == W5500_CONN_ESTABLISHED);
+        }
+    }
 
-    // Surface link state snapshots through bringup status for SWD mailbox visibility.
-    set_w5500_bringup_status(5, (phycfgr & 0x01) != 0 ? 1 : 14, phycfgr);
-    set_w5500_last_native_error(0x51, (phycfgr & 0x01) != 0 ? 0x00 : 0x01, phycfgr);
+    stack.Arg1().NumericByRef().s4 = (int32_t)status.state;
+    stack.Arg2().NumericByRef().s4 = (int32_t)status.connects;
+    stack.Arg3().NumericByRef().s4 = (int32_t)status.attempts;
+    stack.SetResult_I4((int32_t)getStatus);
 
-    NANOCLR_NOCLEANUP();
+    NANOCLR_NOCLEANUP_NOLABEL();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeGetVersion___STATIC__U4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500SocketTx_NativeSendStream___STATIC__I4__I4__SZARRAY_U1__I4__I4__I4__BOOLEAN__BYREF_I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    uint8_t version = 0;
-    uint8_t phycfgr = 0;
+    set_w5500_bringup_status(17, 0, 0);
+
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    CLR_RT_HeapBlock_Array* dataArray = stack.Arg1().DereferenceArray();
+    int32_t offset = stack.Arg2().NumericByRef().s4;
+    int32_t count = stack.Arg3().NumericByRef().s4;
+    int32_t timeoutMs = stack.Arg4().NumericByRef().s4;
+    bool waitForSendOk = stack.Arg5().NumericByRef().u1 != 0;
+    uint8_t* payload = NULL;
+    uint8_t socket = 0;
+    uint32_t sent = 0;
+    w5500_socket_status_t sendStatus = W5500_SOCKET_IO_ERROR;
+
+    FAULT_ON_NULL(dataArray);
+
+    stack.Arg6().NumericByRef().s4 = 0;
 
-    if (!g_initialized)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketConnected[socket] || !w5500_is_initialized())
     {
-        version = w5500_probe_version_minimal(&phycfgr);
-        stack.SetResult_U4((uint32_t)version);
-        set_w5500_bringup_status(5, version == 0x04 ? 1 : 14, version);
+        stack.SetResult_I4((int32_t)W5500_SOCKET_NOT_INITIALIZED);
+        set_w5500_bringup_status(17, 14, (uint8_t)W5500_SOCKET_NOT_INITIALIZED);
         NANOCLR_SET_AND_LEAVE(S_OK);
     }
 
-    version = w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
-    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-    stack.SetResult_U4((uint32_t)version);
+    if (offset < 0 || count < 0 || timeoutMs < 0 || (uint32_t)(offset + count) > dataArray->m_numOfElements)
+    {
+        stack.SetResult_I4((int32_t)W5500_SOCKET_INVALID_PARAM);
+        set_w5500_bringup_status(17, 14, (uint8_t)W5500_SOCKET_INVALID_PARAM);
+        NANOCLR_SET_AND_LEAVE(S_OK);
+    }
 
-    // Surface VERSIONR and PHYCFGR together for SWD-only diagnostics.
-    set_w5500_bringup_status(5, version == 0x04 ? 1 : 14, version);
-    set_w5500_last_native_error(0x53, version, phycfgr);
+    // The payload is in the chip's TX buffer when this returns, so the managed
+    // array can be reused even while the last SEND is still in flight.
+    payload = (uint8_t*)dataArray->GetFirstElement();
+    sendStatus = w5500_send_stream(socket, payload + offset, (uint32_t)count,
+                                   waitForSendOk ? 0 : W5500_SEND_NO_WAIT, timeoutMs, &sent);
+    stack.Arg6().NumericByRef().s4 = (int32_t)sent;
+
+    if (sendStatus == W5500_SOCKET_NOT_INITIALIZED)
+    {
+        g_socketConnected[socket] = false;
+    }
+
+    stack.SetResult_I4((int32_t)sendStatus);
+    set_w5500_bringup_status(17, sendStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)sendStatus);
 
     NANOCLR_NOCLEANUP();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeGetVersionPhyStatus___STATIC__U4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500MqttKeepAlive_NativeStart___STATIC__I4__I4__I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    uint8_t version = 0;
-    uint8_t phycfgr = 0;
-    uint32_t packed = 0;
+    set_w5500_bringup_status(18, 0, 0);
+
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    int32_t keepAliveSeconds = stack.Arg1().NumericByRef().s4;
+    uint8_t socket = 0;
+    w5500_socket_status_t startStatus = W5500_SOCKET_INVALID_PARAM;
 
-    if (!g_initialized)
+    if (!w5500_handle_to_socket(socketHandle, &socket) || !g_socketConnected[socket])
     {
-        stack.SetResult_U4(0);
-        set_w5500_last_native_error(0x54, (uint8_t)W5500_SOCKET_NOT_INITIALIZED, 0x00);
-        NANOCLR_SET_AND_LEAVE(S_OK);
+        startStatus = W5500_SOCKET_NOT_INITIALIZED;
+    }
+    else if (keepAliveSeconds > 0 && keepAliveSeconds <= 0xFFFF)
+    {
+        startStatus = w5500_keepalive_start(socket, (uint16_t)keepAliveSeconds);
     }
 
-    version = w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
-    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-    packed = (((uint32_t)version) << 8) | (uint32_t)phycfgr;
-    stack.SetResult_U4(packed);
-
-    set_w5500_bringup_status(5, (phycfgr & 0x01) != 0 ? 1 : 14, phycfgr);
-    set_w5500_last_native_error(0x54, version, phycfgr);
+    stack.SetResult_I4((int32_t)startStatus);
+    set_w5500_bringup_status(18, startStatus == W5500_SOCKET_OK ? 1 : 14, (uint8_t)startStatus);
 
-    NANOCLR_NOCLEANUP();
+    NANOCLR_NOCLEANUP_NOLABEL();
 }
 
-HRESULT Library_cubley_interop_W5500Socket_NativeSetPhyMode___STATIC__U4__I4(CLR_RT_StackFrame& stack)
+HRESULT Library_cubley_interop_W5500MqttKeepAlive_NativeStop___STATIC__I4__I4(CLR_RT_StackFrame& stack)
 {
     NANOCLR_HEADER();
 
-    int32_t modeCode = stack.Arg0().NumericByRef().s4;
-    uint8_t opmdc = 0;
-    uint8_t phycfgr = 0;
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    uint8_t socket = 0;
+    w5500_socket_status_t stopStatus = W5500_SOCKET_INVALID_PARAM;
 
-    if (!g_initialized)
+    if (w5500_handle_to_socket(socketHandle, &socket))
     {
-        stack.SetResult_U4(0);
-        set_w5500_last_native_error(0x55, (uint8_t)W5500_SOCKET_NOT_INITIALIZED, 0x00);
-        NANOCLR_SET_AND_LEAVE(S_OK);
+        w5500_keepalive_stop(socket);
+        stopStatus = W5500_SOCKET_OK;
     }
 
-    if (modeCode < 0 || modeCode > 7)
-    {
-        stack.SetResult_U4(0);
-        set_w5500_last_native_error(0x55, (uint8_t)W5500_SOCKET_INVALID_PARAM, 0xFF);
-        NANOCLR_SET_AND_LEAVE(S_OK);
-    }
+    stack.SetResult_I4((int32_t)stopStatus);
 
-    opmdc = (uint8_t)(modeCode & 0x07);
+    NANOCLR_NOCLEANUP_NOLABEL();
+}
 
-    // Keep PHY in software mode and deassert reset (RST=1) while programming OPMDC.
-    w5500_write8(
-        W5500_PHYCFGR,
-        W5500_BSB_COMMON,
-        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | (uint8_t)(opmdc << 3)));
-    chThdSleepMilliseconds(5);
+HRESULT Library_cubley_interop_W5500MqttKeepAlive_NativeGetStats___STATIC__I4__I4__BYREF_U4__BYREF_U4__BYREF_U4(CLR_RT_StackFrame& stack)
+{
+    NANOCLR_HEADER();
 
-    // Trigger PHY reset (active-low RST=0) to apply mode change.
-    w5500_write8(
-        W5500_PHYCFGR,
-        W5500_BSB_COMMON,
-        (uint8_t)(W5500_PHYCFGR_OPMD | (uint8_t)(opmdc << 3)));
+    int32_t socketHandle = stack.Arg0().NumericByRef().s4;
+    uint8_t socket = 0;
+    w5500_keepalive_stats_t stats = {};
+    w5500_socket_status_t getStatus = W5500_SOCKET_INVALID_PARAM;
 
-    for (int rst_poll = 0; rst_poll < 300; rst_poll++)
+    if (w5500_handle_to_socket(socketHandle, &socket))
     {
-        chThdSleepMilliseconds(10);
-        phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
-        if ((phycfgr & W5500_PHYCFGR_RST) != 0)
-        {
-            break;
-        }
+        getStatus = w5500_keepalive_get_stats(socket, &stats) ? W5500_SOCKET_OK : W5500_SOCKET_NOT_INITIALIZED;
     }
 
-    // Re-assert same SW mode with reset deasserted.
-    w5500_write8(
-        W5500_PHYCFGR,
-        W5500_BSB_COMMON,
-        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | (uint8_t)(opmdc << 3)));
-    chThdSleepMilliseconds(5);
-    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+    stack.Arg1().NumericByRef().u4 = stats.pingsSent;
+    stack.Arg2().NumericByRef().u4 = stats.pingResponses;
+    stack.Arg3().NumericByRef().u4 = stats.missed;
+    stack.SetResult_I4((int32_t)getStatus);
 
-    stack.SetResult_U4((uint32_t)phycfgr);
-    set_w5500_last_native_error(0x55, opmdc, phycfgr);
-
-    NANOCLR_NOCLEANUP();
+    NANOCLR_NOCLEANUP_NOLABEL();
 }
@@ -0,0 +1,156 @@
+/**
+ * @file w5500_link_responder.cpp
+ * @brief HAL-independent ARP / ICMP echo responder for W5500 MACRAW frames
+ */
+
+#include "w5500_link_responder.h"
+#include <string.h>
+
+#define ETHERTYPE_IPV4              0x0800
+#define ETHERTYPE_ARP               0x0806
+
+#define ARP_BYTES                   28
+#define ARP_OPER_REQUEST            1
+#define ARP_OPER_REPLY              2
+
+#define IPV4_MIN_HEADER_BYTES       20
+#define IPV4_PROTO_ICMP             1
+#define IPV4_REPLY_TTL              64
+
+#define ICMP_MIN_BYTES              8
+#define ICMP_ECHO_REPLY             0
+#define ICMP_ECHO_REQUEST           8
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)(v & 0xFF);
+}
+
+uint16_t link_responder_checksum(const uint8_t *data, uint16_t length)
+{
+    uint32_t sum = 0;
+
+    for (uint16_t i = 0; i + 1 < length; i += 2) {
+        sum += get16(&data[i]);
+    }
+    if ((length & 1) != 0) {
+        sum += (uint32_t)data[length - 1] << 8;
+    }
+    while ((sum >> 16) != 0) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+/* Ethernet header of the reply: back to the sender, from us */
+static void swap_ethernet(uint8_t *frame, const uint8_t mac[6])
+{
+    memcpy(&frame[0], &frame[6], 6);
+    memcpy(&frame[6], mac, 6);
+}
+
+static uint16_t pad_frame(uint8_t *frame, uint16_t length, uint16_t capacity)
+{
+    if (length < LINK_RESPONDER_MIN_FRAME_BYTES && capacity >= LINK_RESPONDER_MIN_FRAME_BYTES) {
+        memset(&frame[length], 0, LINK_RESPONDER_MIN_FRAME_BYTES - length);
+        return LINK_RESPONDER_MIN_FRAME_BYTES;
+    }
+    return length;
+}
+
+static link_responder_kind_t reply_arp(uint8_t *frame, uint16_t length, uint16_t capacity,
+                                       const uint8_t mac[6], const uint8_t ip[4], uint16_t *out_length)
+{
+    uint8_t *arp = &frame[LINK_RESPONDER_ETH_HEADER_BYTES];
+
+    if (length < LINK_RESPONDER_ETH_HEADER_BYTES + ARP_BYTES) {
+        return LINK_RESPONDER_NONE;
+    }
+
+    // Ethernet / IPv4 request for our address
+    if (get16(&arp[0]) != 1 || get16(&arp[2]) != ETHERTYPE_IPV4 || arp[4] != 6 || arp[5] != 4 ||
+        get16(&arp[6]) != ARP_OPER_REQUEST || memcmp(&arp[24], ip, 4) != 0) {
+        return LINK_RESPONDER_NONE;
+    }
+
+    // Target := sender, sender := us
+    memcpy(&arp[18], &arp[8], 10);
+    memcpy(&arp[8], mac, 6);
+    memcpy(&arp[14], ip, 4);
+    put16(&arp[6], ARP_OPER_REPLY);
+    swap_ethernet(frame, mac);
+
+    *out_length = pad_frame(frame, LINK_RESPONDER_ETH_HEADER_BYTES + ARP_BYTES, capacity);
+    return LINK_RESPONDER_ARP_REPLY;
+}
+
+static link_responder_kind_t reply_echo(uint8_t *frame, uint16_t length, uint16_t capacity,
+                                        const uint8_t mac[6], const uint8_t ip[4], uint16_t *out_length)
+{
+    uint8_t *ipv4 = &frame[LINK_RESPONDER_ETH_HEADER_BYTES];
+
+    // Unicast to us only: no replies to broadcast pings
+    if (length < LINK_RESPONDER_ETH_HEADER_BYTES + IPV4_MIN_HEADER_BYTES || memcmp(&frame[0], mac, 6) != 0) {
+        return LINK_RESPONDER_NONE;
+    }
+
+    uint16_t header_bytes = (uint16_t)((ipv4[0] & 0x0F) * 4);
+    uint16_t total_bytes = get16(&ipv4[2]);
+    if ((ipv4[0] >> 4) != 4 || header_bytes < IPV4_MIN_HEADER_BYTES ||
+        total_bytes < header_bytes + ICMP_MIN_BYTES ||
+        LINK_RESPONDER_ETH_HEADER_BYTES + total_bytes > length) {
+        return LINK_RESPONDER_NONE;
+    }
+
+    // Whole, checksummed, addressed to us; fragments are left to the reassembler we do not have
+    if (ipv4[9] != IPV4_PROTO_ICMP || (get16(&ipv4[6]) & 0x3FFF) != 0 || memcmp(&ipv4[16], ip, 4) != 0 ||
+        link_responder_checksum(ipv4, header_bytes) != 0) {
+        return LINK_RESPONDER_NONE;
+    }
+
+    uint8_t *icmp = &ipv4[header_bytes];
+    uint16_t icmp_bytes = (uint16_t)(total_bytes - header_bytes);
+    if (icmp[0] != ICMP_ECHO_REQUEST || icmp[1] != 0 || link_responder_checksum(icmp, icmp_bytes) != 0) {
+        return LINK_RESPONDER_NONE;
+    }
+
+    // ICMP: same identifier, sequence and data
+    icmp[0] = ICMP_ECHO_REPLY;
+    put16(&icmp[2], 0);
+    put16(&icmp[2], link_responder_checksum(icmp, icmp_bytes));
+
+    // IPv4: back to the sender with a fresh TTL
+    memcpy(&ipv4[16], &ipv4[12], 4);
+    memcpy(&ipv4[12], ip, 4);
+    ipv4[8] = IPV4_REPLY_TTL;
+    put16(&ipv4[10], 0);
+    put16(&ipv4[10], link_responder_checksum(ipv4, header_bytes));
+
+    swap_ethernet(frame, mac);
+
+    *out_length = pad_frame(frame, (uint16_t)(LINK_RESPONDER_ETH_HEADER_BYTES + total_bytes), capacity);
+    return LINK_RESPONDER_ECHO_REPLY;
+}
+
+link_responder_kind_t link_responder_reply(uint8_t *frame, uint16_t length, uint16_t capacity,
+                                           const uint8_t mac[6], const uint8_t ip[4], uint16_t *out_length)
+{
+    if (length < LINK_RESPONDER_ETH_HEADER_BYTES || length > capacity) {
+        return LINK_RESPONDER_NONE;
+    }
+
+    switch (get16(&frame[12])) {
+        case ETHERTYPE_ARP:
+            return reply_arp(frame, length, capacity, mac, ip, out_length);
+        case ETHERTYPE_IPV4:
+            return reply_echo(frame, length, capacity, mac, ip, out_length);
+        default:
+            return LINK_RESPONDER_NONE;
+    }
+}
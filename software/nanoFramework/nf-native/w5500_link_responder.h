@@ -0,0 +1,58 @@
+/**
+ * @file w5500_link_responder.h
+ * @brief HAL-independent ARP / ICMP echo responder for W5500 MACRAW frames
+ *
+ * Socket 0 in MACRAW mode hands over whole Ethernet II frames. The responder
+ * turns an ARP request for our address into the ARP reply and an ICMP echo
+ * request for our address into the echo reply, rewriting the frame in place
+ * so no second frame buffer is needed. Everything else is left alone.
+ *
+ * Nothing here touches the HAL, so the same code runs on target under
+ * w5500_native.cpp and in the host tests under tests/native/.
+ */
+
+#ifndef W5500_LINK_RESPONDER_H
+#define W5500_LINK_RESPONDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINK_RESPONDER_ETH_HEADER_BYTES     14
+#define LINK_RESPONDER_MIN_FRAME_BYTES      60          // Ethernet minimum without FCS
+#define LINK_RESPONDER_MAX_FRAME_BYTES      1514        // 1500-byte MTU + Ethernet header
+
+typedef enum {
+    LINK_RESPONDER_NONE = 0,            // Not for us, not handled or malformed
+    LINK_RESPONDER_ARP_REPLY = 1,
+    LINK_RESPONDER_ECHO_REPLY = 2
+} link_responder_kind_t;
+
+/**
+ * @brief Internet checksum (RFC 1071) of length bytes, folded and complemented
+ */
+uint16_t link_responder_checksum(const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Rewrite a received frame into its reply
+ * @param frame Ethernet II frame (destination MAC first, no FCS)
+ * @param length Bytes in frame
+ * @param capacity Size of the frame buffer (replies are padded to 60 bytes)
+ * @param mac Our MAC address (SHAR)
+ * @param ip Our IPv4 address (SIPR)
+ * @param out_length Reply length when a reply was built
+ * @return Kind of reply now in frame; LINK_RESPONDER_NONE leaves frame untouched
+ *
+ * ICMP is only answered for unfragmented IPv4 with a valid header checksum.
+ */
+link_responder_kind_t link_responder_reply(uint8_t *frame, uint16_t length, uint16_t capacity,
+                                           const uint8_t mac[6], const uint8_t ip[4], uint16_t *out_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* W5500_LINK_RESPONDER_H */
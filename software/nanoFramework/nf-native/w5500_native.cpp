@@ -0,0 +1,3343 @@
+/**
+ * @file w5500_native.cpp
+ * @brief Native W5500 socket transport over SPI2 (no CLR dependencies)
+ */
+
+#include "w5500_native.h"
+#include "w5500_link_responder.h"
+#include <string.h>
+#include <stdlib.h>
+#include "board_cubley.h"
+
+extern volatile uint32_t g_cubley_diag_current_status;
+extern volatile uint32_t g_cubley_diag_last_error;
+
+static const uint8_t W5500_MR = 0x0000;
+static const uint8_t W5500_GAR = 0x0001;
+static const uint8_t W5500_SUBR = 0x0005;
+static const uint8_t W5500_SHAR = 0x0009;
+static const uint8_t W5500_SIPR = 0x000F;
+static const uint8_t W5500_RTR = 0x0019;
+static const uint8_t W5500_RCR = 0x001B;
+static const uint8_t W5500_SIR = 0x0017;
+static const uint8_t W5500_SIMR = 0x0018;
+static const uint16_t W5500_PHYCFGR = 0x002E;
+static const uint8_t W5500_VERSIONR = 0x0039;
+
+static const uint8_t W5500_PHYCFGR_LNK = 0x01;
+static const uint8_t W5500_PHYCFGR_SPD = 0x02;
+static const uint8_t W5500_PHYCFGR_DPX = 0x04;
+static const uint8_t W5500_PHYCFGR_OPMDC_MASK = 0x38;
+static const uint8_t W5500_PHYCFGR_OPMD = 0x40;
+static const uint8_t W5500_PHYCFGR_RST = 0x80;
+// W5500 PHYCFGR.OPMDC[5:3] encoding (datasheet rev 1.0.6, table on PHYCFGR):
+//   000 10BT-HD       001 10BT-FD       010 100BT-HD (no AN)  011 100BT-FD (no AN)
+//   100 100BT-HD AN   101 Power Down    110 All-capable AN    111 reserved/not used
+// "All capable, auto-negotiation enabled" = OPMDC = 0b110 -> bits[5:3]=110 -> 0x30.
+// (Earlier value 0x38 set OPMDC=0b111 which is reserved; the analog TX block treated
+// it as power-down equivalent, leaving TD+ pinned at +3V3 via R28 with no FLPs.)
+static const uint8_t W5500_PHYCFGR_OPMDC_ALL_AUTO = 0x30;
+
+static const uint16_t Sn_MR = 0x0000;
+static const uint16_t Sn_CR = 0x0001;
+static const uint16_t Sn_IR = 0x0002;
+static const uint16_t Sn_SR = 0x0003;
+static const uint16_t Sn_PORT = 0x0004;
+static const uint16_t Sn_DIPR = 0x000C;
+static const uint16_t Sn_DPORT = 0x0010;
+// In UDP mode each datagram in the RX buffer starts with this header:
+// source IP (4), source port (2), payload length (2).
+static const uint16_t kUdpHeaderBytes = 8;
+// MACRAW RX: 2-byte big-endian length (counting itself) before each frame.
+static const uint16_t kMacrawHeaderBytes = 2;
+static const uint16_t Sn_TX_FSR = 0x0020;
+static const uint16_t Sn_TX_WR = 0x0024;
+static const uint16_t Sn_RX_RSR = 0x0026;
+static const uint16_t Sn_RX_RD = 0x0028;
+static const uint16_t Sn_RXBUF_SIZE = 0x001E;
+static const uint16_t Sn_TXBUF_SIZE = 0x001F;
+static const uint16_t Sn_IMR = 0x002C;
+static const uint16_t Sn_KPALVTR = 0x002F;
+
+static const uint8_t W5500_SOCK_MODE_TCP = 0x01;
+static const uint8_t W5500_SOCK_MODE_UDP = 0x02;
+static const uint8_t W5500_SOCK_MODE_MACRAW = 0x04;
+static const uint8_t W5500_SOCK_MACRAW_MFEN = 0x80;
+static const uint8_t W5500_MR_PB = 0x10;
+static const uint8_t W5500_CMD_OPEN = 0x01;
+static const uint8_t W5500_CMD_CONNECT = 0x04;
+static const uint8_t W5500_CMD_DISCON = 0x08;
+static const uint8_t W5500_CMD_CLOSE = 0x10;
+static const uint8_t W5500_CMD_SEND = 0x20;
+static const uint8_t W5500_CMD_RECV = 0x40;
+
+static const uint8_t W5500_SOCK_CLOSED = 0x00;
+static const uint8_t W5500_SOCK_INIT = 0x13;
+static const uint8_t W5500_SOCK_SYNSENT = 0x15;
+static const uint8_t W5500_SOCK_ESTABLISHED = 0x17;
+static const uint8_t W5500_SOCK_CLOSE_WAIT = 0x1C;
+static const uint8_t W5500_SOCK_UDP = 0x22;
+static const uint8_t W5500_SOCK_MACRAW = 0x42;
+
+static const uint8_t W5500_IR_CON = 0x01;
+static const uint8_t W5500_IR_DISCON = 0x02;
+static const uint8_t W5500_IR_TIMEOUT = 0x08;
+static const uint8_t W5500_IR_SENDOK = 0x10;
+static const uint8_t W5500_IR_RECV = 0x04;
+static const uint8_t W5500_IR_ALL =
+    (uint8_t)(W5500_IR_CON | W5500_IR_DISCON | W5500_IR_RECV | W5500_IR_TIMEOUT | W5500_IR_SENDOK);
+
+static const uint8_t W5500_BSB_COMMON = 0x00;
+static const uint8_t W5500_BSB_SOCKET_REG = 0x01;
+static const uint8_t W5500_BSB_SOCKET_TX = 0x02;
+static const uint8_t W5500_BSB_SOCKET_RX = 0x03;
+
+static const uint16_t kDefaultSourcePort = 50000;
+static const uint16_t kDefaultRetryTime = 2000;
+static const uint8_t kDefaultRetryCount = 3;
+static const uint8_t kSocketCount = W5500_SOCKET_COUNT;
+static const uint8_t kSocketBufferTotalKb = 16;
+// Re-read SIR this often even without an INT edge, so a missed edge costs latency, not a hang.
+static const uint32_t kIrqSafetyPollMs = 100;
+// Fast profile: cap for the post-reset VERSIONR and MR.RST polls (1 ms steps).
+static const uint32_t kFastResetPollMs = 50;
+
+static uint8_t g_networkMac[6] = {0x02, 0x08, 0xDC, 0x00, 0x00, 0x01};
+static uint8_t g_networkGateway[4] = {192, 168, 1, 1};
+static uint8_t g_networkSubnet[4] = {255, 255, 255, 0};
+static uint8_t g_networkIp[4] = {192, 168, 1, 123};
+
+static bool g_initialized = false;
+static uint16_t g_nextSourcePort = kDefaultSourcePort;
+
+static w5500_io_mode_t g_ioMode = W5500_DEFAULT_IO_MODE;
+static w5500_init_profile_t g_initProfile = W5500_DEFAULT_INIT_PROFILE;
+static uint32_t g_initDurationUs = 0;
+
+// SWD latch: 0xD7 | init profile | bring-up duration in ms (capped at 0xFFFF).
+// Written at the end of every w5500_init() attempt, success or not.
+volatile uint32_t g_w5500_init_timing = 0;
+// Signalled from the INT falling edge; the waiting thread does the SPI work.
+// Only socket calls wait on it: the reconnect thread polls Sn_SR instead, so
+// there is never more than one waiter.
+static binary_semaphore_t g_irqSem;
+// Sn_IR bits acknowledged on the chip but not yet consumed by a wait.
+static uint8_t g_socketIrLatched[kSocketCount];
+// Bumped by every close. A wait or receive that yielded the lock compares it
+// to tell that its connection ended, even if the reconnect thread has opened
+// a new one on the same socket since.
+static uint32_t g_socketEpoch[kSocketCount];
+// A SEND was issued and its SENDOK has not been collected yet; the chip
+// takes one SEND at a time, so the next one waits for it.
+static bool g_socketSendPending[kSocketCount];
+
+// Socket pool and buffer split, guarded like the SPI helpers by g_driverLock.
+static bool g_socketOpen[kSocketCount];
+static uint8_t g_socketRxBufKb[kSocketCount] = W5500_DEFAULT_RXBUF_KB;
+static uint8_t g_socketTxBufKb[kSocketCount] = W5500_DEFAULT_TXBUF_KB;
+
+// RX mirror: bytes already taken off the chip (RECV issued), oldest at head.
+static_assert((W5500_RX_MIRROR_BYTES & (W5500_RX_MIRROR_BYTES - 1)) == 0, "W5500_RX_MIRROR_BYTES must be a power of two");
+static const uint16_t kRxMirrorMask = W5500_RX_MIRROR_BYTES - 1;
+
+struct w5500_rx_mirror_t
+{
+    uint16_t head;
+    uint16_t count;
+    uint8_t data[W5500_RX_MIRROR_BYTES];
+};
+
+static w5500_rx_mirror_t g_rxMirror[kSocketCount];
+static bool g_rxMirrorEnabled = W5500_DEFAULT_RX_MIRROR;
+// Receive-path accounting; SPI bytes are charged only while g_rxMetering.
+static w5500_rx_stats_t g_rxStats;
+static bool g_rxMetering = false;
+
+// Link probe (socket 0 in MACRAW mode). One frame buffer: replies are built
+// in place by link_responder_reply().
+static const uint8_t kLinkProbeSocket = 0;
+static const uint8_t kLinkProbeDrainFrames = 8;
+static const uint32_t kLinkProbeSendTimeoutMs = 10;
+static bool g_linkProbeActive = false;
+static uint8_t g_linkProbeFrame[W5500_LINK_PROBE_FRAME_BYTES];
+static w5500_link_probe_stats_t g_linkProbeStats;
+
+// Driver lock: a plain (non-recursive) ChibiOS mutex plus an owner/depth pair
+// so public calls can nest and waits can hand the chip over while they sleep.
+static MUTEX_DECL(g_driverLock);
+static thread_t* g_driverLockOwner = NULL;
+static uint32_t g_driverLockDepth = 0;
+
+// Native reconnect (one slot per socket, one thread for all of them).
+struct w5500_reconnect_slot_t
+{
+    bool active;
+    uint8_t remoteIp[4];
+    uint16_t remotePort;
+    w5500_reconnect_policy_t policy;
+    w5500_reconnect_status_t status;
+    systime_t since;                // Entered the current state
+    uint32_t nextBackoffMs;         // Ceiling for the next backoff draw
+};
+
+static w5500_reconnect_slot_t g_reconnect[kSocketCount];
+static EVENTSOURCE_DECL(g_reconnectEvents);
+static binary_semaphore_t g_reconnectWake;
+static thread_t* g_reconnectThread = NULL;
+static uint32_t g_reconnectRandom = 0;
+static THD_WORKING_AREA(wa_w5500_reconnect, W5500_RECONNECT_THREAD_WA_SIZE);
+
+// MQTT keep-alive offload, stepped by the reconnect thread.
+struct w5500_keepalive_slot_t
+{
+    bool enabled;
+    bool pingOutstanding;
+    sysinterval_t interval;         // Idle TX before a PINGREQ, and the wait for its PINGRESP
+    systime_t pingSentAt;
+    w5500_keepalive_stats_t stats;
+};
+
+static w5500_keepalive_slot_t g_keepalive[kSocketCount];
+// Time of the last SEND on each socket, and whether a send call is under way
+// (it may have yielded the lock between chunks of one packet).
+static systime_t g_socketLastTx[kSocketCount];
+static bool g_socketSendBusy[kSocketCount];
+
+void set_w5500_bringup_status(uint8_t stage, uint8_t result, uint8_t detail)
+{
+    g_cubley_diag_current_status = ((uint32_t)0xD5 << 24) | ((uint32_t)stage << 16) | ((uint32_t)result << 8) | (uint32_t)detail;
+}
+
+void set_w5500_last_native_error(uint8_t op, uint8_t code, uint8_t detail)
+{
+    // 0xE1 marker | op | code | detail (sticky until next update).
+    g_cubley_diag_last_error = ((uint32_t)0xE1 << 24) | ((uint32_t)op << 16) | ((uint32_t)code << 8) | (uint32_t)detail;
+}
+
+void w5500_lock(void)
+{
+    thread_t* self = chThdGetSelfX();
+    if (g_driverLockOwner == self)
+    {
+        g_driverLockDepth++;
+        return;
+    }
+
+    chMtxLock(&g_driverLock);
+    g_driverLockOwner = self;
+    g_driverLockDepth = 1;
+}
+
+void w5500_unlock(void)
+{
+    if (--g_driverLockDepth == 0)
+    {
+        g_driverLockOwner = NULL;
+        chMtxUnlock(&g_driverLock);
+    }
+}
+
+// Holds the driver lock for the rest of the scope.
+class W5500Lock
+{
+public:
+    W5500Lock() { w5500_lock(); }
+    ~W5500Lock() { w5500_unlock(); }
+};
+
+// Marks a send call under way on the socket for the rest of the scope.
+class W5500SendBusy
+{
+public:
+    explicit W5500SendBusy(uint8_t socket) : m_socket(socket) { g_socketSendBusy[socket] = true; }
+    ~W5500SendBusy() { g_socketSendBusy[m_socket] = false; }
+
+private:
+    uint8_t m_socket;
+};
+
+// What w5500_lock_yield() gave up, handed back to w5500_lock_reacquire().
+struct w5500_lock_hold_t
+{
+    uint32_t depth;                 // 0 when the lock was kept
+    bool rxMetering;
+};
+
+// Give the lock up entirely before blocking. The reconnect thread keeps it
+// through a whole step (a few frames plus at most a command poll), so a stop
+// or release never lands between its CLOSE, OPEN and CONNECT. RX metering
+// pauses with the lock, so other threads' SPI is not charged to a receive.
+static w5500_lock_hold_t w5500_lock_yield(void)
+{
+    w5500_lock_hold_t hold = {0, false};
+    if (g_driverLockOwner != chThdGetSelfX() || g_driverLockOwner == g_reconnectThread)
+    {
+        return hold;
+    }
+
+    hold.depth = g_driverLockDepth;
+    hold.rxMetering = g_rxMetering;
+    g_rxMetering = false;
+    g_driverLockDepth = 0;
+    g_driverLockOwner = NULL;
+    chMtxUnlock(&g_driverLock);
+    return hold;
+}
+
+static void w5500_lock_reacquire(const w5500_lock_hold_t& hold)
+{
+    if (hold.depth == 0)
+    {
+        return;
+    }
+
+    chMtxLock(&g_driverLock);
+    g_driverLockOwner = chThdGetSelfX();
+    g_driverLockDepth = hold.depth;
+    g_rxMetering = hold.rxMetering;
+}
+
+// Charges the SPI traffic of one receive call to the RX stats; the caller
+// reports what it delivered.
+class W5500RxMeter
+{
+public:
+    W5500RxMeter() : m_previous(g_rxMetering) { g_rxMetering = true; }
+    ~W5500RxMeter() { g_rxMetering = m_previous; }
+    void delivered(uint32_t bytes) { g_rxStats.appBytes += bytes; }
+
+private:
+    bool m_previous;
+};
+
+static inline void w5500_spi_meter(uint32_t bytes)
+{
+    if (g_rxMetering)
+    {
+        g_rxStats.spiBytes += bytes;
+    }
+}
+
+// Sleep without holding the chip.
+static void w5500_sleep_ms(uint32_t ms)
+{
+    w5500_lock_hold_t hold = w5500_lock_yield();
+    chThdSleepMilliseconds(ms);
+    w5500_lock_reacquire(hold);
+}
+
+// Hardware SPI2 for W5500: PB12=NSS, PB13=SCK, PB14=MISO, PB15=MOSI (all AF5).
+// APB1=42 MHz; probed at BR[2:0]=010 -> fPCLK/8 ~5.25 MHz, mode 0 (CPOL=0
+// CPHA=0), then switched to the default/calibrated divider.
+static SPIConfig g_spi2cfg;
+static bool g_spi2cfg_initialized = false;
+// SPI DMA on STM32F4 cannot access CCM stack (0x1000xxxx), so keep transfer
+// buffers in static SRAM-backed storage.
+static uint8_t g_w5500_spi_tx4[4];
+static uint8_t g_w5500_spi_rx4[4];
+static uint8_t g_w5500_last_spi_rx0 = 0;
+static uint8_t g_w5500_last_spi_rx1 = 0;
+static uint8_t g_w5500_last_spi_ctrl = 0;
+static uint8_t g_w5500_last_spi_data = 0;
+// CS transition bits sampled around a 4-byte read transaction:
+// bit3=before select, bit2=after select, bit1=before unselect, bit0=after unselect.
+// Expected for active-low CS is 0b1001 (0x9).
+static uint8_t g_w5500_last_cs_bits = 0;
+// PB12 high->low->high GPIO sanity code from w5500_hw_init() (expected 0b101 = 0x5).
+static uint8_t g_w5500_cs_gpio_code = 0;
+
+static inline void w5500_cs_gpio_assert(void)
+{
+    palClearLine(W5500_CS_LINE);
+}
+
+static inline void w5500_cs_gpio_release(void)
+{
+    palSetLine(W5500_CS_LINE);
+}
+
+static inline void w5500_spi_select(void)
+{
+    spiSelect(&SPID2);
+}
+
+static inline void w5500_spi_unselect(void)
+{
+    spiUnselect(&SPID2);
+}
+
+static void w5500_spi_prepare_config(void)
+{
+    if (g_spi2cfg_initialized)
+    {
+        return;
+    }
+
+    memset(&g_spi2cfg, 0, sizeof(g_spi2cfg));
+
+#if (SPI_SUPPORTS_CIRCULAR == TRUE)
+    g_spi2cfg.circular = false;
+#endif
+
+#if defined(HAL_LLD_SELECT_SPI_V2)
+#if (SPI_SUPPORTS_SLAVE_MODE == TRUE)
+    g_spi2cfg.slave = false;
+#endif
+    g_spi2cfg.data_cb = NULL;
+    g_spi2cfg.error_cb = NULL;
+#else
+    g_spi2cfg.end_cb = NULL;
+#endif
+
+#if (SPI_SELECT_MODE == SPI_SELECT_MODE_LINE)
+    g_spi2cfg.ssline = W5500_CS_LINE;
+#elif (SPI_SELECT_MODE == SPI_SELECT_MODE_PORT)
+    g_spi2cfg.ssport = GPIOB;
+    g_spi2cfg.ssmask = (ioportmask_t)(1U << 12U);
+#elif (SPI_SELECT_MODE == SPI_SELECT_MODE_PAD)
+    g_spi2cfg.ssport = GPIOB;
+    g_spi2cfg.sspad = 12U;
+#else
+#error Unsupported SPI_SELECT_MODE for W5500 SPI config
+#endif
+
+    g_spi2cfg.cr1 = SPI_CR1_BR_1;
+    g_spi2cfg.cr2 = 0U;
+    g_spi2cfg_initialized = true;
+}
+
+static void w5500_spi_start(void)
+{
+    w5500_spi_prepare_config();
+    // Early init can run before scheduler start; avoid mutex-based bus acquire there.
+    spiStart(&SPID2, &g_spi2cfg);
+}
+
+static void w5500_spi_set_cr1(uint16_t cr1)
+{
+    g_spi2cfg.cr1 = cr1;
+    spiStop(&SPID2);
+    spiStart(&SPID2, &g_spi2cfg);
+}
+
+static void w5500_scope_spi_clock_burst()
+{
+    // Scope-assist for low-end DSO capture: emit repeated, slow SPI bursts with CS low.
+    static uint8_t tx[32];
+    static uint8_t rx[32];
+
+    for (size_t i = 0; i < sizeof(tx); i++)
+    {
+        tx[i] = (uint8_t)((i & 1U) != 0U ? 0xAAU : 0x55U);
+    }
+
+    // Slowest prescaler gives the widest pulses for easy visual confirmation.
+    w5500_spi_set_cr1((uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0));
+
+    for (int burst = 0; burst < 12; burst++)
+    {
+        memset(rx, 0, sizeof(rx));
+        w5500_spi_select();
+        spiExchange(&SPID2, sizeof(tx), tx, rx);
+        w5500_spi_unselect();
+        chThdSleepMilliseconds(20);
+    }
+
+    // Restore default probe baseline before entering normal init sequence.
+    w5500_spi_set_cr1(SPI_CR1_BR_1);
+}
+
+static void w5500_scope_versionr_stream(uint8_t *lastVersion, uint8_t *nonZeroCount)
+{
+    static uint8_t tx4[4];
+    static uint8_t rx4[4];
+
+    tx4[0] = (uint8_t)(W5500_VERSIONR >> 8);
+    tx4[1] = (uint8_t)(W5500_VERSIONR & 0xFF);
+    tx4[2] = (uint8_t)((W5500_BSB_COMMON << 3) | 0x00);
+    tx4[3] = 0x00;
+
+    uint8_t last = 0;
+    uint8_t nonZero = 0;
+
+    // Slow, repeated valid reads to make MISO transitions visible on entry-level scopes.
+    w5500_spi_set_cr1((uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0));
+
+    for (int i = 0; i < 48; i++)
+    {
+        memset(rx4, 0, sizeof(rx4));
+        w5500_spi_select();
+        spiExchange(&SPID2, 4U, tx4, rx4);
+        w5500_spi_unselect();
+
+        last = rx4[3];
+        if (rx4[3] != 0)
+        {
+            nonZero++;
+        }
+
+        chThdSleepMilliseconds(8);
+    }
+
+    w5500_spi_set_cr1(SPI_CR1_BR_1);
+
+    if (lastVersion != NULL)
+    {
+        *lastVersion = last;
+    }
+
+    if (nonZeroCount != NULL)
+    {
+        *nonZeroCount = nonZero;
+    }
+}
+
+
+static inline uint8_t socket_reg_bsb(uint8_t socket)
+{
+    return (uint8_t)(W5500_BSB_SOCKET_REG + (socket * 4));
+}
+
+static inline uint8_t socket_tx_bsb(uint8_t socket)
+{
+    return (uint8_t)(W5500_BSB_SOCKET_TX + (socket * 4));
+}
+
+static inline uint8_t socket_rx_bsb(uint8_t socket)
+{
+    return (uint8_t)(W5500_BSB_SOCKET_RX + (socket * 4));
+}
+
+// Hardware SPI transaction helpers.
+// The W5500 frame format is: [ADDR_HI][ADDR_LO][BSB|RW] followed by data bytes.
+// Use ChibiOS select/unselect so CS handling follows SPIConfig behavior.
+static uint8_t w5500_read8(uint16_t address, uint8_t bsb)
+{
+    g_w5500_spi_tx4[0] = (uint8_t)(address >> 8);
+    g_w5500_spi_tx4[1] = (uint8_t)(address & 0xFF);
+    g_w5500_spi_tx4[2] = (uint8_t)((bsb << 3) | 0x00);
+    g_w5500_spi_tx4[3] = 0x00;
+
+    g_w5500_spi_rx4[0] = 0;
+    g_w5500_spi_rx4[1] = 0;
+    g_w5500_spi_rx4[2] = 0;
+    g_w5500_spi_rx4[3] = 0;
+
+    uint8_t csBits = 0;
+    if (palReadLine(W5500_CS_LINE) != 0)
+    {
+        csBits |= 0x08;
+    }
+
+    w5500_spi_select();
+    if (palReadLine(W5500_CS_LINE) != 0)
+    {
+        csBits |= 0x04;
+    }
+
+    spiExchange(&SPID2, 4U, g_w5500_spi_tx4, g_w5500_spi_rx4);
+    w5500_spi_meter(4U);
+
+    if (palReadLine(W5500_CS_LINE) != 0)
+    {
+        csBits |= 0x02;
+    }
+
+    w5500_spi_unselect();
+    if (palReadLine(W5500_CS_LINE) != 0)
+    {
+        csBits |= 0x01;
+    }
+
+    // Keep latest raw response bytes for SWD diagnostics.
+    g_w5500_last_spi_rx0 = g_w5500_spi_rx4[0];
+    g_w5500_last_spi_rx1 = g_w5500_spi_rx4[1];
+    g_w5500_last_spi_ctrl = g_w5500_spi_rx4[2];
+    g_w5500_last_spi_data = g_w5500_spi_rx4[3];
+    g_w5500_last_cs_bits = csBits;
+
+    return g_w5500_spi_rx4[3];
+}
+
+static void w5500_write8(uint16_t address, uint8_t bsb, uint8_t value)
+{
+    g_w5500_spi_tx4[0] = (uint8_t)(address >> 8);
+    g_w5500_spi_tx4[1] = (uint8_t)(address & 0xFF);
+    g_w5500_spi_tx4[2] = (uint8_t)((bsb << 3) | 0x04);
+    g_w5500_spi_tx4[3] = value;
+
+    w5500_spi_select();
+    spiSend(&SPID2, 4U, g_w5500_spi_tx4);
+    w5500_spi_unselect();
+    w5500_spi_meter(4U);
+}
+
+// SPI transaction list. Frames are staged back to back in the static buffers
+// below and w5500_chain_execute() clocks each one out as a single transfer
+// (header and data in one DMA setup) with no work in between. The W5500 ends
+// a frame on CS high, so a chain still costs one select per frame. Data too
+// large to stage goes straight from/to the caller's buffer after the staged
+// header; callers only do that with static or heap buffers, never the CCM
+// stack. Reads are copied out of the staging area once the chain has run.
+static const uint8_t kChainMaxFrames = 8;
+static const uint16_t kFrameHeaderBytes = 3;
+
+struct w5500_spi_frame_t
+{
+    uint16_t offset;                // frame start in g_w5500_chain_tx/rx
+    uint16_t stagedLength;          // header + staged data bytes
+    uint8_t* readOut;               // read destination, NULL for a write
+    const uint8_t* externalData;    // unstaged write payload
+    uint16_t externalLength;        // unstaged payload bytes (read or write)
+};
+
+static uint8_t g_w5500_chain_tx[W5500_SPI_CHAIN_BYTES];
+static uint8_t g_w5500_chain_rx[W5500_SPI_CHAIN_BYTES];
+static w5500_spi_frame_t g_w5500_chain[kChainMaxFrames];
+static uint8_t g_w5500_chain_frames = 0;
+static uint16_t g_w5500_chain_used = 0;
+
+static void w5500_chain_execute(void)
+{
+    for (uint8_t i = 0; i < g_w5500_chain_frames; i++)
+    {
+        const w5500_spi_frame_t* frame = &g_w5500_chain[i];
+        const bool stagedRead = frame->readOut != NULL && frame->externalLength == 0;
+
+        w5500_spi_select();
+        if (stagedRead)
+        {
+            spiExchange(&SPID2, frame->stagedLength, &g_w5500_chain_tx[frame->offset], &g_w5500_chain_rx[frame->offset]);
+        }
+        else
+        {
+            spiSend(&SPID2, frame->stagedLength, &g_w5500_chain_tx[frame->offset]);
+            if (frame->readOut != NULL)
+            {
+                spiReceive(&SPID2, frame->externalLength, frame->readOut);
+            }
+            else if (frame->externalLength > 0)
+            {
+                spiSend(&SPID2, frame->externalLength, frame->externalData);
+            }
+        }
+        w5500_spi_unselect();
+        w5500_spi_meter((uint32_t)frame->stagedLength + frame->externalLength);
+
+        if (stagedRead)
+        {
+            memcpy(frame->readOut, &g_w5500_chain_rx[frame->offset + kFrameHeaderBytes], frame->stagedLength - kFrameHeaderBytes);
+        }
+    }
+
+    g_w5500_chain_frames = 0;
+    g_w5500_chain_used = 0;
+}
+
+// Append a frame header with room for stagedData bytes behind it; runs the
+// pending chain first when it is full.
+static w5500_spi_frame_t* w5500_chain_add(uint16_t address, uint8_t bsb, bool write, uint16_t stagedData)
+{
+    if (g_w5500_chain_frames == kChainMaxFrames ||
+        (uint32_t)g_w5500_chain_used + kFrameHeaderBytes + stagedData > W5500_SPI_CHAIN_BYTES)
+    {
+        w5500_chain_execute();
+    }
+
+    w5500_spi_frame_t* frame = &g_w5500_chain[g_w5500_chain_frames++];
+    frame->offset = g_w5500_chain_used;
+    frame->stagedLength = (uint16_t)(kFrameHeaderBytes + stagedData);
+    frame->readOut = NULL;
+    frame->externalData = NULL;
+    frame->externalLength = 0;
+
+    uint8_t* header = &g_w5500_chain_tx[frame->offset];
+    header[0] = (uint8_t)(address >> 8);
+    header[1] = (uint8_t)(address & 0xFF);
+    header[2] = (uint8_t)((bsb << 3) | (write ? 0x04 : 0x00));
+
+    g_w5500_chain_used = (uint16_t)(g_w5500_chain_used + frame->stagedLength);
+    return frame;
+}
+
+static bool w5500_chain_can_stage(uint16_t length)
+{
+    return (uint32_t)kFrameHeaderBytes + length <= W5500_SPI_CHAIN_BYTES;
+}
+
+static void w5500_chain_read(uint16_t address, uint8_t bsb, uint8_t* out, uint16_t length)
+{
+    if (w5500_chain_can_stage(length))
+    {
+        w5500_spi_frame_t* frame = w5500_chain_add(address, bsb, false, length);
+        memset(&g_w5500_chain_tx[frame->offset + kFrameHeaderBytes], 0, length);
+        frame->readOut = out;
+        return;
+    }
+
+    w5500_spi_frame_t* frame = w5500_chain_add(address, bsb, false, 0);
+    frame->readOut = out;
+    frame->externalLength = length;
+}
+
+static void w5500_chain_write(uint16_t address, uint8_t bsb, const uint8_t* data, uint16_t length)
+{
+    if (w5500_chain_can_stage(length))
+    {
+        w5500_spi_frame_t* frame = w5500_chain_add(address, bsb, true, length);
+        memcpy(&g_w5500_chain_tx[frame->offset + kFrameHeaderBytes], data, length);
+        return;
+    }
+
+    w5500_spi_frame_t* frame = w5500_chain_add(address, bsb, true, 0);
+    frame->externalData = data;
+    frame->externalLength = length;
+}
+
+static void w5500_chain_write8(uint16_t address, uint8_t bsb, uint8_t value)
+{
+    w5500_chain_write(address, bsb, &value, 1);
+}
+
+static void w5500_chain_write16(uint16_t address, uint8_t bsb, uint16_t value)
+{
+    const uint8_t word[2] = {(uint8_t)(value >> 8), (uint8_t)(value & 0xFF)};
+    w5500_chain_write(address, bsb, word, 2);
+}
+
+static inline uint16_t w5500_be16(const uint8_t* bytes)
+{
+    return (uint16_t)((bytes[0] << 8) | bytes[1]);
+}
+
+static void w5500_read_buf(uint16_t address, uint8_t bsb, uint8_t* out, uint16_t length)
+{
+    w5500_chain_read(address, bsb, out, length);
+    w5500_chain_execute();
+}
+
+static void w5500_write_buf(uint16_t address, uint8_t bsb, const uint8_t* data, uint16_t length)
+{
+    w5500_chain_write(address, bsb, data, length);
+    w5500_chain_execute();
+}
+
+static uint16_t w5500_read16(uint16_t address, uint8_t bsb)
+{
+    uint8_t word[2];
+    w5500_read_buf(address, bsb, word, 2);
+    return w5500_be16(word);
+}
+
+static void w5500_write16(uint16_t address, uint8_t bsb, uint16_t value)
+{
+    w5500_chain_write16(address, bsb, value);
+    w5500_chain_execute();
+}
+
+static bool w5500_wait_command_done(uint8_t socket, int32_t timeoutMs)
+{
+    int32_t elapsed = 0;
+    while (w5500_read8(Sn_CR, socket_reg_bsb(socket)) != 0)
+    {
+        if (elapsed >= timeoutMs)
+        {
+            return false;
+        }
+
+        w5500_sleep_ms(1);
+        elapsed++;
+    }
+
+    return true;
+}
+
+static bool w5500_issue_socket_command(uint8_t socket, uint8_t command, int32_t timeoutMs)
+{
+    w5500_write8(Sn_CR, socket_reg_bsb(socket), command);
+    return w5500_wait_command_done(socket, timeoutMs);
+}
+
+static void w5500_keepalive_disable(uint8_t socket);
+
+// Forget mirrored bytes when the socket's stream ends or changes mode.
+static void w5500_rx_mirror_reset(uint8_t socket)
+{
+    g_rxMirror[socket].head = 0;
+    g_rxMirror[socket].count = 0;
+}
+
+static void w5500_socket_close(uint8_t socket)
+{
+    w5500_keepalive_disable(socket);
+    w5500_rx_mirror_reset(socket);
+    w5500_issue_socket_command(socket, W5500_CMD_CLOSE, 50);
+    w5500_write8(Sn_IR, socket_reg_bsb(socket), 0xFF);
+    g_socketIrLatched[socket] = 0;
+    g_socketSendPending[socket] = false;
+
+    // The DISCON just cleared is handed to a waiter on this socket instead
+    // (see w5500_wait_socket_ir); wake it rather than leave it to the safety poll.
+    g_socketEpoch[socket]++;
+    if (g_initialized)
+    {
+        chBSemSignal(&g_irqSem);
+    }
+}
+
+static void w5500_apply_buffer_sizes(void)
+{
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        w5500_write8(Sn_RXBUF_SIZE, socket_reg_bsb(socket), g_socketRxBufKb[socket]);
+        w5500_write8(Sn_TXBUF_SIZE, socket_reg_bsb(socket), g_socketTxBufKb[socket]);
+    }
+}
+
+// BR[2:0] for a divider of 2^(BR+1); -1 if not a power of two in 2-256.
+static int w5500_spi_divider_to_br(uint16_t divider)
+{
+    for (int br = 0; br < 8; br++)
+    {
+        if (divider == (uint16_t)(2U << br))
+        {
+            return br;
+        }
+    }
+
+    return -1;
+}
+
+// Keeps the CPOL/CPHA choice of the bring-up probe, replaces BR only.
+static void w5500_spi_apply_divider(uint16_t divider)
+{
+    int br = w5500_spi_divider_to_br(divider);
+    w5500_spi_set_cr1((uint16_t)((g_spi2cfg.cr1 & ~SPI_CR1_BR) | ((uint16_t)br * SPI_CR1_BR_0)));
+}
+
+static uint16_t w5500_spi_current_divider(void)
+{
+    return (uint16_t)(2U << ((g_spi2cfg.cr1 & SPI_CR1_BR) / SPI_CR1_BR_0));
+}
+
+static const uint16_t kSpiSlowestDivider = 256;
+static const uint8_t kSpiCalibrationRounds = 4;
+static const uint16_t kSpiCalibrationBytes = 128;
+
+// Static so the staged copies come from DMA-reachable SRAM either way.
+static uint8_t g_spiPatternOut[kSpiCalibrationBytes];
+static uint8_t g_spiPatternIn[kSpiCalibrationBytes];
+
+// Write a pattern to the scratch socket's TX buffer and read it back, plus a
+// VERSIONR read; a new pattern each round (edges, walking ones, counting).
+static bool w5500_spi_pattern_check(uint8_t scratchSocket)
+{
+    for (uint8_t round = 0; round < kSpiCalibrationRounds; round++)
+    {
+        for (uint16_t i = 0; i < kSpiCalibrationBytes; i++)
+        {
+            switch ((i + round) & 3U)
+            {
+                case 0: g_spiPatternOut[i] = (uint8_t)((i & 1U) != 0 ? 0x55 : 0xAA); break;
+                case 1: g_spiPatternOut[i] = (uint8_t)(1U << ((i + round) & 7U)); break;
+                case 2: g_spiPatternOut[i] = (uint8_t)~(1U << ((i + round) & 7U)); break;
+                default: g_spiPatternOut[i] = (uint8_t)(i * 37U + round); break;
+            }
+        }
+
+        memset(g_spiPatternIn, 0, sizeof(g_spiPatternIn));
+        w5500_chain_write(0, socket_tx_bsb(scratchSocket), g_spiPatternOut, kSpiCalibrationBytes);
+        w5500_chain_read(0, socket_tx_bsb(scratchSocket), g_spiPatternIn, kSpiCalibrationBytes);
+        w5500_chain_execute();
+
+        if (memcmp(g_spiPatternOut, g_spiPatternIn, kSpiCalibrationBytes) != 0 ||
+            w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON) != 0x04)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static w5500_socket_status_t w5500_spi_calibrate(uint16_t fastestDivider)
+{
+    uint8_t scratchSocket = kSocketCount;
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        if (g_socketTxBufKb[socket] > 0)
+        {
+            scratchSocket = socket;
+            break;
+        }
+    }
+
+    if (scratchSocket == kSocketCount)
+    {
+        return W5500_SOCKET_NOT_SUPPORTED;
+    }
+
+    // A speed that already fails the check is backed off before stepping up.
+    uint16_t good = 0;
+    for (uint16_t divider = w5500_spi_current_divider(); divider <= kSpiSlowestDivider; divider = (uint16_t)(divider * 2))
+    {
+        w5500_spi_apply_divider(divider);
+        if (w5500_spi_pattern_check(scratchSocket))
+        {
+            good = divider;
+            break;
+        }
+    }
+
+    if (good == 0)
+    {
+        set_w5500_last_native_error(0x4E, 0xEE, 0x00);
+        return W5500_SOCKET_IO_ERROR;
+    }
+
+    for (uint16_t divider = (uint16_t)(good / 2); divider >= fastestDivider && divider >= 2; divider = (uint16_t)(divider / 2))
+    {
+        w5500_spi_apply_divider(divider);
+        if (!w5500_spi_pattern_check(scratchSocket))
+        {
+            break;
+        }
+        good = divider;
+    }
+
+    w5500_spi_apply_divider(good);
+
+    // op 0x4E: calibrated SPI divider (detail = BR bits).
+    set_w5500_last_native_error(0x4E, (uint8_t)good, (uint8_t)w5500_spi_divider_to_br(good));
+    return W5500_SOCKET_OK;
+}
+
+static void w5500_int_callback(void *arg)
+{
+    (void)arg;
+
+    chSysLockFromISR();
+    chBSemSignalI(&g_irqSem);
+    chSysUnlockFromISR();
+}
+
+static void w5500_irq_setup(void)
+{
+    chBSemObjectInit(&g_irqSem, true);
+    palEnableLineEvent(W5500_INT_LINE, PAL_EVENT_MODE_FALLING_EDGE);
+    palSetLineCallback(W5500_INT_LINE, w5500_int_callback, NULL);
+}
+
+static void w5500_apply_io_mode(void)
+{
+    // Unmasking every socket in SIMR is enough: Sn_IMR selects the events per socket.
+    w5500_write8(W5500_SIMR, W5500_BSB_COMMON, g_ioMode == W5500_IO_INTERRUPT ? 0xFF : 0x00);
+}
+
+// Move pending Sn_IR bits into g_socketIrLatched and acknowledge them, which
+// releases INT so the next event produces a fresh falling edge. Without
+// force, an idle INT line (high) short-circuits the SPI reads, and the
+// waiting socket's Sn_IR is tried before the SIR scan: usually it is the one
+// that pulled INT low, and any other socket still holding INT low is picked
+// up by the next wait.
+static void w5500_service_interrupts(uint8_t waitingSocket, bool force)
+{
+    if (!force)
+    {
+        if (palReadLine(W5500_INT_LINE) != PAL_LOW)
+        {
+            return;
+        }
+
+        uint8_t ir = w5500_read8(Sn_IR, socket_reg_bsb(waitingSocket));
+        if (ir != 0)
+        {
+            w5500_write8(Sn_IR, socket_reg_bsb(waitingSocket), ir);
+            g_socketIrLatched[waitingSocket] |= ir;
+            return;
+        }
+    }
+
+    uint8_t sir = w5500_read8(W5500_SIR, W5500_BSB_COMMON);
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        if ((sir & (1U << socket)) == 0)
+        {
+            continue;
+        }
+
+        uint8_t ir = w5500_read8(Sn_IR, socket_reg_bsb(socket));
+        if (ir != 0)
+        {
+            w5500_write8(Sn_IR, socket_reg_bsb(socket), ir);
+            g_socketIrLatched[socket] |= ir;
+        }
+    }
+}
+
+static void w5500_link_probe_check(uint8_t waitingSocket);
+
+// Wait until one of the Sn_IR bits in mask is raised (and acknowledge it).
+// Returns the bits seen, 0 on timeout; a close of the socket by another
+// thread while waiting reads as DISCON. While the link probe is on, waits on
+// other sockets also answer the frames queued on socket 0.
+static uint8_t w5500_wait_socket_ir(uint8_t socket, uint8_t mask, sysinterval_t timeout)
+{
+    const systime_t start = chVTGetSystemTimeX();
+    const uint32_t epoch = g_socketEpoch[socket];
+
+    if (g_ioMode == W5500_IO_POLLED)
+    {
+        while (true)
+        {
+            if (g_socketEpoch[socket] != epoch)
+            {
+                return (uint8_t)(mask & W5500_IR_DISCON);
+            }
+
+            uint8_t ir = (uint8_t)(w5500_read8(Sn_IR, socket_reg_bsb(socket)) & mask);
+            if (ir != 0)
+            {
+                w5500_write8(Sn_IR, socket_reg_bsb(socket), ir);
+                return ir;
+            }
+
+            if (chVTTimeElapsedSinceX(start) >= timeout)
+            {
+                return 0;
+            }
+
+            w5500_link_probe_check(socket);
+            w5500_sleep_ms(1);
+        }
+    }
+
+    bool force = false;
+    while (true)
+    {
+        if (g_socketEpoch[socket] != epoch)
+        {
+            return (uint8_t)(mask & W5500_IR_DISCON);
+        }
+
+        w5500_service_interrupts(socket, force);
+
+        uint8_t ir = (uint8_t)(g_socketIrLatched[socket] & mask);
+        if (ir != 0)
+        {
+            g_socketIrLatched[socket] &= (uint8_t)~ir;
+            return ir;
+        }
+
+        w5500_link_probe_check(socket);
+
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= timeout)
+        {
+            return 0;
+        }
+
+        sysinterval_t wait = timeout - elapsed;
+        if (wait > TIME_MS2I(kIrqSafetyPollMs))
+        {
+            wait = TIME_MS2I(kIrqSafetyPollMs);
+        }
+
+        // A timed-out wait re-reads SIR over SPI in case the edge was lost.
+        w5500_lock_hold_t hold = w5500_lock_yield();
+        force = chBSemWaitTimeout(&g_irqSem, wait) != MSG_OK;
+        w5500_lock_reacquire(hold);
+    }
+}
+
+bool w5500_parse_ipv4(const char* text, uint8_t out[4])
+{
+    if (text == NULL)
+    {
+        return false;
+    }
+
+    int idx = 0;
+    int value = 0;
+    bool hasDigit = false;
+
+    for (const char* p = text; ; ++p)
+    {
+        char c = *p;
+
+        if (c >= '0' && c <= '9')
+        {
+            value = (value * 10) + (c - '0');
+            if (value > 255)
+            {
+                return false;
+            }
+            hasDigit = true;
+            continue;
+        }
+
+        if (c == '.' || c == '\0')
+        {
+            if (!hasDigit || idx > 3)
+            {
+                return false;
+            }
+
+            out[idx++] = (uint8_t)value;
+            value = 0;
+            hasDigit = false;
+
+            if (c == '\0')
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        return false;
+    }
+
+    return idx == 4;
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+
+    if (c >= 'A' && c <= 'F')
+    {
+        return 10 + (c - 'A');
+    }
+
+    if (c >= 'a' && c <= 'f')
+    {
+        return 10 + (c - 'a');
+    }
+
+    return -1;
+}
+
+bool w5500_parse_mac(const char* text, uint8_t out[6])
+{
+    if (text == NULL)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        int hi = hex_nibble(*text++);
+        int lo = hex_nibble(*text++);
+
+        if (hi < 0 || lo < 0)
+        {
+            return false;
+        }
+
+        out[i] = (uint8_t)((hi << 4) | lo);
+
+        if (i < 5)
+        {
+            if (*text++ != ':')
+            {
+                return false;
+            }
+        }
+    }
+
+    return *text == '\0';
+}
+
+static void w5500_apply_network_settings()
+{
+    w5500_write_buf(W5500_GAR, W5500_BSB_COMMON, g_networkGateway, 4);
+    w5500_write_buf(W5500_SUBR, W5500_BSB_COMMON, g_networkSubnet, 4);
+    w5500_write_buf(W5500_SHAR, W5500_BSB_COMMON, g_networkMac, 6);
+    w5500_write_buf(W5500_SIPR, W5500_BSB_COMMON, g_networkIp, 4);
+}
+
+uint8_t w5500_probe_version_minimal(uint8_t *outPhyCfgr)
+{
+    W5500Lock lock;
+
+    // Presence-only probe: configure pins/SPI, read VERSIONR and PHYCFGR, and
+    // avoid socket allocation and full hardware init side effects.
+    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_ALTERNATE(5));
+    palSetLineMode(PAL_LINE(GPIOB, 14U), PAL_MODE_ALTERNATE(5));
+    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_ALTERNATE(5));
+    palSetLineMode(W5500_CS_LINE, PAL_MODE_OUTPUT_PUSHPULL);
+    w5500_cs_gpio_release();
+    palSetLineMode(W5500_RESET_LINE, PAL_MODE_OUTPUT_PUSHPULL);
+    palSetLine(W5500_RESET_LINE);
+    palSetLineMode(W5500_INT_LINE, PAL_MODE_INPUT_PULLUP);
+
+    w5500_spi_start();
+    w5500_spi_set_cr1((uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0));
+
+    uint8_t version = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        version = w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
+        if (version == 0x04)
+        {
+            break;
+        }
+        chThdSleepMilliseconds(1);
+    }
+
+    const uint8_t phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+    w5500_spi_set_cr1(SPI_CR1_BR_1);
+
+    if (outPhyCfgr != NULL)
+    {
+        *outPhyCfgr = phycfgr;
+    }
+
+    set_w5500_last_native_error(0x56, version, phycfgr);
+    return version;
+}
+
+// Scope-assist GPIO checks (diagnostic profile only): a slow pulse train on
+// SCK/MOSI, then the PB12 software-drive check reported as op 0x49.
+static void w5500_diag_gpio_checks(void)
+{
+    // Scope-assist: Drive PB13 and PB15 as slow GPIO pulses for 500 ms so single-channel scope can catch them.
+    // This proves the physical probe paths and GPIO control work before enabling SPI peripheral.
+    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_OUTPUT_PUSHPULL);
+    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_OUTPUT_PUSHPULL);
+    for (int pulse = 0; pulse < 20; pulse++)
+    {
+        palSetLine(PAL_LINE(GPIOB, 13U));
+        palSetLine(PAL_LINE(GPIOB, 15U));
+        chThdSleepMilliseconds(12);
+        palClearLine(PAL_LINE(GPIOB, 13U));
+        palClearLine(PAL_LINE(GPIOB, 15U));
+        chThdSleepMilliseconds(12);
+    }
+    // Now switch back to AF5 for real SPI use.
+    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_ALTERNATE(5));  // SCK
+    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_ALTERNATE(5));  // MOSI
+
+    // op 0x49: PB12 software-drive sanity check (high->low->high).
+    // code bits: b2=readback after first high, b1=after low, b0=after final high.
+    // detail bits: high nibble=ODR snapshots (same phase order), low nibble=IDR snapshots.
+    uint8_t cs_hi1 = (palReadLine(W5500_CS_LINE) != 0) ? 1U : 0U;
+    w5500_cs_gpio_assert();
+    uint8_t cs_lo = (palReadLine(W5500_CS_LINE) != 0) ? 1U : 0U;
+    w5500_cs_gpio_release();
+    uint8_t cs_hi2 = (palReadLine(W5500_CS_LINE) != 0) ? 1U : 0U;
+    uint8_t odr_hi1 = (uint8_t)((GPIOB->ODR & (1U << 12U)) ? 1U : 0U);
+    w5500_cs_gpio_assert();
+    uint8_t odr_lo = (uint8_t)((GPIOB->ODR & (1U << 12U)) ? 1U : 0U);
+    w5500_cs_gpio_release();
+    uint8_t odr_hi2 = (uint8_t)((GPIOB->ODR & (1U << 12U)) ? 1U : 0U);
+    g_w5500_cs_gpio_code = (uint8_t)((cs_hi1 << 2) | (cs_lo << 1) | cs_hi2);
+    set_w5500_last_native_error(
+        0x49,
+        g_w5500_cs_gpio_code,
+        (uint8_t)(((odr_hi1 << 6) | (odr_lo << 5) | (odr_hi2 << 4)) | g_w5500_cs_gpio_code));
+}
+
+// Diagnostic profile: scope bursts around a slow hardware reset, then the
+// four-way SPI mode/speed probe. Returns the last VERSIONR read.
+static uint8_t w5500_diag_probe_version(void)
+{
+    // op 0x4B: SPI2 register state after start (CR1 high nibble, SR low nibble).
+    // If CR1 is 0, SPI2 likely never started.  SR bit 1 (TXE)=1 means TX buffer empty.
+    uint8_t cr1_bits = (uint8_t)((SPID2.config->cr1 & 0xF0) >> 4);
+    uint8_t sr_bits = (uint8_t)(SPI2->SR & 0x0F);
+    set_w5500_last_native_error(0x4B, cr1_bits, sr_bits);
+
+    // op 0x4C: run a long, slow SPI burst to make SCK/MOSI/CS visible on low-cost scopes.
+    set_w5500_last_native_error(0x4C, 0x01, 0x00);
+    w5500_scope_spi_clock_burst();
+    set_w5500_last_native_error(0x4C, 0x02, 0x00);
+
+    // Hardware reset: assert for 20 ms, then release and wait 50 ms for W5500 POR.
+    palClearLine(W5500_RESET_LINE);
+    chThdSleepMilliseconds(20);
+    palSetLine(W5500_RESET_LINE);
+    chThdSleepMilliseconds(50);
+
+    // op 0x4D: slow repeated VERSIONR stream summary for scope-limited MISO diagnosis.
+    // code=last VERSIONR byte seen, detail=count of non-zero VERSIONR samples across stream.
+    uint8_t streamLastVersion = 0;
+    uint8_t streamNonZeroCount = 0;
+    w5500_scope_versionr_stream(&streamLastVersion, &streamNonZeroCount);
+    set_w5500_last_native_error(0x4D, streamLastVersion, streamNonZeroCount);
+
+    // Probe SPI mode/speed combinations to isolate board-level timing/phase issues.
+    // code 0x00: mode0 fast  (~5.25 MHz)
+    // code 0x01: mode0 slow  (~164 kHz)
+    // code 0x02: mode3 slow  (~164 kHz)
+    // code 0x03: mode3 fast  (~5.25 MHz)
+    static const uint16_t kProbeCr1[] = {
+        SPI_CR1_BR_1,
+        (uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0),
+        (uint16_t)(SPI_CR1_BR_2 | SPI_CR1_BR_1 | SPI_CR1_BR_0 | SPI_CR1_CPOL | SPI_CR1_CPHA),
+        (uint16_t)(SPI_CR1_BR_1 | SPI_CR1_CPOL | SPI_CR1_CPHA)
+    };
+
+    static const uint8_t kProbeCode[] = {0x00, 0x01, 0x02, 0x03};
+
+    uint8_t version = 0;
+    uint8_t selectedProbeCode = 0xFF;
+
+    for (size_t p = 0; p < (sizeof(kProbeCr1) / sizeof(kProbeCr1[0])); p++)
+    {
+        w5500_spi_set_cr1(kProbeCr1[p]);
+        chThdSleepMilliseconds(2);
+
+        for (int i = 0; i < 3; i++)
+        {
+            version = w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
+            if (version == 0x04)
+            {
+                selectedProbeCode = kProbeCode[p];
+                break;
+            }
+            chThdSleepMilliseconds(2);
+        }
+
+        // op 0x47: per-probe VERSIONR sample.
+        // detail high nibble=CS transition bits, low nibble=raw SPI control echo low nibble.
+        set_w5500_last_native_error(
+            0x47,
+            (uint8_t)((kProbeCode[p] << 4) | (version & 0x0F)),
+            (uint8_t)((g_w5500_last_cs_bits << 4) | (g_w5500_cs_gpio_code & 0x0F)));
+
+        if (version == 0x04)
+        {
+            break;
+        }
+    }
+
+    if (selectedProbeCode != 0xFF)
+    {
+        // op 0x48: selected working probe code in detail.
+        set_w5500_last_native_error(0x48, 0x04, selectedProbeCode);
+    }
+
+    return version;
+}
+
+// Fast profile: a short hardware reset (RSTn >= 500 us), then VERSIONR in
+// mode 0 at the probe speed, polled every 1 ms until the PLL has locked.
+static uint8_t w5500_fast_probe_version(void)
+{
+    palClearLine(W5500_RESET_LINE);
+    chThdSleepMilliseconds(1);
+    palSetLine(W5500_RESET_LINE);
+
+    uint8_t version = 0;
+    for (uint32_t i = 0; i < kFastResetPollMs; i++)
+    {
+        chThdSleepMilliseconds(1);
+        version = w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
+        if (version == 0x04)
+        {
+            set_w5500_last_native_error(0x48, 0x04, 0x00);
+            break;
+        }
+    }
+
+    return version;
+}
+
+// Diagnostic profile PHY sequence: fixed settle delays and a readback after
+// every step (ops 0x44, 0x46, 0x43), polling the PHY reset every 10 ms.
+static void w5500_diag_configure_phy(uint8_t phycfgr)
+{
+    // Capture PHY mode immediately after hardware reset/probe, before MR software reset.
+    // Note: when OPMD=0 (HW mode), OPMDC field interpretation is limited; do not infer exact
+    // PMODE pin levels from OPMDC alone without physical measurement.
+    set_w5500_last_native_error(
+        0x44,
+        (uint8_t)((phycfgr & W5500_PHYCFGR_OPMDC_MASK) >> 3),
+        phycfgr);
+
+    w5500_write8(W5500_MR, W5500_BSB_COMMON, 0x80);
+    // Allow enough time for MR software reset to complete before touching PHYCFGR.
+    chThdSleepMilliseconds(50);
+
+    // Step 1: Write desired SW configuration with RST deasserted (bit7=1, active-low reset).
+    // Keep PHY out of reset while establishing OPMD/OPMDC.
+    w5500_write8(
+        W5500_PHYCFGR,
+        W5500_BSB_COMMON,
+        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | W5500_PHYCFGR_OPMDC_ALL_AUTO));
+    chThdSleepMilliseconds(10);
+
+    // op 0x46: readback after step-1 write. If OPMD=0 here, SW-mode write did not stick.
+    // Expected high bits: PHYCFGR[7:3]=11110b (RST=1, OPMD=1, OPMDC=6 = all-capable AN).
+    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+    set_w5500_last_native_error(0x46, (uint8_t)((phycfgr & W5500_PHYCFGR_OPMD) != 0 ? 0xA1 : 0xA0), phycfgr);
+
+    // Step 2: Trigger PHY reset (active-low): drive RST bit low while preserving SW mode bits.
+    w5500_write8(
+        W5500_PHYCFGR,
+        W5500_BSB_COMMON,
+        (uint8_t)(W5500_PHYCFGR_OPMD | W5500_PHYCFGR_OPMDC_ALL_AUTO));
+    chThdSleepMilliseconds(50);
+
+    // Intermediate readback (op 0x43): may still show RST=0 while reset is in progress.
+    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+    set_w5500_last_native_error(0x43, (uint8_t)((phycfgr & W5500_PHYCFGR_OPMD) != 0 ? 0xA1 : 0xA0), phycfgr);
+
+    // Poll until RST bit self-clears back to 1 (datasheet: ~3ms; observed to take longer in some runs).
+    // Timeout after 3 seconds, then continue. We always re-assert SW mode afterward.
+    for (int rst_poll = 0; rst_poll < 300; rst_poll++)
+    {
+        chThdSleepMilliseconds(10);
+        phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+        if ((phycfgr & W5500_PHYCFGR_RST) != 0)
+        {
+            break;
+        }
+    }
+}
+
+// Fast profile PHY sequence: each step waits only until the chip reports it
+// done (MR.RST, then PHYCFGR.RST), polled every 1 ms with the same 3 s cap.
+static void w5500_fast_configure_phy(void)
+{
+    w5500_write8(W5500_MR, W5500_BSB_COMMON, 0x80);
+    for (uint32_t i = 0; i < kFastResetPollMs; i++)
+    {
+        if ((w5500_read8(W5500_MR, W5500_BSB_COMMON) & 0x80) == 0)
+        {
+            break;
+        }
+        chThdSleepMilliseconds(1);
+    }
+
+    // OPMD/OPMDC are latched by the PHY reset, so write them with RST low.
+    w5500_write8(
+        W5500_PHYCFGR,
+        W5500_BSB_COMMON,
+        (uint8_t)(W5500_PHYCFGR_OPMD | W5500_PHYCFGR_OPMDC_ALL_AUTO));
+    for (int rst_poll = 0; rst_poll < 3000; rst_poll++)
+    {
+        chThdSleepMilliseconds(1);
+        if ((w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON) & W5500_PHYCFGR_RST) != 0)
+        {
+            break;
+        }
+    }
+}
+
+static w5500_socket_status_t w5500_hw_init()
+{
+    set_w5500_last_native_error(0x40, 0x00, 0x00);
+
+    const bool diagnostic = (g_initProfile == W5500_INIT_DIAGNOSTIC);
+
+    // Configure W5500 control pins.
+    // SPI2 pins (PB12-PB15) are already AF5 via board_cubley.h; no palSetLineMode needed.
+    // But explicitly enforce AF5 at runtime to catch any mux config issues.
+    palSetLineMode(PAL_LINE(GPIOB, 13U), PAL_MODE_ALTERNATE(5));  // SCK
+    palSetLineMode(PAL_LINE(GPIOB, 14U), PAL_MODE_ALTERNATE(5));  // MISO
+    palSetLineMode(PAL_LINE(GPIOB, 15U), PAL_MODE_ALTERNATE(5));  // MOSI
+    palSetLineMode(W5500_CS_LINE, PAL_MODE_OUTPUT_PUSHPULL);
+    w5500_cs_gpio_release();
+    palSetLineMode(W5500_RESET_LINE, PAL_MODE_OUTPUT_PUSHPULL);
+    palSetLineMode(W5500_INT_LINE, PAL_MODE_INPUT_PULLUP);
+
+    if (diagnostic)
+    {
+        w5500_diag_gpio_checks();
+    }
+
+    // Start hardware SPI2 driver (acquires bus, applies g_spi2cfg).
+    w5500_spi_start();
+
+    const uint8_t version = diagnostic ? w5500_diag_probe_version() : w5500_fast_probe_version();
+
+    // Always capture PHY config register for diagnostic mailbox.
+    uint8_t phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+
+    if (version != 0x04)
+    {
+        // Report raw VERSIONR and PHYCFGR for board-level diagnostics.
+        set_w5500_bringup_status(0xA0, version, phycfgr);
+        // op 0x41: code=VERSIONR read.
+        // detail high nibble=CS transition bits, low nibble=raw SPI control echo low nibble.
+        set_w5500_last_native_error(
+            0x41,
+            version,
+            (uint8_t)((g_w5500_last_cs_bits << 4) | (g_w5500_cs_gpio_code & 0x0F)));
+        // op 0x4A: raw RX bytes from last VERSIONR 4-byte frame.
+        // code=rx0, detail=rx1 (rx2/rx3 remain available via existing globals and op 0x41 context).
+        set_w5500_last_native_error(0x4A, g_w5500_last_spi_rx0, g_w5500_last_spi_rx1);
+        return (w5500_socket_status_t)(0x20 | (version & 0x0F));
+    }
+
+    if (diagnostic)
+    {
+        w5500_diag_configure_phy(phycfgr);
+    }
+    else
+    {
+        w5500_fast_configure_phy();
+    }
+
+    // Re-assert SW all-auto mode regardless of poll outcome to avoid depending on previous
+    // reset timing behavior.
+    w5500_write8(
+        W5500_PHYCFGR,
+        W5500_BSB_COMMON,
+        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | W5500_PHYCFGR_OPMDC_ALL_AUTO));
+    if (diagnostic)
+    {
+        chThdSleepMilliseconds(5);
+    }
+    phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+
+    // op 0x45: post-reset settled state after explicit SW-mode re-assert.
+    set_w5500_last_native_error(0x45, (uint8_t)((phycfgr & W5500_PHYCFGR_OPMD) != 0 ? 0xA1 : 0xA0), phycfgr);
+
+    w5500_apply_network_settings();
+    w5500_write16(W5500_RTR, W5500_BSB_COMMON, kDefaultRetryTime);
+    w5500_write8(W5500_RCR, W5500_BSB_COMMON, kDefaultRetryCount);
+
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        w5500_socket_close(socket);
+    }
+    w5500_apply_buffer_sizes();
+
+    // Leave the probe speed; calibration falls back to a slower divider (or
+    // keeps the default) rather than failing bring-up.
+    w5500_spi_apply_divider(W5500_SPI_DEFAULT_DIVIDER);
+#if W5500_SPI_CALIBRATE
+    w5500_spi_calibrate(W5500_SPI_FASTEST_DIVIDER);
+#endif
+
+    w5500_irq_setup();
+    w5500_apply_io_mode();
+
+    return W5500_SOCKET_OK;
+}
+
+bool w5500_is_initialized(void)
+{
+    return g_initialized;
+}
+
+w5500_socket_status_t w5500_init(void)
+{
+    W5500Lock lock;
+
+    if (g_initialized)
+    {
+        return W5500_SOCKET_OK;
+    }
+
+    const systime_t started = chVTGetSystemTimeX();
+    w5500_socket_status_t initStatus = w5500_hw_init();
+    if (initStatus == W5500_SOCKET_OK)
+    {
+        g_initialized = true;
+    }
+
+    g_initDurationUs = (uint32_t)TIME_I2US(chVTTimeElapsedSinceX(started));
+    const uint32_t durationMs = g_initDurationUs / 1000U;
+    g_w5500_init_timing =
+        0xD7000000u | ((uint32_t)g_initProfile << 16) | (durationMs > 0xFFFFU ? 0xFFFFU : durationMs);
+
+    if (initStatus == W5500_SOCKET_OK)
+    {
+        // op 0x4F: bring-up complete; code=profile, detail=duration in 10 ms units (capped).
+        const uint32_t tens = durationMs / 10U;
+        set_w5500_last_native_error(0x4F, (uint8_t)g_initProfile, (uint8_t)(tens > 0xFFU ? 0xFFU : tens));
+    }
+
+    return initStatus;
+}
+
+void w5500_set_init_profile(w5500_init_profile_t profile)
+{
+    g_initProfile = profile;
+}
+
+w5500_init_profile_t w5500_get_init_profile(void)
+{
+    return g_initProfile;
+}
+
+uint32_t w5500_get_init_duration_us(void)
+{
+    return g_initDurationUs;
+}
+
+extern "C" int cubley_w5500_early_init(void)
+{
+    return (int)w5500_init();
+}
+
+void w5500_set_network(const uint8_t ip[4], const uint8_t subnet[4], const uint8_t gateway[4], const uint8_t mac[6])
+{
+    W5500Lock lock;
+
+    memcpy(g_networkIp, ip, sizeof(g_networkIp));
+    memcpy(g_networkSubnet, subnet, sizeof(g_networkSubnet));
+    memcpy(g_networkGateway, gateway, sizeof(g_networkGateway));
+    memcpy(g_networkMac, mac, sizeof(g_networkMac));
+
+    if (g_initialized)
+    {
+        w5500_apply_network_settings();
+    }
+}
+
+uint8_t w5500_read_version(void)
+{
+    W5500Lock lock;
+
+    return w5500_read8(W5500_VERSIONR, W5500_BSB_COMMON);
+}
+
+uint8_t w5500_read_phycfgr(void)
+{
+    W5500Lock lock;
+
+    return w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+}
+
+uint8_t w5500_set_phy_mode(uint8_t opmdc)
+{
+    W5500Lock lock;
+
+    uint8_t phycfgr = 0;
+
+    // Keep PHY in software mode and deassert reset (RST=1) while programming OPMDC.
+    w5500_write8(
+        W5500_PHYCFGR,
+        W5500_BSB_COMMON,
+        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | (uint8_t)(opmdc << 3)));
+    chThdSleepMilliseconds(5);
+
+    // Trigger PHY reset (active-low RST=0) to apply mode change.
+    w5500_write8(
+        W5500_PHYCFGR,
+        W5500_BSB_COMMON,
+        (uint8_t)(W5500_PHYCFGR_OPMD | (uint8_t)(opmdc << 3)));
+
+    for (int rst_poll = 0; rst_poll < 300; rst_poll++)
+    {
+        chThdSleepMilliseconds(10);
+        phycfgr = w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+        if ((phycfgr & W5500_PHYCFGR_RST) != 0)
+        {
+            break;
+        }
+    }
+
+    // Re-assert same SW mode with reset deasserted.
+    w5500_write8(
+        W5500_PHYCFGR,
+        W5500_BSB_COMMON,
+        (uint8_t)(W5500_PHYCFGR_RST | W5500_PHYCFGR_OPMD | (uint8_t)(opmdc << 3)));
+    chThdSleepMilliseconds(5);
+
+    return w5500_read8(W5500_PHYCFGR, W5500_BSB_COMMON);
+}
+
+void w5500_set_io_mode(w5500_io_mode_t mode)
+{
+    W5500Lock lock;
+
+    g_ioMode = mode;
+
+    if (g_initialized)
+    {
+        w5500_apply_io_mode();
+    }
+}
+
+w5500_io_mode_t w5500_get_io_mode(void)
+{
+    return g_ioMode;
+}
+
+// Handed out by the pool or held by the link probe.
+static bool w5500_socket_in_use(uint8_t socket)
+{
+    return g_socketOpen[socket] || (g_linkProbeActive && socket == kLinkProbeSocket);
+}
+
+static bool w5500_valid_buffer_kb(uint8_t kb)
+{
+    return kb == 0 || kb == 1 || kb == 2 || kb == 4 || kb == 8 || kb == 16;
+}
+
+w5500_socket_status_t w5500_set_buffer_sizes(const uint8_t rxKb[W5500_SOCKET_COUNT], const uint8_t txKb[W5500_SOCKET_COUNT])
+{
+    W5500Lock lock;
+
+    uint32_t rxTotal = 0;
+    uint32_t txTotal = 0;
+
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        if (!w5500_valid_buffer_kb(rxKb[socket]) || !w5500_valid_buffer_kb(txKb[socket]))
+        {
+            return W5500_SOCKET_INVALID_PARAM;
+        }
+
+        rxTotal += rxKb[socket];
+        txTotal += txKb[socket];
+    }
+
+    if (rxTotal > kSocketBufferTotalKb || txTotal > kSocketBufferTotalKb)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    // Resizing moves every socket's buffer window, so it is only safe while all are idle.
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        if (w5500_socket_in_use(socket))
+        {
+            return W5500_SOCKET_BUSY;
+        }
+    }
+
+    memcpy(g_socketRxBufKb, rxKb, sizeof(g_socketRxBufKb));
+    memcpy(g_socketTxBufKb, txKb, sizeof(g_socketTxBufKb));
+
+    if (g_initialized)
+    {
+        w5500_apply_buffer_sizes();
+    }
+
+    return W5500_SOCKET_OK;
+}
+
+void w5500_get_buffer_sizes(uint8_t rxKb[W5500_SOCKET_COUNT], uint8_t txKb[W5500_SOCKET_COUNT])
+{
+    W5500Lock lock;
+
+    memcpy(rxKb, g_socketRxBufKb, sizeof(g_socketRxBufKb));
+    memcpy(txKb, g_socketTxBufKb, sizeof(g_socketTxBufKb));
+}
+
+w5500_socket_status_t w5500_set_spi_divider(uint16_t divider)
+{
+    W5500Lock lock;
+
+    if (w5500_spi_divider_to_br(divider) < 0)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    w5500_spi_prepare_config();
+    w5500_spi_apply_divider(divider);
+    return W5500_SOCKET_OK;
+}
+
+uint16_t w5500_get_spi_divider(void)
+{
+    W5500Lock lock;
+
+    w5500_spi_prepare_config();
+    return w5500_spi_current_divider();
+}
+
+uint32_t w5500_get_spi_clock_hz(void)
+{
+    return STM32_PCLK1 / w5500_get_spi_divider();
+}
+
+w5500_socket_status_t w5500_calibrate_spi(uint16_t fastestDivider, uint16_t* outDivider)
+{
+    W5500Lock lock;
+
+    if (w5500_spi_divider_to_br(fastestDivider) < 0)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    if (!g_initialized)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        if (w5500_socket_in_use(socket))
+        {
+            return W5500_SOCKET_BUSY;
+        }
+    }
+
+    w5500_socket_status_t status = w5500_spi_calibrate(fastestDivider);
+    *outDivider = w5500_spi_current_divider();
+    return status;
+}
+
+w5500_socket_status_t w5500_socket_open(uint8_t* outSocket)
+{
+    W5500Lock lock;
+
+    if (!g_initialized)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    for (uint8_t socket = 0; socket < kSocketCount; socket++)
+    {
+        if (!w5500_socket_in_use(socket) && g_socketRxBufKb[socket] != 0 && g_socketTxBufKb[socket] != 0)
+        {
+            g_socketOpen[socket] = true;
+            *outSocket = socket;
+            return W5500_SOCKET_OK;
+        }
+    }
+
+    return W5500_SOCKET_BUSY;
+}
+
+static void w5500_reconnect_detach(uint8_t socket);
+
+w5500_socket_status_t w5500_socket_release(uint8_t socket)
+{
+    W5500Lock lock;
+
+    if (socket >= kSocketCount || !g_socketOpen[socket])
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    w5500_reconnect_detach(socket);
+
+    if (g_initialized)
+    {
+        w5500_socket_disconnect(socket);
+    }
+
+    g_socketOpen[socket] = false;
+    return W5500_SOCKET_OK;
+}
+
+bool w5500_socket_is_open(uint8_t socket)
+{
+    return socket < kSocketCount && g_socketOpen[socket];
+}
+
+bool w5500_socket_is_connected(uint8_t socket)
+{
+    W5500Lock lock;
+
+    uint8_t status = w5500_read8(Sn_SR, socket_reg_bsb(socket));
+    return status == W5500_SOCK_ESTABLISHED || status == W5500_SOCK_CLOSE_WAIT;
+}
+
+void w5500_socket_disconnect(uint8_t socket)
+{
+    W5500Lock lock;
+
+    w5500_issue_socket_command(socket, W5500_CMD_DISCON, 100);
+    w5500_socket_close(socket);
+}
+
+// Reopen the socket in TCP mode on the next source port (Sn_SR = INIT).
+static w5500_socket_status_t w5500_tcp_open(uint8_t socket)
+{
+    if (!w5500_issue_socket_command(socket, W5500_CMD_CLOSE, 100))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    w5500_write8(Sn_MR, socket_reg_bsb(socket), W5500_SOCK_MODE_TCP);
+    w5500_write16(Sn_PORT, socket_reg_bsb(socket), g_nextSourcePort++);
+
+    if (!w5500_issue_socket_command(socket, W5500_CMD_OPEN, 200))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    if (w5500_read8(Sn_SR, socket_reg_bsb(socket)) != W5500_SOCK_INIT)
+    {
+        return W5500_SOCKET_IO_ERROR;
+    }
+
+    return W5500_SOCKET_OK;
+}
+
+// Send the SYN from INIT; the handshake completes in the background.
+static w5500_socket_status_t w5500_tcp_issue_connect(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort)
+{
+    w5500_write_buf(Sn_DIPR, socket_reg_bsb(socket), remoteIp, 4);
+    w5500_write16(Sn_DPORT, socket_reg_bsb(socket), remotePort);
+    w5500_write8(Sn_IMR, socket_reg_bsb(socket), W5500_IR_ALL);
+    w5500_write8(Sn_IR, socket_reg_bsb(socket), 0xFF);
+    g_socketIrLatched[socket] = 0;
+    g_socketSendPending[socket] = false;
+    w5500_keepalive_disable(socket);
+    w5500_rx_mirror_reset(socket);
+
+    if (!w5500_issue_socket_command(socket, W5500_CMD_CONNECT, 200))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    return W5500_SOCKET_OK;
+}
+
+w5500_socket_status_t w5500_connect(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort, int32_t timeoutMs)
+{
+    W5500Lock lock;
+
+    if (g_reconnect[socket].active)
+    {
+        return W5500_SOCKET_BUSY;
+    }
+
+    w5500_socket_status_t status = w5500_tcp_open(socket);
+    if (status == W5500_SOCKET_OK)
+    {
+        status = w5500_tcp_issue_connect(socket, remoteIp, remotePort);
+    }
+
+    if (status != W5500_SOCKET_OK)
+    {
+        return status;
+    }
+
+    // CON on ESTABLISHED; TIMEOUT/DISCON when the SYN is refused or unanswered.
+    uint8_t ir = w5500_wait_socket_ir(socket, (uint8_t)(W5500_IR_CON | W5500_IR_DISCON | W5500_IR_TIMEOUT),
+                                      timeoutMs > 0 ? TIME_MS2I(timeoutMs) : TIME_IMMEDIATE);
+    if ((ir & W5500_IR_CON) != 0)
+    {
+        return W5500_SOCKET_OK;
+    }
+
+    return W5500_SOCKET_TIMEOUT;
+}
+
+// Wait for the SENDOK of a SEND left in flight by w5500_send_stream(). TIMEOUT
+// (still pending) when it does not come in time, or when TIMEOUT/DISCON ends it.
+static w5500_socket_status_t w5500_send_collect(uint8_t socket, sysinterval_t timeout)
+{
+    if (!g_socketSendPending[socket])
+    {
+        return W5500_SOCKET_OK;
+    }
+
+    uint8_t ir = w5500_wait_socket_ir(socket, (uint8_t)(W5500_IR_SENDOK | W5500_IR_TIMEOUT | W5500_IR_DISCON), timeout);
+    if (ir == 0)
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    g_socketSendPending[socket] = false;
+    return (ir & W5500_IR_SENDOK) != 0 ? W5500_SOCKET_OK : W5500_SOCKET_TIMEOUT;
+}
+
+w5500_socket_status_t w5500_send(uint8_t socket, const uint8_t* data, uint16_t length)
+{
+    W5500Lock lock;
+
+    // Sn_TX_FSR can never reach more than the socket's buffer size.
+    if ((uint32_t)length > (uint32_t)g_socketTxBufKb[socket] * 1024U)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    W5500SendBusy busy(socket);
+    w5500_socket_status_t pending = w5500_send_collect(socket, TIME_MS2I(2000));
+    if (pending != W5500_SOCKET_OK)
+    {
+        return pending;
+    }
+
+    // Sn_SR plus Sn_TX_FSR..Sn_TX_WR (0x20-0x25, contiguous) in one chain.
+    uint8_t status = 0;
+    uint8_t txRegs[6];
+    w5500_chain_read(Sn_SR, socket_reg_bsb(socket), &status, 1);
+    w5500_chain_read(Sn_TX_FSR, socket_reg_bsb(socket), txRegs, sizeof(txRegs));
+    w5500_chain_execute();
+
+    if (status != W5500_SOCK_ESTABLISHED && status != W5500_SOCK_CLOSE_WAIT)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    int32_t elapsed = 0;
+    uint16_t freeSize = w5500_be16(&txRegs[0]);
+    while (freeSize < length)
+    {
+        if (elapsed >= 2000)
+        {
+            return W5500_SOCKET_TIMEOUT;
+        }
+        w5500_sleep_ms(1);
+        elapsed++;
+        freeSize = w5500_read16(Sn_TX_FSR, socket_reg_bsb(socket));
+    }
+
+    // Payload, new Sn_TX_WR and SEND in one chain. Sn_CR is not polled
+    // afterwards: SENDOK (or TIMEOUT/DISCON) below shows the command ran.
+    uint16_t writePtr = w5500_be16(&txRegs[4]);
+    w5500_chain_write(writePtr, socket_tx_bsb(socket), data, length);
+    w5500_chain_write16(Sn_TX_WR, socket_reg_bsb(socket), (uint16_t)(writePtr + length));
+    w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_SEND);
+    w5500_chain_execute();
+    g_socketLastTx[socket] = chVTGetSystemTimeX();
+
+    uint8_t ir = w5500_wait_socket_ir(socket, (uint8_t)(W5500_IR_SENDOK | W5500_IR_TIMEOUT | W5500_IR_DISCON), TIME_MS2I(2000));
+    if ((ir & W5500_IR_SENDOK) != 0)
+    {
+        return W5500_SOCKET_OK;
+    }
+
+    return W5500_SOCKET_TIMEOUT;
+}
+
+static sysinterval_t w5500_timeout_interval(int32_t timeoutMs)
+{
+    return timeoutMs > 0 ? TIME_MS2I(timeoutMs) : TIME_IMMEDIATE;
+}
+
+static sysinterval_t w5500_time_left(systime_t start, sysinterval_t timeout)
+{
+    sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+    return elapsed >= timeout ? TIME_IMMEDIATE : (sysinterval_t)(timeout - elapsed);
+}
+
+w5500_socket_status_t w5500_send_stream(uint8_t socket, const uint8_t* data, uint32_t length, uint8_t flags,
+                                        int32_t timeoutMs, uint32_t* outSent)
+{
+    W5500Lock lock;
+
+    *outSent = 0;
+    if (timeoutMs < 0 || (flags & (uint8_t)~W5500_SEND_NO_WAIT) != 0)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    const systime_t start = chVTGetSystemTimeX();
+    const sysinterval_t timeout = w5500_timeout_interval(timeoutMs);
+    W5500SendBusy busy(socket);
+    w5500_socket_status_t result = W5500_SOCKET_OK;
+
+    while (*outSent < length)
+    {
+        uint8_t status = 0;
+        uint8_t txRegs[6];
+        w5500_chain_read(Sn_SR, socket_reg_bsb(socket), &status, 1);
+        w5500_chain_read(Sn_TX_FSR, socket_reg_bsb(socket), txRegs, sizeof(txRegs));
+        w5500_chain_execute();
+
+        if (status != W5500_SOCK_ESTABLISHED && status != W5500_SOCK_CLOSE_WAIT)
+        {
+            return W5500_SOCKET_NOT_INITIALIZED;
+        }
+
+        uint32_t remaining = length - *outSent;
+        uint16_t freeSize = w5500_be16(&txRegs[0]);
+        uint16_t chunk = remaining < freeSize ? (uint16_t)remaining : freeSize;
+        // With more to come, stop at half the buffer so the other half can be
+        // filled while this chunk is on the wire.
+        uint16_t half = (uint16_t)(g_socketTxBufKb[socket] * 512U);
+        if (remaining > freeSize && chunk > half)
+        {
+            chunk = half;
+        }
+
+        if (chunk == 0)
+        {
+            if (chVTTimeElapsedSinceX(start) >= timeout)
+            {
+                return W5500_SOCKET_TIMEOUT;
+            }
+
+            // Space comes back as the chip finishes the SEND in flight (or, with
+            // none, as the peer acknowledges what is already on the wire).
+            if (g_socketSendPending[socket])
+            {
+                result = w5500_send_collect(socket, w5500_time_left(start, timeout));
+                if (result != W5500_SOCKET_OK)
+                {
+                    return result;
+                }
+            }
+            else
+            {
+                w5500_sleep_ms(1);
+            }
+            continue;
+        }
+
+        // The chip masks buffer addresses to the socket's TX size, so a chunk
+        // may run past the end of the buffer and the 16-bit pointer may wrap.
+        uint16_t writePtr = w5500_be16(&txRegs[4]);
+        w5500_chain_write(writePtr, socket_tx_bsb(socket), data + *outSent, chunk);
+        if (g_socketSendPending[socket])
+        {
+            // Copy while the previous chunk is on the wire; commit it after its SENDOK.
+            w5500_chain_execute();
+            result = w5500_send_collect(socket, w5500_time_left(start, timeout));
+            if (result != W5500_SOCKET_OK)
+            {
+                return result;
+            }
+        }
+        w5500_chain_write16(Sn_TX_WR, socket_reg_bsb(socket), (uint16_t)(writePtr + chunk));
+        w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_SEND);
+        w5500_chain_execute();
+
+        g_socketSendPending[socket] = true;
+        g_socketLastTx[socket] = chVTGetSystemTimeX();
+        *outSent += chunk;
+    }
+
+    if ((flags & W5500_SEND_NO_WAIT) != 0)
+    {
+        return W5500_SOCKET_OK;
+    }
+
+    return w5500_send_collect(socket, w5500_time_left(start, timeout));
+}
+
+// Issue RECV for everything before readPtr + length (already copied or dropped).
+static bool w5500_rx_consume(uint8_t socket, uint16_t readPtr, uint16_t length)
+{
+    w5500_chain_write16(Sn_RX_RD, socket_reg_bsb(socket), (uint16_t)(readPtr + length));
+    w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_RECV);
+    w5500_chain_execute();
+    g_rxStats.recvCommands++;
+    return w5500_wait_command_done(socket, 100);
+}
+
+// Move as much of what the chip holds as fits into the socket's mirror: one
+// burst (two when the ring wraps), Sn_RX_RD and RECV in a single chain.
+static bool w5500_rx_mirror_fill(uint8_t socket, uint16_t available, uint16_t readPtr)
+{
+    w5500_rx_mirror_t* mirror = &g_rxMirror[socket];
+    uint16_t length = (uint16_t)(W5500_RX_MIRROR_BYTES - mirror->count);
+    if (available < length)
+    {
+        length = available;
+    }
+
+    if (length == 0)
+    {
+        return true;
+    }
+
+    uint16_t tail = (uint16_t)((mirror->head + mirror->count) & kRxMirrorMask);
+    uint16_t first = (uint16_t)(W5500_RX_MIRROR_BYTES - tail);
+    if (first > length)
+    {
+        first = length;
+    }
+
+    w5500_chain_read(readPtr, socket_rx_bsb(socket), &mirror->data[tail], first);
+    if (length > first)
+    {
+        w5500_chain_read((uint16_t)(readPtr + first), socket_rx_bsb(socket), mirror->data, (uint16_t)(length - first));
+    }
+
+    mirror->count = (uint16_t)(mirror->count + length);
+    return w5500_rx_consume(socket, readPtr, length);
+}
+
+// Copy up to maxLength mirrored bytes to out (NULL drops them); returns the count.
+static uint16_t w5500_rx_mirror_take(uint8_t socket, uint8_t* out, uint16_t maxLength)
+{
+    w5500_rx_mirror_t* mirror = &g_rxMirror[socket];
+    uint16_t length = mirror->count < maxLength ? mirror->count : maxLength;
+
+    if (out != NULL)
+    {
+        uint16_t first = (uint16_t)(W5500_RX_MIRROR_BYTES - mirror->head);
+        if (first > length)
+        {
+            first = length;
+        }
+
+        memcpy(out, &mirror->data[mirror->head], first);
+        memcpy(out + first, mirror->data, (size_t)(length - first));
+        g_rxStats.mirrorBytes += length;
+    }
+
+    mirror->head = (uint16_t)((mirror->head + length) & kRxMirrorMask);
+    mirror->count = (uint16_t)(mirror->count - length);
+    return length;
+}
+
+// Copy the first length mirrored bytes to out without consuming them.
+static void w5500_rx_mirror_peek(uint8_t socket, uint8_t* out, uint16_t length)
+{
+    const w5500_rx_mirror_t* mirror = &g_rxMirror[socket];
+    for (uint16_t i = 0; i < length; i++)
+    {
+        out[i] = mirror->data[(mirror->head + i) & kRxMirrorMask];
+    }
+}
+
+// Nothing more will arrive on the connection: closed, or the peer's FIN is in
+// (CLOSE_WAIT) and everything before it has been read.
+static bool w5500_rx_at_end(uint8_t socket)
+{
+    uint8_t status = w5500_read8(Sn_SR, socket_reg_bsb(socket));
+    return status == W5500_SOCK_CLOSED || status == W5500_SOCK_CLOSE_WAIT;
+}
+
+// Copy whatever is pending (up to maxLength) once data arrives before start + timeout.
+static w5500_socket_status_t w5500_receive_until(uint8_t socket, uint8_t* buffer, uint16_t maxLength,
+                                                 systime_t start, sysinterval_t timeout, uint16_t* outReceived)
+{
+    const uint32_t epoch = g_socketEpoch[socket];
+    *outReceived = 0;
+
+    while (true)
+    {
+        // Closed (and maybe reconnected) while waiting: that stream is over.
+        if (g_socketEpoch[socket] != epoch)
+        {
+            return W5500_SOCKET_NOT_INITIALIZED;
+        }
+
+        // Mirrored bytes come first; they were taken off the chip before anything still on it.
+        if (g_rxMirror[socket].count > 0)
+        {
+            *outReceived = w5500_rx_mirror_take(socket, buffer, maxLength);
+            return W5500_SOCKET_OK;
+        }
+
+        // Sn_RX_RSR and Sn_RX_RD are adjacent (0x26-0x29): one frame.
+        uint8_t rxRegs[4];
+        w5500_read_buf(Sn_RX_RSR, socket_reg_bsb(socket), rxRegs, sizeof(rxRegs));
+        uint16_t available = w5500_be16(&rxRegs[0]);
+        uint16_t readPtr = w5500_be16(&rxRegs[2]);
+        if (available > 0)
+        {
+            // A small read out of a larger backlog prefetches the backlog, so the
+            // reads after it cost no SPI.
+            if (g_rxMirrorEnabled && maxLength < available && maxLength < W5500_RX_MIRROR_BYTES)
+            {
+                if (!w5500_rx_mirror_fill(socket, available, readPtr))
+                {
+                    return W5500_SOCKET_TIMEOUT;
+                }
+                continue;
+            }
+
+            uint16_t toRead = available;
+            if (toRead > maxLength)
+            {
+                toRead = maxLength;
+            }
+
+            w5500_chain_read(readPtr, socket_rx_bsb(socket), buffer, toRead);
+            if (!w5500_rx_consume(socket, readPtr, toRead))
+            {
+                return W5500_SOCKET_TIMEOUT;
+            }
+
+            *outReceived = toRead;
+            return W5500_SOCKET_OK;
+        }
+
+        if (w5500_rx_at_end(socket))
+        {
+            return W5500_SOCKET_NOT_INITIALIZED;
+        }
+
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= timeout)
+        {
+            return W5500_SOCKET_TIMEOUT;
+        }
+
+        // RECV for new data; DISCON/TIMEOUT so a dropped peer is seen via Sn_SR above.
+        w5500_wait_socket_ir(socket, (uint8_t)(W5500_IR_RECV | W5500_IR_DISCON | W5500_IR_TIMEOUT), timeout - elapsed);
+    }
+}
+
+w5500_socket_status_t w5500_receive(uint8_t socket, uint8_t* buffer, uint16_t maxLength, int32_t timeoutMs, uint16_t* outReceived)
+{
+    W5500Lock lock;
+    W5500RxMeter meter;
+
+    w5500_socket_status_t status = w5500_receive_until(socket, buffer, maxLength, chVTGetSystemTimeX(),
+                                                       w5500_timeout_interval(timeoutMs), outReceived);
+    meter.delivered(*outReceived);
+    return status;
+}
+
+// Appends to *inOutReceived until it reaches length or the shared deadline passes.
+static w5500_socket_status_t w5500_receive_exact_until(uint8_t socket, uint8_t* buffer, uint16_t length,
+                                                       systime_t start, sysinterval_t timeout, uint16_t* inOutReceived)
+{
+    while (*inOutReceived < length)
+    {
+        uint16_t chunk = 0;
+        w5500_socket_status_t status = w5500_receive_until(socket, buffer + *inOutReceived,
+                                                           (uint16_t)(length - *inOutReceived), start, timeout, &chunk);
+        *inOutReceived = (uint16_t)(*inOutReceived + chunk);
+        if (status != W5500_SOCKET_OK)
+        {
+            return status;
+        }
+    }
+
+    return W5500_SOCKET_OK;
+}
+
+w5500_socket_status_t w5500_receive_exact(uint8_t socket, uint8_t* buffer, uint16_t length, int32_t timeoutMs, uint16_t* outReceived)
+{
+    W5500Lock lock;
+    W5500RxMeter meter;
+
+    *outReceived = 0;
+    w5500_socket_status_t status = w5500_receive_exact_until(socket, buffer, length, chVTGetSystemTimeX(),
+                                                             w5500_timeout_interval(timeoutMs), outReceived);
+    meter.delivered(*outReceived);
+    return status;
+}
+
+// Fixed-header length (2-5) once the remaining-length varint is complete,
+// 0 while more bytes are needed, -1 for a varint longer than 4 bytes.
+static int w5500_mqtt_parse_header(const uint8_t* header, uint16_t count, uint32_t* outRemaining)
+{
+    uint32_t value = 0;
+    for (uint16_t i = 1; i < count; i++)
+    {
+        value |= (uint32_t)(header[i] & 0x7F) << (7 * (i - 1));
+        if ((header[i] & 0x80) == 0)
+        {
+            *outRemaining = value;
+            return i + 1;
+        }
+
+        if (i == W5500_MQTT_MAX_HEADER_BYTES - 1)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static bool w5500_keepalive_pingresp(uint8_t socket, const uint8_t* header);
+
+static w5500_socket_status_t w5500_receive_mqtt_frame_until(uint8_t socket, uint8_t* buffer, uint16_t maxLength,
+                                                            systime_t start, sysinterval_t timeout, uint16_t* outLength)
+{
+    // With the mirror the header is parsed from RAM and the stream is read
+    // through it; without it the header is peeked in the chip's RX buffer.
+    // Bytes left mirrored from before the mirror was switched off still count.
+    const bool mirrored = g_rxMirrorEnabled || g_rxMirror[socket].count > 0;
+    uint8_t header[W5500_MQTT_MAX_HEADER_BYTES];
+    uint16_t peeked = 0;
+    uint16_t available = 0;
+    uint16_t readPtr = 0;
+    uint32_t remaining = 0;
+    int headerLength = 0;
+    const uint32_t epoch = g_socketEpoch[socket];
+
+    *outLength = 0;
+
+    // Peek until the fixed header is complete; nothing is consumed yet, so a
+    // timeout here leaves the stream framed.
+    while (true)
+    {
+        if (g_socketEpoch[socket] != epoch)
+        {
+            return W5500_SOCKET_NOT_INITIALIZED;
+        }
+
+        if (mirrored)
+        {
+            // Only go to the chip when the mirror has nothing new: packets
+            // that arrived together are framed without any SPI.
+            if (g_rxMirror[socket].count <= peeked)
+            {
+                uint8_t rxRegs[4];
+                w5500_read_buf(Sn_RX_RSR, socket_reg_bsb(socket), rxRegs, sizeof(rxRegs));
+                if (!w5500_rx_mirror_fill(socket, w5500_be16(&rxRegs[0]), w5500_be16(&rxRegs[2])))
+                {
+                    return W5500_SOCKET_TIMEOUT;
+                }
+            }
+            available = g_rxMirror[socket].count;
+        }
+        else
+        {
+            uint8_t rxRegs[4];
+            w5500_read_buf(Sn_RX_RSR, socket_reg_bsb(socket), rxRegs, sizeof(rxRegs));
+            available = w5500_be16(&rxRegs[0]);
+            readPtr = w5500_be16(&rxRegs[2]);
+        }
+
+        if (available > peeked)
+        {
+            peeked = available < W5500_MQTT_MAX_HEADER_BYTES ? available : W5500_MQTT_MAX_HEADER_BYTES;
+            if (mirrored)
+            {
+                w5500_rx_mirror_peek(socket, header, peeked);
+            }
+            else
+            {
+                w5500_read_buf(readPtr, socket_rx_bsb(socket), header, peeked);
+            }
+
+            headerLength = w5500_mqtt_parse_header(header, peeked, &remaining);
+            if (headerLength < 0)
+            {
+                return W5500_SOCKET_IO_ERROR;
+            }
+
+            // The answer to a natively injected PINGREQ is dropped here.
+            if (headerLength > 0 && w5500_keepalive_pingresp(socket, header))
+            {
+                if (mirrored)
+                {
+                    w5500_rx_mirror_take(socket, NULL, (uint16_t)headerLength);
+                }
+                else if (!w5500_rx_consume(socket, readPtr, (uint16_t)headerLength))
+                {
+                    return W5500_SOCKET_TIMEOUT;
+                }
+                peeked = 0;
+                continue;
+            }
+
+            if (headerLength > 0)
+            {
+                break;
+            }
+        }
+        else if (w5500_rx_at_end(socket))
+        {
+            return W5500_SOCKET_NOT_INITIALIZED;
+        }
+
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= timeout)
+        {
+            return W5500_SOCKET_TIMEOUT;
+        }
+
+        w5500_wait_socket_ir(socket, (uint8_t)(W5500_IR_RECV | W5500_IR_DISCON | W5500_IR_TIMEOUT), timeout - elapsed);
+    }
+
+    // Packets beyond 64 KB are not used by this firmware's MQTT traffic.
+    if (remaining > 0xFFFEu)
+    {
+        return W5500_SOCKET_IO_ERROR;
+    }
+
+    const uint16_t frameLength = (uint16_t)(1 + remaining);
+    if (frameLength > maxLength)
+    {
+        *outLength = frameLength;
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    buffer[0] = header[0];
+
+    // Whatever of the body is mirrored is copied from RAM; the rest streams
+    // in under the same deadline.
+    if (mirrored)
+    {
+        w5500_rx_mirror_take(socket, NULL, (uint16_t)headerLength);
+        *outLength = (uint16_t)(1 + w5500_rx_mirror_take(socket, buffer + 1, (uint16_t)remaining));
+        return w5500_receive_exact_until(socket, buffer, frameLength, start, timeout, outLength);
+    }
+
+    // Common case: the whole packet is already buffered, so the body is one
+    // burst read and the header and body are released with a single RECV.
+    if (available >= headerLength + remaining)
+    {
+        if (remaining > 0)
+        {
+            w5500_chain_read((uint16_t)(readPtr + headerLength), socket_rx_bsb(socket), buffer + 1, (uint16_t)remaining);
+        }
+
+        *outLength = frameLength;
+        return w5500_rx_consume(socket, readPtr, (uint16_t)(headerLength + remaining)) ? W5500_SOCKET_OK : W5500_SOCKET_TIMEOUT;
+    }
+
+    // Body still arriving (or larger than the RX buffer): drop the header and
+    // stream the body under the same deadline.
+    *outLength = 1;
+    if (!w5500_rx_consume(socket, readPtr, (uint16_t)headerLength))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    return w5500_receive_exact_until(socket, buffer, frameLength, start, timeout, outLength);
+}
+
+w5500_socket_status_t w5500_receive_mqtt_frame(uint8_t socket, uint8_t* buffer, uint16_t maxLength, int32_t timeoutMs, uint16_t* outLength)
+{
+    W5500Lock lock;
+    W5500RxMeter meter;
+
+    w5500_socket_status_t status = w5500_receive_mqtt_frame_until(socket, buffer, maxLength, chVTGetSystemTimeX(),
+                                                                  w5500_timeout_interval(timeoutMs), outLength);
+    // INVALID_PARAM reports the required length, nothing was delivered.
+    meter.delivered(status == W5500_SOCKET_INVALID_PARAM ? 0 : *outLength);
+    return status;
+}
+
+w5500_socket_status_t w5500_peek_available(uint8_t socket, uint16_t* outAvailable)
+{
+    W5500Lock lock;
+    W5500RxMeter meter;
+
+    uint32_t available = (uint32_t)g_rxMirror[socket].count + w5500_read16(Sn_RX_RSR, socket_reg_bsb(socket));
+    *outAvailable = available > 0xFFFFu ? 0xFFFFu : (uint16_t)available;
+    if (*outAvailable == 0 && w5500_read8(Sn_SR, socket_reg_bsb(socket)) == W5500_SOCK_CLOSED)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    return W5500_SOCKET_OK;
+}
+
+void w5500_set_rx_mirror(bool enable)
+{
+    W5500Lock lock;
+
+    g_rxMirrorEnabled = enable;
+}
+
+bool w5500_get_rx_mirror(void)
+{
+    return g_rxMirrorEnabled;
+}
+
+void w5500_get_rx_stats(w5500_rx_stats_t* outStats)
+{
+    W5500Lock lock;
+
+    memcpy(outStats, &g_rxStats, sizeof(*outStats));
+}
+
+void w5500_reset_rx_stats(void)
+{
+    W5500Lock lock;
+
+    memset(&g_rxStats, 0, sizeof(g_rxStats));
+}
+
+w5500_socket_status_t w5500_udp_open(uint8_t socket, uint16_t localPort)
+{
+    W5500Lock lock;
+
+    if (g_reconnect[socket].active)
+    {
+        return W5500_SOCKET_BUSY;
+    }
+
+    if (!w5500_issue_socket_command(socket, W5500_CMD_CLOSE, 100))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    w5500_rx_mirror_reset(socket);
+    w5500_chain_write8(Sn_MR, socket_reg_bsb(socket), W5500_SOCK_MODE_UDP);
+    w5500_chain_write16(Sn_PORT, socket_reg_bsb(socket), localPort != 0 ? localPort : g_nextSourcePort++);
+    w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_OPEN);
+    w5500_chain_execute();
+
+    if (!w5500_wait_command_done(socket, 200))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    if (w5500_read8(Sn_SR, socket_reg_bsb(socket)) != W5500_SOCK_UDP)
+    {
+        return W5500_SOCKET_IO_ERROR;
+    }
+
+    w5500_chain_write8(Sn_IMR, socket_reg_bsb(socket), W5500_IR_ALL);
+    w5500_chain_write8(Sn_IR, socket_reg_bsb(socket), 0xFF);
+    w5500_chain_execute();
+    g_socketIrLatched[socket] = 0;
+
+    return W5500_SOCKET_OK;
+}
+
+w5500_socket_status_t w5500_udp_send_to(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort,
+                                        const uint8_t* data, uint16_t length)
+{
+    W5500Lock lock;
+
+    if (length == 0 || length > W5500_UDP_MAX_PAYLOAD || (uint32_t)length > (uint32_t)g_socketTxBufKb[socket] * 1024U)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    uint8_t status = 0;
+    uint8_t txRegs[6];
+    w5500_chain_read(Sn_SR, socket_reg_bsb(socket), &status, 1);
+    w5500_chain_read(Sn_TX_FSR, socket_reg_bsb(socket), txRegs, sizeof(txRegs));
+    w5500_chain_execute();
+
+    if (status != W5500_SOCK_UDP)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    int32_t elapsed = 0;
+    uint16_t freeSize = w5500_be16(&txRegs[0]);
+    while (freeSize < length)
+    {
+        if (elapsed >= 2000)
+        {
+            return W5500_SOCKET_TIMEOUT;
+        }
+        w5500_sleep_ms(1);
+        elapsed++;
+        freeSize = w5500_read16(Sn_TX_FSR, socket_reg_bsb(socket));
+    }
+
+    // Sn_DIPR and Sn_DPORT are adjacent (0x0C-0x11): the destination is one
+    // frame in the same chain as the payload, Sn_TX_WR and SEND.
+    uint8_t destination[6];
+    memcpy(destination, remoteIp, 4);
+    destination[4] = (uint8_t)(remotePort >> 8);
+    destination[5] = (uint8_t)(remotePort & 0xFF);
+
+    uint16_t writePtr = w5500_be16(&txRegs[4]);
+    w5500_chain_write(Sn_DIPR, socket_reg_bsb(socket), destination, sizeof(destination));
+    w5500_chain_write(writePtr, socket_tx_bsb(socket), data, length);
+    w5500_chain_write16(Sn_TX_WR, socket_reg_bsb(socket), (uint16_t)(writePtr + length));
+    w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_SEND);
+    w5500_chain_execute();
+
+    // TIMEOUT here means ARP for a unicast destination went unanswered.
+    uint8_t ir = w5500_wait_socket_ir(socket, (uint8_t)(W5500_IR_SENDOK | W5500_IR_TIMEOUT), TIME_MS2I(2000));
+    if ((ir & W5500_IR_SENDOK) != 0)
+    {
+        return W5500_SOCKET_OK;
+    }
+
+    return W5500_SOCKET_TIMEOUT;
+}
+
+w5500_socket_status_t w5500_udp_receive_from(uint8_t socket, uint8_t* buffer, uint16_t maxLength, int32_t timeoutMs,
+                                             uint8_t outRemoteIp[4], uint16_t* outRemotePort, uint16_t* outReceived)
+{
+    W5500Lock lock;
+
+    const systime_t start = chVTGetSystemTimeX();
+    const sysinterval_t timeout = w5500_timeout_interval(timeoutMs);
+
+    *outReceived = 0;
+    *outRemotePort = 0;
+    memset(outRemoteIp, 0, 4);
+
+    while (true)
+    {
+        uint8_t rxRegs[4];
+        w5500_read_buf(Sn_RX_RSR, socket_reg_bsb(socket), rxRegs, sizeof(rxRegs));
+        uint16_t available = w5500_be16(&rxRegs[0]);
+        if (available >= kUdpHeaderBytes)
+        {
+            uint16_t readPtr = w5500_be16(&rxRegs[2]);
+            uint8_t header[kUdpHeaderBytes];
+            w5500_read_buf(readPtr, socket_rx_bsb(socket), header, sizeof(header));
+
+            // The chip only queues whole datagrams, so a length past RSR is corruption.
+            uint16_t datagramLength = w5500_be16(&header[6]);
+            if ((uint32_t)kUdpHeaderBytes + datagramLength > available)
+            {
+                return W5500_SOCKET_IO_ERROR;
+            }
+
+            uint16_t toRead = datagramLength < maxLength ? datagramLength : maxLength;
+            if (toRead > 0)
+            {
+                w5500_chain_read((uint16_t)(readPtr + kUdpHeaderBytes), socket_rx_bsb(socket), buffer, toRead);
+            }
+            w5500_chain_write16(Sn_RX_RD, socket_reg_bsb(socket), (uint16_t)(readPtr + kUdpHeaderBytes + datagramLength));
+            w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_RECV);
+            w5500_chain_execute();
+
+            memcpy(outRemoteIp, header, 4);
+            *outRemotePort = w5500_be16(&header[4]);
+            *outReceived = toRead;
+            return w5500_wait_command_done(socket, 100) ? W5500_SOCKET_OK : W5500_SOCKET_TIMEOUT;
+        }
+
+        if (w5500_read8(Sn_SR, socket_reg_bsb(socket)) != W5500_SOCK_UDP)
+        {
+            return W5500_SOCKET_NOT_INITIALIZED;
+        }
+
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= timeout)
+        {
+            return W5500_SOCKET_TIMEOUT;
+        }
+
+        w5500_wait_socket_ir(socket, W5500_IR_RECV, timeout - elapsed);
+    }
+}
+
+static bool w5500_link_probe_send(uint16_t length)
+{
+    const uint8_t socket = kLinkProbeSocket;
+    uint8_t txRegs[6];
+    w5500_read_buf(Sn_TX_FSR, socket_reg_bsb(socket), txRegs, sizeof(txRegs));
+
+    // No waiting for TX space: the caller may be another socket's wait.
+    if (w5500_be16(&txRegs[0]) < length)
+    {
+        return false;
+    }
+
+    uint16_t writePtr = w5500_be16(&txRegs[4]);
+    w5500_chain_write(writePtr, socket_tx_bsb(socket), g_linkProbeFrame, length);
+    w5500_chain_write16(Sn_TX_WR, socket_reg_bsb(socket), (uint16_t)(writePtr + length));
+    w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_SEND);
+    w5500_chain_execute();
+
+    uint8_t ir = w5500_wait_socket_ir(socket, W5500_IR_SENDOK, TIME_MS2I(kLinkProbeSendTimeoutMs));
+    return (ir & W5500_IR_SENDOK) != 0;
+}
+
+// Take up to kLinkProbeDrainFrames frames from socket 0 and answer those
+// meant for us. Returns the number of frames taken.
+static uint16_t w5500_link_probe_drain(void)
+{
+    const uint8_t socket = kLinkProbeSocket;
+    uint16_t handled = 0;
+
+    while (handled < kLinkProbeDrainFrames)
+    {
+        uint8_t rxRegs[4];
+        w5500_read_buf(Sn_RX_RSR, socket_reg_bsb(socket), rxRegs, sizeof(rxRegs));
+        uint16_t available = w5500_be16(&rxRegs[0]);
+        if (available < kMacrawHeaderBytes)
+        {
+            return handled;
+        }
+
+        const systime_t start = chVTGetSystemTimeX();
+        uint16_t readPtr = w5500_be16(&rxRegs[2]);
+        uint8_t header[kMacrawHeaderBytes];
+        w5500_read_buf(readPtr, socket_rx_bsb(socket), header, sizeof(header));
+
+        // A length past RSR means the framing is lost: drop everything queued.
+        uint16_t packetLength = w5500_be16(header);
+        if (packetLength <= kMacrawHeaderBytes || packetLength > available)
+        {
+            packetLength = available;
+        }
+
+        uint16_t frameLength = (uint16_t)(packetLength - kMacrawHeaderBytes);
+        bool fits = frameLength > 0 && frameLength <= sizeof(g_linkProbeFrame);
+        if (fits)
+        {
+            w5500_chain_read((uint16_t)(readPtr + kMacrawHeaderBytes), socket_rx_bsb(socket), g_linkProbeFrame, frameLength);
+        }
+        w5500_chain_write16(Sn_RX_RD, socket_reg_bsb(socket), (uint16_t)(readPtr + packetLength));
+        w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_RECV);
+        w5500_chain_execute();
+        w5500_wait_command_done(socket, 100);
+
+        handled++;
+        g_linkProbeStats.frames++;
+        if (!fits)
+        {
+            g_linkProbeStats.dropped++;
+            continue;
+        }
+
+        uint16_t replyLength = 0;
+        link_responder_kind_t kind = link_responder_reply(g_linkProbeFrame, frameLength, sizeof(g_linkProbeFrame),
+                                                          g_networkMac, g_networkIp, &replyLength);
+        if (kind == LINK_RESPONDER_NONE)
+        {
+            continue;
+        }
+
+        if (!w5500_link_probe_send(replyLength))
+        {
+            g_linkProbeStats.dropped++;
+            continue;
+        }
+
+        if (kind == LINK_RESPONDER_ARP_REPLY)
+        {
+            g_linkProbeStats.arpReplies++;
+            continue;
+        }
+
+        uint32_t serviceUs = (uint32_t)TIME_I2US(chVTTimeElapsedSinceX(start));
+        g_linkProbeStats.echoReplies++;
+        g_linkProbeStats.lastEchoUs = serviceUs;
+        if (serviceUs > g_linkProbeStats.maxEchoUs)
+        {
+            g_linkProbeStats.maxEchoUs = serviceUs;
+        }
+    }
+
+    // Stopped at the cap: keep RECV pending so the next wait comes back here.
+    g_socketIrLatched[socket] |= W5500_IR_RECV;
+    return handled;
+}
+
+static void w5500_link_probe_check(uint8_t waitingSocket)
+{
+    if (!g_linkProbeActive || waitingSocket == kLinkProbeSocket)
+    {
+        return;
+    }
+
+    if (g_ioMode == W5500_IO_POLLED)
+    {
+        // One RSR read per poll instead of Sn_IR: frames left by a capped drain still count.
+        if (w5500_read16(Sn_RX_RSR, socket_reg_bsb(kLinkProbeSocket)) == 0)
+        {
+            return;
+        }
+    }
+    else
+    {
+        if ((g_socketIrLatched[kLinkProbeSocket] & W5500_IR_RECV) == 0)
+        {
+            return;
+        }
+        g_socketIrLatched[kLinkProbeSocket] &= (uint8_t)~W5500_IR_RECV;
+    }
+
+    w5500_link_probe_drain();
+}
+
+w5500_socket_status_t w5500_link_probe_enable(bool enable)
+{
+    W5500Lock lock;
+
+    const uint8_t socket = kLinkProbeSocket;
+
+    if (!g_initialized)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    if (enable == g_linkProbeActive)
+    {
+        return W5500_SOCKET_OK;
+    }
+
+    if (!enable)
+    {
+        g_linkProbeActive = false;
+        w5500_socket_close(socket);
+        w5500_write8(W5500_MR, W5500_BSB_COMMON, (uint8_t)(w5500_read8(W5500_MR, W5500_BSB_COMMON) & ~W5500_MR_PB));
+        return W5500_SOCKET_OK;
+    }
+
+    if (g_socketOpen[socket])
+    {
+        return W5500_SOCKET_BUSY;
+    }
+
+    if (g_socketRxBufKb[socket] == 0 || g_socketTxBufKb[socket] == 0)
+    {
+        return W5500_SOCKET_NOT_SUPPORTED;
+    }
+
+    if (!w5500_issue_socket_command(socket, W5500_CMD_CLOSE, 100))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    // MFEN: only frames for our MAC plus broadcast/multicast reach the RX buffer.
+    w5500_chain_write8(Sn_MR, socket_reg_bsb(socket), (uint8_t)(W5500_SOCK_MODE_MACRAW | W5500_SOCK_MACRAW_MFEN));
+    w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_OPEN);
+    w5500_chain_execute();
+
+    if (!w5500_wait_command_done(socket, 200))
+    {
+        return W5500_SOCKET_TIMEOUT;
+    }
+
+    if (w5500_read8(Sn_SR, socket_reg_bsb(socket)) != W5500_SOCK_MACRAW)
+    {
+        return W5500_SOCKET_IO_ERROR;
+    }
+
+    // The chip's own ping reply is blocked so each echo request is answered once.
+    uint8_t mode = w5500_read8(W5500_MR, W5500_BSB_COMMON);
+    w5500_chain_write8(Sn_IMR, socket_reg_bsb(socket), (uint8_t)(W5500_IR_RECV | W5500_IR_SENDOK));
+    w5500_chain_write8(Sn_IR, socket_reg_bsb(socket), 0xFF);
+    w5500_chain_write8(W5500_MR, W5500_BSB_COMMON, (uint8_t)(mode | W5500_MR_PB));
+    w5500_chain_execute();
+    g_socketIrLatched[socket] = 0;
+
+    memset(&g_linkProbeStats, 0, sizeof(g_linkProbeStats));
+    g_linkProbeActive = true;
+    return W5500_SOCKET_OK;
+}
+
+bool w5500_link_probe_is_enabled(void)
+{
+    return g_linkProbeActive;
+}
+
+w5500_socket_status_t w5500_link_probe_service(int32_t timeoutMs, uint16_t* outHandled)
+{
+    W5500Lock lock;
+
+    const systime_t start = chVTGetSystemTimeX();
+    const sysinterval_t timeout = w5500_timeout_interval(timeoutMs);
+
+    *outHandled = 0;
+    if (!g_linkProbeActive)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    while (true)
+    {
+        *outHandled = w5500_link_probe_drain();
+        if (*outHandled != 0)
+        {
+            return W5500_SOCKET_OK;
+        }
+
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= timeout)
+        {
+            return W5500_SOCKET_TIMEOUT;
+        }
+
+        w5500_wait_socket_ir(kLinkProbeSocket, W5500_IR_RECV, timeout - elapsed);
+    }
+}
+
+void w5500_link_probe_get_stats(w5500_link_probe_stats_t* outStats)
+{
+    W5500Lock lock;
+
+    memcpy(outStats, &g_linkProbeStats, sizeof(g_linkProbeStats));
+}
+
+static void w5500_reconnect_set_state(uint8_t socket, w5500_conn_state_t state)
+{
+    g_reconnect[socket].status.state = state;
+    g_reconnect[socket].since = chVTGetSystemTimeX();
+    chEvtBroadcastFlags(&g_reconnectEvents, (eventflags_t)1U << socket);
+}
+
+// xorshift32: only there to spread retries, not for anything secret.
+static uint32_t w5500_reconnect_random(void)
+{
+    uint32_t x = g_reconnectRandom;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_reconnectRandom = x;
+    return x;
+}
+
+// Draw this backoff from [ceiling / 2, ceiling] and double the ceiling for
+// the next failure. The caller has already closed the socket.
+static sysinterval_t w5500_reconnect_back_off(uint8_t socket)
+{
+    w5500_reconnect_slot_t* slot = &g_reconnect[socket];
+    uint32_t ceiling = slot->nextBackoffMs;
+    uint32_t floor = ceiling / 2;
+
+    slot->status.backoffMs = floor + w5500_reconnect_random() % (ceiling - floor + 1);
+    slot->nextBackoffMs = ceiling > slot->policy.maxBackoffMs / 2 ? slot->policy.maxBackoffMs : ceiling * 2;
+    w5500_reconnect_set_state(socket, W5500_CONN_BACKOFF);
+    return TIME_MS2I(slot->status.backoffMs);
+}
+
+// Advance one supervised socket; returns how long until it needs another look.
+static sysinterval_t w5500_reconnect_step(uint8_t socket)
+{
+    w5500_reconnect_slot_t* slot = &g_reconnect[socket];
+    const sysinterval_t elapsed = chVTTimeElapsedSinceX(slot->since);
+
+    if (slot->status.state == W5500_CONN_BACKOFF && elapsed < TIME_MS2I(slot->status.backoffMs))
+    {
+        return TIME_MS2I(slot->status.backoffMs) - elapsed;
+    }
+
+    switch (slot->status.state)
+    {
+        case W5500_CONN_CLOSED:
+        case W5500_CONN_BACKOFF:
+            slot->status.attempts++;
+            if (w5500_tcp_open(socket) != W5500_SOCKET_OK)
+            {
+                w5500_socket_close(socket);
+                return w5500_reconnect_back_off(socket);
+            }
+
+            w5500_reconnect_set_state(socket, W5500_CONN_INIT);
+            if (w5500_tcp_issue_connect(socket, slot->remoteIp, slot->remotePort) != W5500_SOCKET_OK)
+            {
+                w5500_socket_close(socket);
+                return w5500_reconnect_back_off(socket);
+            }
+
+            w5500_reconnect_set_state(socket, W5500_CONN_SYNSENT);
+            return TIME_MS2I(W5500_RECONNECT_CONNECT_POLL_MS);
+
+        case W5500_CONN_INIT:
+        case W5500_CONN_SYNSENT:
+        {
+            uint8_t status = w5500_read8(Sn_SR, socket_reg_bsb(socket));
+            if (status == W5500_SOCK_ESTABLISHED)
+            {
+                // CON is consumed here rather than by a socket wait.
+                w5500_write8(Sn_IR, socket_reg_bsb(socket), (uint8_t)(W5500_IR_CON | W5500_IR_TIMEOUT));
+                g_socketIrLatched[socket] &= (uint8_t)~(W5500_IR_CON | W5500_IR_TIMEOUT);
+
+                slot->status.connects++;
+                slot->status.lastConnectUs = TIME_I2US(elapsed);
+                slot->nextBackoffMs = slot->policy.minBackoffMs;
+                w5500_reconnect_set_state(socket, W5500_CONN_ESTABLISHED);
+                return TIME_MS2I(W5500_RECONNECT_SUPERVISE_POLL_MS);
+            }
+
+            // Still handshaking; CLOSED means RST or the chip's SYN retries ran out.
+            if (status == W5500_SOCK_SYNSENT && elapsed < TIME_MS2I(slot->policy.connectTimeoutMs))
+            {
+                return TIME_MS2I(W5500_RECONNECT_CONNECT_POLL_MS);
+            }
+
+            w5500_socket_close(socket);
+            return w5500_reconnect_back_off(socket);
+        }
+
+        case W5500_CONN_ESTABLISHED:
+        default:
+            if (w5500_read8(Sn_SR, socket_reg_bsb(socket)) == W5500_SOCK_ESTABLISHED)
+            {
+                return TIME_MS2I(W5500_RECONNECT_SUPERVISE_POLL_MS);
+            }
+
+            // Peer closed (CLOSE_WAIT) or reset: FIN our side and start over
+            // from the shortest backoff.
+            w5500_socket_disconnect(socket);
+            return w5500_reconnect_back_off(socket);
+    }
+}
+
+static const uint8_t kMqttPingReq[2] = {0xC0, 0x00};
+static const uint8_t kMqttPingResp = 0xD0;
+
+static void w5500_keepalive_disable(uint8_t socket)
+{
+    if (!g_keepalive[socket].enabled)
+    {
+        return;
+    }
+
+    g_keepalive[socket].enabled = false;
+    g_keepalive[socket].pingOutstanding = false;
+    w5500_write8(Sn_KPALVTR, socket_reg_bsb(socket), 0);
+}
+
+// Queue a PINGREQ on an idle socket. BUSY when it has to wait for a send call
+// or for TX space, NOT_INITIALIZED once the connection has gone.
+static w5500_socket_status_t w5500_keepalive_inject(uint8_t socket)
+{
+    // Nobody else is waiting for a SENDOK left pending by a streamed send.
+    if (g_socketSendBusy[socket] || w5500_send_collect(socket, TIME_IMMEDIATE) != W5500_SOCKET_OK)
+    {
+        return W5500_SOCKET_BUSY;
+    }
+
+    uint8_t status = 0;
+    uint8_t txRegs[6];
+    w5500_chain_read(Sn_SR, socket_reg_bsb(socket), &status, 1);
+    w5500_chain_read(Sn_TX_FSR, socket_reg_bsb(socket), txRegs, sizeof(txRegs));
+    w5500_chain_execute();
+
+    if (status != W5500_SOCK_ESTABLISHED)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    if (w5500_be16(&txRegs[0]) < sizeof(kMqttPingReq))
+    {
+        return W5500_SOCKET_BUSY;
+    }
+
+    // Its SENDOK is collected by the next send (or the next ping).
+    uint16_t writePtr = w5500_be16(&txRegs[4]);
+    w5500_chain_write(writePtr, socket_tx_bsb(socket), kMqttPingReq, sizeof(kMqttPingReq));
+    w5500_chain_write16(Sn_TX_WR, socket_reg_bsb(socket), (uint16_t)(writePtr + sizeof(kMqttPingReq)));
+    w5500_chain_write8(Sn_CR, socket_reg_bsb(socket), W5500_CMD_SEND);
+    w5500_chain_execute();
+
+    w5500_keepalive_slot_t* slot = &g_keepalive[socket];
+    g_socketSendPending[socket] = true;
+    g_socketLastTx[socket] = chVTGetSystemTimeX();
+    slot->pingSentAt = g_socketLastTx[socket];
+    slot->pingOutstanding = true;
+    slot->stats.pingsSent++;
+    return W5500_SOCKET_OK;
+}
+
+// Ping an idle socket or drop a silent one; returns how long until it needs
+// another look.
+static sysinterval_t w5500_keepalive_step(uint8_t socket)
+{
+    w5500_keepalive_slot_t* slot = &g_keepalive[socket];
+
+    if (slot->pingOutstanding)
+    {
+        const sysinterval_t waited = chVTTimeElapsedSinceX(slot->pingSentAt);
+        if (waited < slot->interval)
+        {
+            return slot->interval - waited;
+        }
+
+        // Unread data means the broker is still talking and the PINGRESP is
+        // queued behind it (on the chip or in the RX mirror); the frame
+        // reader will swallow it.
+        if (g_rxMirror[socket].count != 0 || w5500_read16(Sn_RX_RSR, socket_reg_bsb(socket)) != 0)
+        {
+            slot->pingOutstanding = false;
+            return slot->interval;
+        }
+
+        // The close wakes a reader blocked on the socket with DISCON, so it
+        // returns NOT_INITIALIZED now rather than at the end of its timeout.
+        slot->stats.missed++;
+        w5500_socket_disconnect(socket);
+        return TIME_INFINITE;
+    }
+
+    // Every SEND (ours included) restarts the idle time.
+    const sysinterval_t idle = chVTTimeElapsedSinceX(g_socketLastTx[socket]);
+    if (idle < slot->interval)
+    {
+        return slot->interval - idle;
+    }
+
+    switch (w5500_keepalive_inject(socket))
+    {
+        case W5500_SOCKET_OK:
+            return slot->interval;
+
+        case W5500_SOCKET_NOT_INITIALIZED:
+            // The socket's owner sees the closed connection on its next call.
+            w5500_keepalive_disable(socket);
+            return TIME_INFINITE;
+
+        default:
+            return TIME_MS2I(W5500_KEEPALIVE_RETRY_MS);
+    }
+}
+
+// True for a PINGRESP header (already peeked) while keep-alive is on; the
+// frame reader then drops it so the managed client never sees it.
+static bool w5500_keepalive_pingresp(uint8_t socket, const uint8_t* header)
+{
+    w5500_keepalive_slot_t* slot = &g_keepalive[socket];
+    if (!slot->enabled || header[0] != kMqttPingResp || header[1] != 0)
+    {
+        return false;
+    }
+
+    slot->pingOutstanding = false;
+    slot->stats.pingResponses++;
+    return true;
+}
+
+static THD_FUNCTION(w5500_reconnect_thread, arg)
+{
+    (void)arg;
+    chRegSetThreadName("w5500_conn");
+
+    while (true)
+    {
+        sysinterval_t wait = TIME_INFINITE;
+        {
+            W5500Lock lock;
+
+            for (uint8_t socket = 0; socket < kSocketCount; socket++)
+            {
+                if (g_reconnect[socket].active)
+                {
+                    sysinterval_t next = w5500_reconnect_step(socket);
+                    if (next < wait)
+                    {
+                        wait = next;
+                    }
+                }
+
+                // After the reconnect step, which disables it when it drops the connection.
+                if (g_keepalive[socket].enabled)
+                {
+                    sysinterval_t next = w5500_keepalive_step(socket);
+                    if (next < wait)
+                    {
+                        wait = next;
+                    }
+                }
+            }
+        }
+
+        // Start and stop (of either) signal g_reconnectWake so a change is acted on at once.
+        chBSemWaitTimeout(&g_reconnectWake, wait);
+    }
+}
+
+// Stop supervising without touching the chip (the caller disconnects).
+static void w5500_reconnect_detach(uint8_t socket)
+{
+    if (!g_reconnect[socket].active)
+    {
+        return;
+    }
+
+    g_reconnect[socket].active = false;
+    w5500_reconnect_set_state(socket, W5500_CONN_CLOSED);
+}
+
+// Create the thread on first use, then have it look at every slot again.
+static void w5500_reconnect_thread_wake(void)
+{
+    if (g_reconnectThread == NULL)
+    {
+        // Seeded from the MAC so boards restarted together draw different delays.
+        g_reconnectRandom = (((uint32_t)g_networkMac[2] << 24) | ((uint32_t)g_networkMac[3] << 16) |
+                             ((uint32_t)g_networkMac[4] << 8) | g_networkMac[5]) ^ chSysGetRealtimeCounterX();
+        if (g_reconnectRandom == 0)
+        {
+            g_reconnectRandom = 1;
+        }
+
+        chBSemObjectInit(&g_reconnectWake, true);
+        g_reconnectThread = chThdCreateStatic(wa_w5500_reconnect, sizeof(wa_w5500_reconnect), NORMALPRIO + 1,
+                                              w5500_reconnect_thread, NULL);
+    }
+
+    chBSemSignal(&g_reconnectWake);
+}
+
+w5500_socket_status_t w5500_reconnect_start(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort,
+                                            const w5500_reconnect_policy_t* policy)
+{
+    W5500Lock lock;
+
+    static const w5500_reconnect_policy_t kDefaultPolicy = W5500_RECONNECT_DEFAULT_POLICY;
+    if (policy == NULL)
+    {
+        policy = &kDefaultPolicy;
+    }
+
+    if (socket >= kSocketCount || !g_socketOpen[socket] || remotePort == 0 || policy->connectTimeoutMs == 0 ||
+        policy->minBackoffMs == 0 || policy->minBackoffMs > policy->maxBackoffMs)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    if (!g_initialized)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    w5500_reconnect_slot_t* slot = &g_reconnect[socket];
+    if (slot->active)
+    {
+        return W5500_SOCKET_BUSY;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    memcpy(slot->remoteIp, remoteIp, sizeof(slot->remoteIp));
+    slot->remotePort = remotePort;
+    slot->policy = *policy;
+    slot->nextBackoffMs = policy->minBackoffMs;
+    slot->since = chVTGetSystemTimeX();
+    slot->active = true;
+
+    w5500_reconnect_thread_wake();
+    return W5500_SOCKET_OK;
+}
+
+w5500_socket_status_t w5500_reconnect_stop(uint8_t socket)
+{
+    W5500Lock lock;
+
+    if (socket >= kSocketCount || !g_reconnect[socket].active)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    w5500_reconnect_detach(socket);
+    w5500_socket_disconnect(socket);
+    chBSemSignal(&g_reconnectWake);
+    return W5500_SOCKET_OK;
+}
+
+void w5500_reconnect_get_status(uint8_t socket, w5500_reconnect_status_t* outStatus)
+{
+    W5500Lock lock;
+
+    memcpy(outStatus, &g_reconnect[socket].status, sizeof(*outStatus));
+}
+
+event_source_t* w5500_reconnect_get_event_source(void)
+{
+    return &g_reconnectEvents;
+}
+
+w5500_socket_status_t w5500_keepalive_start(uint8_t socket, uint16_t keepAliveSeconds)
+{
+    W5500Lock lock;
+
+    if (socket >= kSocketCount || !g_socketOpen[socket] || keepAliveSeconds == 0)
+    {
+        return W5500_SOCKET_INVALID_PARAM;
+    }
+
+    if (!g_initialized || w5500_read8(Sn_SR, socket_reg_bsb(socket)) != W5500_SOCK_ESTABLISHED)
+    {
+        return W5500_SOCKET_NOT_INITIALIZED;
+    }
+
+    // The chip's own keep-alive (5 s units) only fires if the pings stall.
+    uint32_t kpalvtr = ((uint32_t)keepAliveSeconds + 4U) / 5U;
+    w5500_write8(Sn_KPALVTR, socket_reg_bsb(socket), (uint8_t)(kpalvtr > 0xFFU ? 0xFFU : kpalvtr));
+
+    w5500_keepalive_slot_t* slot = &g_keepalive[socket];
+    memset(slot, 0, sizeof(*slot));
+    slot->interval = TIME_MS2I((uint32_t)keepAliveSeconds * 500U);
+    slot->enabled = true;
+    g_socketLastTx[socket] = chVTGetSystemTimeX();
+
+    w5500_reconnect_thread_wake();
+    return W5500_SOCKET_OK;
+}
+
+void w5500_keepalive_stop(uint8_t socket)
+{
+    W5500Lock lock;
+
+    if (socket < kSocketCount)
+    {
+        w5500_keepalive_disable(socket);
+    }
+}
+
+bool w5500_keepalive_get_stats(uint8_t socket, w5500_keepalive_stats_t* outStats)
+{
+    W5500Lock lock;
+
+    memcpy(outStats, &g_keepalive[socket].stats, sizeof(*outStats));
+    return g_keepalive[socket].enabled;
+}
@@ -0,0 +1,391 @@
+/**
+ * @file w5500_native.h
+ * @brief Native W5500 socket transport over SPI2
+ *
+ * Register access, bring-up and the TCP socket primitives used by
+ * w5500_interop.cpp. Nothing here depends on the CLR, so the same code runs
+ * from cubley_w5500_early_init() before the runtime starts and in the
+ * host simulation under tests/native/sim/.
+ */
+
+#ifndef W5500_NATIVE_H
+#define W5500_NATIVE_H
+
+#include <hal.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+enum w5500_socket_status_t
+{
+    W5500_SOCKET_OK = 0,
+    W5500_SOCKET_INVALID_PARAM = 1,
+    W5500_SOCKET_NOT_INITIALIZED = 2,
+    W5500_SOCKET_BUSY = 3,
+    W5500_SOCKET_TIMEOUT = 4,
+    W5500_SOCKET_NOT_SUPPORTED = 5,
+    W5500_SOCKET_IO_ERROR = 6
+};
+
+// How socket waits learn about CON/DISCON/RECV/TIMEOUT/SENDOK.
+// INTERRUPT: SIMR/Sn_IMR unmask the events, the INT line (PC7) falling edge
+// wakes the waiting thread and Sn_IR is only read while INT is asserted
+// (plus a 100 ms safety re-check). POLLED: Sn_IR is read over SPI every 1 ms.
+enum w5500_io_mode_t
+{
+    W5500_IO_POLLED = 0,
+    W5500_IO_INTERRUPT = 1
+};
+
+#ifndef W5500_DEFAULT_IO_MODE
+#define W5500_DEFAULT_IO_MODE W5500_IO_INTERRUPT
+#endif
+
+// What w5500_init() runs besides the bring-up itself. DIAGNOSTIC keeps the
+// board bring-up aids: a 480 ms GPIO pulse train on SCK/MOSI, the PB12 check,
+// slow SPI and VERSIONR bursts for entry-level scopes, the four-way SPI mode
+// probe and fixed PHY settle delays with a readback after each step (~1.3 s).
+// FAST does a 1 ms reset, one VERSIONR check (polled until the PLL locks) and
+// the PHY configuration, waiting only as long as the chip's reset bits say.
+enum w5500_init_profile_t
+{
+    W5500_INIT_DIAGNOSTIC = 0,
+    W5500_INIT_FAST = 1
+};
+
+#ifndef W5500_DEFAULT_INIT_PROFILE
+#define W5500_DEFAULT_INIT_PROFILE W5500_INIT_FAST
+#endif
+
+#define W5500_SOCKET_COUNT 8
+
+// Per-socket buffer split in KB (socket 0 first), written to Sn_RXBUF_SIZE /
+// Sn_TXBUF_SIZE at bring-up. Valid sizes are 0, 1, 2, 4, 8 and 16; the
+// sockets of each direction share 16 KB. A socket with a 0 KB buffer is
+// never handed out by w5500_socket_open().
+#ifndef W5500_DEFAULT_RXBUF_KB
+#define W5500_DEFAULT_RXBUF_KB {2, 2, 2, 2, 2, 2, 2, 2}
+#endif
+
+#ifndef W5500_DEFAULT_TXBUF_KB
+#define W5500_DEFAULT_TXBUF_KB {2, 2, 2, 2, 2, 2, 2, 2}
+#endif
+
+// SPI2 clock = APB1 (42 MHz) / divider, divider a power of two from 2 to 256.
+// Bring-up probes at /8, then applies W5500_SPI_DEFAULT_DIVIDER and, with
+// W5500_SPI_CALIBRATE, steps towards W5500_SPI_FASTEST_DIVIDER (/2 = 21 MHz;
+// the W5500 is rated to ~33 MHz) for as long as the pattern check passes.
+#ifndef W5500_SPI_DEFAULT_DIVIDER
+#define W5500_SPI_DEFAULT_DIVIDER 8
+#endif
+
+#ifndef W5500_SPI_FASTEST_DIVIDER
+#define W5500_SPI_FASTEST_DIVIDER 2
+#endif
+
+#ifndef W5500_SPI_CALIBRATE
+#define W5500_SPI_CALIBRATE 1
+#endif
+
+// Static staging area for batched SPI frames (SRAM, DMA-reachable). Payloads
+// up to this size minus the 3-byte frame header go out in the same transfer
+// as their header; larger ones are sent from the caller's buffer.
+#ifndef W5500_SPI_CHAIN_BYTES
+#define W5500_SPI_CHAIN_BYTES 320
+#endif
+
+// Driver lock. Every public call below takes it, so the CLR thread, the
+// early-init thread and the reconnect thread never interleave SPI frames.
+// Socket waits and command polls give it up while they sleep, so a receive
+// blocked for seconds does not hold the other threads off the chip. Nested
+// locking from the same thread is allowed.
+void w5500_lock(void);
+void w5500_unlock(void);
+
+// SWD diagnostic mailbox: 0xD5 | stage | result | detail.
+void set_w5500_bringup_status(uint8_t stage, uint8_t result, uint8_t detail);
+
+// SWD last-error record: 0xE1 | op | code | detail (sticky until next update).
+void set_w5500_last_native_error(uint8_t op, uint8_t code, uint8_t detail);
+
+// Dotted-quad "a.b.c.d" to bytes; false on any malformed octet.
+bool w5500_parse_ipv4(const char* text, uint8_t out[4]);
+
+// "aa:bb:cc:dd:ee:ff" to bytes; false on malformed input.
+bool w5500_parse_mac(const char* text, uint8_t out[6]);
+
+// Full bring-up (reset, SPI probe, PHY all-auto, network registers, socket
+// buffer split). Idempotent: returns W5500_SOCKET_OK once the chip is up.
+w5500_socket_status_t w5500_init(void);
+
+bool w5500_is_initialized(void);
+
+// Profile for the next w5500_init() (see W5500_DEFAULT_INIT_PROFILE); no
+// effect once the chip is up.
+void w5500_set_init_profile(w5500_init_profile_t profile);
+w5500_init_profile_t w5500_get_init_profile(void);
+
+// Duration of the last w5500_init() attempt, also latched for SWD in
+// g_w5500_init_timing (0xD7 | profile | ms) and, on success, as op 0x4F.
+uint32_t w5500_get_init_duration_us(void);
+
+extern "C" int cubley_w5500_early_init(void);
+
+// Store the network settings and write them to the chip when it is up.
+void w5500_set_network(const uint8_t ip[4], const uint8_t subnet[4], const uint8_t gateway[4], const uint8_t mac[6]);
+
+// Presence-only probe (pins + SPI, no reset); returns VERSIONR, 0x04 on a W5500.
+uint8_t w5500_probe_version_minimal(uint8_t *outPhyCfgr);
+
+uint8_t w5500_read_version(void);
+uint8_t w5500_read_phycfgr(void);
+
+// Program PHYCFGR.OPMDC (0-7) in software mode and reset the PHY; returns PHYCFGR.
+uint8_t w5500_set_phy_mode(uint8_t opmdc);
+
+// Select socket event delivery; applies to the next wait (SIMR is rewritten
+// when the chip is up).
+void w5500_set_io_mode(w5500_io_mode_t mode);
+w5500_io_mode_t w5500_get_io_mode(void);
+
+// Replace the buffer split (see W5500_DEFAULT_RXBUF_KB). INVALID_PARAM for an
+// unsupported size or a direction over 16 KB, BUSY while any socket is open.
+w5500_socket_status_t w5500_set_buffer_sizes(const uint8_t rxKb[W5500_SOCKET_COUNT], const uint8_t txKb[W5500_SOCKET_COUNT]);
+void w5500_get_buffer_sizes(uint8_t rxKb[W5500_SOCKET_COUNT], uint8_t txKb[W5500_SOCKET_COUNT]);
+
+// SPI2 clock divider (see W5500_SPI_DEFAULT_DIVIDER); INVALID_PARAM unless a
+// power of two in 2-256. Takes effect on the next transfer, no check is made.
+w5500_socket_status_t w5500_set_spi_divider(uint16_t divider);
+uint16_t w5500_get_spi_divider(void);
+uint32_t w5500_get_spi_clock_hz(void);
+
+// Find the fastest reliable SPI clock: the current divider is verified first
+// (slowing down until a pattern written to a socket TX buffer reads back
+// intact), then halved down to fastestDivider while the check keeps passing;
+// the last good divider stays selected. IO_ERROR if no speed passes,
+// NOT_INITIALIZED before bring-up, BUSY while a socket is open (its TX buffer
+// is the scratch area).
+w5500_socket_status_t w5500_calibrate_spi(uint16_t fastestDivider, uint16_t* outDivider);
+
+// Socket pool: claim the lowest free socket that has RX and TX buffer space
+// (BUSY when none is left), and give it back (disconnecting it first).
+w5500_socket_status_t w5500_socket_open(uint8_t* outSocket);
+w5500_socket_status_t w5500_socket_release(uint8_t socket);
+bool w5500_socket_is_open(uint8_t socket);
+
+// TCP client socket primitives (socket = W5500 socket index 0-7). A send
+// larger than the socket's TX buffer is rejected with INVALID_PARAM; larger
+// payloads go through w5500_send_stream(). The receive calls return
+// NOT_INITIALIZED once the peer has closed (CLOSE_WAIT) and its data is read,
+// and as soon as another thread (keep-alive, reconnect) closes the socket
+// under them; a connection the reconnect thread brings back is a new session.
+w5500_socket_status_t w5500_connect(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort, int32_t timeoutMs);
+w5500_socket_status_t w5500_send(uint8_t socket, const uint8_t* data, uint16_t length);
+w5500_socket_status_t w5500_receive(uint8_t socket, uint8_t* buffer, uint16_t maxLength, int32_t timeoutMs, uint16_t* outReceived);
+
+// Streaming send for payloads of any size: writes as much as Sn_TX_FSR allows,
+// issues SEND and continues with the rest as space frees up, copying the next
+// chunk while the previous one is on the wire. outSent counts bytes committed
+// with a SEND. With W5500_SEND_NO_WAIT it returns once the last SEND is
+// issued; its SENDOK (or a TIMEOUT/DISCON) is collected by the next send on
+// the socket. timeoutMs bounds the whole call.
+#define W5500_SEND_NO_WAIT 0x01
+w5500_socket_status_t w5500_send_stream(uint8_t socket, const uint8_t* data, uint32_t length, uint8_t flags,
+                                        int32_t timeoutMs, uint32_t* outSent);
+
+// Read exactly length bytes within timeoutMs (one deadline for the whole read).
+// TIMEOUT or NOT_INITIALIZED (peer closed) leave the partial count in *outReceived.
+w5500_socket_status_t w5500_receive_exact(uint8_t socket, uint8_t* buffer, uint16_t length, int32_t timeoutMs, uint16_t* outReceived);
+
+// Longest MQTT fixed header: control byte + 4 remaining-length bytes.
+#define W5500_MQTT_MAX_HEADER_BYTES 5
+
+// Read one MQTT control packet into buffer as [fixed header byte][variable
+// header + payload] (remaining-length varint stripped); *outLength = 1 + the
+// remaining length. The header is parsed straight from the RX buffer, so a
+// buffered packet costs one burst read. TIMEOUT with *outLength 0 consumed
+// nothing; a non-zero count means the body was cut short. INVALID_PARAM puts
+// the required length in *outLength without consuming anything; IO_ERROR
+// flags a malformed remaining length or a packet over 64 KB.
+w5500_socket_status_t w5500_receive_mqtt_frame(uint8_t socket, uint8_t* buffer, uint16_t maxLength, int32_t timeoutMs, uint16_t* outLength);
+
+// Bytes waiting (RX mirror plus Sn_RX_RSR), without consuming them.
+// NOT_INITIALIZED once the socket is closed and drained.
+w5500_socket_status_t w5500_peek_available(uint8_t socket, uint16_t* outAvailable);
+
+// RX mirror for the TCP receive calls. A receive asking for less than the
+// chip holds pulls everything pending (up to W5500_RX_MIRROR_BYTES) into a
+// per-socket ring in MCU RAM with one burst read and one RECV; the following
+// receives, MQTT frame reads and peeks are served from RAM before the chip is
+// asked again. A read at least as large as what is pending still goes
+// straight into the caller's buffer. w5500_receive_mqtt_frame() parses the
+// fixed header from the ring, so packets buffered together cost one SPI chain.
+#ifndef W5500_RX_MIRROR_BYTES
+#define W5500_RX_MIRROR_BYTES 512       // Per socket, a power of two
+#endif
+
+#ifndef W5500_DEFAULT_RX_MIRROR
+#define W5500_DEFAULT_RX_MIRROR true
+#endif
+
+// Applies to the next prefetch; bytes already mirrored are still served first.
+void w5500_set_rx_mirror(bool enable);
+bool w5500_get_rx_mirror(void);
+
+// Cost of the TCP receive calls (w5500_receive, _exact, _mqtt_frame and
+// w5500_peek_available). spiBytes counts every byte clocked while one of them
+// holds the chip (frame headers, registers, data, RECV, Sn_IR/Sn_CR polls),
+// not while it sleeps; spiBytes / appBytes is the read amplification.
+struct w5500_rx_stats_t
+{
+    uint32_t appBytes;              // Delivered to callers
+    uint32_t mirrorBytes;           // Copied to callers out of the RX mirror
+    uint32_t spiBytes;
+    uint32_t recvCommands;
+};
+
+void w5500_get_rx_stats(w5500_rx_stats_t* outStats);
+void w5500_reset_rx_stats(void);
+
+bool w5500_socket_is_connected(uint8_t socket);
+void w5500_socket_disconnect(uint8_t socket);
+
+// Largest UDP payload sent in one datagram without IP fragmentation (1500-byte MTU).
+#define W5500_UDP_MAX_PAYLOAD 1472
+
+// Reopen the socket in UDP mode bound to localPort (0 picks the next source
+// port). Release it with w5500_socket_release() as for TCP.
+w5500_socket_status_t w5500_udp_open(uint8_t socket, uint16_t localPort);
+
+// One datagram to remoteIp:remotePort (255.255.255.255 broadcasts without
+// ARP). INVALID_PARAM for an empty payload or one over W5500_UDP_MAX_PAYLOAD
+// or the TX buffer; TIMEOUT when ARP for a unicast destination fails.
+w5500_socket_status_t w5500_udp_send_to(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort,
+                                        const uint8_t* data, uint16_t length);
+
+// Next datagram and its source within timeoutMs. Up to maxLength payload bytes
+// are copied and the rest of a longer datagram is dropped (*outReceived is the
+// copied count). NOT_INITIALIZED once the socket is no longer in UDP mode.
+w5500_socket_status_t w5500_udp_receive_from(uint8_t socket, uint8_t* buffer, uint16_t maxLength, int32_t timeoutMs,
+                                             uint8_t outRemoteIp[4], uint16_t* outRemotePort, uint16_t* outReceived);
+
+// Link probe: socket 0 in MACRAW mode (MAC filter on) answers ARP requests and
+// ICMP echo requests for our address natively (w5500_link_responder.h), with
+// the chip's own ping reply blocked (MR.PB) so each echo is answered once.
+// Frames are handled from every socket wait in the driver, so an MQTT client
+// blocked in a receive keeps the probe answering; w5500_link_probe_service()
+// covers idle periods. Frames over W5500_LINK_PROBE_FRAME_BYTES are dropped.
+#ifndef W5500_LINK_PROBE_FRAME_BYTES
+#define W5500_LINK_PROBE_FRAME_BYTES 1514
+#endif
+
+struct w5500_link_probe_stats_t
+{
+    uint32_t frames;        // Frames taken from socket 0
+    uint32_t arpReplies;
+    uint32_t echoReplies;
+    uint32_t dropped;       // Oversized frames and replies that failed to send
+    uint32_t lastEchoUs;    // Echo request read -> reply SENDOK
+    uint32_t maxEchoUs;
+};
+
+// Claim socket 0 for the probe (stats reset) or give it back to the pool.
+// BUSY while socket 0 is handed out, NOT_SUPPORTED when it has no buffer space.
+w5500_socket_status_t w5500_link_probe_enable(bool enable);
+bool w5500_link_probe_is_enabled(void);
+
+// Answer queued frames, waiting up to timeoutMs for the first one;
+// *outHandled counts the frames taken. NOT_INITIALIZED while disabled.
+w5500_socket_status_t w5500_link_probe_service(int32_t timeoutMs, uint16_t* outHandled);
+void w5500_link_probe_get_stats(w5500_link_probe_stats_t* outStats);
+
+// Native reconnect: a ChibiOS thread keeps a pool socket connected to one TCP
+// endpoint. It opens the socket (INIT), issues CONNECT (SYNSENT) and polls
+// Sn_SR every W5500_RECONNECT_CONNECT_POLL_MS until ESTABLISHED; a refused or
+// unanswered SYN, or a connection that later drops (checked every
+// W5500_RECONNECT_SUPERVISE_POLL_MS), closes the socket and waits out a
+// backoff before the next attempt. The backoff doubles from minBackoffMs up
+// to maxBackoffMs and restarts at minBackoffMs once a connection is made;
+// each delay is drawn from [backoff / 2, backoff] so boards restarted
+// together do not reconnect in lockstep.
+enum w5500_conn_state_t
+{
+    W5500_CONN_CLOSED = 0,          // Not supervised
+    W5500_CONN_INIT = 1,            // Socket open in TCP mode
+    W5500_CONN_SYNSENT = 2,         // CONNECT issued
+    W5500_CONN_ESTABLISHED = 3,
+    W5500_CONN_BACKOFF = 4          // Waiting to retry after a failed or dropped connection
+};
+
+#ifndef W5500_RECONNECT_CONNECT_POLL_MS
+#define W5500_RECONNECT_CONNECT_POLL_MS 5
+#endif
+
+#ifndef W5500_RECONNECT_SUPERVISE_POLL_MS
+#define W5500_RECONNECT_SUPERVISE_POLL_MS 100
+#endif
+
+#ifndef W5500_RECONNECT_THREAD_WA_SIZE
+#define W5500_RECONNECT_THREAD_WA_SIZE 512
+#endif
+
+struct w5500_reconnect_policy_t
+{
+    uint32_t connectTimeoutMs;      // SYNSENT longer than this counts as a failed attempt
+    uint32_t minBackoffMs;
+    uint32_t maxBackoffMs;
+};
+
+#define W5500_RECONNECT_DEFAULT_POLICY {3000, 250, 8000}
+
+struct w5500_reconnect_status_t
+{
+    w5500_conn_state_t state;
+    uint32_t attempts;              // CONNECTs issued since start
+    uint32_t connects;              // Times ESTABLISHED was reached; a new value is a new connection
+    uint32_t backoffMs;             // Current (or last) backoff delay
+    uint32_t lastConnectUs;         // CONNECT -> ESTABLISHED of the latest connection
+};
+
+// Supervise an open pool socket (w5500_socket_open); the first attempt starts
+// at once. INVALID_PARAM for a socket not handed out or a policy with a zero
+// field or minBackoffMs > maxBackoffMs (NULL selects the default), BUSY when
+// the socket is already supervised. w5500_connect() and w5500_udp_open() are
+// refused with BUSY on a supervised socket; w5500_socket_release() stops it.
+w5500_socket_status_t w5500_reconnect_start(uint8_t socket, const uint8_t remoteIp[4], uint16_t remotePort,
+                                            const w5500_reconnect_policy_t* policy);
+
+// Stop supervising and disconnect; the socket stays open in the pool.
+w5500_socket_status_t w5500_reconnect_stop(uint8_t socket);
+void w5500_reconnect_get_status(uint8_t socket, w5500_reconnect_status_t* outStatus);
+
+// Broadcast with flag (1 << socket) after each state change of that socket.
+event_source_t* w5500_reconnect_get_event_source(void);
+
+// MQTT keep-alive offload, run by the same thread as the reconnect state
+// machine. Once the MQTT session is up (CONNACK accepted), start it with the
+// keep-alive from CONNECT: Sn_KPALVTR is set so the chip probes an idle TCP
+// connection itself, and after keepAliveSeconds / 2 without a send a
+// pre-encoded PINGREQ is injected. w5500_receive_mqtt_frame() swallows the
+// PINGRESP; none within another keepAliveSeconds / 2 disconnects the socket.
+// A ping never lands inside a packet a send call is still writing: it is put
+// off by W5500_KEEPALIVE_RETRY_MS instead. Disconnecting or releasing the
+// socket stops it (a new connection needs a new CONNECT first).
+#ifndef W5500_KEEPALIVE_RETRY_MS
+#define W5500_KEEPALIVE_RETRY_MS 10
+#endif
+
+struct w5500_keepalive_stats_t
+{
+    uint32_t pingsSent;
+    uint32_t pingResponses;
+    uint32_t missed;                // PINGREQs left unanswered (each dropped the connection)
+};
+
+// INVALID_PARAM for keepAliveSeconds 0 or a socket not handed out,
+// NOT_INITIALIZED unless the socket is ESTABLISHED. Restarting resets the stats.
+w5500_socket_status_t w5500_keepalive_start(uint8_t socket, uint16_t keepAliveSeconds);
+void w5500_keepalive_stop(uint8_t socket);
+// Stats since the last start; false once keep-alive has stopped.
+bool w5500_keepalive_get_stats(uint8_t socket, w5500_keepalive_stats_t* outStats);
+
+#endif // W5500_NATIVE_H
@@ -78,6 +78,89 @@ public class W5500SocketContractTests
         Assert.Equal(4, configureParams.Length);
         Assert.All(configureParams, p => Assert.Equal(typeof(string), p.ParameterType));
     }
+
+    [Theory]
+    [InlineData("NativeBind")]
+    [InlineData("NativeSendTo")]
+    [InlineData("NativeReceiveFrom")]
+    public void UdpNativeMethods_HaveExternShape(string methodName)
+    {
+        var method = typeof(Cubley.Interop.W5500SocketUdp).GetMethod(methodName, BindingFlags.Public | BindingFlags.Static);
+
+        Assert.NotNull(method);
+        Assert.Equal(typeof(int), method.ReturnType);
+        Assert.Null(method.GetMethodBody());
+    }
+
+    [Theory]
+    [InlineData("NativeEnable")]
+    [InlineData("NativeService")]
+    [InlineData("NativeGetStats")]
+    public void LinkProbeNativeMethods_HaveExternShape(string methodName)
+    {
+        var method = typeof(Cubley.Interop.W5500LinkProbe).GetMethod(methodName, BindingFlags.Public | BindingFlags.Static);
+
+        Assert.NotNull(method);
+        Assert.Equal(typeof(int), method.ReturnType);
+        Assert.Null(method.GetMethodBody());
+    }
+
+    [Theory]
+    [InlineData("NativeStart")]
+    [InlineData("NativeStop")]
+    [InlineData("NativeGetState")]
+    public void ReconnectNativeMethods_HaveExternShape(string methodName)
+    {
+        var method = typeof(Cubley.Interop.W5500SocketReconnect).GetMethod(methodName, BindingFlags.Public | BindingFlags.Static);
+
+        Assert.NotNull(method);
+        Assert.Equal(typeof(int), method.ReturnType);
+        Assert.Null(method.GetMethodBody());
+    }
+
+    [Theory]
+    [InlineData("NativeStart")]
+    [InlineData("NativeStop")]
+    [InlineData("NativeGetStats")]
+    public void MqttKeepAliveNativeMethods_HaveExternShape(string methodName)
+    {
+        var method = typeof(Cubley.Interop.W5500MqttKeepAlive).GetMethod(methodName, BindingFlags.Public | BindingFlags.Static);
+
+        Assert.NotNull(method);
+        Assert.Equal(typeof(int), method.ReturnType);
+        Assert.Null(method.GetMethodBody());
+    }
+
+    [Fact]
+    public void SendStreamNativeMethod_HasExternShape()
+    {
+        var method = typeof(Cubley.Interop.W5500SocketTx).GetMethod("NativeSendStream", BindingFlags.Public | BindingFlags.Static);
+
+        Assert.NotNull(method);
+        Assert.Equal(typeof(int), method.ReturnType);
+        Assert.Equal(7, method.GetParameters().Length);
+        Assert.Null(method.GetMethodBody());
+    }
+
+    [Fact]
+    public void ConnectionStateValues_MatchNative()
+    {
+        // w5500_native.h w5500_conn_state_t and w5500_interop.cpp W5500_MANAGED_EVENT_SUBCATEGORY
+        Assert.Equal(0, (int)W5500Socket.ConnectionState.Closed);
+        Assert.Equal(1, (int)W5500Socket.ConnectionState.Init);
+        Assert.Equal(2, (int)W5500Socket.ConnectionState.SynSent);
+        Assert.Equal(3, (int)W5500Socket.ConnectionState.Established);
+        Assert.Equal(4, (int)W5500Socket.ConnectionState.Backoff);
+        Assert.Equal(0xD6, W5500Socket.ConnectionEventSubCategory);
+    }
+
+    [Fact]
+    public void FormatIpv4_UnpacksBigEndianAddress()
+    {
+        Assert.Equal("192.168.1.10", W5500Socket.FormatIpv4(0xC0A8010Au));
+        Assert.Equal("255.255.255.255", W5500Socket.FormatIpv4(0xFFFFFFFFu));
+        Assert.Equal("0.0.0.0", W5500Socket.FormatIpv4(0u));
+    }
 }
 
 public class DiSEqCInteropContractTests
@@ -89,18 +172,66 @@ public class DiSEqCInteropContractTests
         Assert.Equal(1, (int)DiSEqC.Status.Busy);
         Assert.Equal(2, (int)DiSEqC.Status.InvalidParam);
         Assert.Equal(3, (int)DiSEqC.Status.Timeout);
+        Assert.Equal(4, (int)DiSEqC.Status.ReplyError);
+        Assert.Equal(5, (int)DiSEqC.Status.LnbError);
+        Assert.Equal(6, (int)DiSEqC.Status.NotFound);
+        Assert.Equal(7, (int)DiSEqC.Status.Aborted);
+    }
+
+    [Fact]
+    public void SatelliteTableBlobMax_MatchesNative()
+    {
+        // diseqc_sat_table.h DISEQC_SAT_BLOB_MAX (8-byte header + 24 entries × 8)
+        Assert.Equal(200, DiSEqC.SatelliteTableBlobMax);
+    }
+
+    [Fact]
+    public void BurstEnumValues_MatchNative()
+    {
+        // diseqc_native.h diseqc_burst_t
+        Assert.Equal(0, (int)DiSEqC.Burst.SatA);
+        Assert.Equal(1, (int)DiSEqC.Burst.SatB);
+        Assert.Equal(2, (int)DiSEqC.Burst.None);
+    }
+
+    [Fact]
+    public void MotionEnumValues_MatchNative()
+    {
+        // diseqc_motion.h diseqc_motion_state_t
+        Assert.Equal(0, (int)DiSEqC.Motion.Settled);
+        Assert.Equal(1, (int)DiSEqC.Motion.Moving);
+        Assert.Equal(2, (int)DiSEqC.Motion.Driving);
     }
 
     [Theory]
     [InlineData("NativeGotoAngle")]
     [InlineData("NativeTransmit")]
+    [InlineData("NativeEnqueue")]
+    [InlineData("NativeGetCompletedSequence")]
+    [InlineData("NativeQuery")]
+    [InlineData("NativeToneBurst")]
+    [InlineData("NativeSwitch")]
+    [InlineData("NativeSetSite")]
+    [InlineData("NativeGotoUsals")]
+    [InlineData("NativeGotoSatellite")]
+    [InlineData("NativeStoreSatellite")]
+    [InlineData("NativeSetSatellite")]
+    [InlineData("NativeGotoPosition")]
+    [InlineData("NativeStorePosition")]
+    [InlineData("NativeExportSatelliteTable")]
+    [InlineData("NativeImportSatelliteTable")]
     [InlineData("NativeHalt")]
+    [InlineData("NativeAbort")]
+    [InlineData("NativeGetAbortLatency")]
     [InlineData("NativeDriveEast")]
     [InlineData("NativeDriveWest")]
     [InlineData("NativeStepEast")]
     [InlineData("NativeStepWest")]
     [InlineData("NativeIsBusy")]
     [InlineData("NativeGetCurrentAngle")]
+    [InlineData("NativeGetMotionState")]
+    [InlineData("NativeGetMotionEta")]
+    [InlineData("NativeSetMotionProfile")]
     public void InternalNativeMethods_HaveExternShape(string methodName)
     {
         var method = typeof(DiSEqC).GetMethod(methodName, BindingFlags.NonPublic | BindingFlags.Static);
@@ -121,6 +252,17 @@ public class DiSEqCInteropContractTests
         Assert.Single(transmit.GetParameters());
         Assert.Equal(typeof(byte[]), transmit.GetParameters()[0].ParameterType);
     }
+
+    [Fact]
+    public void CompletionEventConstants_MatchNative()
+    {
+        // diseqc_interop.cpp DISEQC_MANAGED_EVENT_SUBCATEGORY and diseqc_native.h DISEQC_EVT_*
+        Assert.Equal(0xD5, DiSEqC.CompletionEventSubCategory);
+        Assert.Equal(0x01, DiSEqC.CompletionFlagFrameDone);
+        Assert.Equal(0x02, DiSEqC.CompletionFlagIdle);
+        Assert.Equal(0x04, DiSEqC.CompletionFlagSettled);
+        Assert.Equal(0x08, DiSEqC.CompletionFlagAborted);
+    }
 }
 
 public class LnbInteropContractTests
@@ -169,6 +169,30 @@ public class MqttPacketTests
         Assert.Equal(0x4242, packetId);
     }
 
+    [Fact]
+    public void DecodePublish_InPlaceRangeIgnoresTrailingBytes()
+    {
+        byte[] packet = MqttPacket.EncodePublish("t/buf", new byte[] { 9, 8 }, qos: 1, retain: false, packetId: 0x0102);
+        MqttPacket.DecodeRemainingLength(packet, 1, out int rlBytes);
+        int length = packet.Length - 1 - rlBytes;
+
+        // Same layout as the reused receive buffer: header at [0], stale bytes after the packet.
+        byte[] buffer = new byte[1 + length + 4];
+        buffer[0] = packet[0];
+        System.Array.Copy(packet, 1 + rlBytes, buffer, 1, length);
+        for (int i = 1 + length; i < buffer.Length; i++)
+        {
+            buffer[i] = 0xEE;
+        }
+
+        MqttPacket.DecodePublish(buffer[0], buffer, 1, length, out string topic, out byte[] payload, out byte qos, out ushort packetId);
+
+        Assert.Equal("t/buf", topic);
+        Assert.Equal(new byte[] { 9, 8 }, payload);
+        Assert.Equal(1, qos);
+        Assert.Equal(0x0102, packetId);
+    }
+
     [Fact]
     public void EncodeSubscribe_HasReservedFlagsAndQosByte()
     {
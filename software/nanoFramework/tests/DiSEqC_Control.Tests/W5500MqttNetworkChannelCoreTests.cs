@@ -14,10 +14,65 @@ public class W5500MqttNetworkChannelCoreTests
         core.Connect();
 
         Assert.Equal(1, api.OpenCallCount);
-        Assert.Equal(1, api.ConnectCallCount);
+        Assert.Equal(1, api.StartReconnectCallCount);
+        Assert.Equal(1500, api.LastWaitTimeoutMs);
         Assert.True(core.DataAvailable);
     }
 
+    [Fact]
+    public void Connect_WhenWaitTimesOut_KeepsSocketSupervised()
+    {
+        var api = new FakeW5500SocketApi
+        {
+            Reachable = false
+        };
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+
+        Assert.Throws<InvalidOperationException>(() => core.Connect());
+        Assert.Equal(0, api.CloseCallCount);
+        Assert.True(core.ConnectWaitTimedOut);
+
+        api.Reachable = true;
+        core.Connect();
+
+        Assert.False(core.ConnectWaitTimedOut);
+        Assert.Equal(1, api.OpenCallCount);
+        Assert.Equal(1, api.StartReconnectCallCount);
+        Assert.True(core.DataAvailable);
+    }
+
+    [Fact]
+    public void Connect_WhenOpenFails_DoesNotReportWaitTimeout()
+    {
+        var api = new FakeW5500SocketApi
+        {
+            OpenStatus = W5500Socket.Status.IoError
+        };
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+
+        Assert.Throws<InvalidOperationException>(() => core.Connect());
+        Assert.False(core.ConnectWaitTimedOut);
+        Assert.Equal(0, api.LastWaitTimeoutMs);
+    }
+
+    [Fact]
+    public void ReceiveMqttFrame_AfterNativeReconnect_ThrowsUntilConnectedAgain()
+    {
+        var api = new FakeW5500SocketApi();
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+        core.Connect();
+        Assert.Equal(2, core.ReceiveMqttFrame(new byte[8], 100));
+
+        // The reconnect thread replaced the connection: same socket, new session
+        api.Connects++;
+        Assert.Throws<InvalidOperationException>(() => core.ReceiveMqttFrame(new byte[8], 100));
+        Assert.Throws<InvalidOperationException>(() => core.Send(new byte[] { 0xC0, 0x00 }));
+
+        core.Connect();
+        Assert.Equal(2, core.ReceiveMqttFrame(new byte[8], 100));
+        Assert.Equal(1, api.OpenCallCount);
+    }
+
     [Fact]
     public void Send_UsesLoopUntilAllBytesSent()
     {
@@ -32,6 +87,21 @@ public class W5500MqttNetworkChannelCoreTests
 
         Assert.Equal(5, sent);
         Assert.True(api.SendCallCount >= 3);
+        Assert.False(api.LastSendWaitedForSendOk);
+    }
+
+    [Fact]
+    public void StartKeepAlive_HandsIntervalToNativeDriver()
+    {
+        var api = new FakeW5500SocketApi();
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+
+        Assert.Throws<InvalidOperationException>(() => core.StartKeepAlive(60));
+
+        core.Connect();
+        core.StartKeepAlive(60);
+
+        Assert.Equal(60, api.LastKeepAliveSeconds);
     }
 
     [Fact]
@@ -64,6 +134,77 @@ public class W5500MqttNetworkChannelCoreTests
         Assert.Contains("IoError", ex.Message);
     }
 
+    [Fact]
+    public void ReceiveExact_FillsRequestedRangeAtOffset()
+    {
+        var api = new FakeW5500SocketApi();
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+        core.Connect();
+
+        var buffer = new byte[8];
+        int received = core.ReceiveExact(buffer, 2, 5, 300);
+
+        Assert.Equal(5, received);
+        Assert.Equal(new byte[] { 0, 0, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0 }, buffer);
+    }
+
+    [Fact]
+    public void ReceiveExact_WhenTimeout_ReturnsPartialCount()
+    {
+        var api = new FakeW5500SocketApi
+        {
+            ReceiveStatus = W5500Socket.Status.Timeout,
+            PartialCount = 3
+        };
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+        core.Connect();
+
+        int received = core.ReceiveExact(new byte[8], 0, 8, 300);
+
+        Assert.Equal(3, received);
+    }
+
+    [Fact]
+    public void Available_ReportsPendingBytes()
+    {
+        var api = new FakeW5500SocketApi
+        {
+            PendingBytes = 17
+        };
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+        core.Connect();
+
+        Assert.Equal(17, core.Available);
+    }
+
+    [Fact]
+    public void ReceiveMqttFrame_WhenBufferTooSmall_ReturnsNegatedRequiredLength()
+    {
+        var api = new FakeW5500SocketApi
+        {
+            FrameLength = 300
+        };
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+        core.Connect();
+
+        Assert.Equal(-300, core.ReceiveMqttFrame(new byte[256], 300));
+        Assert.Equal(300, core.ReceiveMqttFrame(new byte[300], 300));
+    }
+
+    [Fact]
+    public void ReceiveMqttFrame_WhenBodyCutShort_Throws()
+    {
+        var api = new FakeW5500SocketApi
+        {
+            ReceiveStatus = W5500Socket.Status.Timeout,
+            PartialCount = 4
+        };
+        var core = new W5500MqttNetworkChannelCore("broker.local", 1883, 1500, 2500, api);
+        core.Connect();
+
+        Assert.Throws<InvalidOperationException>(() => core.ReceiveMqttFrame(new byte[64], 300));
+    }
+
     [Fact]
     public void Close_CallsCloseAndMarksDisconnected()
     {
@@ -93,30 +234,60 @@ public class W5500MqttNetworkChannelCoreTests
         private bool _connected;
 
         public int OpenCallCount { get; private set; }
-        public int ConnectCallCount { get; private set; }
+        public int StartReconnectCallCount { get; private set; }
+        public int LastWaitTimeoutMs { get; private set; }
         public int SendCallCount { get; private set; }
+        public bool LastSendWaitedForSendOk { get; private set; } = true;
+        public int LastKeepAliveSeconds { get; private set; }
         public int CloseCallCount { get; private set; }
 
         public int SendChunkSize { get; set; } = int.MaxValue;
         public W5500Socket.Status ReceiveStatus { get; set; } = W5500Socket.Status.Ok;
+        public int PartialCount { get; set; }
+        public int PendingBytes { get; set; }
+        public int FrameLength { get; set; } = 2;
+        public bool Reachable { get; set; } = true;
+        public int Connects { get; set; } = 1;
+        public W5500Socket.Status OpenStatus { get; set; } = W5500Socket.Status.Ok;
 
         public W5500Socket.Status Open(out int socketHandle)
         {
             OpenCallCount++;
             socketHandle = _nextSocketHandle++;
+            return OpenStatus;
+        }
+
+        public W5500Socket.Status StartReconnect(int socketHandle, string host, int port, int connectTimeoutMs, int minBackoffMs, int maxBackoffMs)
+        {
+            StartReconnectCallCount++;
+            return W5500Socket.Status.Ok;
+        }
+
+        public W5500Socket.Status GetConnectionState(int socketHandle, out W5500Socket.ConnectionState state, out int connects, out int attempts)
+        {
+            state = _connected ? W5500Socket.ConnectionState.Established : W5500Socket.ConnectionState.SynSent;
+            connects = Connects;
+            attempts = Connects;
             return W5500Socket.Status.Ok;
         }
 
-        public W5500Socket.Status Connect(int socketHandle, string host, int port, int timeoutMs)
+        public W5500Socket.Status WaitForConnectionState(int socketHandle, W5500Socket.ConnectionState state, int timeoutMs)
+        {
+            LastWaitTimeoutMs = timeoutMs;
+            _connected = Reachable;
+            return _connected ? W5500Socket.Status.Ok : W5500Socket.Status.Timeout;
+        }
+
+        public W5500Socket.Status StartMqttKeepAlive(int socketHandle, int keepAliveSeconds)
         {
-            ConnectCallCount++;
-            _connected = true;
+            LastKeepAliveSeconds = keepAliveSeconds;
             return W5500Socket.Status.Ok;
         }
 
-        public W5500Socket.Status Send(int socketHandle, byte[] data, int offset, int count, out int sent)
+        public W5500Socket.Status SendStream(int socketHandle, byte[] data, int offset, int count, int timeoutMs, bool waitForSendOk, out int sent)
         {
             SendCallCount++;
+            LastSendWaitedForSendOk = waitForSendOk;
             sent = count > SendChunkSize ? SendChunkSize : count;
             return W5500Socket.Status.Ok;
         }
@@ -138,6 +309,41 @@ public class W5500MqttNetworkChannelCoreTests
             return W5500Socket.Status.Ok;
         }
 
+        public W5500Socket.Status ReceiveExact(int socketHandle, byte[] buffer, int offset, int count, int timeoutMs, out int received)
+        {
+            received = ReceiveStatus == W5500Socket.Status.Ok ? count : PartialCount;
+            for (int i = 0; i < received; i++)
+            {
+                buffer[offset + i] = 0xAA;
+            }
+
+            return ReceiveStatus;
+        }
+
+        public W5500Socket.Status PeekAvailable(int socketHandle, out int available)
+        {
+            available = PendingBytes;
+            return W5500Socket.Status.Ok;
+        }
+
+        public W5500Socket.Status ReceiveMqttFrame(int socketHandle, byte[] buffer, int timeoutMs, out int length)
+        {
+            if (ReceiveStatus != W5500Socket.Status.Ok)
+            {
+                length = PartialCount;
+                return ReceiveStatus;
+            }
+
+            length = FrameLength;
+            if (FrameLength > buffer.Length)
+            {
+                return W5500Socket.Status.InvalidParam;
+            }
+
+            buffer[0] = 0x30;
+            return W5500Socket.Status.Ok;
+        }
+
         public W5500Socket.Status Close(int socketHandle)
         {
             CloseCallCount++;
@@ -0,0 +1,77 @@
+/**
+ * @file diseqc_player_model.cpp
+ * @brief Host-side timing model of the DiSEqC segment player
+ */
+
+#include "diseqc_player_model.h"
+
+static uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+model_cpu_t model_default_cpu(void)
+{
+    model_cpu_t cpu;
+    cpu.irq_latency_ns = 150;
+    cpu.isr_cost_ns = 1200;
+    cpu.context_switch_ns = 600;
+    cpu.thread_body_ns = 900;
+    cpu.sched_delay_max_ns = 50000;
+    cpu.seed = 0x1234567u;
+    return cpu;
+}
+
+model_result_t model_play(diseqc_bits_t frame, model_tx_mode_t mode, const model_cpu_t *cpu)
+{
+    model_result_t result = {0, 0, 0, 0, 0, 0, 0};
+    uint32_t rng = cpu->seed != 0 ? cpu->seed : 1;
+
+    diseqc_player_t player;
+    diseqc_player_load(&player, frame, DISEQC_CARRIER_DUTY);
+
+    uint64_t now = 0;           // Time the current segment's edge is applied
+    uint64_t ideal = 0;         // Time the edge should have been applied
+    const diseqc_segment_t *seg = diseqc_player_current(&player);
+
+    while (seg != NULL) {
+        uint64_t edge = now;
+        uint64_t expiry = edge + (uint64_t)seg->duration_us * 1000u;
+
+        result.segments++;
+        result.isr_count++;
+        result.cpu_ns += cpu->isr_cost_ns;
+
+        // Time at which the next segment (or carrier OFF) is applied
+        uint64_t next = expiry + cpu->irq_latency_ns + cpu->isr_cost_ns;
+
+        if (mode == MODEL_TX_THREAD) {
+            uint32_t sched_delay = cpu->sched_delay_max_ns != 0
+                                 ? xorshift32(&rng) % (cpu->sched_delay_max_ns + 1u)
+                                 : 0;
+            next += cpu->context_switch_ns + sched_delay + cpu->thread_body_ns;
+            result.thread_wakeups++;
+            result.cpu_ns += 2u * cpu->context_switch_ns + cpu->thread_body_ns;
+        }
+
+        uint64_t nominal = (uint64_t)seg->duration_us * 1000u;
+        uint64_t actual = next - edge;
+        uint64_t error = actual > nominal ? actual - nominal : nominal - actual;
+        if (error > result.max_segment_error_ns) {
+            result.max_segment_error_ns = (uint32_t)error;
+        }
+
+        ideal += nominal;
+        now = next;
+        seg = diseqc_player_advance(&player);
+    }
+
+    result.frame_ns = now;
+    result.drift_ns = now - ideal;
+    return result;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file diseqc_player_model.h
+ * @brief Host-side timing model of the DiSEqC segment player
+ *
+ * Replays a packed frame through the same diseqc_player_t cursor used by
+ * diseqc_native.cpp and models when each carrier edge would actually land on
+ * the target for the two transmit modes:
+ * - THREAD: GPT ISR signals diseqc_tx, which is scheduled and reloads the timer
+ * - ISR:    GPT ISR reloads PWM and the timer itself
+ *
+ * All times are in nanoseconds. Scheduler load is modelled as a uniformly
+ * distributed extra delay before diseqc_tx gets the CPU after being signalled.
+ */
+
+#ifndef DISEQC_PLAYER_MODEL_H
+#define DISEQC_PLAYER_MODEL_H
+
+#include "diseqc_frame.h"
+
+typedef enum {
+    MODEL_TX_THREAD = 0,
+    MODEL_TX_ISR = 1
+} model_tx_mode_t;
+
+typedef struct {
+    uint32_t irq_latency_ns;        // Timer expiry to first ISR instruction
+    uint32_t isr_cost_ns;           // GPT ISR body incl. PWM/GPT reload
+    uint32_t context_switch_ns;     // One ChibiOS context switch
+    uint32_t thread_body_ns;        // diseqc_tx loop body per segment
+    uint32_t sched_delay_max_ns;    // Worst extra delay from other runnable work
+    uint32_t seed;                  // PRNG seed for the scheduler delay
+} model_cpu_t;
+
+typedef struct {
+    uint32_t segments;              // Segments played
+    uint32_t isr_count;             // GPT interrupts taken
+    uint32_t thread_wakeups;        // diseqc_tx wakeups
+    uint64_t cpu_ns;                // CPU time spent on the frame
+    uint32_t max_segment_error_ns;  // Worst |actual - nominal| segment length
+    uint64_t drift_ns;              // Frame end lateness vs. ideal timing
+    uint64_t frame_ns;              // Actual frame duration
+} model_result_t;
+
+/**
+ * @brief F407 @ 168 MHz defaults used by the unit tests
+ */
+model_cpu_t model_default_cpu(void);
+
+/**
+ * @brief Play a packed frame and collect timing/CPU statistics
+ */
+model_result_t model_play(diseqc_bits_t frame, model_tx_mode_t mode, const model_cpu_t *cpu);
+
+#endif /* DISEQC_PLAYER_MODEL_H */
@@ -0,0 +1,71 @@
+/**
+ * @file link_frames.cpp
+ * @brief Ethernet test frames for the W5500 link probe tests
+ */
+
+#include "link_frames.h"
+#include "w5500_link_responder.h"
+
+#include <string.h>
+
+static const uint8_t kBroadcastMac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)(v & 0xFF);
+}
+
+uint16_t link_frames_arp_request(uint8_t *frame, const uint8_t sender_mac[6], const uint8_t sender_ip[4],
+                                 const uint8_t target_ip[4])
+{
+    memcpy(&frame[0], kBroadcastMac, 6);
+    memcpy(&frame[6], sender_mac, 6);
+    put16(&frame[12], 0x0806);
+
+    uint8_t *arp = &frame[14];
+    put16(&arp[0], 1);                  // Ethernet
+    put16(&arp[2], 0x0800);             // IPv4
+    arp[4] = 6;
+    arp[5] = 4;
+    put16(&arp[6], 1);                  // Request
+    memcpy(&arp[8], sender_mac, 6);
+    memcpy(&arp[14], sender_ip, 4);
+    memset(&arp[18], 0, 6);
+    memcpy(&arp[24], target_ip, 4);
+    return 42;
+}
+
+uint16_t link_frames_echo_request(uint8_t *frame, const uint8_t dst_mac[6], const uint8_t src_mac[6],
+                                  const uint8_t src_ip[4], const uint8_t dst_ip[4],
+                                  uint16_t id, uint16_t seq, uint16_t data_len)
+{
+    memcpy(&frame[0], dst_mac, 6);
+    memcpy(&frame[6], src_mac, 6);
+    put16(&frame[12], 0x0800);
+
+    uint8_t *ip = &frame[14];
+    memset(ip, 0, 20);
+    ip[0] = 0x45;
+    put16(&ip[2], (uint16_t)(20 + 8 + data_len));
+    put16(&ip[4], seq);                 // Identification
+    put16(&ip[6], 0x4000);              // Don't fragment
+    ip[8] = 128;
+    ip[9] = 1;                          // ICMP
+    memcpy(&ip[12], src_ip, 4);
+    memcpy(&ip[16], dst_ip, 4);
+    put16(&ip[10], link_responder_checksum(ip, 20));
+
+    uint8_t *icmp = &ip[20];
+    icmp[0] = 8;
+    icmp[1] = 0;
+    put16(&icmp[2], 0);
+    put16(&icmp[4], id);
+    put16(&icmp[6], seq);
+    for (uint16_t i = 0; i < data_len; i++) {
+        icmp[8 + i] = (uint8_t)i;
+    }
+    put16(&icmp[2], link_responder_checksum(icmp, (uint16_t)(8 + data_len)));
+
+    return (uint16_t)(LINK_FRAMES_ECHO_HEADER_BYTES + data_len);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file link_frames.h
+ * @brief Ethernet test frames for the W5500 link probe tests
+ *
+ * Builds the ARP and ICMP echo requests a pinging host would send, with
+ * valid checksums, so tests can corrupt exactly one field at a time.
+ */
+
+#ifndef LINK_FRAMES_H
+#define LINK_FRAMES_H
+
+#include <stdint.h>
+
+#define LINK_FRAMES_ECHO_HEADER_BYTES   42      // Ethernet + IPv4 + ICMP echo header
+
+/**
+ * @brief ARP who-has target_ip, broadcast from sender_mac/sender_ip
+ * @return Frame length (42, unpadded)
+ */
+uint16_t link_frames_arp_request(uint8_t *frame, const uint8_t sender_mac[6], const uint8_t sender_ip[4],
+                                 const uint8_t target_ip[4]);
+
+/**
+ * @brief ICMP echo request with data_len bytes of 0x00, 0x01, ... data
+ * @return Frame length (42 + data_len)
+ */
+uint16_t link_frames_echo_request(uint8_t *frame, const uint8_t dst_mac[6], const uint8_t src_mac[6],
+                                  const uint8_t src_ip[4], const uint8_t dst_ip[4],
+                                  uint16_t id, uint16_t seq, uint16_t data_len);
+
+#endif /* LINK_FRAMES_H */
@@ -0,0 +1,188 @@
+/**
+ * @file ch.h
+ * @brief Host simulation of the ChibiOS/RT 21.11 kernel subset used by nf-native
+ *
+ * Only what the drivers in nf-native/ call is provided. Time is virtual: it
+ * advances only when every thread is blocked (sleeps, semaphore/event waits,
+ * SPI and I2C transfers), and every expiry due on the way (GPT one-shots,
+ * virtual timers, device model events) runs at its exact virtual timestamp.
+ *
+ * Threads run on their own host stacks under a deterministic priority
+ * scheduler: the highest-priority ready thread runs until it blocks or readies
+ * a higher-priority one, interrupts (timer and device events) run between
+ * threads. Nothing is preempted mid-instruction, so locks only count nesting.
+ * The test's main() is the NORMALPRIO "main" thread. See sim_hal.h for the
+ * control API used by the benchmarks.
+ */
+
+#ifndef SIM_CH_H
+#define SIM_CH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef TRUE
+#define TRUE                        1
+#endif
+#ifndef FALSE
+#define FALSE                       0
+#endif
+
+/* Same tick rate as target-overrides/nanoCLR/chconf.h */
+#define CH_CFG_ST_FREQUENCY         10000
+
+typedef uint32_t systime_t;
+typedef uint32_t sysinterval_t;
+typedef uint32_t rtcnt_t;
+typedef int32_t msg_t;
+typedef uint32_t eventmask_t;
+typedef uint32_t eventflags_t;
+typedef uint32_t tprio_t;
+
+#define MSG_OK                      (msg_t)0
+#define MSG_TIMEOUT                 (msg_t)-1
+#define MSG_RESET                   (msg_t)-2
+
+#define TIME_IMMEDIATE              ((sysinterval_t)0)
+#define TIME_INFINITE               ((sysinterval_t)-1)
+
+#define TIME_S2I(secs)              ((sysinterval_t)((uint64_t)(secs) * CH_CFG_ST_FREQUENCY))
+#define TIME_MS2I(msecs)            ((sysinterval_t)((((uint64_t)(msecs) * CH_CFG_ST_FREQUENCY) + 999) / 1000))
+#define TIME_US2I(usecs)            ((sysinterval_t)((((uint64_t)(usecs) * CH_CFG_ST_FREQUENCY) + 999999) / 1000000))
+#define TIME_I2MS(interval)         ((uint32_t)((((uint64_t)(interval) * 1000) + CH_CFG_ST_FREQUENCY - 1) / CH_CFG_ST_FREQUENCY))
+#define TIME_I2US(interval)         ((uint32_t)((((uint64_t)(interval) * 1000000) + CH_CFG_ST_FREQUENCY - 1) / CH_CFG_ST_FREQUENCY))
+
+/* Realtime counter conversions (port macros) */
+#define RTC2US(freq, n)             ((((n) - 1UL) / ((freq) / 1000000UL)) + 1UL)
+#define US2RTC(freq, usec)          ((rtcnt_t)(((freq) + 999999UL) / 1000000UL) * (usec))
+
+#define NORMALPRIO                  128
+#define HIGHPRIO                    255
+#define LOWPRIO                     2
+
+#define EVENT_MASK(eid)             ((eventmask_t)1 << (eventmask_t)(eid))
+#define ALL_EVENTS                  ((eventmask_t)-1)
+
+typedef void (*tfunc_t)(void *p);
+
+struct sim_context;
+
+typedef struct sim_thread {
+    const char *name;
+    tfunc_t func;
+    void *arg;
+    tprio_t prio;
+    uint8_t state;                      // sim_hal.cpp scheduler state
+    uint64_t deadline_ns;               // Blocked until this time...
+    bool (*wake)(const void *arg);      // ...or until wake(wake_arg) holds
+    const void *wake_arg;
+    bool woken;                         // Last block ended by wake(), not timeout
+    eventmask_t epending;
+    struct sim_context *context;        // Host stack and register state
+} thread_t;
+
+/* Threads run on host-allocated stacks: the working area only keeps sizeof() budgets meaningful */
+#define THD_WORKING_AREA_SIZE(n)    (n)
+#define THD_WORKING_AREA(s, n)      uint8_t s[THD_WORKING_AREA_SIZE(n)]
+#define THD_FUNCTION(tname, arg)    void tname(void *arg)
+
+typedef struct {
+    volatile bool taken;
+} binary_semaphore_t;
+
+typedef struct {
+    thread_t *owner;
+} mutex_t;
+
+#define MUTEX_DECL(name)            mutex_t name = {NULL}
+
+struct event_listener;
+
+typedef struct {
+    struct event_listener *next;
+} event_source_t;
+
+#define EVENTSOURCE_DECL(name)      event_source_t name = {NULL}
+
+typedef struct event_listener {
+    struct event_listener *next;
+    thread_t *listener;
+    eventmask_t events;
+    eventflags_t flags;
+    eventflags_t wflags;
+} event_listener_t;
+
+struct sim_vt;
+typedef void (*vtfunc_t)(struct sim_vt *vtp, void *p);
+
+typedef struct sim_vt {
+    bool armed;
+    uint64_t deadline_ns;
+    vtfunc_t func;
+    void *par;
+    struct sim_vt *next;
+} virtual_timer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* System locks: callbacks never preempt host code, so these only count nesting */
+void chSysLock(void);
+void chSysUnlock(void);
+void chSysLockFromISR(void);
+void chSysUnlockFromISR(void);
+void chSchRescheduleS(void);
+rtcnt_t chSysGetRealtimeCounterX(void);
+
+/* Threads */
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg);
+thread_t *chThdGetSelfX(void);
+void chRegSetThreadName(const char *name);
+void chThdSleep(sysinterval_t time);
+#define chThdSleepSeconds(sec)      chThdSleep(TIME_S2I(sec))
+#define chThdSleepMilliseconds(ms)  chThdSleep(TIME_MS2I(ms))
+#define chThdSleepMicroseconds(us)  chThdSleep(TIME_US2I(us))
+
+/* Binary semaphores */
+void chBSemObjectInit(binary_semaphore_t *bsp, bool taken);
+msg_t chBSemWait(binary_semaphore_t *bsp);
+msg_t chBSemWaitTimeout(binary_semaphore_t *bsp, sysinterval_t timeout);
+void chBSemSignal(binary_semaphore_t *bsp);
+void chBSemSignalI(binary_semaphore_t *bsp);
+void chBSemResetI(binary_semaphore_t *bsp, bool taken);
+void chBSemReset(binary_semaphore_t *bsp, bool taken);
+
+/* Mutexes: no priority inheritance, waiters take the mutex in priority order */
+void chMtxObjectInit(mutex_t *mp);
+void chMtxLock(mutex_t *mp);
+void chMtxUnlock(mutex_t *mp);
+
+/* Event sources: flags broadcast to listeners, events pend on the registering thread */
+void chEvtObjectInit(event_source_t *esp);
+void chEvtRegisterMaskWithFlags(event_source_t *esp, event_listener_t *elp,
+                                eventmask_t events, eventflags_t wflags);
+void chEvtRegisterMask(event_source_t *esp, event_listener_t *elp, eventmask_t events);
+void chEvtUnregister(event_source_t *esp, event_listener_t *elp);
+void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags);
+void chEvtBroadcastFlags(event_source_t *esp, eventflags_t flags);
+eventflags_t chEvtGetAndClearFlags(event_listener_t *elp);
+eventmask_t chEvtWaitAnyTimeout(eventmask_t events, sysinterval_t timeout);
+
+/* Virtual timers and system time */
+void chVTObjectInit(virtual_timer_t *vtp);
+void chVTSetI(virtual_timer_t *vtp, sysinterval_t delay, vtfunc_t vtfunc, void *par);
+void chVTSet(virtual_timer_t *vtp, sysinterval_t delay, vtfunc_t vtfunc, void *par);
+void chVTResetI(virtual_timer_t *vtp);
+void chVTReset(virtual_timer_t *vtp);
+bool chVTIsArmedI(const virtual_timer_t *vtp);
+systime_t chVTGetSystemTimeX(void);
+#define chVTGetSystemTime()         chVTGetSystemTimeX()
+sysinterval_t chVTTimeElapsedSinceX(systime_t start);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_CH_H */
@@ -0,0 +1,314 @@
+/**
+ * @file hal.h
+ * @brief Host simulation of the ChibiOS HAL subset used by nf-native
+ *
+ * PWM and GPT drivers run on the virtual clock from ch.h; PAL lines are
+ * plain bitfields on simulated GPIO ports; SPI and I2C transfers are handed
+ * byte-by-byte to the device models attached with sim_spi_attach() /
+ * sim_i2c_attach() and take the bus time their clock configuration implies.
+ */
+
+#ifndef SIM_HAL_H_INCLUDED
+#define SIM_HAL_H_INCLUDED
+
+#include "ch.h"
+
+/* Clock tree of the F407 target (168 MHz HCLK, APB1 42 MHz) */
+#define STM32_HCLK                  168000000U
+#define STM32_PCLK1                 42000000U
+#define STM32_PCLK2                 84000000U
+
+/*===========================================================================*/
+/* STM32 register blocks touched directly by the drivers                     */
+/*===========================================================================*/
+
+/* Aligned so PAL_LINE() can pack the pad number into the low bits */
+typedef struct alignas(16) {
+    volatile uint32_t MODER;
+    volatile uint32_t OTYPER;
+    volatile uint32_t OSPEEDR;
+    volatile uint32_t PUPDR;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    volatile uint32_t BSRR;
+    volatile uint32_t LCKR;
+    volatile uint32_t AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t SR;
+    volatile uint32_t DR;
+} SPI_TypeDef;
+
+extern GPIO_TypeDef SIM_GPIOA, SIM_GPIOB, SIM_GPIOC, SIM_GPIOD, SIM_GPIOE;
+extern SPI_TypeDef SIM_SPI1, SIM_SPI2;
+
+#define GPIOA                       (&SIM_GPIOA)
+#define GPIOB                       (&SIM_GPIOB)
+#define GPIOC                       (&SIM_GPIOC)
+#define GPIOD                       (&SIM_GPIOD)
+#define GPIOE                       (&SIM_GPIOE)
+#define SPI1                        (&SIM_SPI1)
+#define SPI2                        (&SIM_SPI2)
+
+#define SPI_CR1_CPHA                (1U << 0)
+#define SPI_CR1_CPOL                (1U << 1)
+#define SPI_CR1_MSTR                (1U << 2)
+#define SPI_CR1_BR_0                (1U << 3)
+#define SPI_CR1_BR_1                (1U << 4)
+#define SPI_CR1_BR_2                (1U << 5)
+#define SPI_CR1_BR                  (SPI_CR1_BR_0 | SPI_CR1_BR_1 | SPI_CR1_BR_2)
+#define SPI_CR1_SPE                 (1U << 6)
+#define SPI_SR_TXE                  (1U << 1)
+
+/*===========================================================================*/
+/* PAL                                                                       */
+/*===========================================================================*/
+
+typedef GPIO_TypeDef *ioportid_t;
+typedef uint32_t ioportmask_t;
+typedef uint32_t iomode_t;
+typedef uintptr_t ioline_t;
+typedef void (*palcallback_t)(void *arg);
+
+#define PAL_LOW                     0U
+#define PAL_HIGH                    1U
+
+#define PAL_LINE(port, pad)         ((ioline_t)((uintptr_t)(port)) | ((ioline_t)(pad)))
+#define PAL_PORT(line)              ((ioportid_t)(((uintptr_t)(line)) & ~(uintptr_t)0x0F))
+#define PAL_PAD(line)               ((uint32_t)((uintptr_t)(line) & 0x0FU))
+
+#define PAL_MODE_RESET              0U
+#define PAL_MODE_UNCONNECTED        1U
+#define PAL_MODE_INPUT              2U
+#define PAL_MODE_INPUT_PULLUP       3U
+#define PAL_MODE_INPUT_PULLDOWN     4U
+#define PAL_MODE_INPUT_ANALOG       5U
+#define PAL_MODE_OUTPUT_PUSHPULL    6U
+#define PAL_MODE_OUTPUT_OPENDRAIN   7U
+#define PAL_STM32_MODE_MASK         0x0FU
+#define PAL_STM32_MODE_ALTERNATE    0x08U
+#define PAL_MODE_ALTERNATE(n)       (PAL_STM32_MODE_ALTERNATE | ((iomode_t)(n) << 8))
+#define PAL_STM32_OTYPE_OPENDRAIN   (1U << 4)
+#define PAL_STM32_PUPDR_PULLUP      (1U << 5)
+#define PAL_STM32_PUPDR_PULLDOWN    (1U << 6)
+#define PAL_STM32_OSPEED_HIGHEST    (1U << 7)
+
+#define PAL_EVENT_MODE_DISABLED     0U
+#define PAL_EVENT_MODE_RISING_EDGE  1U
+#define PAL_EVENT_MODE_FALLING_EDGE 2U
+#define PAL_EVENT_MODE_BOTH_EDGES   3U
+
+#define PAL_USE_CALLBACKS           TRUE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void palSetLineMode(ioline_t line, iomode_t mode);
+void palSetLine(ioline_t line);
+void palClearLine(ioline_t line);
+void palWriteLine(ioline_t line, uint32_t bit);
+void palToggleLine(ioline_t line);
+uint32_t palReadLine(ioline_t line);
+void palEnableLineEvent(ioline_t line, uint32_t mode);
+void palDisableLineEvent(ioline_t line);
+void palSetLineCallback(ioline_t line, palcallback_t cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* PWM                                                                       */
+/*===========================================================================*/
+
+#define PWM_CHANNELS                4
+#define PWM_OUTPUT_DISABLED         0x00U
+#define PWM_OUTPUT_ACTIVE_HIGH      0x01U
+#define PWM_OUTPUT_ACTIVE_LOW       0x02U
+
+typedef uint32_t pwmcnt_t;
+typedef uint8_t pwmchannel_t;
+typedef struct PWMDriver PWMDriver;
+typedef void (*pwmcallback_t)(PWMDriver *pwmp);
+
+typedef struct {
+    uint32_t mode;
+    pwmcallback_t callback;
+} PWMChannelConfig;
+
+typedef struct {
+    uint32_t frequency;
+    pwmcnt_t period;
+    pwmcallback_t callback;
+    PWMChannelConfig channels[PWM_CHANNELS];
+    uint32_t cr2;
+    uint32_t bdtr;
+    uint32_t dier;
+} PWMConfig;
+
+struct PWMDriver {
+    const PWMConfig *config;
+    bool started;
+    pwmcnt_t width[PWM_CHANNELS];
+};
+
+extern PWMDriver PWMD4;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void pwmStart(PWMDriver *pwmp, const PWMConfig *config);
+void pwmStop(PWMDriver *pwmp);
+void pwmEnableChannel(PWMDriver *pwmp, pwmchannel_t channel, pwmcnt_t width);
+void pwmEnableChannelI(PWMDriver *pwmp, pwmchannel_t channel, pwmcnt_t width);
+void pwmDisableChannel(PWMDriver *pwmp, pwmchannel_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* GPT                                                                       */
+/*===========================================================================*/
+
+typedef uint32_t gptcnt_t;
+typedef uint32_t gptfreq_t;
+typedef struct GPTDriver GPTDriver;
+typedef void (*gptcallback_t)(GPTDriver *gptp);
+
+typedef enum {
+    GPT_UNINIT = 0,
+    GPT_STOP = 1,
+    GPT_READY = 2,
+    GPT_CONTINUOUS = 3,
+    GPT_ONESHOT = 4
+} gptstate_t;
+
+typedef struct {
+    gptfreq_t frequency;
+    gptcallback_t callback;
+    uint32_t cr2;
+    uint32_t dier;
+} GPTConfig;
+
+struct GPTDriver {
+    gptstate_t state;
+    const GPTConfig *config;
+    uint64_t deadline_ns;
+    GPTDriver *next;
+};
+
+extern GPTDriver GPTD5;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void gptStart(GPTDriver *gptp, const GPTConfig *config);
+void gptStop(GPTDriver *gptp);
+void gptStartOneShot(GPTDriver *gptp, gptcnt_t interval);
+void gptStartOneShotI(GPTDriver *gptp, gptcnt_t interval);
+void gptStopTimer(GPTDriver *gptp);
+void gptStopTimerI(GPTDriver *gptp);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* SPI (v1 API, line select)                                                 */
+/*===========================================================================*/
+
+#define SPI_SELECT_MODE_NONE        0
+#define SPI_SELECT_MODE_PAD         1
+#define SPI_SELECT_MODE_PORT        2
+#define SPI_SELECT_MODE_LINE        3
+#define SPI_SELECT_MODE             SPI_SELECT_MODE_LINE
+#define SPI_SUPPORTS_CIRCULAR       FALSE
+
+typedef struct SPIDriver SPIDriver;
+typedef void (*spicallback_t)(SPIDriver *spip);
+
+typedef struct {
+    spicallback_t end_cb;
+    ioline_t ssline;
+    uint16_t cr1;
+    uint16_t cr2;
+} SPIConfig;
+
+struct sim_spi_device;
+
+struct SPIDriver {
+    const SPIConfig *config;
+    SPI_TypeDef *spi;
+    struct sim_spi_device *device;
+    bool selected;
+};
+
+extern SPIDriver SPID2;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void spiStart(SPIDriver *spip, const SPIConfig *config);
+void spiStop(SPIDriver *spip);
+void spiSelect(SPIDriver *spip);
+void spiUnselect(SPIDriver *spip);
+void spiExchange(SPIDriver *spip, size_t n, const void *txbuf, void *rxbuf);
+void spiSend(SPIDriver *spip, size_t n, const void *txbuf);
+void spiReceive(SPIDriver *spip, size_t n, void *rxbuf);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* I2C                                                                       */
+/*===========================================================================*/
+
+typedef uint16_t i2caddr_t;
+
+typedef enum {
+    OPMODE_I2C = 1
+} i2copmode_t;
+
+typedef struct {
+    i2copmode_t op_mode;
+    uint32_t clock_speed;
+    uint32_t duty_cycle;
+} I2CConfig;
+
+struct sim_i2c_device;
+
+typedef struct {
+    const I2CConfig *config;
+    struct sim_i2c_device *devices;
+} I2CDriver;
+
+extern I2CDriver I2CD1;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void i2cStart(I2CDriver *i2cp, const I2CConfig *config);
+void i2cStop(I2CDriver *i2cp);
+msg_t i2cMasterTransmitTimeout(I2CDriver *i2cp, i2caddr_t addr,
+                               const uint8_t *txbuf, size_t txbytes,
+                               uint8_t *rxbuf, size_t rxbytes,
+                               sysinterval_t timeout);
+msg_t i2cMasterReceiveTimeout(I2CDriver *i2cp, i2caddr_t addr,
+                              uint8_t *rxbuf, size_t rxbytes,
+                              sysinterval_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_HAL_H_INCLUDED */
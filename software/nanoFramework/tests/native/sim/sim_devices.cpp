@@ -0,0 +1,583 @@
+/**
+ * @file sim_devices.cpp
+ * @brief LNBH26PQR and W5500 models for the host HAL simulation
+ */
+
+#include "sim_devices.h"
+
+#include <string.h>
+
+/*===========================================================================*/
+/* LNBH26PQR                                                                 */
+/*===========================================================================*/
+
+static void lnbh26_write(sim_i2c_device_t *dev, const uint8_t *data, size_t n)
+{
+    sim_lnbh26_t *lnb = (sim_lnbh26_t *)dev;
+
+    lnb->pointer = data[0] & 0x01;
+    if (n > 1 && lnb->pointer == 0) {
+        lnb->regs[0] = data[1];
+        lnb->writes++;
+        lnb->last_write_ns = sim_now_ns();
+    }
+}
+
+static void lnbh26_read(sim_i2c_device_t *dev, uint8_t *data, size_t n)
+{
+    sim_lnbh26_t *lnb = (sim_lnbh26_t *)dev;
+
+    for (size_t i = 0; i < n; i++) {
+        data[i] = lnb->regs[lnb->pointer];
+    }
+}
+
+void sim_lnbh26_init(sim_lnbh26_t *lnb, uint16_t addr)
+{
+    memset(lnb, 0, sizeof(*lnb));
+    lnb->dev.addr = addr;
+    lnb->dev.write = lnbh26_write;
+    lnb->dev.read = lnbh26_read;
+}
+
+/*===========================================================================*/
+/* W5500                                                                     */
+/*===========================================================================*/
+
+/* Common registers */
+#define W_MR                        0x00
+#define W_SIR                       0x17
+#define W_SIMR                      0x18
+#define W_PHYCFGR                   0x2E
+#define W_VERSIONR                  0x39
+#define W_PHYCFGR_RST               0x80
+#define W_PHYCFGR_LINK_100FD        0x07
+
+/* Socket registers */
+#define S_MR                        0x00
+#define S_CR                        0x01
+#define S_IR                        0x02
+#define S_SR                        0x03
+#define S_DIPR                      0x0C
+#define S_RXBUF_SIZE                0x1E
+#define S_TXBUF_SIZE                0x1F
+#define S_TX_FSR                    0x20
+#define S_TX_RD                     0x22
+#define S_TX_WR                     0x24
+#define S_RX_RSR                    0x26
+#define S_RX_RD                     0x28
+#define S_RX_WR                     0x2A
+#define S_IMR                       0x2C
+
+#define SR_CLOSED                   0x00
+#define SR_INIT                     0x13
+#define SR_SYNSENT                  0x15
+#define SR_ESTABLISHED              0x17
+#define SR_FIN_WAIT                 0x18
+#define SR_CLOSE_WAIT               0x1C
+#define SR_UDP                      0x22
+#define SR_MACRAW                   0x42
+
+#define IR_CON                      0x01
+#define IR_DISCON                   0x02
+#define IR_RECV                     0x04
+#define IR_TIMEOUT                  0x08
+#define IR_SENDOK                   0x10
+
+#define CMD_OPEN                    0x01
+#define CMD_CONNECT                 0x04
+#define CMD_DISCON                  0x08
+#define CMD_CLOSE                   0x10
+#define CMD_SEND                    0x20
+#define CMD_RECV                    0x40
+
+typedef struct {
+    sim_w5500_t *chip;
+    uint8_t socket;
+    uint16_t length;
+    bool datagram;                  // Dropped whole when it does not fit
+    uint8_t data[SIM_W5500_MAX_BUF_SIZE];
+} sim_w5500_arrival_t;
+
+/* SIR follows the sockets' masked Sn_IR; INT is asserted (low) while SIR & SIMR */
+static void update_int(sim_w5500_t *chip)
+{
+    uint8_t sir = 0;
+    for (int s = 0; s < SIM_W5500_SOCKETS; s++) {
+        if ((chip->sockets[s].regs[S_IR] & chip->sockets[s].regs[S_IMR]) != 0) {
+            sir |= (uint8_t)(1U << s);
+        }
+    }
+    chip->common[W_SIR] = sir;
+
+    if (chip->int_line != 0) {
+        sim_pal_drive(chip->int_line, (sir & chip->common[W_SIMR]) != 0 ? PAL_LOW : PAL_HIGH);
+    }
+}
+
+static void raise_ir(sim_w5500_socket_t *sock, uint8_t bits)
+{
+    sock->regs[S_IR] |= bits;
+    update_int(sock->chip);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+/* Buffer size in bytes from Sn_TXBUF_SIZE/Sn_RXBUF_SIZE (KB); pointers wrap modulo it */
+static uint16_t buf_size(const sim_w5500_socket_t *sock, uint16_t reg)
+{
+    uint8_t kb = sock->regs[reg];
+    return (uint16_t)(kb <= 16 ? kb * 1024U : 0U);
+}
+
+static uint16_t buf_mask(const sim_w5500_socket_t *sock, uint16_t reg)
+{
+    uint16_t size = buf_size(sock, reg);
+    return size != 0 ? (uint16_t)(size - 1) : 0;
+}
+
+static void w5500_reset_registers(sim_w5500_t *chip)
+{
+    uint8_t phycfgr = chip->common[W_PHYCFGR];
+
+    memset(chip->common, 0, sizeof(chip->common));
+    chip->common[W_PHYCFGR] = phycfgr;
+    chip->common[W_VERSIONR] = 0x04;
+
+    for (int s = 0; s < SIM_W5500_SOCKETS; s++) {
+        sim_w5500_socket_t *sock = &chip->sockets[s];
+        memset(sock->regs, 0, sizeof(sock->regs));
+        sock->regs[S_RXBUF_SIZE] = 2;
+        sock->regs[S_TXBUF_SIZE] = 2;
+        sock->regs[S_IMR] = 0xFF;
+        sock->tx_rd = 0;
+        sock->tx_acked = 0;
+        sock->sending = false;
+        sock->rx_wr = 0;
+    }
+}
+
+/* Read-only registers that follow chip-internal pointers */
+static uint8_t socket_reg_read(sim_w5500_socket_t *sock, uint16_t addr)
+{
+    uint8_t tmp[2];
+
+    switch (addr & ~1U) {
+        case S_TX_FSR:
+            put16(tmp, (uint16_t)(buf_size(sock, S_TXBUF_SIZE) - (uint16_t)(get16(&sock->regs[S_TX_WR]) - sock->tx_acked)));
+            return tmp[addr & 1U];
+        case S_TX_RD:
+            put16(tmp, sock->tx_rd);
+            return tmp[addr & 1U];
+        case S_RX_RSR:
+            put16(tmp, (uint16_t)(sock->rx_wr - get16(&sock->regs[S_RX_RD])));
+            return tmp[addr & 1U];
+        case S_RX_WR:
+            put16(tmp, sock->rx_wr);
+            return tmp[addr & 1U];
+        default:
+            return addr < sizeof(sock->regs) ? sock->regs[addr] : 0;
+    }
+}
+
+static void connect_done(void *arg)
+{
+    sim_w5500_socket_t *sock = (sim_w5500_socket_t *)arg;
+
+    if (sock->regs[S_SR] != SR_SYNSENT) {
+        return;
+    }
+    if (sock->peer_listening) {
+        sock->regs[S_SR] = SR_ESTABLISHED;
+        raise_ir(sock, IR_CON);
+    } else {
+        sock->regs[S_SR] = SR_CLOSED;
+        raise_ir(sock, IR_TIMEOUT);
+    }
+}
+
+static void send_done(void *arg)
+{
+    sim_w5500_socket_t *sock = (sim_w5500_socket_t *)arg;
+
+    // The segment is acknowledged: its buffer space comes back with SENDOK
+    sock->tx_acked = sock->tx_rd;
+    sock->sending = false;
+    raise_ir(sock, IR_SENDOK);
+}
+
+static void discon_done(void *arg)
+{
+    sim_w5500_socket_t *sock = (sim_w5500_socket_t *)arg;
+
+    // A CLOSE (or re-OPEN) issued meanwhile abandons the FIN exchange
+    if (sock->regs[S_SR] != SR_FIN_WAIT) {
+        return;
+    }
+    sock->regs[S_SR] = SR_CLOSED;
+    raise_ir(sock, IR_DISCON);
+}
+
+static void socket_command(sim_w5500_t *chip, sim_w5500_socket_t *sock, uint8_t cmd)
+{
+    switch (cmd) {
+        case CMD_OPEN:
+        {
+            // MACRAW exists on socket 0 only
+            uint8_t mode = (uint8_t)(sock->regs[S_MR] & 0x0F);
+            bool macraw = mode == 0x04 && sock == &chip->sockets[0];
+            if (mode == 0x01 || mode == 0x02 || macraw) {
+                sock->regs[S_SR] = mode == 0x01 ? SR_INIT : (mode == 0x02 ? SR_UDP : SR_MACRAW);
+                sock->tx_rd = get16(&sock->regs[S_TX_WR]);
+                sock->tx_acked = sock->tx_rd;
+                sock->sending = false;
+                sock->rx_wr = get16(&sock->regs[S_RX_RD]);
+            }
+            break;
+        }
+        case CMD_CONNECT:
+            if (sock->regs[S_SR] == SR_INIT) {
+                sock->regs[S_SR] = SR_SYNSENT;
+                sim_schedule_ns((uint64_t)chip->timing.connect_rtt_us * 1000ULL, connect_done, sock);
+            }
+            break;
+        case CMD_SEND: {
+            uint16_t wr = get16(&sock->regs[S_TX_WR]);
+            uint16_t length = (uint16_t)(wr - sock->tx_rd);
+            if (sock->sending) {
+                sock->send_overlaps++;
+            }
+            sock->sending = true;
+            for (uint16_t i = 0; i < length; i++) {
+                if (sock->sent_len < sizeof(sock->sent)) {
+                    sock->sent[sock->sent_len++] = sock->tx[(uint16_t)(sock->tx_rd + i) & buf_mask(sock, S_TXBUF_SIZE)];
+                }
+            }
+            sock->tx_rd = wr;
+            if (sock->regs[S_SR] == SR_UDP) {
+                // Sn_DIPR..Sn_DPORT as latched by this SEND
+                memcpy(sock->last_dest, &sock->regs[S_DIPR], sizeof(sock->last_dest));
+                sock->datagrams_sent++;
+            } else if (sock->regs[S_SR] == SR_MACRAW) {
+                sock->datagrams_sent++;
+            }
+            sock->last_send_ns = sim_now_ns();
+            sim_schedule_ns((uint64_t)length * chip->timing.wire_ns_per_byte +
+                            (uint64_t)chip->timing.ack_us * 1000ULL, send_done, sock);
+            break;
+        }
+        case CMD_RECV:
+            // RX_RD already moved by the host; RSR follows it
+            break;
+        case CMD_DISCON:
+            if (sock->regs[S_SR] == SR_ESTABLISHED || sock->regs[S_SR] == SR_CLOSE_WAIT) {
+                sock->regs[S_SR] = SR_FIN_WAIT;
+                sim_schedule_ns((uint64_t)chip->timing.connect_rtt_us * 1000ULL, discon_done, sock);
+            }
+            break;
+        case CMD_CLOSE:
+            sock->regs[S_SR] = SR_CLOSED;
+            break;
+        default:
+            break;
+    }
+}
+
+static void phy_reset_done(void *arg)
+{
+    sim_w5500_t *chip = (sim_w5500_t *)arg;
+    chip->common[W_PHYCFGR] |= W_PHYCFGR_RST;
+}
+
+static void common_write(sim_w5500_t *chip, uint16_t addr, uint8_t value)
+{
+    if (addr >= sizeof(chip->common)) {
+        return;
+    }
+
+    switch (addr) {
+        case W_MR:
+            if ((value & 0x80) != 0) {
+                w5500_reset_registers(chip);
+                update_int(chip);
+            } else {
+                chip->common[W_MR] = value;
+            }
+            break;
+        case W_PHYCFGR:
+            chip->common[W_PHYCFGR] = (uint8_t)((value & 0xF8) | (chip->common[W_PHYCFGR] & 0x07));
+            if ((value & W_PHYCFGR_RST) == 0) {
+                sim_schedule_ns((uint64_t)chip->timing.phy_reset_us * 1000ULL, phy_reset_done, chip);
+            }
+            break;
+        case W_SIMR:
+            chip->common[W_SIMR] = value;
+            update_int(chip);
+            break;
+        case W_SIR:
+        case W_VERSIONR:
+            break;
+        default:
+            chip->common[addr] = value;
+            break;
+    }
+}
+
+static void socket_reg_write(sim_w5500_t *chip, sim_w5500_socket_t *sock, uint16_t addr, uint8_t value)
+{
+    switch (addr) {
+        case S_CR:
+            socket_command(chip, sock, value);
+            sock->regs[S_CR] = 0;
+            break;
+        case S_IR:
+            sock->regs[S_IR] &= (uint8_t)~value;
+            update_int(chip);
+            break;
+        case S_IMR:
+            sock->regs[S_IMR] = value;
+            update_int(chip);
+            break;
+        case S_SR:
+        case S_TX_FSR: case S_TX_FSR + 1:
+        case S_TX_RD: case S_TX_RD + 1:
+        case S_RX_RSR: case S_RX_RSR + 1:
+        case S_RX_WR: case S_RX_WR + 1:
+            break;
+        default:
+            if (addr < sizeof(sock->regs)) {
+                sock->regs[addr] = value;
+            }
+            break;
+    }
+}
+
+static uint8_t w5500_access(sim_w5500_t *chip, uint8_t mosi)
+{
+    uint8_t bsb = (uint8_t)(chip->control >> 3);
+    bool write = (chip->control & 0x04) != 0;
+    uint16_t addr = chip->address++;
+    uint8_t miso = 0;
+
+    if (bsb == 0) {
+        if (write) {
+            common_write(chip, addr, mosi);
+        } else {
+            miso = addr < sizeof(chip->common) ? chip->common[addr] : 0;
+        }
+        return miso;
+    }
+
+    uint8_t s = (uint8_t)(bsb >> 2);
+    if (s >= SIM_W5500_SOCKETS) {
+        return 0;
+    }
+    sim_w5500_socket_t *sock = &chip->sockets[s];
+
+    switch (bsb & 0x03) {
+        case 1:
+            if (write) {
+                socket_reg_write(chip, sock, addr, mosi);
+            } else {
+                miso = socket_reg_read(sock, addr);
+            }
+            break;
+        case 2:
+            if (write) {
+                sock->tx[addr & buf_mask(sock, S_TXBUF_SIZE)] = mosi;
+            } else {
+                miso = sock->tx[addr & buf_mask(sock, S_TXBUF_SIZE)];
+            }
+            break;
+        case 3:
+            if (!write) {
+                miso = sock->rx[addr & buf_mask(sock, S_RXBUF_SIZE)];
+            }
+            break;
+        default:
+            break;
+    }
+
+    return miso;
+}
+
+static void w5500_select(sim_spi_device_t *dev)
+{
+    sim_w5500_t *chip = (sim_w5500_t *)dev;
+    chip->phase = 0;
+    chip->frames++;
+}
+
+static uint8_t w5500_exchange(sim_spi_device_t *dev, uint8_t mosi)
+{
+    sim_w5500_t *chip = (sim_w5500_t *)dev;
+
+    chip->frame_bytes++;
+
+    switch (chip->phase) {
+        case 0:
+            chip->address = (uint16_t)(mosi << 8);
+            chip->phase = 1;
+            return 0x00;
+        case 1:
+            chip->address |= mosi;
+            chip->phase = 2;
+            return 0x01;
+        case 2:
+            chip->control = mosi;
+            chip->phase = 3;
+            return 0x02;
+        default:
+            return w5500_access(chip, mosi);
+    }
+}
+
+static void w5500_unselect(sim_spi_device_t *dev)
+{
+    (void)dev;
+}
+
+void sim_w5500_init(sim_w5500_t *chip)
+{
+    memset(chip, 0, sizeof(*chip));
+    chip->dev.select = w5500_select;
+    chip->dev.exchange = w5500_exchange;
+    chip->dev.unselect = w5500_unselect;
+
+    chip->timing.phy_reset_us = 3000;
+    chip->timing.connect_rtt_us = 500;
+    chip->timing.wire_ns_per_byte = 80;
+    chip->timing.ack_us = 20;
+
+    chip->common[W_PHYCFGR] = W_PHYCFGR_RST;
+    w5500_reset_registers(chip);
+
+    for (int s = 0; s < SIM_W5500_SOCKETS; s++) {
+        chip->sockets[s].chip = chip;
+        chip->sockets[s].peer_listening = true;
+    }
+}
+
+void sim_w5500_attach_int(sim_w5500_t *chip, ioline_t line)
+{
+    chip->int_line = line;
+    update_int(chip);
+}
+
+void sim_w5500_set_link(sim_w5500_t *chip, bool up)
+{
+    chip->common[W_PHYCFGR] = (uint8_t)((chip->common[W_PHYCFGR] & 0xF8) | (up ? W_PHYCFGR_LINK_100FD : 0));
+}
+
+static void peer_arrival(void *arg)
+{
+    sim_w5500_arrival_t *arrival = (sim_w5500_arrival_t *)arg;
+    sim_w5500_socket_t *sock = &arrival->chip->sockets[arrival->socket];
+
+    uint16_t free_space = (uint16_t)(buf_size(sock, S_RXBUF_SIZE) - (uint16_t)(sock->rx_wr - get16(&sock->regs[S_RX_RD])));
+    uint16_t n = arrival->length < free_space ? arrival->length : free_space;
+    if (arrival->datagram && n < arrival->length) {
+        delete arrival;
+        return;
+    }
+
+    for (uint16_t i = 0; i < n; i++) {
+        sock->rx[(uint16_t)(sock->rx_wr + i) & buf_mask(sock, S_RXBUF_SIZE)] = arrival->data[i];
+    }
+    sock->rx_wr = (uint16_t)(sock->rx_wr + n);
+    raise_ir(sock, IR_RECV);
+
+    delete arrival;
+}
+
+static void peer_fin(void *arg)
+{
+    sim_w5500_socket_t *sock = (sim_w5500_socket_t *)arg;
+
+    if (sock->regs[S_SR] != SR_ESTABLISHED) {
+        return;
+    }
+    sock->regs[S_SR] = SR_CLOSE_WAIT;
+    raise_ir(sock, IR_DISCON);
+}
+
+void sim_w5500_peer_close(sim_w5500_t *chip, uint8_t socket, uint32_t delay_us)
+{
+    sim_schedule_ns((uint64_t)delay_us * 1000ULL, peer_fin, &chip->sockets[socket]);
+}
+
+void sim_w5500_peer_send(sim_w5500_t *chip, uint8_t socket, const uint8_t *data, uint16_t length, uint32_t delay_us)
+{
+    sim_w5500_arrival_t *arrival = new sim_w5500_arrival_t;
+
+    arrival->chip = chip;
+    arrival->socket = socket;
+    arrival->length = length < SIM_W5500_MAX_BUF_SIZE ? length : SIM_W5500_MAX_BUF_SIZE;
+    arrival->datagram = false;
+    memcpy(arrival->data, data, arrival->length);
+
+    sim_schedule_ns((uint64_t)delay_us * 1000ULL, peer_arrival, arrival);
+}
+
+void sim_w5500_peer_send_datagram(sim_w5500_t *chip, uint8_t socket, const uint8_t src_ip[4], uint16_t src_port,
+                                  const uint8_t *data, uint16_t length, uint32_t delay_us)
+{
+    sim_w5500_arrival_t *arrival = new sim_w5500_arrival_t;
+    uint16_t max_payload = SIM_W5500_MAX_BUF_SIZE - 8;
+
+    arrival->chip = chip;
+    arrival->socket = socket;
+    arrival->datagram = true;
+    if (length > max_payload) {
+        length = max_payload;
+    }
+
+    // RX buffer layout in UDP mode: source IP, source port, length, payload
+    memcpy(arrival->data, src_ip, 4);
+    put16(&arrival->data[4], src_port);
+    put16(&arrival->data[6], length);
+    memcpy(&arrival->data[8], data, length);
+    arrival->length = (uint16_t)(8 + length);
+
+    sim_schedule_ns((uint64_t)delay_us * 1000ULL, peer_arrival, arrival);
+}
+
+void sim_w5500_peer_send_frame(sim_w5500_t *chip, const uint8_t *frame, uint16_t length, uint32_t delay_us)
+{
+    sim_w5500_arrival_t *arrival = new sim_w5500_arrival_t;
+    uint16_t max_frame = SIM_W5500_MAX_BUF_SIZE - 2;
+
+    arrival->chip = chip;
+    arrival->socket = 0;
+    arrival->datagram = true;
+    if (length > max_frame) {
+        length = max_frame;
+    }
+
+    // RX buffer layout in MACRAW mode: length (including these 2 bytes), frame
+    put16(&arrival->data[0], (uint16_t)(length + 2));
+    memcpy(&arrival->data[2], frame, length);
+    arrival->length = (uint16_t)(2 + length);
+
+    sim_schedule_ns((uint64_t)delay_us * 1000ULL, peer_arrival, arrival);
+}
+
+uint32_t sim_w5500_peer_take(sim_w5500_t *chip, uint8_t socket, uint8_t *out, uint32_t max)
+{
+    sim_w5500_socket_t *sock = &chip->sockets[socket];
+    uint32_t n = sock->sent_len < max ? sock->sent_len : max;
+
+    memcpy(out, sock->sent, n);
+    memmove(sock->sent, sock->sent + n, sock->sent_len - n);
+    sock->sent_len -= n;
+    return n;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file sim_devices.h
+ * @brief Device models for the host HAL simulation (LNBH26PQR, W5500)
+ */
+
+#ifndef SIM_DEVICES_H
+#define SIM_DEVICES_H
+
+#include "sim_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================*/
+/* LNBH26PQR: register pointer + control/status registers on I2C             */
+/*===========================================================================*/
+
+typedef struct {
+    sim_i2c_device_t dev;           // Must stay first
+    uint8_t regs[2];                // 0 = control, 1 = status
+    uint8_t pointer;
+    uint32_t writes;                // Control register writes seen
+    uint64_t last_write_ns;         // Virtual time of the last control write
+} sim_lnbh26_t;
+
+void sim_lnbh26_init(sim_lnbh26_t *lnb, uint16_t addr);
+
+/*===========================================================================*/
+/* W5500: SPI frame decoder, register file, socket state machine, peer      */
+/*===========================================================================*/
+
+#define SIM_W5500_SOCKETS           8
+#define SIM_W5500_MAX_BUF_SIZE      16384       // Largest Sn_TXBUF_SIZE/Sn_RXBUF_SIZE (16 KB)
+
+typedef struct {
+    uint32_t phy_reset_us;          // PHYCFGR.RST low -> self-set
+    uint32_t connect_rtt_us;        // CONNECT -> ESTABLISHED (or TIMEOUT)
+    uint32_t wire_ns_per_byte;      // SEND -> SENDOK pacing (100BASE-TX = 80 ns)
+    uint32_t ack_us;                // Fixed per-SEND overhead until SENDOK
+} sim_w5500_timing_t;
+
+struct sim_w5500;
+
+typedef struct {
+    struct sim_w5500 *chip;
+    uint8_t regs[0x30];
+    uint8_t tx[SIM_W5500_MAX_BUF_SIZE];   // Only the first Sn_TXBUF_SIZE KB are used
+    uint8_t rx[SIM_W5500_MAX_BUF_SIZE];   // Only the first Sn_RXBUF_SIZE KB are used
+    uint16_t tx_rd;                 // Chip-internal TX read pointer
+    uint16_t tx_acked;              // TX space is freed up to here, at SENDOK
+    bool sending;                   // SEND issued, SENDOK not raised yet
+    uint32_t send_overlaps;         // SEND commands issued while one was still in flight
+    uint16_t rx_wr;                 // Chip-internal RX write pointer
+    bool peer_listening;            // CONNECT succeeds
+    uint8_t sent[8192];             // Bytes that left the chip (peer side)
+    uint32_t sent_len;
+    uint8_t last_dest[6];           // UDP: Sn_DIPR + Sn_DPORT of the last datagram
+    uint32_t datagrams_sent;        // UDP / MACRAW: SEND commands in those modes
+    uint64_t last_send_ns;          // Virtual time of the last SEND command
+} sim_w5500_socket_t;
+
+typedef struct sim_w5500 {
+    sim_spi_device_t dev;           // Must stay first
+    sim_w5500_timing_t timing;
+    ioline_t int_line;              // Active-low INT output, 0 = not wired
+    uint8_t common[0x40];
+    sim_w5500_socket_t sockets[SIM_W5500_SOCKETS];
+
+    // SPI frame decoder
+    uint8_t phase;                  // 0-2 header bytes, 3 data
+    uint16_t address;
+    uint8_t control;
+
+    uint32_t frames;                // Chip-select frames seen
+    uint64_t frame_bytes;           // Bytes clocked in those frames
+} sim_w5500_t;
+
+void sim_w5500_init(sim_w5500_t *chip);
+
+/**
+ * @brief Wire INT: driven low while any socket has (Sn_IR & Sn_IMR) set and its SIMR bit unmasked
+ */
+void sim_w5500_attach_int(sim_w5500_t *chip, ioline_t line);
+
+/**
+ * @brief Make the chip look like one with its PHY linked at 100 Mbit full duplex
+ */
+void sim_w5500_set_link(sim_w5500_t *chip, bool up);
+
+/**
+ * @brief Peer on the far side of a socket sends data, arriving after delay_us
+ */
+void sim_w5500_peer_send(sim_w5500_t *chip, uint8_t socket, const uint8_t *data, uint16_t length, uint32_t delay_us);
+
+/**
+ * @brief A datagram from src_ip:src_port reaches a UDP socket after delay_us (dropped if the RX buffer is full)
+ */
+void sim_w5500_peer_send_datagram(sim_w5500_t *chip, uint8_t socket, const uint8_t src_ip[4], uint16_t src_port,
+                                  const uint8_t *data, uint16_t length, uint32_t delay_us);
+
+/**
+ * @brief An Ethernet frame (no FCS) reaches socket 0 in MACRAW mode after delay_us (dropped if the RX buffer is full)
+ */
+void sim_w5500_peer_send_frame(sim_w5500_t *chip, const uint8_t *frame, uint16_t length, uint32_t delay_us);
+
+/**
+ * @brief Peer closes its side of an established connection (FIN) after delay_us: CLOSE_WAIT + DISCON
+ */
+void sim_w5500_peer_close(sim_w5500_t *chip, uint8_t socket, uint32_t delay_us);
+
+/**
+ * @brief Take what the socket has transmitted so far
+ * @return Number of bytes copied (the capture is cleared)
+ */
+uint32_t sim_w5500_peer_take(sim_w5500_t *chip, uint8_t socket, uint8_t *out, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_DEVICES_H */
@@ -0,0 +1,1077 @@
+/**
+ * @file sim_hal.cpp
+ * @brief Virtual clock, kernel objects and HAL drivers for the host simulation
+ *
+ * Every thread, the test's main() included, runs on its own host stack. A
+ * blocking call records its deadline and wake condition and enters the
+ * scheduler, which runs interrupts (timer and device events) due at the
+ * current time, then switches to the highest-priority ready thread, and
+ * only when nothing is ready advances the clock to the next event or thread
+ * deadline. Timer callbacks, device events and driver threads therefore
+ * interleave exactly as their virtual timestamps dictate, and the same
+ * inputs always produce the same schedule.
+ */
+
+#include "sim_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include <vector>
+
+GPIO_TypeDef SIM_GPIOA, SIM_GPIOB, SIM_GPIOC, SIM_GPIOD, SIM_GPIOE;
+SPI_TypeDef SIM_SPI1, SIM_SPI2;
+PWMDriver PWMD4;
+GPTDriver GPTD5;
+SPIDriver SPID2 = {NULL, &SIM_SPI2, NULL, false};
+I2CDriver I2CD1;
+
+/* Diagnostic mailbox normally defined by cubley_interop.cpp */
+volatile uint32_t g_cubley_diag_current_status;
+volatile uint32_t g_cubley_diag_last_error;
+
+static const uint64_t kTickNs = 1000000000ULL / CH_CFG_ST_FREQUENCY;
+static const uint64_t kForever = ~0ULL;
+
+/*===========================================================================*/
+/* Event list                                                                */
+/*===========================================================================*/
+
+typedef enum {
+    EVT_GPT,
+    EVT_VT,
+    EVT_DEVICE
+} sim_event_kind_t;
+
+typedef struct {
+    uint64_t t_ns;
+    uint64_t order;                 // FIFO among equal timestamps
+    sim_event_kind_t kind;
+    void *object;
+    sim_event_fn_t fn;
+    void *arg;
+} sim_event_t;
+
+static uint64_t g_now_ns;
+static uint64_t g_order;
+static uint32_t g_isr_latency_ns;
+static uint32_t g_switch_ns;
+static uint32_t g_spi_setup_ns;
+static int g_isr_nesting;
+static sim_counters_t g_counters;
+static std::vector<sim_event_t> g_events;
+static std::vector<sim_pwm_edge_t> g_pwm_trace;
+
+static void event_add(uint64_t t_ns, sim_event_kind_t kind, void *object, sim_event_fn_t fn, void *arg)
+{
+    sim_event_t ev = {t_ns, g_order++, kind, object, fn, arg};
+    g_events.push_back(ev);
+}
+
+static void event_cancel(void *object)
+{
+    for (size_t i = 0; i < g_events.size(); i++) {
+        if (g_events[i].object == object) {
+            g_events.erase(g_events.begin() + (long)i);
+            return;
+        }
+    }
+}
+
+static int event_next(uint64_t limit_ns)
+{
+    int best = -1;
+    for (size_t i = 0; i < g_events.size(); i++) {
+        const sim_event_t &ev = g_events[i];
+        if (ev.t_ns > limit_ns) {
+            continue;
+        }
+        if (best < 0 || ev.t_ns < g_events[best].t_ns ||
+            (ev.t_ns == g_events[best].t_ns && ev.order < g_events[best].order)) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+static void event_dispatch(sim_event_t ev)
+{
+    if (ev.t_ns > g_now_ns) {
+        g_now_ns = ev.t_ns;
+    }
+
+    g_isr_nesting++;
+    switch (ev.kind) {
+        case EVT_GPT: {
+            GPTDriver *gptp = (GPTDriver *)ev.object;
+            // One-shot: driver is READY again before the callback runs
+            gptp->state = GPT_READY;
+            g_now_ns += g_isr_latency_ns;
+            if (gptp->config != NULL && gptp->config->callback != NULL) {
+                g_counters.interrupts++;
+                gptp->config->callback(gptp);
+            }
+            break;
+        }
+        case EVT_VT: {
+            virtual_timer_t *vtp = (virtual_timer_t *)ev.object;
+            vtp->armed = false;
+            vtp->func(vtp, vtp->par);
+            break;
+        }
+        case EVT_DEVICE:
+            ev.fn(ev.arg);
+            break;
+    }
+    g_isr_nesting--;
+}
+
+/*===========================================================================*/
+/* Scheduler                                                                 */
+/*===========================================================================*/
+
+enum {
+    THD_STATE_CURRENT,
+    THD_STATE_BLOCKED,
+    THD_STATE_FINAL
+};
+
+struct sim_context {
+    ucontext_t uc;
+    void *stack;
+};
+
+/* Host stack per driver thread; target working areas are far smaller */
+static const size_t kHostStackSize = 256 * 1024;
+
+static sim_context g_main_context;
+static thread_t g_main_thread = {"main", NULL, NULL, NORMALPRIO, THD_STATE_CURRENT,
+                                 0, NULL, NULL, false, 0, &g_main_context};
+static thread_t *g_current = &g_main_thread;
+static bool g_cpu_idle;                 // Idle thread owns the CPU (time is advancing)
+static std::vector<thread_t *> g_all_threads(1, &g_main_thread);   // Creation order
+
+typedef bool (*sim_wake_fn_t)(const void *arg);
+
+static bool thread_ready(const thread_t *tp)
+{
+    if (tp->state != THD_STATE_BLOCKED) {
+        return false;
+    }
+    return tp->deadline_ns <= g_now_ns || (tp->wake != NULL && tp->wake(tp->wake_arg));
+}
+
+/* Highest-priority ready thread; ties go to the current thread, then creation order */
+static thread_t *thread_pick(void)
+{
+    thread_t *best = NULL;
+    for (size_t i = 0; i < g_all_threads.size(); i++) {
+        thread_t *tp = g_all_threads[i];
+        if (!thread_ready(tp)) {
+            continue;
+        }
+        if (best == NULL || tp->prio > best->prio || (tp->prio == best->prio && tp == g_current)) {
+            best = tp;
+        }
+    }
+    return best;
+}
+
+static void thread_resume(thread_t *tp)
+{
+    // Waking from idle is a switch even back to the thread that last ran
+    bool switching = tp != g_current || g_cpu_idle;
+    g_cpu_idle = false;
+
+    tp->woken = tp->wake != NULL && tp->wake(tp->wake_arg);
+    tp->wake = NULL;
+    tp->state = THD_STATE_CURRENT;
+
+    if (!switching) {
+        return;
+    }
+    g_counters.context_switches++;
+    g_now_ns += g_switch_ns;
+
+    if (tp != g_current) {
+        thread_t *prev = g_current;
+        g_current = tp;
+        swapcontext(&prev->context->uc, &tp->context->uc);
+    }
+}
+
+/**
+ * @brief Run interrupts and other threads until the current thread is resumed
+ */
+static void schedule(void)
+{
+    while (true) {
+        // Interrupts due now run before any thread
+        int due = event_next(g_now_ns);
+        if (due >= 0) {
+            sim_event_t ev = g_events[due];
+            g_events.erase(g_events.begin() + due);
+            event_dispatch(ev);
+            continue;
+        }
+
+        thread_t *next = thread_pick();
+        if (next != NULL) {
+            thread_resume(next);
+            return;
+        }
+
+        // Nothing ready: jump to the earliest event or thread deadline
+        uint64_t until = kForever;
+        int ev = event_next(kForever);
+        if (ev >= 0) {
+            until = g_events[ev].t_ns;
+        }
+        for (size_t i = 0; i < g_all_threads.size(); i++) {
+            const thread_t *tp = g_all_threads[i];
+            if (tp->state == THD_STATE_BLOCKED && tp->deadline_ns < until) {
+                until = tp->deadline_ns;
+            }
+        }
+
+        if (until == kForever) {
+            // Nothing left that could ever wake anyone: fail the main thread's wait
+            fprintf(stderr, "sim: all threads blocked forever at t=%llu ns\n", (unsigned long long)g_now_ns);
+            g_main_thread.deadline_ns = g_now_ns;
+            continue;
+        }
+        g_now_ns = until;
+        g_cpu_idle = true;
+    }
+}
+
+/**
+ * @brief Block the current thread until deadline_ns, or until wake(arg) holds
+ * @return true when woken by the condition
+ */
+static bool sim_block(uint64_t deadline_ns, sim_wake_fn_t wake, const void *arg)
+{
+    if (g_isr_nesting > 0) {
+        fprintf(stderr, "sim: blocking call from interrupt context at t=%llu ns\n",
+                (unsigned long long)g_now_ns);
+        abort();
+    }
+
+    thread_t *self = g_current;
+    self->state = THD_STATE_BLOCKED;
+    self->deadline_ns = deadline_ns;
+    self->wake = wake;
+    self->wake_arg = arg;
+    schedule();
+    return self->woken;
+}
+
+/**
+ * @brief Hand the CPU to a higher-priority thread made ready by the caller
+ *
+ * Inside an interrupt this is deferred: the scheduler picks the thread when
+ * the interrupt returns.
+ */
+static void reschedule(void)
+{
+    if (g_isr_nesting > 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < g_all_threads.size(); i++) {
+        const thread_t *tp = g_all_threads[i];
+        if (tp->prio > g_current->prio && thread_ready(tp)) {
+            sim_block(g_now_ns, NULL, NULL);
+            return;
+        }
+    }
+}
+
+static void thread_entry(void)
+{
+    thread_t *self = g_current;
+    self->func(self->arg);
+
+    // Returning from the thread function is chThdExit()
+    self->state = THD_STATE_FINAL;
+    schedule();
+}
+
+static uint64_t deadline_after(sysinterval_t ticks)
+{
+    if (ticks == TIME_INFINITE) {
+        return kForever;
+    }
+    return g_now_ns + (uint64_t)ticks * kTickNs;
+}
+
+/*===========================================================================*/
+/* Control API                                                               */
+/*===========================================================================*/
+
+uint64_t sim_now_ns(void)
+{
+    return g_now_ns;
+}
+
+void sim_run_us(uint64_t us)
+{
+    sim_block(g_now_ns + us * 1000ULL, NULL, NULL);
+}
+
+/* No pending event, and every thread but the waiter blocked without a timeout */
+static bool system_idle(const void *arg)
+{
+    if (!g_events.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < g_all_threads.size(); i++) {
+        const thread_t *tp = g_all_threads[i];
+        if (tp == arg || tp->state == THD_STATE_FINAL) {
+            continue;
+        }
+        if (tp->deadline_ns != kForever || thread_ready(tp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sim_run_until_idle(uint64_t max_us)
+{
+    return sim_block(g_now_ns + max_us * 1000ULL, system_idle, g_current);
+}
+
+void sim_set_isr_latency_ns(uint32_t ns)
+{
+    g_isr_latency_ns = ns;
+}
+
+void sim_set_context_switch_ns(uint32_t ns)
+{
+    g_switch_ns = ns;
+}
+
+void sim_set_spi_setup_ns(uint32_t ns)
+{
+    g_spi_setup_ns = ns;
+}
+
+sim_counters_t sim_counters(void)
+{
+    sim_counters_t now = g_counters;
+    now.t_ns = g_now_ns;
+    return now;
+}
+
+sim_counters_t sim_counters_since(const sim_counters_t *start)
+{
+    sim_counters_t now = sim_counters();
+    sim_counters_t delta;
+    delta.t_ns = now.t_ns - start->t_ns;
+    delta.spi_frames = now.spi_frames - start->spi_frames;
+    delta.spi_transfers = now.spi_transfers - start->spi_transfers;
+    delta.spi_bytes = now.spi_bytes - start->spi_bytes;
+    delta.i2c_transactions = now.i2c_transactions - start->i2c_transactions;
+    delta.sleeps = now.sleeps - start->sleeps;
+    delta.context_switches = now.context_switches - start->context_switches;
+    delta.interrupts = now.interrupts - start->interrupts;
+    return delta;
+}
+
+void sim_counters_print(const char *label, const sim_counters_t *delta)
+{
+    printf("  %s: %llu us, %u SPI frames/%u transfers (%llu bytes), %u I2C, %u sleeps, %u switches, %u IRQs\n",
+           label, (unsigned long long)(delta->t_ns / 1000), (unsigned)delta->spi_frames,
+           (unsigned)delta->spi_transfers, (unsigned long long)delta->spi_bytes, (unsigned)delta->i2c_transactions,
+           (unsigned)delta->sleeps, (unsigned)delta->context_switches, (unsigned)delta->interrupts);
+}
+
+void sim_schedule_ns(uint64_t delay_ns, sim_event_fn_t fn, void *arg)
+{
+    event_add(g_now_ns + delay_ns, EVT_DEVICE, NULL, fn, arg);
+}
+
+size_t sim_pwm_trace(const sim_pwm_edge_t **edges)
+{
+    *edges = g_pwm_trace.empty() ? NULL : &g_pwm_trace[0];
+    return g_pwm_trace.size();
+}
+
+void sim_pwm_trace_clear(void)
+{
+    g_pwm_trace.clear();
+}
+
+/*===========================================================================*/
+/* Kernel                                                                    */
+/*===========================================================================*/
+
+static int g_lock_nesting;
+
+void chSysLock(void)
+{
+    g_lock_nesting++;
+}
+
+void chSysUnlock(void)
+{
+    g_lock_nesting--;
+}
+
+void chSysLockFromISR(void)
+{
+    g_lock_nesting++;
+}
+
+void chSysUnlockFromISR(void)
+{
+    g_lock_nesting--;
+}
+
+void chSchRescheduleS(void)
+{
+    reschedule();
+}
+
+rtcnt_t chSysGetRealtimeCounterX(void)
+{
+    // DWT cycle counter at HCLK
+    return (rtcnt_t)((g_now_ns * (STM32_HCLK / 1000000U)) / 1000ULL);
+}
+
+static thread_t g_threads[8];
+static sim_context g_contexts[8];
+static size_t g_thread_count;
+
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg)
+{
+    (void)wsp;
+    (void)size;
+
+    if (g_thread_count >= sizeof(g_threads) / sizeof(g_threads[0])) {
+        return NULL;
+    }
+
+    sim_context *ctx = &g_contexts[g_thread_count];
+    ctx->stack = malloc(kHostStackSize);
+    getcontext(&ctx->uc);
+    ctx->uc.uc_stack.ss_sp = ctx->stack;
+    ctx->uc.uc_stack.ss_size = kHostStackSize;
+    ctx->uc.uc_link = NULL;
+    makecontext(&ctx->uc, thread_entry, 0);
+
+    // Created ready: runs at once when it outranks the creator
+    thread_t *tp = &g_threads[g_thread_count++];
+    memset(tp, 0, sizeof(*tp));
+    tp->func = pf;
+    tp->arg = arg;
+    tp->prio = prio;
+    tp->state = THD_STATE_BLOCKED;
+    tp->deadline_ns = g_now_ns;
+    tp->context = ctx;
+    g_all_threads.push_back(tp);
+
+    reschedule();
+    return tp;
+}
+
+thread_t *chThdGetSelfX(void)
+{
+    return g_current;
+}
+
+void chRegSetThreadName(const char *name)
+{
+    g_current->name = name;
+}
+
+void chThdSleep(sysinterval_t time)
+{
+    g_counters.sleeps++;
+    sim_block(deadline_after(time), NULL, NULL);
+}
+
+void chBSemObjectInit(binary_semaphore_t *bsp, bool taken)
+{
+    bsp->taken = taken;
+}
+
+static bool bsem_available(const void *arg)
+{
+    return !((const binary_semaphore_t *)arg)->taken;
+}
+
+msg_t chBSemWaitTimeout(binary_semaphore_t *bsp, sysinterval_t timeout)
+{
+    if (bsp->taken && timeout != TIME_IMMEDIATE) {
+        sim_block(deadline_after(timeout), bsem_available, bsp);
+    }
+
+    if (bsp->taken) {
+        return MSG_TIMEOUT;
+    }
+    bsp->taken = true;
+    return MSG_OK;
+}
+
+msg_t chBSemWait(binary_semaphore_t *bsp)
+{
+    msg_t msg = chBSemWaitTimeout(bsp, TIME_INFINITE);
+    return msg == MSG_OK ? MSG_OK : MSG_RESET;
+}
+
+void chBSemSignalI(binary_semaphore_t *bsp)
+{
+    bsp->taken = false;
+}
+
+void chBSemSignal(binary_semaphore_t *bsp)
+{
+    bsp->taken = false;
+    reschedule();
+}
+
+void chBSemResetI(binary_semaphore_t *bsp, bool taken)
+{
+    bsp->taken = taken;
+}
+
+void chBSemReset(binary_semaphore_t *bsp, bool taken)
+{
+    bsp->taken = taken;
+    reschedule();
+}
+
+void chMtxObjectInit(mutex_t *mp)
+{
+    mp->owner = NULL;
+}
+
+static bool mutex_free(const void *arg)
+{
+    return ((const mutex_t *)arg)->owner == NULL;
+}
+
+void chMtxLock(mutex_t *mp)
+{
+    // Several waiters may be readied by one unlock: the first to run takes it
+    while (mp->owner != NULL) {
+        sim_block(kForever, mutex_free, mp);
+    }
+    mp->owner = g_current;
+}
+
+void chMtxUnlock(mutex_t *mp)
+{
+    mp->owner = NULL;
+    reschedule();
+}
+
+void chEvtObjectInit(event_source_t *esp)
+{
+    esp->next = NULL;
+}
+
+void chEvtRegisterMaskWithFlags(event_source_t *esp, event_listener_t *elp,
+                                eventmask_t events, eventflags_t wflags)
+{
+    elp->listener = g_current;
+    elp->events = events;
+    elp->flags = 0;
+    elp->wflags = wflags;
+    elp->next = esp->next;
+    esp->next = elp;
+}
+
+void chEvtRegisterMask(event_source_t *esp, event_listener_t *elp, eventmask_t events)
+{
+    chEvtRegisterMaskWithFlags(esp, elp, events, (eventflags_t)-1);
+}
+
+void chEvtUnregister(event_source_t *esp, event_listener_t *elp)
+{
+    event_listener_t **link = &esp->next;
+    while (*link != NULL) {
+        if (*link == elp) {
+            *link = elp->next;
+            return;
+        }
+        link = &(*link)->next;
+    }
+}
+
+void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags)
+{
+    for (event_listener_t *elp = esp->next; elp != NULL; elp = elp->next) {
+        elp->flags |= flags;
+        if ((flags & elp->wflags) != 0) {
+            elp->listener->epending |= elp->events;
+        }
+    }
+}
+
+void chEvtBroadcastFlags(event_source_t *esp, eventflags_t flags)
+{
+    chEvtBroadcastFlagsI(esp, flags);
+    reschedule();
+}
+
+eventflags_t chEvtGetAndClearFlags(event_listener_t *elp)
+{
+    eventflags_t flags = elp->flags;
+    elp->flags = 0;
+    return flags;
+}
+
+typedef struct {
+    const thread_t *thread;
+    eventmask_t events;
+} event_wait_t;
+
+static bool events_pending(const void *arg)
+{
+    const event_wait_t *wait = (const event_wait_t *)arg;
+    return (wait->thread->epending & wait->events) != 0;
+}
+
+eventmask_t chEvtWaitAnyTimeout(eventmask_t events, sysinterval_t timeout)
+{
+    thread_t *self = g_current;
+    event_wait_t wait = {self, events};
+
+    if ((self->epending & events) == 0 && timeout != TIME_IMMEDIATE) {
+        sim_block(deadline_after(timeout), events_pending, &wait);
+    }
+
+    eventmask_t got = self->epending & events;
+    self->epending &= ~got;
+    return got;
+}
+
+void chVTObjectInit(virtual_timer_t *vtp)
+{
+    vtp->armed = false;
+    vtp->func = NULL;
+    vtp->par = NULL;
+}
+
+void chVTSetI(virtual_timer_t *vtp, sysinterval_t delay, vtfunc_t vtfunc, void *par)
+{
+    if (vtp->armed) {
+        event_cancel(vtp);
+    }
+    vtp->armed = true;
+    vtp->func = vtfunc;
+    vtp->par = par;
+    vtp->deadline_ns = g_now_ns + (uint64_t)delay * kTickNs;
+    event_add(vtp->deadline_ns, EVT_VT, vtp, NULL, NULL);
+}
+
+void chVTSet(virtual_timer_t *vtp, sysinterval_t delay, vtfunc_t vtfunc, void *par)
+{
+    chVTSetI(vtp, delay, vtfunc, par);
+}
+
+void chVTResetI(virtual_timer_t *vtp)
+{
+    if (vtp->armed) {
+        event_cancel(vtp);
+        vtp->armed = false;
+    }
+}
+
+void chVTReset(virtual_timer_t *vtp)
+{
+    chVTResetI(vtp);
+}
+
+bool chVTIsArmedI(const virtual_timer_t *vtp)
+{
+    return vtp->armed;
+}
+
+systime_t chVTGetSystemTimeX(void)
+{
+    return (systime_t)(g_now_ns / kTickNs);
+}
+
+sysinterval_t chVTTimeElapsedSinceX(systime_t start)
+{
+    return (sysinterval_t)(chVTGetSystemTimeX() - start);
+}
+
+/*===========================================================================*/
+/* PAL                                                                       */
+/*===========================================================================*/
+
+typedef struct {
+    GPIO_TypeDef *port;
+    iomode_t mode[16];
+    uint32_t event_mode[16];
+    palcallback_t cb[16];
+    void *cb_arg[16];
+    uint16_t driven;                // Externally driven level of input pads
+} sim_port_state_t;
+
+static sim_port_state_t g_ports[5] = {
+    {&SIM_GPIOA, {0}, {0}, {0}, {0}, 0xFFFF},
+    {&SIM_GPIOB, {0}, {0}, {0}, {0}, 0xFFFF},
+    {&SIM_GPIOC, {0}, {0}, {0}, {0}, 0xFFFF},
+    {&SIM_GPIOD, {0}, {0}, {0}, {0}, 0xFFFF},
+    {&SIM_GPIOE, {0}, {0}, {0}, {0}, 0xFFFF}
+};
+
+static sim_port_state_t *port_state(ioline_t line)
+{
+    GPIO_TypeDef *port = PAL_PORT(line);
+    for (size_t i = 0; i < sizeof(g_ports) / sizeof(g_ports[0]); i++) {
+        if (g_ports[i].port == port) {
+            return &g_ports[i];
+        }
+    }
+    return NULL;
+}
+
+static bool pad_is_output(const sim_port_state_t *ps, uint32_t pad)
+{
+    iomode_t mode = ps->mode[pad] & PAL_STM32_MODE_MASK;
+    return mode == PAL_MODE_OUTPUT_PUSHPULL || mode == PAL_MODE_OUTPUT_OPENDRAIN;
+}
+
+/* Recompute IDR for one pad and fire its callback on a matching edge */
+static void pad_update(sim_port_state_t *ps, uint32_t pad)
+{
+    uint32_t bit = 1U << pad;
+    uint32_t before = ps->port->IDR & bit;
+    uint32_t level = pad_is_output(ps, pad) ? (ps->port->ODR & bit) : (ps->driven & bit);
+
+    ps->port->IDR = (ps->port->IDR & ~bit) | level;
+
+    if (before == level || ps->cb[pad] == NULL) {
+        return;
+    }
+
+    bool rising = level != 0;
+    uint32_t mode = ps->event_mode[pad];
+    if ((rising && (mode & PAL_EVENT_MODE_RISING_EDGE) != 0) ||
+        (!rising && (mode & PAL_EVENT_MODE_FALLING_EDGE) != 0)) {
+        g_counters.interrupts++;
+        g_isr_nesting++;
+        ps->cb[pad](ps->cb_arg[pad]);
+        g_isr_nesting--;
+        reschedule();
+    }
+}
+
+void palSetLineMode(ioline_t line, iomode_t mode)
+{
+    sim_port_state_t *ps = port_state(line);
+    uint32_t pad = PAL_PAD(line);
+    ps->mode[pad] = mode;
+    pad_update(ps, pad);
+}
+
+void palWriteLine(ioline_t line, uint32_t bit)
+{
+    sim_port_state_t *ps = port_state(line);
+    uint32_t pad = PAL_PAD(line);
+    if (bit != PAL_LOW) {
+        ps->port->ODR |= 1U << pad;
+    } else {
+        ps->port->ODR &= ~(1U << pad);
+    }
+    pad_update(ps, pad);
+}
+
+void palSetLine(ioline_t line)
+{
+    palWriteLine(line, PAL_HIGH);
+}
+
+void palClearLine(ioline_t line)
+{
+    palWriteLine(line, PAL_LOW);
+}
+
+void palToggleLine(ioline_t line)
+{
+    palWriteLine(line, (PAL_PORT(line)->ODR >> PAL_PAD(line)) & 1U ? PAL_LOW : PAL_HIGH);
+}
+
+uint32_t palReadLine(ioline_t line)
+{
+    return (PAL_PORT(line)->IDR >> PAL_PAD(line)) & 1U;
+}
+
+void palEnableLineEvent(ioline_t line, uint32_t mode)
+{
+    port_state(line)->event_mode[PAL_PAD(line)] = mode;
+}
+
+void palDisableLineEvent(ioline_t line)
+{
+    port_state(line)->event_mode[PAL_PAD(line)] = PAL_EVENT_MODE_DISABLED;
+}
+
+void palSetLineCallback(ioline_t line, palcallback_t cb, void *arg)
+{
+    sim_port_state_t *ps = port_state(line);
+    ps->cb[PAL_PAD(line)] = cb;
+    ps->cb_arg[PAL_PAD(line)] = arg;
+}
+
+void sim_pal_drive(ioline_t line, uint32_t level)
+{
+    sim_port_state_t *ps = port_state(line);
+    uint32_t pad = PAL_PAD(line);
+    if (level != PAL_LOW) {
+        ps->driven |= (uint16_t)(1U << pad);
+    } else {
+        ps->driven &= (uint16_t)~(1U << pad);
+    }
+    pad_update(ps, pad);
+}
+
+/*===========================================================================*/
+/* PWM / GPT                                                                 */
+/*===========================================================================*/
+
+static void pwm_set_width(PWMDriver *pwmp, pwmchannel_t channel, pwmcnt_t width)
+{
+    if (pwmp->width[channel] == width) {
+        return;
+    }
+    pwmp->width[channel] = width;
+
+    sim_pwm_edge_t edge = {g_now_ns, pwmp, channel, width};
+    g_pwm_trace.push_back(edge);
+}
+
+void pwmStart(PWMDriver *pwmp, const PWMConfig *config)
+{
+    pwmp->config = config;
+    pwmp->started = true;
+}
+
+void pwmStop(PWMDriver *pwmp)
+{
+    for (pwmchannel_t ch = 0; ch < PWM_CHANNELS; ch++) {
+        pwm_set_width(pwmp, ch, 0);
+    }
+    pwmp->started = false;
+}
+
+void pwmEnableChannelI(PWMDriver *pwmp, pwmchannel_t channel, pwmcnt_t width)
+{
+    pwm_set_width(pwmp, channel, width);
+}
+
+void pwmEnableChannel(PWMDriver *pwmp, pwmchannel_t channel, pwmcnt_t width)
+{
+    pwm_set_width(pwmp, channel, width);
+}
+
+void pwmDisableChannel(PWMDriver *pwmp, pwmchannel_t channel)
+{
+    pwm_set_width(pwmp, channel, 0);
+}
+
+void gptStart(GPTDriver *gptp, const GPTConfig *config)
+{
+    gptp->config = config;
+    gptp->state = GPT_READY;
+}
+
+void gptStop(GPTDriver *gptp)
+{
+    event_cancel(gptp);
+    gptp->state = GPT_STOP;
+}
+
+void gptStartOneShotI(GPTDriver *gptp, gptcnt_t interval)
+{
+    event_cancel(gptp);
+    gptp->state = GPT_ONESHOT;
+    gptp->deadline_ns = g_now_ns + ((uint64_t)interval * 1000000000ULL) / gptp->config->frequency;
+    event_add(gptp->deadline_ns, EVT_GPT, gptp, NULL, NULL);
+}
+
+void gptStartOneShot(GPTDriver *gptp, gptcnt_t interval)
+{
+    gptStartOneShotI(gptp, interval);
+}
+
+void gptStopTimerI(GPTDriver *gptp)
+{
+    event_cancel(gptp);
+    gptp->state = GPT_READY;
+}
+
+void gptStopTimer(GPTDriver *gptp)
+{
+    gptStopTimerI(gptp);
+}
+
+/*===========================================================================*/
+/* SPI                                                                       */
+/*===========================================================================*/
+
+void sim_spi_attach(SPIDriver *spip, sim_spi_device_t *dev)
+{
+    spip->device = dev;
+}
+
+uint32_t sim_spi_clock_hz(const SPIDriver *spip)
+{
+    uint32_t br = (spip->spi->CR1 & SPI_CR1_BR) >> 3;
+    return STM32_PCLK1 >> (br + 1);
+}
+
+void spiStart(SPIDriver *spip, const SPIConfig *config)
+{
+    spip->config = config;
+    spip->spi->CR1 = config->cr1 | SPI_CR1_MSTR | SPI_CR1_SPE;
+    spip->spi->CR2 = config->cr2;
+    spip->spi->SR = SPI_SR_TXE;
+}
+
+void spiStop(SPIDriver *spip)
+{
+    spip->spi->CR1 = 0;
+    spip->spi->SR = 0;
+}
+
+void spiSelect(SPIDriver *spip)
+{
+    palClearLine(spip->config->ssline);
+    spip->selected = true;
+    g_counters.spi_frames++;
+    if (spip->device != NULL && spip->device->select != NULL) {
+        spip->device->select(spip->device);
+    }
+}
+
+void spiUnselect(SPIDriver *spip)
+{
+    if (spip->device != NULL && spip->device->unselect != NULL) {
+        spip->device->unselect(spip->device);
+    }
+    spip->selected = false;
+    palSetLine(spip->config->ssline);
+}
+
+/* Clock n bytes through the attached device, then let the bus time pass */
+static void spi_transfer(SPIDriver *spip, size_t n, const uint8_t *tx, uint8_t *rx)
+{
+    bool too_fast = spip->device != NULL && spip->device->max_clock_hz != 0 &&
+                    sim_spi_clock_hz(spip) > spip->device->max_clock_hz;
+
+    for (size_t i = 0; i < n; i++) {
+        uint8_t mosi = tx != NULL ? tx[i] : 0xFF;
+        uint8_t miso = 0xFF;
+        if (spip->selected && spip->device != NULL) {
+            miso = spip->device->exchange(spip->device, mosi);
+            if (too_fast) {
+                miso ^= 0x01;
+            }
+        }
+        if (rx != NULL) {
+            rx[i] = miso;
+        }
+    }
+
+    g_counters.spi_transfers++;
+    g_counters.spi_bytes += n;
+    uint64_t bus_ns = g_spi_setup_ns + ((uint64_t)n * 8ULL * 1000000000ULL) / sim_spi_clock_hz(spip);
+    sim_block(g_now_ns + bus_ns, NULL, NULL);
+}
+
+void spiExchange(SPIDriver *spip, size_t n, const void *txbuf, void *rxbuf)
+{
+    spi_transfer(spip, n, (const uint8_t *)txbuf, (uint8_t *)rxbuf);
+}
+
+void spiSend(SPIDriver *spip, size_t n, const void *txbuf)
+{
+    spi_transfer(spip, n, (const uint8_t *)txbuf, NULL);
+}
+
+void spiReceive(SPIDriver *spip, size_t n, void *rxbuf)
+{
+    spi_transfer(spip, n, NULL, (uint8_t *)rxbuf);
+}
+
+/*===========================================================================*/
+/* I2C                                                                       */
+/*===========================================================================*/
+
+static const uint32_t kI2cDefaultClockHz = 100000;
+
+void sim_i2c_attach(I2CDriver *i2cp, sim_i2c_device_t *dev)
+{
+    dev->next = i2cp->devices;
+    i2cp->devices = dev;
+}
+
+void i2cStart(I2CDriver *i2cp, const I2CConfig *config)
+{
+    i2cp->config = config;
+}
+
+void i2cStop(I2CDriver *i2cp)
+{
+    i2cp->config = NULL;
+}
+
+static uint64_t i2c_bits_ns(const I2CDriver *i2cp, uint64_t bits)
+{
+    uint32_t hz = (i2cp->config != NULL && i2cp->config->clock_speed != 0) ?
+                  i2cp->config->clock_speed : kI2cDefaultClockHz;
+    return (bits * 1000000000ULL) / hz;
+}
+
+msg_t i2cMasterTransmitTimeout(I2CDriver *i2cp, i2caddr_t addr,
+                               const uint8_t *txbuf, size_t txbytes,
+                               uint8_t *rxbuf, size_t rxbytes,
+                               sysinterval_t timeout)
+{
+    (void)timeout;
+
+    g_counters.i2c_transactions++;
+    sim_i2c_device_t *dev = i2cp->devices;
+    while (dev != NULL && dev->addr != addr) {
+        dev = dev->next;
+    }
+
+    // START + address byte (9 clocks each byte incl. ACK) + STOP
+    uint64_t bits = 1 + 9 + 1;
+    if (dev == NULL) {
+        sim_block(g_now_ns + i2c_bits_ns(i2cp, bits), NULL, NULL);
+        return MSG_RESET;
+    }
+
+    if (txbytes > 0) {
+        bits += 9ULL * txbytes;
+        dev->write(dev, txbuf, txbytes);
+    }
+    if (rxbytes > 0) {
+        // Repeated START + address when a write phase preceded the read
+        if (txbytes > 0) {
+            bits += 1 + 9;
+        }
+        bits += 9ULL * rxbytes;
+        dev->read(dev, rxbuf, rxbytes);
+    }
+
+    sim_block(g_now_ns + i2c_bits_ns(i2cp, bits), NULL, NULL);
+    return MSG_OK;
+}
+
+msg_t i2cMasterReceiveTimeout(I2CDriver *i2cp, i2caddr_t addr,
+                              uint8_t *rxbuf, size_t rxbytes,
+                              sysinterval_t timeout)
+{
+    return i2cMasterTransmitTimeout(i2cp, addr, NULL, 0, rxbuf, rxbytes, timeout);
+}
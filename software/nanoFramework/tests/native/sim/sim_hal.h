@@ -0,0 +1,126 @@
+/**
+ * @file sim_hal.h
+ * @brief Control API for the host HAL simulation (virtual clock, traces, buses)
+ *
+ * Driver code sees only ch.h/hal.h. Benchmarks use this header to advance
+ * the virtual clock, read the PWM output trace, drive input pins, plug
+ * device models (sim_devices.h) onto the SPI and I2C buses and read the
+ * operation counters that turn a driver call into "N SPI frames, M us".
+ *
+ * The control calls block the calling (main) thread: driver threads created
+ * with chThdCreateStatic() run while it waits.
+ */
+
+#ifndef SIM_HAL_CONTROL_H
+#define SIM_HAL_CONTROL_H
+
+#include "hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Virtual clock */
+uint64_t sim_now_ns(void);
+
+/**
+ * @brief Block the calling thread for us of virtual time, running everything due
+ */
+void sim_run_us(uint64_t us);
+
+/**
+ * @brief Block until no timer or device event is pending and every other
+ *        thread waits without a timeout (or max_us elapses)
+ * @return true when the simulation went idle
+ */
+bool sim_run_until_idle(uint64_t max_us);
+
+/**
+ * @brief Delay between a GPT expiry and its callback (interrupt entry), default 0
+ */
+void sim_set_isr_latency_ns(uint32_t ns);
+
+/**
+ * @brief Virtual time charged each time the CPU switches to another thread, default 0
+ */
+void sim_set_context_switch_ns(uint32_t ns);
+
+/**
+ * @brief Virtual time charged per SPI transfer (driver/DMA setup), default 0
+ */
+void sim_set_spi_setup_ns(uint32_t ns);
+
+/* Operation counters, cumulative since start-up */
+typedef struct {
+    uint64_t t_ns;
+    uint32_t spi_frames;            // Chip-select assertions
+    uint32_t spi_transfers;         // spiExchange/spiSend/spiReceive calls (DMA setups on target)
+    uint64_t spi_bytes;
+    uint32_t i2c_transactions;
+    uint32_t sleeps;                // chThdSleep*() calls
+    uint32_t context_switches;
+    uint32_t interrupts;            // GPT and PAL callbacks
+} sim_counters_t;
+
+sim_counters_t sim_counters(void);
+
+/**
+ * @brief Counters accumulated since a previous sim_counters() snapshot
+ */
+sim_counters_t sim_counters_since(const sim_counters_t *start);
+
+/**
+ * @brief Print one benchmark line: "label: T us, N SPI frames (B bytes), ..."
+ */
+void sim_counters_print(const char *label, const sim_counters_t *delta);
+
+/* Device model events */
+typedef void (*sim_event_fn_t)(void *arg);
+
+/**
+ * @brief Call fn(arg) delay_ns from now, from the timer-event context
+ */
+void sim_schedule_ns(uint64_t delay_ns, sim_event_fn_t fn, void *arg);
+
+/* PWM output trace: one record per change of a channel's pulse width */
+typedef struct {
+    uint64_t t_ns;
+    const PWMDriver *driver;
+    uint8_t channel;
+    uint32_t width;
+} sim_pwm_edge_t;
+
+size_t sim_pwm_trace(const sim_pwm_edge_t **edges);
+void sim_pwm_trace_clear(void);
+
+/* External drive of an input line; fires its PAL callback on a matching edge */
+void sim_pal_drive(ioline_t line, uint32_t level);
+
+/* SPI device: called per chip-select frame and per byte (MOSI in, MISO out) */
+typedef struct sim_spi_device {
+    void (*select)(struct sim_spi_device *dev);
+    uint8_t (*exchange)(struct sim_spi_device *dev, uint8_t mosi);
+    void (*unselect)(struct sim_spi_device *dev);
+    uint32_t max_clock_hz;          // Signal-integrity limit, 0 = none; above it MISO bit 0 flips
+} sim_spi_device_t;
+
+void sim_spi_attach(SPIDriver *spip, sim_spi_device_t *dev);
+
+/* SCK frequency for the current CR1 baud-rate bits (APB1 / 2^(BR+1)) */
+uint32_t sim_spi_clock_hz(const SPIDriver *spip);
+
+/* I2C device at a 7-bit address; a transaction is an optional write then read */
+typedef struct sim_i2c_device {
+    uint16_t addr;
+    void (*write)(struct sim_i2c_device *dev, const uint8_t *data, size_t n);
+    void (*read)(struct sim_i2c_device *dev, uint8_t *data, size_t n);
+    struct sim_i2c_device *next;
+} sim_i2c_device_t;
+
+void sim_i2c_attach(I2CDriver *i2cp, sim_i2c_device_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_HAL_CONTROL_H */
@@ -0,0 +1,122 @@
+/**
+ * @file sim_pcap.cpp
+ * @brief Classic libpcap capture files for the host simulation
+ */
+
+#include "sim_pcap.h"
+
+#include <string.h>
+
+#define PCAP_MAGIC_US               0xA1B2C3D4u
+#define PCAP_MAGIC_NS               0xA1B23C4Du
+#define PCAP_GLOBAL_HEADER_BYTES    24
+#define PCAP_RECORD_HEADER_BYTES    16
+#define PCAP_MAX_SNAPLEN            65535
+
+static uint32_t get32(const uint8_t *p, bool swap)
+{
+    if (swap) {
+        return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    }
+    return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+}
+
+/* Files are written little-endian, as on the hosts that record them */
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+int sim_pcap_read(const char *path, sim_pcap_frame_fn_t fn, void *ctx)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    uint8_t header[PCAP_GLOBAL_HEADER_BYTES];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
+        fclose(file);
+        return -1;
+    }
+
+    // The magic number tells both the byte order and the timestamp unit
+    bool swap = false;
+    uint32_t magic = get32(header, false);
+    if (magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) {
+        swap = true;
+        magic = get32(header, true);
+    }
+    if ((magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) ||
+        get32(&header[20], swap) != SIM_PCAP_LINKTYPE_ETHERNET) {
+        fclose(file);
+        return -1;
+    }
+    bool nanoseconds = magic == PCAP_MAGIC_NS;
+
+    static uint8_t frame[PCAP_MAX_SNAPLEN];
+    int frames = 0;
+    uint8_t record[PCAP_RECORD_HEADER_BYTES];
+    while (fread(record, 1, sizeof(record), file) == sizeof(record)) {
+        uint64_t seconds = get32(&record[0], swap);
+        uint32_t fraction = get32(&record[4], swap);
+        uint32_t length = get32(&record[8], swap);
+        if (length > sizeof(frame) || fread(frame, 1, length, file) != length) {
+            break;      // Truncated capture: keep what was complete
+        }
+
+        fn(ctx, seconds * 1000000ULL + (nanoseconds ? fraction / 1000 : fraction), frame, length);
+        frames++;
+    }
+
+    fclose(file);
+    return frames;
+}
+
+bool sim_pcap_open(sim_pcap_writer_t *writer, const char *path)
+{
+    uint8_t header[PCAP_GLOBAL_HEADER_BYTES];
+
+    writer->frames = 0;
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) {
+        return false;
+    }
+
+    memset(header, 0, sizeof(header));
+    put32(&header[0], PCAP_MAGIC_US);
+    header[4] = 2;                              // Version 2.4
+    header[6] = 4;
+    put32(&header[16], PCAP_MAX_SNAPLEN);
+    put32(&header[20], SIM_PCAP_LINKTYPE_ETHERNET);
+    fwrite(header, 1, sizeof(header), writer->file);
+    return true;
+}
+
+void sim_pcap_write(sim_pcap_writer_t *writer, uint64_t t_us, const uint8_t *frame, uint32_t length)
+{
+    uint8_t record[PCAP_RECORD_HEADER_BYTES];
+
+    if (writer->file == NULL) {
+        return;
+    }
+
+    put32(&record[0], (uint32_t)(t_us / 1000000ULL));
+    put32(&record[4], (uint32_t)(t_us % 1000000ULL));
+    put32(&record[8], length);
+    put32(&record[12], length);
+    fwrite(record, 1, sizeof(record), writer->file);
+    fwrite(frame, 1, length, writer->file);
+    writer->frames++;
+}
+
+void sim_pcap_close(sim_pcap_writer_t *writer)
+{
+    if (writer->file != NULL) {
+        fclose(writer->file);
+        writer->file = NULL;
+    }
+}
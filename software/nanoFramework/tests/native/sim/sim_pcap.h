@@ -0,0 +1,56 @@
+/**
+ * @file sim_pcap.h
+ * @brief Classic libpcap capture files for the host simulation
+ *
+ * Reads Ethernet captures (tcpdump -w, Wireshark "pcap" format, either byte
+ * order, µs or ns timestamps) so recorded traffic can be replayed into the
+ * W5500 model, and writes the frames the driver sent back for inspection in
+ * Wireshark. pcapng is not supported.
+ */
+
+#ifndef SIM_PCAP_H
+#define SIM_PCAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_PCAP_LINKTYPE_ETHERNET  1
+
+/**
+ * @brief Called once per captured frame, in file order
+ * @param t_us Capture timestamp in µs
+ * @param frame Captured bytes (no FCS)
+ * @param length Captured length (at most the snap length)
+ */
+typedef void (*sim_pcap_frame_fn_t)(void *ctx, uint64_t t_us, const uint8_t *frame, uint32_t length);
+
+/**
+ * @brief Read every frame of an Ethernet capture
+ * @return Frames delivered, -1 when the file is missing, not pcap or not Ethernet
+ */
+int sim_pcap_read(const char *path, sim_pcap_frame_fn_t fn, void *ctx);
+
+typedef struct {
+    FILE *file;
+    uint32_t frames;
+} sim_pcap_writer_t;
+
+/**
+ * @brief Create (truncate) an Ethernet capture with µs timestamps
+ */
+bool sim_pcap_open(sim_pcap_writer_t *writer, const char *path);
+
+void sim_pcap_write(sim_pcap_writer_t *writer, uint64_t t_us, const uint8_t *frame, uint32_t length);
+
+void sim_pcap_close(sim_pcap_writer_t *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_PCAP_H */
@@ -0,0 +1,44 @@
+/**
+ * @file test_check.h
+ * @brief Minimal check macros for the native host tests
+ *
+ * The host tests are plain executables registered with CTest; a non-zero
+ * exit code marks the test as failed.
+ */
+
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <stdio.h>
+
+static int g_test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            g_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(expected, actual) \
+    do { \
+        long long e_ = (long long)(expected); \
+        long long a_ = (long long)(actual); \
+        if (e_ != a_) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                    __FILE__, __LINE__, #expected, #actual, e_, a_); \
+            g_test_failures++; \
+        } \
+    } while (0)
+
+#define RUN_TEST(fn) \
+    do { \
+        int before_ = g_test_failures; \
+        fn(); \
+        printf("%s %s\n", g_test_failures == before_ ? "[ PASS ]" : "[ FAIL ]", #fn); \
+    } while (0)
+
+#define TEST_RESULT() (g_test_failures == 0 ? 0 : 1)
+
+#endif /* TEST_CHECK_H */
@@ -0,0 +1,188 @@
+/**
+ * @file test_diseqc_frame.cpp
+ * @brief Host tests for the HAL-independent DiSEqC encoder and player
+ */
+
+#include "diseqc_frame.h"
+#include "test_check.h"
+
+static const uint16_t kDuty = 22;
+
+/**
+ * @brief Reference encoder: straight bit-by-bit segment expansion
+ *
+ * Mirrors the original add_bit/add_byte_with_parity table builder so the
+ * packed frames can be checked segment for segment against it.
+ */
+static uint16_t reference_segments(const uint8_t *data, uint8_t length, diseqc_segment_t *out)
+{
+    uint16_t count = 0;
+
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t ones = 0;
+        for (int b = 8; b >= 0; b--) {
+            bool bit;
+            if (b > 0) {
+                bit = ((data[i] >> (b - 1)) & 1) != 0;
+                ones += bit ? 1 : 0;
+            } else {
+                bit = (ones & 1) == 0;
+            }
+
+            out[count].ccr_value = kDuty;
+            out[count].duration_us = bit ? DISEQC_BIT1_HIGH_US : DISEQC_BIT0_HIGH_US;
+            count++;
+            out[count].ccr_value = 0;
+            out[count].duration_us = bit ? DISEQC_BIT1_LOW_US : DISEQC_BIT0_LOW_US;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static bool bits_match_reference(diseqc_bits_t bits, const uint8_t *bytes, uint8_t length)
+{
+    diseqc_segment_t expected[DISEQC_MAX_BITS * 2];
+    uint16_t count = reference_segments(bytes, length, expected);
+
+    diseqc_player_t player;
+    diseqc_player_load(&player, bits, kDuty);
+
+    uint16_t played = 0;
+    for (const diseqc_segment_t *seg = diseqc_player_current(&player);
+         seg != NULL;
+         seg = diseqc_player_advance(&player)) {
+        if (played >= count ||
+            seg->ccr_value != expected[played].ccr_value ||
+            seg->duration_us != expected[played].duration_us) {
+            return false;
+        }
+        played++;
+    }
+
+    return played == count;
+}
+
+static void test_parity_bit_is_odd_parity()
+{
+    CHECK_EQ(1, diseqc_parity_bit(0x00));
+    CHECK_EQ(0, diseqc_parity_bit(0x01));
+    CHECK_EQ(0, diseqc_parity_bit(0xE0));   // three ones already odd
+    CHECK_EQ(1, diseqc_parity_bit(0x60));   // two ones
+}
+
+static void test_pack_rejects_invalid_input()
+{
+    const uint8_t cmd[7] = {0xE0, 0x31, 0x60, 0, 0, 0, 0};
+
+    CHECK_EQ(0, diseqc_bits_from_bytes(NULL, 3).bit_count);
+    CHECK_EQ(0, diseqc_bits_from_bytes(cmd, 0).bit_count);
+    CHECK_EQ(0, diseqc_bits_from_bytes(cmd, 7).bit_count);
+}
+
+static void test_halt_bit_timing()
+{
+    const uint8_t halt[3] = {0xE0, 0x31, 0x60};
+    diseqc_player_t player;
+    diseqc_player_load(&player, diseqc_bits_from_bytes(halt, 3), kDuty);
+
+    // 0xE0 MSB first: 1,1,1,0,0,0,0,0 then parity 0
+    const int expected_bits[9] = {1, 1, 1, 0, 0, 0, 0, 0, 0};
+    const diseqc_segment_t *seg = diseqc_player_current(&player);
+    for (int i = 0; i < 9; i++) {
+        CHECK_EQ(kDuty, seg->ccr_value);
+        CHECK_EQ(expected_bits[i] ? DISEQC_BIT1_HIGH_US : DISEQC_BIT0_HIGH_US, seg->duration_us);
+        seg = diseqc_player_advance(&player);
+        CHECK_EQ(0, seg->ccr_value);
+        CHECK_EQ(expected_bits[i] ? DISEQC_BIT1_LOW_US : DISEQC_BIT0_LOW_US, seg->duration_us);
+        seg = diseqc_player_advance(&player);
+    }
+
+    // Every bit is 1.5 ms regardless of value
+    uint32_t total_us = 0;
+    uint16_t segments = 0;
+    diseqc_player_load(&player, diseqc_bits_from_bytes(halt, 3), kDuty);
+    for (seg = diseqc_player_current(&player); seg != NULL; seg = diseqc_player_advance(&player)) {
+        total_us += seg->duration_us;
+        segments++;
+    }
+    CHECK_EQ(3 * 9 * 2, segments);
+    CHECK_EQ(3 * 9 * 1500, total_us);
+    CHECK(diseqc_player_advance(&player) == NULL);
+}
+
+static void test_runtime_pack_matches_reference()
+{
+    // GotoX 30.0 W and a full 6-byte frame
+    const uint8_t goto_x[5] = {0xE0, 0x31, 0x6E, 0xD1, 0xE0};
+    const uint8_t six[6] = {0xE2, 0x31, 0x6E, 0xFF, 0x00, 0xA5};
+
+    CHECK(bits_match_reference(diseqc_bits_from_bytes(goto_x, 5), goto_x, 5));
+    CHECK(bits_match_reference(diseqc_bits_from_bytes(six, 6), six, 6));
+    CHECK_EQ(DISEQC_MAX_BITS, diseqc_bits_from_bytes(six, 6).bit_count);
+}
+
+// Compile-time evaluation: E0 = 1110 0000 + parity 0
+static_assert(diseqc_bits_make(DISEQC_BITS_EMPTY, 0xE0).pattern == 0x1C0, "E0 packs to 111000000");
+static_assert(diseqc_parity_bit_c(0x60) == 1, "constexpr parity matches runtime");
+
+static void test_fixed_frames_match_reference()
+{
+    struct {
+        diseqc_bits_t bits;
+        uint8_t bytes[4];
+        uint8_t length;
+    } const cases[] = {
+        {DISEQC_BITS_RESET,          {0xE0, 0x00, 0x00},       3},
+        {DISEQC_BITS_CLEAR_RESET,    {0xE0, 0x00, 0x01},       3},
+        {DISEQC_BITS_STANDBY,        {0xE0, 0x00, 0x02},       3},
+        {DISEQC_BITS_POWER_ON,       {0xE0, 0x00, 0x03},       3},
+        {DISEQC_BITS_HALT,           {0xE0, 0x31, 0x60},       3},
+        {DISEQC_BITS_LIMITS_OFF,     {0xE0, 0x31, 0x63},       3},
+        {DISEQC_BITS_LIMIT_EAST,     {0xE0, 0x31, 0x66},       3},
+        {DISEQC_BITS_LIMIT_WEST,     {0xE0, 0x31, 0x67},       3},
+        {DISEQC_BITS_DRIVE_EAST,     {0xE0, 0x31, 0x68, 0x00}, 4},
+        {DISEQC_BITS_DRIVE_WEST,     {0xE0, 0x31, 0x69, 0x00}, 4},
+        {DISEQC_BITS_GOTO_REFERENCE, {0xE0, 0x31, 0x6B, 0x00}, 4},
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        CHECK_EQ(cases[i].length * 9, cases[i].bits.bit_count);
+        CHECK(bits_match_reference(cases[i].bits, cases[i].bytes, cases[i].length));
+    }
+}
+
+static void test_step_prefix_plus_parameter_byte()
+{
+    for (int steps = 1; steps <= 128; steps++) {
+        const uint8_t east[4] = {0xE0, 0x31, 0x68, (uint8_t)steps};
+        const uint8_t west[4] = {0xE0, 0x31, 0x69, (uint8_t)steps};
+        CHECK(bits_match_reference(diseqc_bits_append(DISEQC_BITS_STEP_EAST_PREFIX, (uint8_t)steps), east, 4));
+        CHECK(bits_match_reference(diseqc_bits_append(DISEQC_BITS_STEP_WEST_PREFIX, (uint8_t)steps), west, 4));
+    }
+}
+
+static void test_player_ram_footprint()
+{
+    // Previous segment buffer: 6 bytes × 9 bits × 2 segments × 4 bytes
+    const size_t old_buffer = DISEQC_MAX_BYTES * 9 * 2 * sizeof(diseqc_segment_t);
+
+    printf("  diseqc_player_t = %u bytes (replaces %u-byte segment buffer)\n",
+           (unsigned)sizeof(diseqc_player_t), (unsigned)old_buffer);
+
+    CHECK(sizeof(diseqc_player_t) <= 32);
+    CHECK(sizeof(diseqc_player_t) * 10 < old_buffer);
+}
+
+int main()
+{
+    RUN_TEST(test_parity_bit_is_odd_parity);
+    RUN_TEST(test_pack_rejects_invalid_input);
+    RUN_TEST(test_halt_bit_timing);
+    RUN_TEST(test_runtime_pack_matches_reference);
+    RUN_TEST(test_fixed_frames_match_reference);
+    RUN_TEST(test_step_prefix_plus_parameter_byte);
+    RUN_TEST(test_player_ram_footprint);
+    return TEST_RESULT();
+}
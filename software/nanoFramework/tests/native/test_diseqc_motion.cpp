@@ -0,0 +1,218 @@
+/**
+ * @file test_diseqc_motion.cpp
+ * @brief Rotor motion estimator: trapezoid timing, ETA, backlash, halt
+ */
+
+#include "diseqc_motion.h"
+#include "test_check.h"
+
+#define TICK_MS 100
+
+/**
+ * @brief Run the model at the driver's tick rate until it settles
+ * @return Elapsed ms, or -1 if it never settled
+ */
+static int32_t run_to_settle(diseqc_motion_t *motion, int *settle_edges)
+{
+    int32_t elapsed = 0;
+
+    while (elapsed < 120000) {
+        elapsed += TICK_MS;
+        if (diseqc_motion_advance(motion, TICK_MS)) {
+            (*settle_edges)++;
+            return elapsed;
+        }
+    }
+
+    return -1;
+}
+
+static void test_long_move_matches_trapezoid()
+{
+    diseqc_motion_t motion;
+    diseqc_motion_init(&motion, NULL, 0);
+    diseqc_motion_goto(&motion, 30000);
+
+    // 0.5 s spin-up (450 mdeg) + 29.1° at 1.8°/s + 0.5 s spin-down = 17167 ms
+    int32_t eta = diseqc_motion_eta_ms(&motion);
+    CHECK(eta > 17100 && eta < 17250);
+    CHECK_EQ(DISEQC_MOTION_MOVING, motion.state);
+
+    int edges = 0;
+    int32_t last = 0;
+    int32_t elapsed = 0;
+    bool monotonic = true;
+
+    while (!diseqc_motion_advance(&motion, TICK_MS)) {
+        elapsed += TICK_MS;
+        monotonic = monotonic && motion.position_mdeg >= last && motion.position_mdeg <= 30000;
+        last = motion.position_mdeg;
+        CHECK(motion.velocity_mdeg_s <= DISEQC_MOTION_SPEED_MDEG_S);
+        if (elapsed > 60000) {
+            break;
+        }
+    }
+    elapsed += TICK_MS;
+    edges++;
+
+    CHECK(monotonic);
+    CHECK(elapsed >= 17100 && elapsed <= 17400);
+    CHECK_EQ(30000, motion.position_mdeg);
+    CHECK_EQ(DISEQC_MOTION_SETTLED, motion.state);
+    CHECK_EQ(0, diseqc_motion_eta_ms(&motion));
+
+    // The settle edge is reported once
+    CHECK(!diseqc_motion_advance(&motion, TICK_MS));
+    CHECK_EQ(1, edges);
+}
+
+static void test_eta_tracks_actual_arrival()
+{
+    diseqc_motion_t motion;
+    diseqc_motion_init(&motion, NULL, 5000);
+    diseqc_motion_goto(&motion, -20000);
+
+    int32_t etas[400];
+    int count = 0;
+    etas[count++] = diseqc_motion_eta_ms(&motion);
+
+    int32_t elapsed = 0;
+    while (count < 400) {
+        elapsed += TICK_MS;
+        if (diseqc_motion_advance(&motion, TICK_MS)) {
+            break;
+        }
+        etas[count++] = diseqc_motion_eta_ms(&motion);
+    }
+
+    // elapsed-so-far + ETA predicts the arrival within a couple of ticks
+    int32_t worst = 0;
+    for (int i = 0; i < count; i++) {
+        int32_t error = i * TICK_MS + etas[i] - elapsed;
+        if (error < 0) error = -error;
+        if (error > worst) worst = error;
+    }
+
+    printf("  25 deg move: %d ms, worst ETA error %d ms\n", (int)elapsed, (int)worst);
+    CHECK(worst <= 2 * TICK_MS);
+    CHECK_EQ(-20000, motion.position_mdeg);
+}
+
+static void test_short_move_is_triangular()
+{
+    diseqc_motion_t motion;
+    diseqc_motion_init(&motion, NULL, 0);
+    diseqc_motion_goto(&motion, 500);
+
+    // Peak sqrt(a·d) = 1341 mdeg/s < cruise speed: 2 × 1341 / 3600 = 745 ms
+    int32_t eta = diseqc_motion_eta_ms(&motion);
+    CHECK(eta > 700 && eta < 800);
+
+    int edges = 0;
+    int32_t elapsed = run_to_settle(&motion, &edges);
+
+    // Within two ticks of the analytic profile at 100 ms resolution
+    CHECK(elapsed >= eta - 2 * TICK_MS && elapsed <= eta + 2 * TICK_MS);
+    CHECK_EQ(500, motion.position_mdeg);
+}
+
+static void test_backlash_on_reversal_only()
+{
+    diseqc_motion_config_t config = {2000, 4000, 500};
+    diseqc_motion_t motion;
+    diseqc_motion_init(&motion, &config, 0);
+
+    int edges = 0;
+    diseqc_motion_goto(&motion, 10000);
+    int32_t first = run_to_settle(&motion, &edges);
+
+    // Same direction again: no slack to take up
+    diseqc_motion_goto(&motion, 20000);
+    int32_t same = run_to_settle(&motion, &edges);
+
+    // Reverse: the motor turns through 0.5° before the dish moves
+    diseqc_motion_goto(&motion, 10000);
+    CHECK_EQ(500, motion.backlash_left_mdeg);
+    CHECK(diseqc_motion_eta_ms(&motion) > first);
+
+    diseqc_motion_advance(&motion, TICK_MS);
+    diseqc_motion_advance(&motion, TICK_MS);
+    CHECK_EQ(20000, motion.position_mdeg);
+
+    int32_t reverse = 2 * TICK_MS + run_to_settle(&motion, &edges);
+
+    CHECK_EQ(first, same);
+    CHECK(reverse > first);
+    CHECK_EQ(10000, motion.position_mdeg);
+    CHECK_EQ(3, edges);
+}
+
+static void test_drive_then_halt_spins_down()
+{
+    diseqc_motion_t motion;
+    diseqc_motion_init(&motion, NULL, 0);
+    diseqc_motion_drive(&motion, -1);
+
+    CHECK_EQ(DISEQC_MOTION_DRIVING, motion.state);
+    CHECK_EQ(-1, diseqc_motion_eta_ms(&motion));
+
+    for (int i = 0; i < 30; i++) {
+        CHECK(!diseqc_motion_advance(&motion, TICK_MS));
+    }
+
+    int32_t at_halt = motion.position_mdeg;
+    CHECK(at_halt < -4000);
+    CHECK_EQ(DISEQC_MOTION_SPEED_MDEG_S, motion.velocity_mdeg_s);
+
+    // Stops v²/2a = 450 mdeg further on, in about v/a = 500 ms
+    diseqc_motion_halt(&motion);
+    CHECK_EQ(at_halt - 450, motion.target_mdeg);
+    int32_t eta = diseqc_motion_eta_ms(&motion);
+    CHECK(eta >= 400 && eta <= 600);
+
+    int edges = 0;
+    int32_t elapsed = run_to_settle(&motion, &edges);
+    CHECK(elapsed > 0 && elapsed <= 700);
+    CHECK_EQ(at_halt - 450, motion.position_mdeg);
+}
+
+static void test_drive_stops_at_travel_limit()
+{
+    diseqc_motion_t motion;
+    diseqc_motion_init(&motion, NULL, 75000);
+    diseqc_motion_drive(&motion, 1);
+
+    int edges = 0;
+    CHECK(run_to_settle(&motion, &edges) > 0);
+    CHECK_EQ(DISEQC_MOTION_LIMIT_MDEG, motion.position_mdeg);
+}
+
+static void test_unknown_slot_and_no_op_goto()
+{
+    diseqc_motion_t motion;
+    diseqc_motion_init(&motion, NULL, 1000);
+
+    diseqc_motion_goto(&motion, 1000);
+    CHECK_EQ(DISEQC_MOTION_SETTLED, motion.state);
+    CHECK(!diseqc_motion_advance(&motion, TICK_MS));
+
+    diseqc_motion_invalidate(&motion);
+    CHECK(!motion.position_known);
+    CHECK(!diseqc_motion_busy(&motion));
+
+    diseqc_motion_goto(&motion, 0);
+    CHECK(motion.position_known);
+    CHECK(diseqc_motion_busy(&motion));
+}
+
+int main()
+{
+    RUN_TEST(test_long_move_matches_trapezoid);
+    RUN_TEST(test_eta_tracks_actual_arrival);
+    RUN_TEST(test_short_move_is_triangular);
+    RUN_TEST(test_backlash_on_reversal_only);
+    RUN_TEST(test_drive_then_halt_spins_down);
+    RUN_TEST(test_drive_stops_at_travel_limit);
+    RUN_TEST(test_unknown_slot_and_no_op_goto);
+    return TEST_RESULT();
+}
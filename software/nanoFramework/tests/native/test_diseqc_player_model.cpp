@@ -0,0 +1,85 @@
+/**
+ * @file test_diseqc_player_model.cpp
+ * @brief Jitter/CPU comparison of THREAD vs ISR DiSEqC transmit modes
+ */
+
+#include "diseqc_player_model.h"
+#include "test_check.h"
+
+static diseqc_bits_t encode_goto()
+{
+    // GotoX 30.0° W: E0 31 6E D1 E0
+    const uint8_t cmd[5] = {0xE0, 0x31, 0x6E, 0xD1, 0xE0};
+    return diseqc_bits_from_bytes(cmd, 5);
+}
+
+static void test_isr_mode_needs_no_thread_wakeups()
+{
+    diseqc_bits_t frame = encode_goto();
+    uint16_t count = (uint16_t)(frame.bit_count * 2);
+    model_cpu_t cpu = model_default_cpu();
+
+    model_result_t thread = model_play(frame, MODEL_TX_THREAD, &cpu);
+    model_result_t isr = model_play(frame, MODEL_TX_ISR, &cpu);
+
+    CHECK_EQ(90, count);
+    CHECK_EQ(90, thread.segments);
+    CHECK_EQ(90, thread.thread_wakeups);
+    CHECK_EQ(90, isr.segments);
+    CHECK_EQ(0, isr.thread_wakeups);
+    CHECK_EQ(thread.isr_count, isr.isr_count);
+    CHECK(isr.cpu_ns < thread.cpu_ns);
+}
+
+static void test_isr_mode_jitter_independent_of_scheduler_load()
+{
+    diseqc_bits_t frame = encode_goto();
+
+    model_cpu_t idle = model_default_cpu();
+    idle.sched_delay_max_ns = 0;
+    model_cpu_t loaded = model_default_cpu();
+    loaded.sched_delay_max_ns = 200000;
+
+    model_result_t isr_idle = model_play(frame, MODEL_TX_ISR, &idle);
+    model_result_t isr_loaded = model_play(frame, MODEL_TX_ISR, &loaded);
+    model_result_t thread_loaded = model_play(frame, MODEL_TX_THREAD, &loaded);
+
+    // ISR path only ever adds interrupt entry + reload time per segment
+    CHECK_EQ(isr_idle.max_segment_error_ns, isr_loaded.max_segment_error_ns);
+    CHECK_EQ(loaded.irq_latency_ns + loaded.isr_cost_ns, isr_loaded.max_segment_error_ns);
+
+    // Thread path inherits scheduler delay on every segment
+    CHECK(thread_loaded.max_segment_error_ns > isr_loaded.max_segment_error_ns);
+    CHECK(thread_loaded.drift_ns > isr_loaded.drift_ns);
+
+    // DiSEqC tolerates roughly ±20% on the 500 µs half-bit
+    CHECK(isr_loaded.max_segment_error_ns < 100000u);
+}
+
+static void test_report_comparison()
+{
+    diseqc_bits_t frame = encode_goto();
+    uint16_t count = (uint16_t)(frame.bit_count * 2);
+    model_cpu_t cpu = model_default_cpu();
+
+    model_result_t thread = model_play(frame, MODEL_TX_THREAD, &cpu);
+    model_result_t isr = model_play(frame, MODEL_TX_ISR, &cpu);
+
+    printf("  GotoX %u segments\n", (unsigned)count);
+    printf("  THREAD: wakeups=%u cpu=%lluns max_err=%uns drift=%lluns\n",
+           (unsigned)thread.thread_wakeups, (unsigned long long)thread.cpu_ns,
+           (unsigned)thread.max_segment_error_ns, (unsigned long long)thread.drift_ns);
+    printf("  ISR:    wakeups=%u cpu=%lluns max_err=%uns drift=%lluns\n",
+           (unsigned)isr.thread_wakeups, (unsigned long long)isr.cpu_ns,
+           (unsigned)isr.max_segment_error_ns, (unsigned long long)isr.drift_ns);
+
+    CHECK(thread.frame_ns > isr.frame_ns);
+}
+
+int main()
+{
+    RUN_TEST(test_isr_mode_needs_no_thread_wakeups);
+    RUN_TEST(test_isr_mode_jitter_independent_of_scheduler_load);
+    RUN_TEST(test_report_comparison);
+    return TEST_RESULT();
+}
@@ -0,0 +1,469 @@
+/**
+ * @file test_diseqc_queue.cpp
+ * @brief Host tests for the DiSEqC SPSC frame queue and transmit sequencer
+ */
+
+#include "diseqc_queue.h"
+#include "test_check.h"
+
+#include <thread>
+
+static diseqc_bits_t halt_frame()
+{
+    const uint8_t halt[3] = {0xE0, 0x31, 0x60};
+    return diseqc_bits_from_bytes(halt, 3);
+}
+
+static void test_queue_fifo_and_full()
+{
+    diseqc_queue_t queue;
+    diseqc_queue_init(&queue);
+
+    diseqc_queue_entry_t entry;
+    CHECK(!diseqc_queue_pop(&queue, &entry));
+
+    for (uint32_t i = 0; i < DISEQC_QUEUE_DEPTH; i++) {
+        entry.frame = halt_frame();
+        entry.sequence = i + 1;
+        CHECK(diseqc_queue_push(&queue, &entry));
+    }
+
+    entry.sequence = 99;
+    CHECK(!diseqc_queue_push(&queue, &entry));
+    CHECK_EQ(DISEQC_QUEUE_DEPTH, diseqc_queue_count(&queue));
+
+    for (uint32_t i = 0; i < DISEQC_QUEUE_DEPTH; i++) {
+        CHECK(diseqc_queue_pop(&queue, &entry));
+        CHECK_EQ(i + 1, entry.sequence);
+    }
+    CHECK_EQ(0, diseqc_queue_count(&queue));
+}
+
+static void test_queue_index_wraparound()
+{
+    diseqc_queue_t queue;
+    diseqc_queue_init(&queue);
+
+    // Run the 8-bit indices through several wraps
+    diseqc_queue_entry_t entry;
+    for (uint32_t i = 1; i <= 1000; i++) {
+        entry.frame = halt_frame();
+        entry.sequence = i;
+        CHECK(diseqc_queue_push(&queue, &entry));
+        CHECK(diseqc_queue_pop(&queue, &entry));
+        CHECK_EQ(i, entry.sequence);
+    }
+}
+
+static void test_queue_spsc_threads()
+{
+    static diseqc_queue_t queue;
+    diseqc_queue_init(&queue);
+
+    const uint32_t total = 50000;
+    uint32_t errors = 0;
+
+    std::thread consumer([&]() {
+        uint32_t expected = 1;
+        diseqc_queue_entry_t entry;
+        while (expected <= total) {
+            if (diseqc_queue_pop(&queue, &entry)) {
+                if (entry.sequence != expected || entry.frame.pattern != expected * 3u) {
+                    errors++;
+                }
+                expected++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (uint32_t i = 1; i <= total; ) {
+        diseqc_queue_entry_t entry;
+        entry.frame.pattern = i * 3u;
+        entry.frame.bit_count = 27;
+        entry.sequence = i;
+        if (diseqc_queue_push(&queue, &entry)) {
+            i++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    consumer.join();
+    CHECK_EQ(0, errors);
+}
+
+/**
+ * @brief Drive the sequencer like the GPT callback would, recording timing
+ */
+struct timeline_t {
+    uint64_t now_us;
+    uint32_t steps;
+    uint32_t completed[8];
+    uint64_t completed_at_us[8];
+    uint64_t frame_start_us[8];
+    uint32_t completions;
+    uint32_t frames_started;
+    bool idle;
+};
+
+static void run_until_idle(diseqc_sequencer_t *seq, timeline_t *t)
+{
+    diseqc_seq_action_t action = diseqc_sequencer_step(seq);
+
+    while (true) {
+        t->steps++;
+        if (seq->state == DISEQC_SEQ_FRAME && seq->player.index == 0) {
+            t->frame_start_us[t->frames_started++] = t->now_us;
+        }
+        if (action.completed != 0) {
+            t->completed_at_us[t->completions] = t->now_us;
+            t->completed[t->completions++] = action.completed;
+        }
+        if (action.idle) {
+            t->idle = true;
+            return;
+        }
+        t->now_us += action.duration_us;
+        action = diseqc_sequencer_step(seq);
+    }
+}
+
+static void test_sequencer_inserts_gap_between_frames()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+
+    uint32_t t1 = 0, t2 = 0;
+    CHECK(diseqc_sequencer_enqueue(&seq, halt_frame(), &t1));
+    CHECK(diseqc_sequencer_kick(&seq));
+    // Second frame queued while the first is "on the wire"
+    CHECK(diseqc_sequencer_enqueue(&seq, DISEQC_BITS_DRIVE_EAST, &t2));
+    CHECK(!diseqc_sequencer_kick(&seq));
+
+    timeline_t t = {};
+    run_until_idle(&seq, &t);
+
+    CHECK_EQ(1, t1);
+    CHECK_EQ(2, t2);
+    CHECK_EQ(2, t.completions);
+    CHECK_EQ(t1, t.completed[0]);
+    CHECK_EQ(t2, t.completed[1]);
+    CHECK_EQ(2, t.frames_started);
+
+    // Halt is 27 bits × 1.5 ms; next frame starts exactly one gap later
+    CHECK_EQ(27 * 1500, t.completed_at_us[0]);
+    CHECK_EQ(27 * 1500 + DISEQC_GAP_US, t.frame_start_us[1]);
+    CHECK_EQ(t2, seq.completed_sequence);
+    CHECK(!diseqc_sequencer_busy(&seq));
+    CHECK(diseqc_sequencer_kick(&seq));
+}
+
+static void test_sequencer_committed_then_tone_bursts()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+
+    // Committed port 0, then SA, then SB: the mini-DiSEqC switch order
+    uint32_t t1 = 0, t2 = 0, t3 = 0;
+    CHECK(diseqc_sequencer_enqueue(&seq, diseqc_bits_append(DISEQC_BITS_COMMITTED_PREFIX, 0xF0), &t1));
+    CHECK(diseqc_sequencer_enqueue_tone(&seq, DISEQC_TONE_BURST_US, &t2));
+    CHECK(diseqc_sequencer_enqueue(&seq, DISEQC_BITS_BURST_SB, &t3));
+    CHECK(!diseqc_sequencer_enqueue_tone(&seq, 0, NULL));
+    CHECK(diseqc_sequencer_kick(&seq));
+
+    // SA burst is a single carrier ON segment
+    diseqc_seq_action_t action = diseqc_sequencer_step(&seq);
+    while (action.completed == 0) {
+        action = diseqc_sequencer_step(&seq);
+    }
+    action = diseqc_sequencer_step(&seq);
+    CHECK_EQ(DISEQC_CARRIER_DUTY, action.ccr_value);
+    CHECK_EQ(DISEQC_TONE_BURST_US, action.duration_us);
+    action = diseqc_sequencer_step(&seq);
+    CHECK_EQ(t2, action.completed);
+    CHECK_EQ(0, action.ccr_value);
+    CHECK_EQ(DISEQC_GAP_US, action.duration_us);
+
+    timeline_t t = {};
+    run_until_idle(&seq, &t);
+    CHECK_EQ(1, t.completions);
+    CHECK_EQ(t3, t.completed[0]);
+
+    // SB is nine '1' bits: 9 × 1.5 ms, 0.5 ms of carrier each
+    CHECK_EQ(9 * 1500, t.completed_at_us[0]);
+    CHECK_EQ(18 + 2, t.steps);
+}
+
+static void test_sequencer_switch_sequence_timing()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+
+    CHECK(diseqc_sequencer_enqueue(&seq, diseqc_bits_append(DISEQC_BITS_COMMITTED_PREFIX, 0xF3), NULL));
+    CHECK(diseqc_sequencer_enqueue_tone(&seq, DISEQC_TONE_BURST_US, NULL));
+    CHECK(diseqc_sequencer_kick(&seq));
+
+    timeline_t t = {};
+    run_until_idle(&seq, &t);
+
+    // Committed frame (4 bytes) → 15 ms → burst → 15 ms → idle
+    CHECK_EQ(2, t.frames_started);
+    CHECK_EQ(4 * 9 * 1500, t.completed_at_us[0]);
+    CHECK_EQ(4 * 9 * 1500 + DISEQC_GAP_US, t.frame_start_us[1]);
+    CHECK_EQ(t.frame_start_us[1] + DISEQC_TONE_BURST_US, t.completed_at_us[1]);
+    CHECK_EQ(t.completed_at_us[1] + DISEQC_GAP_US, t.now_us);
+}
+
+static void test_sequencer_reply_window_after_e2_frame()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+
+    // Read positioner status: E2 31 64
+    const uint8_t query[3] = {DISEQC_FRAMING_REPLY, 0x31, 0x64};
+    diseqc_bits_t frame = diseqc_bits_from_bytes(query, 3);
+    CHECK_EQ(DISEQC_FRAMING_REPLY, diseqc_bits_first_byte(frame));
+
+    diseqc_seq_action_t action;
+    CHECK(!diseqc_sequencer_end_reply_window(&seq, &action));
+
+    CHECK(diseqc_sequencer_enqueue(&seq, frame, NULL));
+    CHECK(diseqc_sequencer_kick(&seq));
+    action = diseqc_sequencer_step(&seq);
+    while (action.completed == 0) {
+        action = diseqc_sequencer_step(&seq);
+    }
+
+    // Bus is held quiet long enough for the slave to answer
+    CHECK_EQ(DISEQC_REPLY_WINDOW_US, action.duration_us);
+    CHECK(seq.reply_window);
+
+    // Reply in: cut down to the normal gap, only once
+    CHECK(diseqc_sequencer_end_reply_window(&seq, &action));
+    CHECK_EQ(DISEQC_GAP_US, action.duration_us);
+    CHECK_EQ(0, action.ccr_value);
+    CHECK_EQ(0, action.completed);
+    CHECK(!diseqc_sequencer_end_reply_window(&seq, &action));
+
+    // E0 frames keep the plain gap
+    CHECK(diseqc_sequencer_enqueue(&seq, halt_frame(), NULL));
+    action = diseqc_sequencer_step(&seq);
+    while (action.completed == 0) {
+        action = diseqc_sequencer_step(&seq);
+    }
+    CHECK_EQ(DISEQC_GAP_US, action.duration_us);
+    CHECK(!seq.reply_window);
+}
+
+static diseqc_bits_t goto_frame()
+{
+    // GotoX 30.0° W: E0 31 6E D1 E0
+    const uint8_t cmd[5] = {0xE0, 0x31, 0x6E, 0xD1, 0xE0};
+    return diseqc_bits_from_bytes(cmd, 5);
+}
+
+static void test_abort_flushes_queue_and_sends_halt()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+
+    uint32_t t1 = 0, t2 = 0, t3 = 0, halt = 0;
+    CHECK(diseqc_sequencer_enqueue(&seq, goto_frame(), &t1));
+    CHECK(diseqc_sequencer_enqueue(&seq, DISEQC_BITS_DRIVE_EAST, &t2));
+    CHECK(diseqc_sequencer_enqueue(&seq, DISEQC_BITS_DRIVE_WEST, &t3));
+    CHECK(diseqc_sequencer_kick(&seq));
+
+    // Five bits into the GotoX frame, mid carrier-ON half
+    uint64_t now = 0;
+    diseqc_seq_action_t action = diseqc_sequencer_step(&seq);
+    for (int i = 0; i < 10; i++) {
+        now += action.duration_us;
+        action = diseqc_sequencer_step(&seq);
+    }
+    CHECK(action.ccr_value != 0);
+
+    diseqc_seq_action_t reload;
+    CHECK_EQ(DISEQC_ABORT_NONE, diseqc_sequencer_abort(&seq, halt_frame(), &halt, &reload));
+    CHECK_EQ(1, diseqc_queue_count(&seq.queue));  // Only Halt left
+    CHECK(seq.abort_pending);
+
+    // Current ON half runs out, then the cut: carrier off for the gap
+    now += action.duration_us;
+    action = diseqc_sequencer_step(&seq);
+    CHECK_EQ(0, action.ccr_value);
+    CHECK_EQ(0, action.completed);
+    CHECK_EQ(DISEQC_GAP_US, action.duration_us);
+    CHECK_EQ(DISEQC_SEQ_GAP, seq.state);
+
+    timeline_t t = {};
+    t.now_us = now + action.duration_us;
+    run_until_idle(&seq, &t);
+
+    // Only Halt completes, one gap after the cut
+    CHECK_EQ(1, t.completions);
+    CHECK_EQ(halt, t.completed[0]);
+    CHECK_EQ(now + DISEQC_GAP_US, t.frame_start_us[0]);
+    CHECK_EQ(now + DISEQC_GAP_US + 27 * 1500, t.completed_at_us[0]);
+
+    CHECK(diseqc_sequencer_ticket_aborted(&seq, t1));
+    CHECK(diseqc_sequencer_ticket_aborted(&seq, t2));
+    CHECK(diseqc_sequencer_ticket_aborted(&seq, t3));
+    CHECK(!diseqc_sequencer_ticket_aborted(&seq, halt));
+    CHECK_EQ(halt, seq.completed_sequence);
+}
+
+static void test_abort_latency_bounded_by_one_bit()
+{
+    const diseqc_bits_t frame = goto_frame();
+    const uint32_t frame_us = frame.bit_count * 1500;
+    uint32_t worst = 0;
+    uint32_t worst_at = 0;
+
+    // Abort at every 10 µs across the frame; carrier must be off within one bit
+    for (uint32_t at = 0; at < frame_us; at += 10) {
+        diseqc_sequencer_t seq;
+        diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+        diseqc_sequencer_enqueue(&seq, frame, NULL);
+        diseqc_sequencer_kick(&seq);
+
+        uint32_t start = 0;
+        diseqc_seq_action_t action = diseqc_sequencer_step(&seq);
+        while (start + action.duration_us <= at) {
+            start += action.duration_us;
+            action = diseqc_sequencer_step(&seq);
+        }
+
+        diseqc_seq_action_t reload;
+        diseqc_sequencer_abort(&seq, halt_frame(), NULL, &reload);
+
+        // Carrier already off in an OFF half; otherwise off at the next step
+        uint32_t off_at = at;
+        if (action.ccr_value != 0) {
+            off_at = start + action.duration_us;
+            action = diseqc_sequencer_step(&seq);
+            CHECK_EQ(0, action.ccr_value);
+        }
+
+        if (off_at - at > worst) {
+            worst = off_at - at;
+            worst_at = at;
+        }
+    }
+
+    printf("  abort worst-case carrier stop %u us (abort at %u us into GotoX), bit time 1500 us\n",
+           (unsigned)worst, (unsigned)worst_at);
+    CHECK(worst <= DISEQC_BIT0_HIGH_US);
+    CHECK(worst < DISEQC_BIT0_HIGH_US + DISEQC_BIT0_LOW_US);
+}
+
+static void test_abort_cuts_burst_and_reply_window_now()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+    diseqc_seq_action_t action;
+
+    // SA burst on the wire: no bit boundary, stop now
+    uint32_t burst = 0;
+    CHECK(diseqc_sequencer_enqueue_tone(&seq, DISEQC_TONE_BURST_US, &burst));
+    CHECK(diseqc_sequencer_kick(&seq));
+    action = diseqc_sequencer_step(&seq);
+    CHECK_EQ(DISEQC_TONE_BURST_US, action.duration_us);
+
+    CHECK_EQ(DISEQC_ABORT_RELOAD, diseqc_sequencer_abort(&seq, DISEQC_BITS_EMPTY, NULL, &action));
+    CHECK_EQ(0, action.ccr_value);
+    CHECK_EQ(DISEQC_GAP_US, action.duration_us);
+    CHECK(diseqc_sequencer_ticket_aborted(&seq, burst));
+    action = diseqc_sequencer_step(&seq);
+    CHECK(action.idle);
+
+    // Reply window: shortened to the plain gap before Halt
+    const uint8_t query[3] = {DISEQC_FRAMING_REPLY, 0x31, 0x64};
+    CHECK(diseqc_sequencer_enqueue(&seq, diseqc_bits_from_bytes(query, 3), NULL));
+    CHECK(diseqc_sequencer_kick(&seq));
+    action = diseqc_sequencer_step(&seq);
+    while (action.completed == 0) {
+        action = diseqc_sequencer_step(&seq);
+    }
+    CHECK(seq.reply_window);
+
+    uint32_t halt = 0;
+    CHECK_EQ(DISEQC_ABORT_RELOAD, diseqc_sequencer_abort(&seq, halt_frame(), &halt, &action));
+    CHECK_EQ(DISEQC_GAP_US, action.duration_us);
+    CHECK(!seq.reply_window);
+
+    timeline_t t = {};
+    run_until_idle(&seq, &t);
+    CHECK_EQ(1, t.completions);
+    CHECK_EQ(halt, t.completed[0]);
+}
+
+static void test_abort_when_idle()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+    diseqc_seq_action_t action;
+
+    // Nothing to drop and nothing to send
+    CHECK_EQ(DISEQC_ABORT_NONE, diseqc_sequencer_abort(&seq, DISEQC_BITS_EMPTY, NULL, &action));
+    CHECK(!diseqc_sequencer_busy(&seq));
+    CHECK(!diseqc_sequencer_ticket_aborted(&seq, 1));
+
+    // Halt from idle starts right away, like a kick
+    uint32_t halt = 0;
+    CHECK_EQ(DISEQC_ABORT_START, diseqc_sequencer_abort(&seq, halt_frame(), &halt, &action));
+    action = diseqc_sequencer_step(&seq);
+    CHECK_EQ(DISEQC_SEQ_FRAME, seq.state);
+    CHECK(action.ccr_value != 0);
+    CHECK(!diseqc_sequencer_ticket_aborted(&seq, halt));
+}
+
+static void test_sequencer_idle_step_is_harmless()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+
+    diseqc_seq_action_t action = diseqc_sequencer_step(&seq);
+    CHECK(action.idle);
+    CHECK_EQ(0, action.duration_us);
+    CHECK_EQ(0, action.ccr_value);
+
+    // Kick with nothing queued goes straight back to idle
+    CHECK(diseqc_sequencer_kick(&seq));
+    action = diseqc_sequencer_step(&seq);
+    CHECK(action.idle);
+    CHECK_EQ(DISEQC_SEQ_IDLE, seq.state);
+}
+
+static void test_sequencer_reports_full_queue()
+{
+    diseqc_sequencer_t seq;
+    diseqc_sequencer_init(&seq, DISEQC_CARRIER_DUTY);
+
+    for (int i = 0; i < DISEQC_QUEUE_DEPTH; i++) {
+        CHECK(diseqc_sequencer_enqueue(&seq, halt_frame(), NULL));
+    }
+    uint32_t ticket = 0;
+    CHECK(!diseqc_sequencer_enqueue(&seq, halt_frame(), &ticket));
+    CHECK_EQ(0, ticket);
+    CHECK(diseqc_sequencer_busy(&seq));
+}
+
+int main()
+{
+    RUN_TEST(test_queue_fifo_and_full);
+    RUN_TEST(test_queue_index_wraparound);
+    RUN_TEST(test_queue_spsc_threads);
+    RUN_TEST(test_sequencer_inserts_gap_between_frames);
+    RUN_TEST(test_sequencer_committed_then_tone_bursts);
+    RUN_TEST(test_sequencer_switch_sequence_timing);
+    RUN_TEST(test_sequencer_reply_window_after_e2_frame);
+    RUN_TEST(test_abort_flushes_queue_and_sends_halt);
+    RUN_TEST(test_abort_latency_bounded_by_one_bit);
+    RUN_TEST(test_abort_cuts_burst_and_reply_window_now);
+    RUN_TEST(test_abort_when_idle);
+    RUN_TEST(test_sequencer_idle_step_is_harmless);
+    RUN_TEST(test_sequencer_reports_full_queue);
+    return TEST_RESULT();
+}
@@ -0,0 +1,229 @@
+/**
+ * @file test_diseqc_rx.cpp
+ * @brief Host tests for the DiSEqC 2.x reply decoder, driven by edge traces
+ */
+
+#include "diseqc_rx.h"
+#include "test_check.h"
+
+typedef struct {
+    uint32_t t_us;
+    bool tone_on;
+} edge_t;
+
+/*
+ * Reply E4 40 as seen on DSQOUT by a logic analyser (µs, ±60 µs jitter),
+ * starting 1 ms after the capture was armed.
+ */
+static const edge_t recorded_e4_40[] = {
+    {1000, true}, {1481, false}, {2440, true}, {2930, false},
+    {3953, true}, {4399, false}, {5348, true}, {6393, false},
+    {6901, true}, {7853, false}, {8339, true}, {8853, false},
+    {9800, true}, {10856, false}, {11360, true}, {12327, false},
+    {12771, true}, {13222, false}, {14217, true}, {15210, false},
+    {15658, true}, {16128, false}, {17079, true}, {18089, false},
+    {18583, true}, {19530, false}, {20075, true}, {21087, false},
+    {21542, true}, {22510, false}, {23030, true}, {24050, false},
+    {24564, true}, {25511, false}, {26024, true}, {27038, false},
+};
+
+/**
+ * @brief Play a packed frame through the transmit player and feed its edges
+ *
+ * The slave uses the same bit encoding as the master, so the transmit
+ * player doubles as a trace generator. jitter_us alternately lengthens and
+ * shortens bursts.
+ */
+static uint32_t feed_frame(diseqc_rx_decoder_t *dec, diseqc_bits_t bits, uint32_t start_us, int32_t jitter_us)
+{
+    diseqc_player_t player;
+    diseqc_player_load(&player, bits, DISEQC_CARRIER_DUTY);
+
+    uint32_t t = start_us;
+    int32_t sign = 1;
+
+    for (const diseqc_segment_t *segment = diseqc_player_current(&player);
+         segment != NULL;
+         segment = diseqc_player_advance(&player)) {
+        bool on = segment->ccr_value != 0;
+        diseqc_rx_edge(dec, t, on);
+        t += (uint32_t)((int32_t)segment->duration_us + (on ? sign * jitter_us : -sign * jitter_us));
+        if (!on) {
+            sign = -sign;
+        }
+    }
+
+    return t;
+}
+
+static void test_recorded_trace_decodes()
+{
+    diseqc_rx_decoder_t dec;
+    diseqc_rx_init(&dec);
+
+    int completed = 0;
+    for (size_t i = 0; i < sizeof(recorded_e4_40) / sizeof(recorded_e4_40[0]); i++) {
+        if (diseqc_rx_edge(&dec, recorded_e4_40[i].t_us, recorded_e4_40[i].tone_on)) {
+            completed++;
+        }
+    }
+
+    CHECK_EQ(2, completed);
+    CHECK_EQ(2, diseqc_rx_available(&dec));
+
+    diseqc_rx_byte_t byte;
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(DISEQC_REPLY_OK, byte.value);
+    CHECK_EQ(DISEQC_RX_FLAG_FRAME_START, byte.flags);
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(0x40, byte.value);
+    CHECK_EQ(0, byte.flags);
+    CHECK(!diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(0, dec.glitches);
+}
+
+static void test_round_trip_all_byte_values()
+{
+    diseqc_rx_decoder_t dec;
+    diseqc_rx_init(&dec);
+
+    uint32_t t = 0;
+    diseqc_rx_byte_t byte;
+
+    for (int value = 0; value < 256; value += 3) {
+        const uint8_t reply[3] = {DISEQC_REPLY_OK, (uint8_t)value, (uint8_t)~value};
+        t = feed_frame(&dec, diseqc_bits_from_bytes(reply, 3), t + 20000, 200);
+
+        CHECK(diseqc_rx_pop(&dec, &byte));
+        CHECK_EQ(DISEQC_REPLY_OK, byte.value);
+        CHECK_EQ(DISEQC_RX_FLAG_FRAME_START, byte.flags);
+        CHECK(diseqc_rx_pop(&dec, &byte));
+        CHECK_EQ(value, byte.value);
+        CHECK_EQ(0, byte.flags);
+        CHECK(diseqc_rx_pop(&dec, &byte));
+        CHECK_EQ((uint8_t)~value, byte.value);
+    }
+
+    CHECK_EQ(0, dec.glitches);
+    CHECK_EQ(0, dec.overruns);
+}
+
+static void test_parity_error_flagged()
+{
+    diseqc_rx_decoder_t dec;
+    diseqc_rx_init(&dec);
+
+    // E4 with its parity bit inverted (last transmitted bit)
+    const uint8_t reply[1] = {DISEQC_REPLY_OK};
+    diseqc_bits_t bits = diseqc_bits_from_bytes(reply, 1);
+    bits.pattern ^= 1;
+    feed_frame(&dec, bits, 0, 0);
+
+    diseqc_rx_byte_t byte;
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(DISEQC_REPLY_OK, byte.value);
+    CHECK_EQ(DISEQC_RX_FLAG_FRAME_START | DISEQC_RX_FLAG_PARITY_ERROR, byte.flags);
+}
+
+static void test_glitch_drops_byte_until_next_frame()
+{
+    diseqc_rx_decoder_t dec;
+    diseqc_rx_init(&dec);
+
+    // Two good bits, then a 100 µs spike
+    diseqc_rx_edge(&dec, 0, true);
+    diseqc_rx_edge(&dec, 500, false);
+    diseqc_rx_edge(&dec, 1500, true);
+    diseqc_rx_edge(&dec, 2000, false);
+    diseqc_rx_edge(&dec, 3000, true);
+    diseqc_rx_edge(&dec, 3100, false);
+    CHECK_EQ(1, dec.glitches);
+    CHECK_EQ(0, dec.bit_count);
+
+    // Clean reply after a frame gap decodes normally
+    const uint8_t reply[2] = {DISEQC_REPLY_NOT_SUPPORTED, 0x00};
+    feed_frame(&dec, diseqc_bits_from_bytes(reply, 2), 10000, 0);
+
+    diseqc_rx_byte_t byte;
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(DISEQC_REPLY_NOT_SUPPORTED, byte.value);
+    CHECK_EQ(DISEQC_RX_FLAG_FRAME_START, byte.flags);
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(0x00, byte.value);
+    CHECK(!diseqc_rx_pop(&dec, &byte));
+}
+
+static void test_truncated_frame_discarded_at_gap()
+{
+    diseqc_rx_decoder_t dec;
+    diseqc_rx_init(&dec);
+
+    // Only the first 4 bits of a byte, then silence and a full frame
+    const uint8_t first[1] = {0xE7};
+    diseqc_bits_t bits = diseqc_bits_from_bytes(first, 1);
+    bits.pattern >>= 5;
+    bits.bit_count = 4;
+    uint32_t t = feed_frame(&dec, bits, 0, 0);
+    CHECK_EQ(4, dec.bit_count);
+
+    const uint8_t reply[1] = {DISEQC_REPLY_OK};
+    feed_frame(&dec, diseqc_bits_from_bytes(reply, 1), t + DISEQC_RX_FRAME_GAP_US, 0);
+
+    CHECK_EQ(1, dec.glitches);
+    diseqc_rx_byte_t byte;
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(DISEQC_REPLY_OK, byte.value);
+    CHECK(!diseqc_rx_pop(&dec, &byte));
+}
+
+static void test_timestamp_wraparound()
+{
+    diseqc_rx_decoder_t dec;
+    diseqc_rx_init(&dec);
+
+    const uint8_t reply[2] = {DISEQC_REPLY_OK, 0x5A};
+    feed_frame(&dec, diseqc_bits_from_bytes(reply, 2), 0xFFFFF000u, 50);
+
+    diseqc_rx_byte_t byte;
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(DISEQC_REPLY_OK, byte.value);
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(0x5A, byte.value);
+    CHECK_EQ(0, dec.glitches);
+}
+
+static void test_ring_overrun_flagged()
+{
+    diseqc_rx_decoder_t dec;
+    diseqc_rx_init(&dec);
+
+    const uint8_t reply[1] = {DISEQC_REPLY_OK};
+    uint32_t t = 0;
+    for (int i = 0; i < DISEQC_RX_RING_SIZE + 2; i++) {
+        t = feed_frame(&dec, diseqc_bits_from_bytes(reply, 1), t + 5000, 0);
+    }
+
+    CHECK_EQ(DISEQC_RX_RING_SIZE, diseqc_rx_available(&dec));
+    CHECK_EQ(2, dec.overruns);
+
+    diseqc_rx_byte_t byte;
+    while (diseqc_rx_pop(&dec, &byte)) {
+    }
+
+    // Next byte after space frees up reports the loss
+    feed_frame(&dec, diseqc_bits_from_bytes(reply, 1), t + 5000, 0);
+    CHECK(diseqc_rx_pop(&dec, &byte));
+    CHECK_EQ(DISEQC_RX_FLAG_FRAME_START | DISEQC_RX_FLAG_OVERRUN, byte.flags);
+}
+
+int main()
+{
+    RUN_TEST(test_recorded_trace_decodes);
+    RUN_TEST(test_round_trip_all_byte_values);
+    RUN_TEST(test_parity_error_flagged);
+    RUN_TEST(test_glitch_drops_byte_until_next_frame);
+    RUN_TEST(test_truncated_frame_discarded_at_gap);
+    RUN_TEST(test_timestamp_wraparound);
+    RUN_TEST(test_ring_overrun_flagged);
+    return TEST_RESULT();
+}
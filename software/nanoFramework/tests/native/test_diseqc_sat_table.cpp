@@ -0,0 +1,185 @@
+/**
+ * @file test_diseqc_sat_table.cpp
+ * @brief Host tests for the satellite / positioner slot table
+ */
+
+#include "diseqc_sat_table.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <string.h>
+
+static uint32_t hash_of(const char *id)
+{
+    return diseqc_sat_hash(id, strlen(id));
+}
+
+static diseqc_sat_entry_t make_entry(const char *id, int16_t longitude_tenths, uint8_t slot)
+{
+    diseqc_sat_entry_t entry;
+    entry.id_hash = hash_of(id);
+    entry.longitude_tenths = longitude_tenths;
+    entry.slot = slot;
+    entry.flags = DISEQC_SAT_FLAG_LONGITUDE;
+    return entry;
+}
+
+static void test_hash_matches_compile_time_and_ignores_case()
+{
+    constexpr uint32_t astra = diseqc_sat_hash_c("astra_19.2e");
+
+    CHECK_EQ(astra, hash_of("astra_19.2e"));
+    CHECK_EQ(astra, hash_of("Astra_19.2E"));
+    CHECK_EQ(astra, diseqc_sat_hash_c("ASTRA_19.2E"));
+    CHECK(astra != hash_of("astra_28.2e"));
+
+    // FNV-1a reference values
+    CHECK_EQ(0x811C9DC5u, diseqc_sat_hash("", 0));
+    CHECK_EQ(0xE40C292Cu, hash_of("a"));
+}
+
+static void test_builtin_lookup()
+{
+    diseqc_sat_entry_t entry;
+
+    CHECK(diseqc_sat_builtin_count() > 0);
+    CHECK(diseqc_sat_find(NULL, hash_of("astra_19.2e"), &entry));
+    CHECK_EQ(192, entry.longitude_tenths);
+    CHECK_EQ(0, entry.slot);
+    CHECK_EQ(DISEQC_SAT_FLAG_LONGITUDE, entry.flags);
+
+    CHECK(diseqc_sat_find(NULL, hash_of("thor_0.8w"), &entry));
+    CHECK_EQ(-8, entry.longitude_tenths);
+    CHECK(diseqc_sat_find(NULL, hash_of("hispasat_30w"), &entry));
+    CHECK_EQ(-300, entry.longitude_tenths);
+
+    CHECK(!diseqc_sat_find(NULL, hash_of("no_such_sat"), &entry));
+}
+
+static void test_overlay_overrides_builtin()
+{
+    diseqc_sat_table_t table;
+    diseqc_sat_table_init(&table);
+
+    diseqc_sat_entry_t stored = make_entry("astra_19.2e", 192, 7);
+    CHECK(diseqc_sat_table_set(&table, &stored));
+
+    diseqc_sat_entry_t entry;
+    CHECK(diseqc_sat_find(&table, hash_of("astra_19.2e"), &entry));
+    CHECK_EQ(7, entry.slot);
+
+    // Built-in entries not in the overlay still resolve
+    CHECK(diseqc_sat_find(&table, hash_of("hotbird_13e"), &entry));
+    CHECK_EQ(130, entry.longitude_tenths);
+
+    CHECK(diseqc_sat_table_remove(&table, hash_of("astra_19.2e")));
+    CHECK(!diseqc_sat_table_remove(&table, hash_of("astra_19.2e")));
+    CHECK(diseqc_sat_find(&table, hash_of("astra_19.2e"), &entry));
+    CHECK_EQ(0, entry.slot);
+}
+
+static void test_overlay_stays_sorted_and_bounded()
+{
+    diseqc_sat_table_t table;
+    diseqc_sat_table_init(&table);
+
+    char id[16];
+    for (int i = 0; i < DISEQC_SAT_TABLE_MAX; i++) {
+        snprintf(id, sizeof(id), "custom_%d", i);
+        diseqc_sat_entry_t entry = make_entry(id, (int16_t)(i * 10), (uint8_t)(i + 1));
+        CHECK(diseqc_sat_table_set(&table, &entry));
+    }
+    CHECK_EQ(DISEQC_SAT_TABLE_MAX, table.count);
+
+    for (int i = 1; i < table.count; i++) {
+        CHECK(table.entries[i - 1].id_hash < table.entries[i].id_hash);
+    }
+
+    // Replacing an existing entry works when full, adding does not
+    diseqc_sat_entry_t replace = make_entry("custom_5", 55, 99);
+    CHECK(diseqc_sat_table_set(&table, &replace));
+    diseqc_sat_entry_t extra = make_entry("custom_extra", 0, 1);
+    CHECK(!diseqc_sat_table_set(&table, &extra));
+
+    for (int i = 0; i < DISEQC_SAT_TABLE_MAX; i++) {
+        snprintf(id, sizeof(id), "custom_%d", i);
+        diseqc_sat_entry_t entry;
+        CHECK(diseqc_sat_find(&table, hash_of(id), &entry));
+        CHECK_EQ(i == 5 ? 99 : i + 1, entry.slot);
+    }
+}
+
+static void test_blob_round_trip_and_rejects_corruption()
+{
+    diseqc_sat_table_t table;
+    diseqc_sat_table_init(&table);
+
+    diseqc_sat_entry_t a = make_entry("astra_19.2e", 192, 3);
+    diseqc_sat_entry_t b = make_entry("my_fixed_dish", -725, 12);
+    CHECK(diseqc_sat_table_set(&table, &a));
+    CHECK(diseqc_sat_table_set(&table, &b));
+
+    uint8_t blob[DISEQC_SAT_BLOB_MAX];
+    CHECK_EQ(0, diseqc_sat_table_export(&table, blob, 10));
+    size_t length = diseqc_sat_table_export(&table, blob, sizeof(blob));
+    CHECK_EQ(DISEQC_SAT_BLOB_HEADER + 2 * DISEQC_SAT_BLOB_ENTRY, length);
+
+    diseqc_sat_table_t loaded;
+    diseqc_sat_table_init(&loaded);
+    CHECK(diseqc_sat_table_import(&loaded, blob, length));
+    CHECK_EQ(2, loaded.count);
+    CHECK_EQ(0, memcmp(&table, &loaded, sizeof(table)));
+
+    diseqc_sat_entry_t entry;
+    CHECK(diseqc_sat_find(&loaded, hash_of("my_fixed_dish"), &entry));
+    CHECK_EQ(-725, entry.longitude_tenths);
+    CHECK_EQ(12, entry.slot);
+
+    // Corrupt payload, truncated blob, wrong magic: overlay left unchanged
+    blob[DISEQC_SAT_BLOB_HEADER + 6] ^= 0x40;
+    CHECK(!diseqc_sat_table_import(&loaded, blob, length));
+    blob[DISEQC_SAT_BLOB_HEADER + 6] ^= 0x40;
+    CHECK(!diseqc_sat_table_import(&loaded, blob, length - 1));
+    blob[0] = 'X';
+    CHECK(!diseqc_sat_table_import(&loaded, blob, length));
+    CHECK_EQ(2, loaded.count);
+}
+
+static void test_lookup_latency()
+{
+    diseqc_sat_table_t table;
+    diseqc_sat_table_init(&table);
+
+    char id[16];
+    for (int i = 0; i < DISEQC_SAT_TABLE_MAX; i++) {
+        snprintf(id, sizeof(id), "custom_%d", i);
+        diseqc_sat_entry_t entry = make_entry(id, 0, (uint8_t)(i + 1));
+        diseqc_sat_table_set(&table, &entry);
+    }
+
+    const uint32_t probe = hash_of("eutelsat_16e");
+    const int iterations = 200000;
+    uint32_t found = 0;
+    diseqc_sat_entry_t entry;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        found += diseqc_sat_find(&table, probe, &entry) ? 1 : 0;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations;
+
+    printf("  overlay miss + built-in hit lookup: %.1f ns (host)\n", ns);
+    CHECK_EQ((uint32_t)iterations, found);
+}
+
+int main()
+{
+    RUN_TEST(test_hash_matches_compile_time_and_ignores_case);
+    RUN_TEST(test_builtin_lookup);
+    RUN_TEST(test_overlay_overrides_builtin);
+    RUN_TEST(test_overlay_stays_sorted_and_bounded);
+    RUN_TEST(test_blob_round_trip_and_rejects_corruption);
+    RUN_TEST(test_lookup_latency);
+    return TEST_RESULT();
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_diseqc_usals.cpp
+ * @brief Fixed-point USALS vs. double-precision reference, plus a host benchmark
+ */
+
+#include "diseqc_usals.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <math.h>
+
+static const double kPi = 3.14159265358979323846;
+static const double kEarthRatio = 6378.137 / 42164.172;
+
+/**
+ * @brief Double-precision reference of the same model, in degrees (West positive)
+ */
+static bool reference_angle(double site_lat, double site_lon, double sat_lon, double *angle)
+{
+    double lat = site_lat * kPi / 180.0;
+    double d = (sat_lon - site_lon) * kPi / 180.0;
+
+    if (cos(d) * cos(lat) <= kEarthRatio) {
+        return false;
+    }
+
+    double hour_angle = atan2(sin(d), cos(d) - kEarthRatio * cos(lat)) * 180.0 / kPi;
+    *angle = site_lat >= 0 ? -hour_angle : hour_angle;
+    return true;
+}
+
+static double bam_to_deg(int32_t bam)
+{
+    return (double)bam * 360.0 / 4294967296.0;
+}
+
+static void test_sincos_and_atan2_accuracy()
+{
+    double max_trig = 0, max_atan = 0;
+
+    for (int32_t mdeg = -180000; mdeg <= 180000; mdeg += 250) {
+        int32_t s, c;
+        diseqc_usals_sincos(diseqc_usals_mdeg_to_bam(mdeg), &s, &c);
+        double rad = mdeg / 1000.0 * kPi / 180.0;
+        max_trig = fmax(max_trig, fabs(s / 1073741824.0 - sin(rad)));
+        max_trig = fmax(max_trig, fabs(c / 1073741824.0 - cos(rad)));
+
+        int32_t y = (int32_t)(sin(rad) * 0.9 * 1073741824.0);
+        int32_t x = (int32_t)(cos(rad) * 0.9 * 1073741824.0);
+        double err = bam_to_deg(diseqc_usals_atan2(y, x)) - atan2((double)y, (double)x) * 180.0 / kPi;
+        err = fmod(err + 540.0, 360.0) - 180.0;
+        max_atan = fmax(max_atan, fabs(err));
+    }
+
+    printf("  sincos max error %.2e, atan2 max error %.2e deg\n", max_trig, max_atan);
+    CHECK(max_trig < 1e-7);
+    CHECK(max_atan < 1e-5);
+}
+
+static void test_known_sites()
+{
+    int16_t angle = 0;
+
+    // Due south: no movement
+    CHECK(diseqc_usals_angle16(51500, 19200, 19200, &angle));
+    CHECK_EQ(0, angle);
+
+    // London (51.5 N, 0.1 W) to Astra 19.2 E: about 21.6° East
+    CHECK(diseqc_usals_angle16(51500, -100, 19200, &angle));
+    CHECK(angle < 0);
+    CHECK(angle > -22 * 16 && angle < -21 * 16);
+
+    // Southern hemisphere mirrors the direction
+    int16_t south = 0;
+    CHECK(diseqc_usals_angle16(-33900, 18400, 36000, &south));
+    CHECK(south > 0);
+
+    // Below the horizon
+    CHECK(!diseqc_usals_angle16(51500, 0, 100000, &angle));
+    CHECK(!diseqc_usals_angle16(85000, 0, 0, &angle));
+}
+
+/**
+ * @brief Sweep the full ±80° motor range for a set of latitudes
+ *
+ * Prints the accuracy table (run with ctest -V) and requires every result
+ * to be within one GotoX step (1/16°) of the rounded reference.
+ */
+static void test_accuracy_table()
+{
+    static const int latitudes[] = {0, 10, 25, 40, 51, 60, 70, -20, -35, -50};
+
+    printf("  lat   points  max|err| (1/16 deg)  max|err| deg   range deg\n");
+
+    int worst_steps = 0;
+
+    for (size_t l = 0; l < sizeof(latitudes) / sizeof(latitudes[0]); l++) {
+        int lat = latitudes[l];
+        int points = 0, max_steps = 0;
+        double max_deg = 0, min_angle = 0, max_angle = 0;
+
+        for (int32_t d_mdeg = -90000; d_mdeg <= 90000; d_mdeg += 100) {
+            double ref;
+            if (!reference_angle(lat, 0.0, d_mdeg / 1000.0, &ref) || fabs(ref) > 80.0) {
+                continue;
+            }
+
+            int16_t angle = 0;
+            CHECK(diseqc_usals_angle16(lat * 1000, 0, d_mdeg, &angle));
+
+            int ref16 = (int)floor(ref * 16.0 + 0.5);
+            int steps = abs(angle - ref16);
+            double deg = fabs(angle / 16.0 - ref);
+
+            points++;
+            max_steps = steps > max_steps ? steps : max_steps;
+            max_deg = fmax(max_deg, deg);
+            min_angle = fmin(min_angle, ref);
+            max_angle = fmax(max_angle, ref);
+        }
+
+        printf("  %4d  %6d  %19d  %12.4f   %+.1f..%+.1f\n",
+               lat, points, max_steps, max_deg, min_angle, max_angle);
+        worst_steps = max_steps > worst_steps ? max_steps : worst_steps;
+        CHECK(points > 0);
+    }
+
+    CHECK(worst_steps <= 1);
+}
+
+static void test_benchmark()
+{
+    const int iterations = 100000;
+    volatile int32_t sink = 0;
+    int16_t angle = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        diseqc_usals_angle16(51500, -100, -30000 + (i % 600) * 100, &angle);
+        sink += angle;
+    }
+    auto fixed = std::chrono::steady_clock::now() - start;
+
+    double ref = 0;
+    volatile double dsink = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        reference_angle(51.5, -0.1, -30.0 + (i % 600) * 0.1, &ref);
+        dsink += ref;
+    }
+    auto reference = std::chrono::steady_clock::now() - start;
+
+    printf("  fixed-point %.1f ns/call, double reference %.1f ns/call (host)\n",
+           (double)std::chrono::duration_cast<std::chrono::nanoseconds>(fixed).count() / iterations,
+           (double)std::chrono::duration_cast<std::chrono::nanoseconds>(reference).count() / iterations);
+    (void)sink;
+    (void)dsink;
+}
+
+int main()
+{
+    RUN_TEST(test_sincos_and_atan2_accuracy);
+    RUN_TEST(test_known_sites);
+    RUN_TEST(test_accuracy_table);
+    RUN_TEST(test_benchmark);
+    return TEST_RESULT();
+}
@@ -0,0 +1,294 @@
+/**
+ * @file test_sim_diseqc.cpp
+ * @brief diseqc_native.cpp on the simulated HAL: waveform timing, GotoX clamping, transmit modes and abort latency
+ */
+
+#include "diseqc_native.h"
+#include "sim_devices.h"
+#include "test_check.h"
+
+#include <math.h>
+#include <vector>
+
+static sim_lnbh26_t g_lnb_chip;
+static lnb_handle_t g_lnb_handle;
+
+/* Carrier segments (ON/OFF runs) reconstructed from the PWM trace */
+typedef struct {
+    uint64_t start_ns;
+    uint32_t duration_us;
+    bool on;
+} segment_t;
+
+static std::vector<segment_t> carrier_segments(uint64_t end_ns)
+{
+    std::vector<segment_t> out;
+    const sim_pwm_edge_t *edges = NULL;
+    size_t count = sim_pwm_trace(&edges);
+
+    for (size_t i = 0; i < count; i++) {
+        if (edges[i].driver != &PWMD4 || edges[i].channel != 0) {
+            continue;
+        }
+        uint64_t next_ns = i + 1 < count ? edges[i + 1].t_ns : end_ns;
+        segment_t seg = {edges[i].t_ns, (uint32_t)((next_ns - edges[i].t_ns) / 1000), edges[i].width != 0};
+        out.push_back(seg);
+    }
+    return out;
+}
+
+static void test_gotox_waveform_matches_encoder()
+{
+    // GotoX 30.0° W: E0 31 6E D1 E0
+    const uint8_t cmd[5] = {0xE0, 0x31, 0x6E, 0xD1, 0xE0};
+    diseqc_bits_t bits = diseqc_bits_from_bytes(cmd, 5);
+
+    sim_pwm_trace_clear();
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(DISEQC_OK, diseqc_transmit(cmd, 5));
+    CHECK(sim_run_until_idle(1000000));
+    CHECK(!diseqc_is_busy());
+
+    std::vector<segment_t> segs = carrier_segments(sim_now_ns());
+
+    // Every bit is one ON and one OFF run; the last OFF run merges into the gap
+    CHECK_EQ(bits.bit_count * 2, segs.size());
+    CHECK_EQ(t0, segs[0].start_ns);
+
+    uint32_t frame_us = 0;
+    for (uint8_t i = 0; i < bits.bit_count && 2u * i + 1 < segs.size(); i++) {
+        bool one = ((bits.pattern >> (bits.bit_count - 1 - i)) & 1) != 0;
+        CHECK(segs[2 * i].on);
+        CHECK(!segs[2 * i + 1].on);
+        CHECK_EQ(one ? DISEQC_BIT1_HIGH_US : DISEQC_BIT0_HIGH_US, segs[2 * i].duration_us);
+        frame_us += segs[2 * i].duration_us;
+        if (i + 1 < bits.bit_count) {
+            CHECK_EQ(one ? DISEQC_BIT1_LOW_US : DISEQC_BIT0_LOW_US, segs[2 * i + 1].duration_us);
+            frame_us += segs[2 * i + 1].duration_us;
+        }
+    }
+
+    // 45 bits of 1.5 ms, minus the trailing OFF half
+    printf("  GotoX: %u segments, carrier active %u us\n", (unsigned)segs.size(), (unsigned)frame_us);
+    CHECK(frame_us > 45 * 1500 - 1000 && frame_us < 45 * 1500);
+}
+
+// Bytes of the frame just sent, decoded from the ON-run lengths (parity bits skipped)
+static std::vector<uint8_t> sent_bytes()
+{
+    std::vector<segment_t> segs = carrier_segments(sim_now_ns());
+    std::vector<uint8_t> out;
+    uint16_t acc = 0;
+    unsigned bit = 0;
+    for (size_t i = 0; i < segs.size(); i++) {
+        if (!segs[i].on) {
+            continue;
+        }
+        if (bit % 9 != 8) {
+            acc = (uint16_t)((acc << 1) | (segs[i].duration_us == DISEQC_BIT1_HIGH_US ? 1 : 0));
+        } else {
+            out.push_back((uint8_t)acc);
+            acc = 0;
+        }
+        bit++;
+    }
+    return out;
+}
+
+static void test_back_to_back_frames_keep_gap()
+{
+    sim_pwm_trace_clear();
+    CHECK_EQ(DISEQC_OK, diseqc_send_fixed(DISEQC_CMD_LIMITS_OFF));
+    CHECK_EQ(DISEQC_OK, diseqc_send_fixed(DISEQC_CMD_HALT));
+    CHECK(sim_run_until_idle(1000000));
+
+    std::vector<segment_t> segs = carrier_segments(sim_now_ns());
+    CHECK_EQ(2 * 2 * 27, segs.size());
+
+    // Quiet time between the frames: last OFF half of frame 1 plus the gap
+    const segment_t &between = segs[2 * 27 - 1];
+    CHECK(!between.on);
+    CHECK(between.duration_us >= DISEQC_GAP_US);
+    CHECK(between.duration_us <= DISEQC_GAP_US + DISEQC_BIT1_LOW_US);
+}
+
+static void test_isr_latency_stretches_every_segment()
+{
+    const uint8_t cmd[3] = {0xE0, 0x31, 0x60};
+
+    sim_pwm_trace_clear();
+    CHECK_EQ(DISEQC_OK, diseqc_transmit(cmd, 3));
+    CHECK(sim_run_until_idle(1000000));
+    std::vector<segment_t> ideal = carrier_segments(sim_now_ns());
+
+    sim_set_isr_latency_ns(5000);
+    sim_pwm_trace_clear();
+    CHECK_EQ(DISEQC_OK, diseqc_transmit(cmd, 3));
+    CHECK(sim_run_until_idle(1000000));
+    std::vector<segment_t> late = carrier_segments(sim_now_ns());
+    sim_set_isr_latency_ns(0);
+
+    // Each GPT reload happens one interrupt entry late, so each segment is stretched by it
+    CHECK_EQ(ideal.size(), late.size());
+    CHECK_EQ(ideal[0].duration_us + 5, late[0].duration_us);
+    CHECK_EQ(ideal[10].duration_us + 5, late[10].duration_us);
+}
+
+static void test_thread_mode_pays_a_wakeup_per_segment()
+{
+    const uint8_t cmd[5] = {0xE0, 0x31, 0x6E, 0xD1, 0xE0};
+    sim_counters_t start;
+
+    sim_pwm_trace_clear();
+    start = sim_counters();
+    CHECK_EQ(DISEQC_OK, diseqc_transmit(cmd, 5));
+    CHECK(sim_run_until_idle(1000000));
+    sim_counters_t isr = sim_counters_since(&start);
+    std::vector<segment_t> isr_segs = carrier_segments(sim_now_ns());
+
+    // THREAD mode: every GPT expiry wakes diseqc_tx, which reloads PWM and timer
+    CHECK_EQ(DISEQC_OK, diseqc_set_tx_mode(DISEQC_TX_MODE_THREAD));
+    sim_set_context_switch_ns(8000);
+    sim_pwm_trace_clear();
+    start = sim_counters();
+    CHECK_EQ(DISEQC_OK, diseqc_transmit(cmd, 5));
+    CHECK(sim_run_until_idle(1000000));
+    sim_counters_t thread = sim_counters_since(&start);
+    std::vector<segment_t> thread_segs = carrier_segments(sim_now_ns());
+    sim_set_context_switch_ns(0);
+    CHECK_EQ(DISEQC_OK, diseqc_set_tx_mode(DISEQC_TX_MODE_ISR));
+
+    sim_counters_print("GotoX ISR mode", &isr);
+    sim_counters_print("GotoX THREAD mode (8 us switch)", &thread);
+
+    // Same frame, but only the thread path switches context for each segment
+    CHECK_EQ(isr_segs.size(), thread_segs.size());
+    CHECK_EQ(isr.interrupts, thread.interrupts);
+    CHECK(thread.context_switches >= 90);
+    CHECK(isr.context_switches < 4);
+
+    // Each segment is stretched by the wakeup of diseqc_tx
+    CHECK_EQ(isr_segs[1].duration_us + 8, thread_segs[1].duration_us);
+    CHECK_EQ(isr_segs[20].duration_us + 8, thread_segs[20].duration_us);
+}
+
+static void test_abort_latency_bounded_by_on_half()
+{
+    const uint8_t cmd[5] = {0xE0, 0x31, 0x6E, 0xD1, 0xE0};
+    uint32_t worst_us = 0;
+
+    for (uint32_t offset_us = 100; offset_us < 60000; offset_us += 997) {
+        sim_pwm_trace_clear();
+        CHECK_EQ(DISEQC_OK, diseqc_transmit(cmd, 5));
+        sim_run_us(offset_us);
+
+        uint64_t abort_ns = sim_now_ns();
+        CHECK_EQ(DISEQC_OK, diseqc_abort(false));
+        CHECK(sim_run_until_idle(1000000));
+
+        // Carrier state after the abort request: first OFF edge (or already off)
+        const sim_pwm_edge_t *edges = NULL;
+        size_t count = sim_pwm_trace(&edges);
+        uint64_t off_ns = abort_ns;
+        bool on_at_abort = false;
+        for (size_t i = 0; i < count; i++) {
+            if (edges[i].t_ns <= abort_ns) {
+                on_at_abort = edges[i].width != 0;
+            } else if (on_at_abort && edges[i].width == 0) {
+                off_ns = edges[i].t_ns;
+                break;
+            }
+        }
+
+        uint32_t latency_us = (uint32_t)((off_ns - abort_ns) / 1000);
+        if (latency_us > worst_us) {
+            worst_us = latency_us;
+        }
+
+        // No carrier after the cut
+        CHECK_EQ(0, edges[count - 1].width);
+        CHECK(edges[count - 1].t_ns <= off_ns);
+    }
+
+    uint32_t last_us = 0;
+    uint32_t native_worst_us = diseqc_get_abort_latency_us(&last_us);
+
+    printf("  abort -> carrier off: worst %u us (driver DWT measurement %u us)\n",
+           (unsigned)worst_us, (unsigned)native_worst_us);
+    CHECK(worst_us <= DISEQC_BIT0_HIGH_US);
+    CHECK(native_worst_us <= worst_us + 1);
+    CHECK(native_worst_us + 1 >= worst_us);
+}
+
+static void test_switch_sequence_timing()
+{
+    diseqc_switch_t sw = {2, LNB_VOLTAGE_18V, DISEQC_BURST_SB, true};
+
+    sim_pwm_trace_clear();
+    uint64_t t0 = sim_now_ns();
+    uint32_t writes_before = g_lnb_chip.writes;
+
+    CHECK_EQ(DISEQC_OK, diseqc_switch_sequence(&sw));
+    uint64_t elapsed_us = (sim_now_ns() - t0) / 1000;
+
+    // Voltage/tone writes happen on the I2C bus; tone is last
+    CHECK_EQ(writes_before + 3, g_lnb_chip.writes);
+    CHECK((g_lnb_chip.regs[0] & LNBH26_CTRL_TONE) != 0);
+    CHECK((g_lnb_chip.regs[0] & LNBH26_CTRL_VSEL) != 0);
+
+    // First carrier edge follows the voltage settle time
+    const sim_pwm_edge_t *edges = NULL;
+    CHECK(sim_pwm_trace(&edges) > 0);
+    CHECK(edges[0].t_ns - t0 >= DISEQC_SWITCH_SETTLE_MS * 1000000ULL);
+
+    // 15 ms settle + committed frame (54 ms) + 15 ms gap + SB (13.5 ms) + 15 ms settle
+    printf("  switch sequence: %llu us\n", (unsigned long long)elapsed_us);
+    CHECK(elapsed_us > 100000 && elapsed_us < 130000);
+}
+
+static void test_goto_angle_clamps_before_rounding()
+{
+    // 3000° must clamp to the West limit, not wrap through int16_t to East.
+    // Each goto starts the motion estimate, which keeps the sim busy: run a fixed
+    // frame time instead of until idle, and keep this test last.
+    const struct { float angle; uint8_t hi; uint8_t lo; } cases[] = {
+        {3000.0f, 0xD5, 0x00},    // +80° = 1280/16
+        {-3000.0f, 0xE5, 0x00},
+        {1e30f, 0xD5, 0x00},
+        {30.0f, 0xD1, 0xE0},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        sim_pwm_trace_clear();
+        CHECK_EQ(DISEQC_OK, diseqc_goto_angle(cases[c].angle));
+        sim_run_us(100000);
+        std::vector<uint8_t> bytes = sent_bytes();
+        CHECK_EQ(5u, bytes.size());
+        if (bytes.size() == 5) {
+            CHECK_EQ(cases[c].hi, bytes[3]);
+            CHECK_EQ(cases[c].lo, bytes[4]);
+        }
+    }
+
+    sim_pwm_trace_clear();
+    CHECK_EQ(DISEQC_ERROR_INVALID_PARAM, diseqc_goto_angle(NAN));
+    sim_run_us(100000);
+    CHECK_EQ(0u, carrier_segments(sim_now_ns()).size());
+}
+
+int main()
+{
+    sim_lnbh26_init(&g_lnb_chip, LNBH26_I2C_ADDR);
+    sim_i2c_attach(&I2CD1, &g_lnb_chip.dev);
+    lnb_init(&g_lnb_handle, &I2CD1, LNBH26_I2C_ADDR);
+
+    diseqc_init(&PWMD4, &GPTD5);
+
+    RUN_TEST(test_gotox_waveform_matches_encoder);
+    RUN_TEST(test_back_to_back_frames_keep_gap);
+    RUN_TEST(test_isr_latency_stretches_every_segment);
+    RUN_TEST(test_thread_mode_pays_a_wakeup_per_segment);
+    RUN_TEST(test_abort_latency_bounded_by_on_half);
+    RUN_TEST(test_switch_sequence_timing);
+    RUN_TEST(test_goto_angle_clamps_before_rounding);
+    return TEST_RESULT();
+}
@@ -0,0 +1,86 @@
+/**
+ * @file test_sim_lnbh26.cpp
+ * @brief lnbh26_native.cpp on the simulated I2C bus: register traffic and bus time
+ */
+
+#include "lnbh26_native.h"
+#include "sim_devices.h"
+#include "test_check.h"
+
+static sim_lnbh26_t g_chip;
+static lnb_handle_t g_lnb;
+
+static void test_init_writes_default_control()
+{
+    uint64_t t0 = sim_now_ns();
+
+    CHECK_EQ(LNB_OK, lnb_init(&g_lnb, &I2CD1, LNBH26_I2C_ADDR));
+    CHECK(lnb_is_initialized());
+    CHECK_EQ(1, g_chip.writes);
+    CHECK_EQ(LNBH26_CTRL_EN | LNBH26_CTRL_DISEQC, g_chip.regs[0]);
+
+    // START + addr + reg + value + STOP at 100 kHz: 29 clocks
+    CHECK_EQ(290000, sim_now_ns() - t0);
+}
+
+static void test_register_bits_follow_api()
+{
+    CHECK_EQ(LNB_OK, lnb_set_polarization(&g_lnb, LNB_POL_HORIZONTAL));
+    CHECK((g_chip.regs[0] & LNBH26_CTRL_VSEL) != 0);
+
+    CHECK_EQ(LNB_OK, lnb_set_band(&g_lnb, LNB_BAND_HIGH));
+    CHECK((g_chip.regs[0] & LNBH26_CTRL_TONE) != 0);
+
+    CHECK_EQ(LNB_OK, lnb_set_voltage(&g_lnb, LNB_VOLTAGE_13V));
+    CHECK((g_chip.regs[0] & LNBH26_CTRL_VSEL) == 0);
+    CHECK((g_chip.regs[0] & LNBH26_CTRL_TONE) != 0);
+    CHECK_EQ(4, g_chip.writes);
+}
+
+static void test_status_read_time()
+{
+    g_chip.regs[1] = LNBH26_STAT_VMON;
+    uint8_t status = 0;
+    uint64_t t0 = sim_now_ns();
+
+    CHECK_EQ(LNB_OK, lnb_read_status(&g_lnb, &status));
+    CHECK_EQ(LNBH26_STAT_VMON, status);
+
+    // Pointer write, repeated START, one data byte: 39 clocks
+    CHECK_EQ(390000, sim_now_ns() - t0);
+}
+
+static void test_fast_mode_bus_time()
+{
+    static const I2CConfig fast = {OPMODE_I2C, 400000, 0};
+    i2cStart(&I2CD1, &fast);
+
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(LNB_OK, lnb_set_tone(&g_lnb, false));
+    uint64_t write_ns = sim_now_ns() - t0;
+
+    printf("  control write: %llu us at 400 kHz (290 us at 100 kHz)\n",
+           (unsigned long long)(write_ns / 1000));
+    CHECK_EQ(72500, write_ns);
+
+    i2cStop(&I2CD1);
+}
+
+static void test_missing_device_reports_i2c_error()
+{
+    lnb_handle_t other;
+    CHECK_EQ(LNB_ERROR_I2C, lnb_init(&other, &I2CD1, 0x0A));
+}
+
+int main()
+{
+    sim_lnbh26_init(&g_chip, LNBH26_I2C_ADDR);
+    sim_i2c_attach(&I2CD1, &g_chip.dev);
+
+    RUN_TEST(test_init_writes_default_control);
+    RUN_TEST(test_register_bits_follow_api);
+    RUN_TEST(test_status_read_time);
+    RUN_TEST(test_fast_mode_bus_time);
+    RUN_TEST(test_missing_device_reports_i2c_error);
+    return TEST_RESULT();
+}
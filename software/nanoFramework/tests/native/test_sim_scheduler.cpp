@@ -0,0 +1,207 @@
+/**
+ * @file test_sim_scheduler.cpp
+ * @brief Virtual-time scheduler of the host HAL simulation
+ */
+
+#include "sim_hal.h"
+#include "test_check.h"
+
+#include <string.h>
+
+/* Append-only log of (thread tag, virtual time) steps */
+typedef struct {
+    char tag;
+    uint64_t t_us;
+} step_t;
+
+static step_t g_steps[64];
+static size_t g_step_count;
+
+static void log_step(char tag)
+{
+    if (g_step_count < sizeof(g_steps) / sizeof(g_steps[0])) {
+        g_steps[g_step_count].tag = tag;
+        g_steps[g_step_count].t_us = sim_now_ns() / 1000;
+        g_step_count++;
+    }
+}
+
+static void log_reset(void)
+{
+    g_step_count = 0;
+}
+
+static THD_WORKING_AREA(wa_sleeper_a, 256);
+static THD_WORKING_AREA(wa_sleeper_b, 256);
+static THD_WORKING_AREA(wa_waiter, 256);
+static THD_WORKING_AREA(wa_listener, 256);
+
+static THD_FUNCTION(sleeper_a, arg)
+{
+    (void)arg;
+    chRegSetThreadName("sleeper_a");
+    for (int i = 0; i < 3; i++) {
+        chThdSleepMilliseconds(2);
+        log_step('a');
+    }
+}
+
+static THD_FUNCTION(sleeper_b, arg)
+{
+    (void)arg;
+    for (int i = 0; i < 2; i++) {
+        chThdSleepMilliseconds(3);
+        log_step('b');
+    }
+}
+
+static void test_sleeps_interleave_in_virtual_time()
+{
+    log_reset();
+    uint64_t t0 = sim_now_ns() / 1000;
+
+    chThdCreateStatic(wa_sleeper_a, sizeof(wa_sleeper_a), NORMALPRIO, sleeper_a, NULL);
+    chThdCreateStatic(wa_sleeper_b, sizeof(wa_sleeper_b), NORMALPRIO, sleeper_b, NULL);
+    CHECK(sim_run_until_idle(100000));
+
+    // a: 2, 4, 6 ms; b: 3, 6 ms; the 6 ms tie goes to the earlier-created thread
+    static const char kOrder[] = "abaab";
+    static const uint64_t kTimes[] = {2000, 3000, 4000, 6000, 6000};
+    CHECK_EQ(5, g_step_count);
+    for (size_t i = 0; i < 5 && i < g_step_count; i++) {
+        CHECK_EQ(kOrder[i], g_steps[i].tag);
+        CHECK_EQ(t0 + kTimes[i], g_steps[i].t_us);
+    }
+    CHECK_EQ(t0 + 6000, sim_now_ns() / 1000);
+}
+
+static binary_semaphore_t g_sem;
+
+static THD_FUNCTION(waiter, arg)
+{
+    (void)arg;
+    while (true) {
+        chBSemWait(&g_sem);
+        log_step('w');
+    }
+}
+
+static void release_from_irq(void *arg)
+{
+    (void)arg;
+    chSysLockFromISR();
+    chBSemSignalI(&g_sem);
+    chSysUnlockFromISR();
+}
+
+static void test_higher_priority_thread_preempts_on_signal()
+{
+    log_reset();
+    chBSemObjectInit(&g_sem, true);
+
+    // Outranks main: runs at creation until it blocks on the semaphore
+    chThdCreateStatic(wa_waiter, sizeof(wa_waiter), NORMALPRIO + 1, waiter, NULL);
+    CHECK_EQ(0, g_step_count);
+
+    // Thread-level signal hands over the CPU before the signaller continues
+    chBSemSignal(&g_sem);
+    log_step('m');
+    CHECK_EQ(2, g_step_count);
+    CHECK_EQ('w', g_steps[0].tag);
+    CHECK_EQ('m', g_steps[1].tag);
+
+    // Interrupt-level signal: the waiter runs at the interrupt's timestamp
+    log_reset();
+    uint64_t t0 = sim_now_ns() / 1000;
+    sim_schedule_ns(750000, release_from_irq, NULL);
+    sim_run_us(5000);
+    CHECK_EQ(1, g_step_count);
+    CHECK_EQ(t0 + 750, g_steps[0].t_us);
+}
+
+static void test_context_switch_cost_is_charged()
+{
+    log_reset();
+    sim_set_context_switch_ns(3000);
+
+    uint64_t t0 = sim_now_ns() / 1000;
+    sim_counters_t start = sim_counters();
+    sim_schedule_ns(100000, release_from_irq, NULL);
+    sim_run_us(1000);
+    sim_counters_t delta = sim_counters_since(&start);
+    sim_set_context_switch_ns(0);
+
+    // main -> waiter costs one switch before the waiter's step is logged
+    CHECK_EQ(1, g_step_count);
+    CHECK_EQ(t0 + 103, g_steps[0].t_us);
+    CHECK_EQ(2, delta.context_switches);
+    CHECK_EQ(0, delta.sleeps);
+    CHECK_EQ(1000 + 3, delta.t_ns / 1000);
+}
+
+static event_source_t g_source;
+
+static THD_FUNCTION(listener, arg)
+{
+    (void)arg;
+    event_listener_t el;
+    chEvtRegisterMaskWithFlags(&g_source, &el, EVENT_MASK(0), 0x2);
+
+    while (chEvtWaitAnyTimeout(EVENT_MASK(0), TIME_MS2I(10)) != 0) {
+        if ((chEvtGetAndClearFlags(&el) & 0x2) != 0) {
+            log_step('e');
+        }
+    }
+    log_step('t');
+    chEvtUnregister(&g_source, &el);
+}
+
+static void broadcast_from_irq(void *arg)
+{
+    chSysLockFromISR();
+    chEvtBroadcastFlagsI(&g_source, (eventflags_t)(uintptr_t)arg);
+    chSysUnlockFromISR();
+}
+
+static void test_events_pend_on_the_registering_thread()
+{
+    log_reset();
+    chEvtObjectInit(&g_source);
+    uint64_t t0 = sim_now_ns() / 1000;
+
+    chThdCreateStatic(wa_listener, sizeof(wa_listener), NORMALPRIO + 1, listener, NULL);
+
+    // Flag 0x1 is outside the listener's wflags and must not wake it
+    sim_schedule_ns(1000000, broadcast_from_irq, (void *)(uintptr_t)0x1);
+    sim_schedule_ns(2000000, broadcast_from_irq, (void *)(uintptr_t)0x2);
+
+    // The main thread never registered: nothing pends on it
+    CHECK_EQ(0, chEvtWaitAnyTimeout(EVENT_MASK(0), TIME_MS2I(5)));
+    CHECK(sim_run_until_idle(100000));
+
+    CHECK_EQ(2, g_step_count);
+    CHECK_EQ('e', g_steps[0].tag);
+    CHECK_EQ(t0 + 2000, g_steps[0].t_us);
+    CHECK_EQ('t', g_steps[1].tag);
+    CHECK_EQ(t0 + 12000, g_steps[1].t_us);
+}
+
+static void test_wait_with_nothing_pending_fails()
+{
+    binary_semaphore_t never;
+    chBSemObjectInit(&never, true);
+
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(MSG_RESET, chBSemWait(&never));
+    CHECK_EQ(t0, sim_now_ns());
+}
+
+int main()
+{
+    RUN_TEST(test_sleeps_interleave_in_virtual_time);
+    RUN_TEST(test_higher_priority_thread_preempts_on_signal);
+    RUN_TEST(test_context_switch_cost_is_charged);
+    RUN_TEST(test_events_pend_on_the_registering_thread);
+    RUN_TEST(test_wait_with_nothing_pending_fails);
+    return TEST_RESULT();
+}
@@ -0,0 +1,903 @@
+/**
+ * @file test_sim_w5500.cpp
+ * @brief w5500_native.cpp against the simulated SPI bus and W5500 model (INT wired to PC7)
+ */
+
+#include "w5500_native.h"
+#include "board_cubley.h"
+#include "sim_devices.h"
+#include "test_check.h"
+
+#include <string.h>
+
+extern volatile uint32_t g_cubley_diag_last_error;
+extern volatile uint32_t g_w5500_init_timing;
+
+static sim_w5500_t g_chip;
+static const uint8_t kPeerIp[4] = {192, 168, 1, 10};
+
+static void test_init_brings_up_chip()
+{
+    sim_counters_t start = sim_counters();
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_init());
+    CHECK(w5500_is_initialized());
+    CHECK_EQ(0x04, w5500_read_version());
+
+    uint8_t phycfgr = w5500_read_phycfgr();
+    CHECK_EQ(0xF0, phycfgr & 0xF8);     // RST=1, OPMD=1, OPMDC=all-capable AN
+    CHECK_EQ(0x07, phycfgr & 0x07);     // Link up, 100M, full duplex
+
+    // No signal-integrity limit on the model: calibration reaches fPCLK/2
+    CHECK_EQ(W5500_SPI_FASTEST_DIVIDER, w5500_get_spi_divider());
+    CHECK_EQ(21000000u, w5500_get_spi_clock_hz());
+
+    // Default network settings reached the common registers
+    static const uint8_t ip[4] = {192, 168, 1, 123};
+    CHECK(memcmp(&g_chip.common[0x0F], ip, 4) == 0);
+    CHECK_EQ(PAL_HIGH, palReadLine(W5500_CS_LINE));     // CS released
+
+    sim_counters_t init = sim_counters_since(&start);
+    sim_counters_print("w5500_init (fast profile)", &init);
+    CHECK_EQ(g_chip.frames, init.spi_frames);
+
+    // Fast profile: 1 ms reset, VERSIONR, MR and PHY resets polled to
+    // completion (3 ms PHY reset on the model), then SPI calibration
+    CHECK_EQ(W5500_INIT_FAST, w5500_get_init_profile());
+    uint32_t init_us = w5500_get_init_duration_us();
+    CHECK(init_us > g_chip.timing.phy_reset_us);
+    CHECK(init_us < 20000);
+    CHECK(init_us <= init.t_ns / 1000 + 100);
+    CHECK_EQ(0xD7010000u | (init_us / 1000), g_w5500_init_timing);
+    CHECK_EQ(0xE14F0100u | (init_us / 10000), g_cubley_diag_last_error);
+
+    // Idempotent
+    uint64_t t1 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_init());
+    CHECK_EQ(t1, sim_now_ns());
+}
+
+static void test_network_settings_applied_when_up()
+{
+    uint8_t ip[4], subnet[4], gw[4], mac[6];
+    CHECK(w5500_parse_ipv4("10.0.0.42", ip));
+    CHECK(w5500_parse_ipv4("255.0.0.0", subnet));
+    CHECK(w5500_parse_ipv4("10.0.0.1", gw));
+    CHECK(w5500_parse_mac("02:08:dc:12:34:56", mac));
+
+    uint8_t bad[6];
+    CHECK(!w5500_parse_ipv4("10.0.0.256", bad));
+    CHECK(!w5500_parse_mac("02:08:dc:12:34", bad));
+
+    w5500_set_network(ip, subnet, gw, mac);
+
+    CHECK(memcmp(&g_chip.common[0x01], gw, 4) == 0);
+    CHECK(memcmp(&g_chip.common[0x05], subnet, 4) == 0);
+    CHECK(memcmp(&g_chip.common[0x09], mac, 6) == 0);
+    CHECK(memcmp(&g_chip.common[0x0F], ip, 4) == 0);
+}
+
+static void test_connect_timeout_when_peer_refuses()
+{
+    g_chip.sockets[0].peer_listening = false;
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_connect(0, kPeerIp, 1883, 1000));
+    CHECK(!w5500_socket_is_connected(0));
+    g_chip.sockets[0].peer_listening = true;
+}
+
+static void test_connect_latency()
+{
+    sim_counters_t start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(0, kPeerIp, 1883, 1000));
+    sim_counters_t connect = sim_counters_since(&start);
+    uint64_t connect_us = connect.t_ns / 1000;
+
+    CHECK(w5500_socket_is_connected(0));
+    CHECK_EQ(0x17, g_chip.sockets[0].regs[0x03]);
+
+    // 500 us handshake, discovered by the 1 ms status poll
+    char label[48];
+    snprintf(label, sizeof(label), "connect (%u us handshake)", (unsigned)g_chip.timing.connect_rtt_us);
+    sim_counters_print(label, &connect);
+    CHECK(connect_us >= g_chip.timing.connect_rtt_us);
+    CHECK(connect_us <= g_chip.timing.connect_rtt_us + 1500);
+}
+
+static void test_send_throughput()
+{
+    static uint8_t payload[1024];
+    static uint8_t captured[1024];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+
+    // One block on its own: the per-operation cost
+    sim_counters_t start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(0, payload, sizeof(payload)));
+    sim_counters_t one = sim_counters_since(&start);
+    sim_counters_print("send 1 KB", &one);
+    CHECK(one.spi_bytes >= sizeof(payload));
+    CHECK_EQ(sizeof(payload), sim_w5500_peer_take(&g_chip, 0, captured, sizeof(captured)));
+
+    const int kBlocks = 16;
+    uint64_t t0 = sim_now_ns();
+    uint32_t frames0 = g_chip.frames;
+
+    for (int b = 0; b < kBlocks; b++) {
+        CHECK_EQ(W5500_SOCKET_OK, w5500_send(0, payload, sizeof(payload)));
+        CHECK_EQ(sizeof(payload), sim_w5500_peer_take(&g_chip, 0, captured, sizeof(captured)));
+        CHECK(memcmp(payload, captured, sizeof(payload)) == 0);
+    }
+
+    uint64_t elapsed_us = (sim_now_ns() - t0) / 1000;
+    uint64_t kbytes_s = (uint64_t)kBlocks * sizeof(payload) * 1000000ULL / 1024ULL / elapsed_us;
+
+    printf("  send: %d x 1 KB in %llu us (%llu KB/s), %u SPI frames per block\n",
+           kBlocks, (unsigned long long)elapsed_us, (unsigned long long)kbytes_s,
+           (unsigned)((g_chip.frames - frames0) / kBlocks));
+    CHECK(kbytes_s > 0);
+}
+
+static void test_publish_spi_cost()
+{
+    // A typical rotor status PUBLISH: 2-byte fixed header, topic, small JSON body
+    static uint8_t publish[64];
+    uint8_t captured[64];
+    for (size_t i = 0; i < sizeof(publish); i++) {
+        publish[i] = (uint8_t)(i + 1);
+    }
+
+    // ~3 us per spiExchange/spiSend/spiReceive for the ChibiOS driver and DMA
+    // stream setup on the F407
+    sim_set_spi_setup_ns(3000);
+    sim_counters_t start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(0, publish, sizeof(publish)));
+    sim_counters_t delta = sim_counters_since(&start);
+    sim_set_spi_setup_ns(0);
+    CHECK_EQ(sizeof(publish), sim_w5500_peer_take(&g_chip, 0, captured, sizeof(captured)));
+    sim_counters_print("publish 64 B", &delta);
+
+    // One register access per transaction took 10 frames / 14 transfers / 106
+    // bytes; batched: status+TX pointers, payload+TX_WR+SEND, then the SENDOK ack
+    CHECK(delta.spi_transfers <= 7);
+    CHECK(delta.spi_frames <= 7);
+    CHECK(delta.spi_bytes <= 106);
+}
+
+static void test_send_stream()
+{
+    // A config snapshot or log burst: three times the 2 KB TX buffer
+    static uint8_t payload[6000];
+    static uint8_t captured[sizeof(payload)];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 13 + 5);
+    }
+    sim_w5500_socket_t *sock = &g_chip.sockets[0];
+    uint32_t sent = 0;
+
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_send_stream(0, payload, 16, 0x80, 100, &sent));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_send_stream(0, payload, 16, 0, -1, &sent));
+
+    // Reference: the same bytes as 1 KB w5500_send() calls, each waiting for room and SENDOK
+    uint64_t t0 = sim_now_ns();
+    for (size_t offset = 0; offset < sizeof(payload); offset += 1024) {
+        size_t block = sizeof(payload) - offset < 1024 ? sizeof(payload) - offset : 1024;
+        CHECK_EQ(W5500_SOCKET_OK, w5500_send(0, payload + offset, (uint16_t)block));
+    }
+    uint64_t blocks_us = (sim_now_ns() - t0) / 1000;
+    CHECK_EQ(sizeof(payload), sim_w5500_peer_take(&g_chip, 0, captured, sizeof(captured)));
+
+    // Streamed: chunks wrap the ring buffer, the next one is copied while the last is on the wire
+    uint32_t overlaps0 = sock->send_overlaps;
+    t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send_stream(0, payload, sizeof(payload), 0, 1000, &sent));
+    uint64_t stream_us = (sim_now_ns() - t0) / 1000;
+    CHECK_EQ(sizeof(payload), sent);
+    CHECK_EQ(sizeof(payload), sim_w5500_peer_take(&g_chip, 0, captured, sizeof(captured)));
+    CHECK(memcmp(payload, captured, sizeof(payload)) == 0);
+    CHECK_EQ(overlaps0, sock->send_overlaps);
+    CHECK(!sock->sending);
+    printf("  send 6000 B: %llu us as 1 KB sends, %llu us streamed\n",
+           (unsigned long long)blocks_us, (unsigned long long)stream_us);
+    CHECK(stream_us < blocks_us);
+
+    // Pipelined: returns with the SEND still in flight, the next send collects its SENDOK
+    t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send_stream(0, payload, 512, W5500_SEND_NO_WAIT, 1000, &sent));
+    uint64_t no_wait_us = (sim_now_ns() - t0) / 1000;
+    CHECK_EQ(512u, sent);
+    CHECK(sock->sending);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send_stream(0, payload + 512, 512, W5500_SEND_NO_WAIT, 1000, &sent));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(0, payload + 1024, 512));
+    CHECK_EQ(overlaps0, sock->send_overlaps);
+    CHECK_EQ(1536u, sim_w5500_peer_take(&g_chip, 0, captured, sizeof(captured)));
+    CHECK(memcmp(payload, captured, 1536) == 0);
+    printf("  send 512 B without waiting for SENDOK: %llu us\n", (unsigned long long)no_wait_us);
+
+    // An unacknowledged peer: the buffer fills, the overall timeout ends the call, and
+    // what was committed still goes out once a zero-length send collects it
+    uint32_t ack_us = g_chip.timing.ack_us;
+    g_chip.timing.ack_us = 50000;
+    t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_send_stream(0, payload, sizeof(payload), 0, 20, &sent));
+    uint64_t timeout_us = (sim_now_ns() - t0) / 1000;
+    CHECK_EQ(1024u, sent);
+    CHECK(timeout_us >= 19000 && timeout_us < 22000);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send_stream(0, NULL, 0, 0, 100, &sent));
+    g_chip.timing.ack_us = ack_us;
+    CHECK_EQ(1024u, sim_w5500_peer_take(&g_chip, 0, captured, sizeof(captured)));
+}
+
+/* Worst arrival -> w5500_receive() return over a sweep of arrival offsets */
+static uint32_t receive_worst_latency_us(uint32_t *spi_frames_per_message)
+{
+    static const uint8_t message[] = "hello from the broker";
+    uint8_t buffer[64];
+    uint16_t received = 0;
+    uint32_t worst_us = 0;
+    sim_counters_t start = sim_counters();
+    uint32_t rounds = 0;
+
+    for (uint32_t delay_us = 50; delay_us < 5000; delay_us += 331) {
+        sim_w5500_peer_send(&g_chip, 0, message, sizeof(message), delay_us);
+        uint64_t arrival_ns = sim_now_ns() + (uint64_t)delay_us * 1000ULL;
+
+        CHECK_EQ(W5500_SOCKET_OK, w5500_receive(0, buffer, sizeof(buffer), 100, &received));
+        CHECK_EQ(sizeof(message), received);
+        CHECK(memcmp(buffer, message, sizeof(message)) == 0);
+
+        uint32_t latency_us = (uint32_t)((sim_now_ns() - arrival_ns) / 1000);
+        if (latency_us > worst_us) {
+            worst_us = latency_us;
+        }
+        rounds++;
+    }
+
+    sim_counters_t receive = sim_counters_since(&start);
+    *spi_frames_per_message = receive.spi_frames / rounds;
+    return worst_us;
+}
+
+static void test_receive_latency()
+{
+    uint32_t polled_frames = 0;
+    uint32_t irq_frames = 0;
+
+    w5500_set_io_mode(W5500_IO_POLLED);
+    uint32_t polled_us = receive_worst_latency_us(&polled_frames);
+    w5500_set_io_mode(W5500_IO_INTERRUPT);
+    uint32_t irq_us = receive_worst_latency_us(&irq_frames);
+
+    printf("  receive POLLED: worst arrival -> return %u us, %u SPI frames per message\n",
+           (unsigned)polled_us, (unsigned)polled_frames);
+    printf("  receive INTERRUPT: worst arrival -> return %u us, %u SPI frames per message\n",
+           (unsigned)irq_us, (unsigned)irq_frames);
+
+    // Polled: arrival is only seen by the next 1 ms poll of Sn_IR
+    CHECK(polled_us <= 1100);
+    // Interrupt: INT edge, then SIR/Sn_IR service and the data read over SPI
+    CHECK(irq_us < 200);
+}
+
+static void test_idle_receive_spi_cost()
+{
+    uint8_t buffer[16];
+    uint16_t received = 0;
+    sim_counters_t start;
+
+    w5500_set_io_mode(W5500_IO_POLLED);
+    start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive(0, buffer, sizeof(buffer), 1000, &received));
+    sim_counters_t polled = sim_counters_since(&start);
+
+    w5500_set_io_mode(W5500_IO_INTERRUPT);
+    start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive(0, buffer, sizeof(buffer), 1000, &received));
+    sim_counters_t irq = sim_counters_since(&start);
+
+    sim_counters_print("idle receive 1 s POLLED", &polled);
+    sim_counters_print("idle receive 1 s INTERRUPT", &irq);
+
+    // One Sn_IR read per millisecond vs. only the 100 ms safety re-reads of SIR
+    CHECK(polled.spi_frames >= 900);
+    CHECK(irq.spi_frames <= 16);
+}
+
+static void test_missed_int_edge_recovered_by_safety_poll()
+{
+    static const uint8_t message[] = "late";
+    uint8_t buffer[16];
+    uint16_t received = 0;
+
+    // INT not wired: the line idles high and never produces an edge
+    sim_w5500_attach_int(&g_chip, 0);
+    sim_w5500_peer_send(&g_chip, 0, message, sizeof(message), 5000);
+    uint64_t arrival_ns = sim_now_ns() + 5000000ULL;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive(0, buffer, sizeof(buffer), 1000, &received));
+    CHECK_EQ(sizeof(message), received);
+    uint64_t latency_us = (sim_now_ns() - arrival_ns) / 1000;
+    sim_w5500_attach_int(&g_chip, W5500_INT_LINE);
+
+    printf("  receive without INT edge: %llu us after arrival\n", (unsigned long long)latency_us);
+    CHECK(latency_us <= 100000 + 100);
+}
+
+static void test_receive_times_out_when_quiet()
+{
+    uint8_t buffer[16];
+    uint16_t received = 0;
+    uint64_t t0 = sim_now_ns();
+
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive(0, buffer, sizeof(buffer), 20, &received));
+    CHECK_EQ(0, received);
+    CHECK((sim_now_ns() - t0) / 1000000 >= 20);
+}
+
+static void test_disconnect()
+{
+    w5500_socket_disconnect(0);
+    CHECK(!w5500_socket_is_connected(0));
+}
+
+static void test_sockets_run_concurrently()
+{
+    static const uint8_t to_mqtt[] = "PUBLISH rotor/cmd";
+    static const uint8_t to_status[] = "GET /status";
+    static const uint8_t reply[] = "HTTP/1.0 200 OK";
+    uint8_t mqtt = 0xFF, http = 0xFF, telemetry = 0xFF;
+    uint8_t buffer[64];
+    uint16_t received = 0;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&mqtt));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&http));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&telemetry));
+    CHECK_EQ(0, mqtt);
+    CHECK_EQ(1, http);
+    CHECK_EQ(2, telemetry);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(mqtt, kPeerIp, 1883, 1000));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(http, kPeerIp, 8080, 1000));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(telemetry, kPeerIp, 9000, 1000));
+
+    // Each socket got its own source port
+    uint16_t port_mqtt = (uint16_t)((g_chip.sockets[mqtt].regs[0x04] << 8) | g_chip.sockets[mqtt].regs[0x05]);
+    uint16_t port_http = (uint16_t)((g_chip.sockets[http].regs[0x04] << 8) | g_chip.sockets[http].regs[0x05]);
+    CHECK(port_mqtt != port_http);
+
+    // Both arrive together; reading the HTTP socket first latches the MQTT RECV
+    sim_w5500_peer_send(&g_chip, mqtt, to_mqtt, sizeof(to_mqtt), 300);
+    sim_w5500_peer_send(&g_chip, http, to_status, sizeof(to_status), 300);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive(http, buffer, sizeof(buffer), 100, &received));
+    CHECK_EQ(sizeof(to_status), received);
+    CHECK(memcmp(buffer, to_status, sizeof(to_status)) == 0);
+
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive(mqtt, buffer, sizeof(buffer), 100, &received));
+    CHECK_EQ(sizeof(to_mqtt), received);
+    CHECK(memcmp(buffer, to_mqtt, sizeof(to_mqtt)) == 0);
+    CHECK((sim_now_ns() - t0) / 1000 < 100);
+
+    // Nothing leaked into the telemetry socket
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive(telemetry, buffer, sizeof(buffer), 5, &received));
+
+    // The reply leaves on the HTTP socket only
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(http, reply, sizeof(reply)));
+    CHECK_EQ(sizeof(reply), sim_w5500_peer_take(&g_chip, http, buffer, sizeof(buffer)));
+    CHECK(memcmp(buffer, reply, sizeof(reply)) == 0);
+    CHECK_EQ(0, sim_w5500_peer_take(&g_chip, mqtt, buffer, sizeof(buffer)));
+
+    // Tearing down the status connection leaves the broker connection up
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(http));
+    CHECK(!w5500_socket_is_open(http));
+    CHECK(!w5500_socket_is_connected(http));
+    CHECK(w5500_socket_is_connected(mqtt));
+    CHECK(w5500_socket_is_connected(telemetry));
+
+    // A released socket is handed out again
+    uint8_t reused = 0xFF;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&reused));
+    CHECK_EQ(http, reused);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(reused));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(telemetry));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(mqtt));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_socket_release(mqtt));
+    CHECK(!w5500_socket_is_connected(mqtt));
+}
+
+static void test_buffer_split()
+{
+    static const uint8_t kDefault[W5500_SOCKET_COUNT] = {2, 2, 2, 2, 2, 2, 2, 2};
+    // MQTT on socket 0 gets 8 KB each way; socket 6 has no TX and socket 7 no buffers
+    static const uint8_t kRx[W5500_SOCKET_COUNT] = {8, 2, 2, 1, 1, 1, 1, 0};
+    static const uint8_t kTx[W5500_SOCKET_COUNT] = {8, 2, 2, 2, 1, 1, 0, 0};
+    static const uint8_t kOddSize[W5500_SOCKET_COUNT] = {3, 2, 2, 2, 2, 2, 2, 0};
+    static const uint8_t kOverCommitted[W5500_SOCKET_COUNT] = {16, 1, 0, 0, 0, 0, 0, 0};
+
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_set_buffer_sizes(kOddSize, kTx));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_set_buffer_sizes(kRx, kOverCommitted));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_set_buffer_sizes(kRx, kTx));
+    for (int s = 0; s < W5500_SOCKET_COUNT; s++) {
+        CHECK_EQ(kRx[s], g_chip.sockets[s].regs[0x1E]);
+        CHECK_EQ(kTx[s], g_chip.sockets[s].regs[0x1F]);
+    }
+
+    uint8_t rx[W5500_SOCKET_COUNT], tx[W5500_SOCKET_COUNT];
+    w5500_get_buffer_sizes(rx, tx);
+    CHECK(memcmp(rx, kRx, sizeof(rx)) == 0);
+    CHECK(memcmp(tx, kTx, sizeof(tx)) == 0);
+
+    // Sockets 0-5 have both buffers; 6 and 7 are never handed out
+    uint8_t sockets[6];
+    for (uint8_t i = 0; i < 6; i++) {
+        CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&sockets[i]));
+        CHECK_EQ(i, sockets[i]);
+    }
+    uint8_t extra = 0xFF;
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_socket_open(&extra));
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_set_buffer_sizes(kDefault, kDefault));
+
+    // A 6 KB message fits the 8 KB socket in one send, but not a 2 KB one
+    static uint8_t payload[6144];
+    static uint8_t captured[6144];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 13 + 1);
+    }
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(sockets[0], kPeerIp, 1883, 1000));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(sockets[0], payload, sizeof(payload)));
+    CHECK_EQ(sizeof(payload), sim_w5500_peer_take(&g_chip, sockets[0], captured, sizeof(captured)));
+    CHECK(memcmp(payload, captured, sizeof(payload)) == 0);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(sockets[1], kPeerIp, 8080, 1000));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_send(sockets[1], payload, 3072));
+
+    // Received data wraps inside the smaller 1 KB RX window of socket 3
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(sockets[3], kPeerIp, 9000, 1000));
+    uint16_t received = 0;
+    for (int round = 0; round < 3; round++) {
+        sim_w5500_peer_send(&g_chip, sockets[3], payload + round * 700, 700, 100);
+        CHECK_EQ(W5500_SOCKET_OK, w5500_receive(sockets[3], captured, 1024, 100, &received));
+        CHECK_EQ(700, received);
+        CHECK(memcmp(captured, payload + round * 700, 700) == 0);
+    }
+
+    for (uint8_t i = 0; i < 6; i++) {
+        CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(sockets[i]));
+    }
+    CHECK_EQ(W5500_SOCKET_OK, w5500_set_buffer_sizes(kDefault, kDefault));
+    CHECK_EQ(2, g_chip.sockets[0].regs[0x1E]);
+}
+
+static void test_receive_exact()
+{
+    static const uint8_t header[] = {0x30, 0x0B};
+    static const uint8_t body[] = "rotor/az=42";
+    uint8_t buffer[32];
+    uint8_t socket = 0xFF;
+    uint16_t received = 0;
+    uint16_t available = 0;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(socket, kPeerIp, 1883, 1000));
+
+    // Peek reports the header without consuming it
+    sim_w5500_peer_send(&g_chip, socket, header, sizeof(header), 100);
+    sim_run_us(200);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_peek_available(socket, &available));
+    CHECK_EQ(sizeof(header), available);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_peek_available(socket, &available));
+    CHECK_EQ(sizeof(header), available);
+
+    // Body split over two segments 3 ms apart arrives as one read at an offset
+    sim_w5500_peer_send(&g_chip, socket, body, 4, 1000);
+    sim_w5500_peer_send(&g_chip, socket, body + 4, sizeof(body) - 4, 4000);
+    memset(buffer, 0, sizeof(buffer));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_exact(socket, buffer + 3, sizeof(header) + sizeof(body), 100, &received));
+    CHECK_EQ(sizeof(header) + sizeof(body), received);
+    CHECK(memcmp(buffer + 3, header, sizeof(header)) == 0);
+    CHECK(memcmp(buffer + 3 + sizeof(header), body, sizeof(body)) == 0);
+    CHECK_EQ(0, buffer[2]);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_peek_available(socket, &available));
+    CHECK_EQ(0, available);
+
+    // Short data: one deadline for the whole read, partial count reported
+    sim_w5500_peer_send(&g_chip, socket, body, 5, 1000);
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive_exact(socket, buffer, 8, 20, &received));
+    CHECK_EQ(5, received);
+    // Deadline counts from the 100 us system tick the call started in
+    uint64_t waited_us = (sim_now_ns() - t0) / 1000;
+    CHECK(waited_us >= 20000 - 100);
+    CHECK(waited_us < 21000);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static uint64_t send_1k_us(uint8_t socket)
+{
+    static uint8_t payload[1024];
+    static uint8_t captured[1024];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 5 + 1);
+    }
+
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(socket, payload, sizeof(payload)));
+    uint64_t us = (sim_now_ns() - t0) / 1000;
+    CHECK_EQ(sizeof(payload), sim_w5500_peer_take(&g_chip, socket, captured, sizeof(captured)));
+    CHECK(memcmp(payload, captured, sizeof(payload)) == 0);
+    return us;
+}
+
+static void test_spi_calibration()
+{
+    uint16_t divider = 0;
+    uint8_t socket = 0xFF;
+
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_set_spi_divider(3));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_set_spi_divider(512));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_calibrate_spi(1, &divider));
+
+    // Board traces good to 12 MHz: 21 MHz fails the readback, 10.5 MHz is kept
+    g_chip.dev.max_clock_hz = 12000000;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_set_spi_divider(16));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_calibrate_spi(2, &divider));
+    CHECK_EQ(4, divider);
+    CHECK_EQ(0x04, w5500_read_version());
+
+    // Starting above the limit backs off first
+    g_chip.dev.max_clock_hz = 4000000;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_calibrate_spi(2, &divider));
+    CHECK_EQ(16, divider);
+    CHECK_EQ(0x04, w5500_read_version());
+
+    // Nothing works: reported, left at the slowest divider
+    g_chip.dev.max_clock_hz = 100000;
+    CHECK_EQ(W5500_SOCKET_IO_ERROR, w5500_calibrate_spi(2, &divider));
+    CHECK_EQ(256, divider);
+
+    g_chip.dev.max_clock_hz = 0;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_calibrate_spi(2, &divider));
+
+    // Bulk cost at the old fixed clock vs. the calibrated one
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(socket, kPeerIp, 1883, 1000));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_set_spi_divider(8));
+    uint64_t slow_us = send_1k_us(socket);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_set_spi_divider(2));
+    uint64_t fast_us = send_1k_us(socket);
+    printf("  send 1 KB: %llu us at 5.25 MHz, %llu us at 21 MHz\n",
+           (unsigned long long)slow_us, (unsigned long long)fast_us);
+    CHECK(fast_us < slow_us);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_calibrate_spi(2, &divider));
+    CHECK_EQ(2, divider);
+}
+
+/* PUBLISH with a body of body_len pattern bytes; returns the frame length */
+static uint16_t build_mqtt_frame(uint8_t *out, uint16_t body_len)
+{
+    uint16_t n = 0;
+    uint32_t value = body_len;
+
+    out[n++] = 0x30;
+    do {
+        uint8_t b = (uint8_t)(value & 0x7F);
+        value >>= 7;
+        out[n++] = (uint8_t)(value != 0 ? (b | 0x80) : b);
+    } while (value != 0);
+
+    for (uint16_t i = 0; i < body_len; i++) {
+        out[n++] = (uint8_t)(i * 7 + 3);
+    }
+    return n;
+}
+
+static void test_receive_mqtt_frame()
+{
+    static uint8_t frame[3200];
+    static uint8_t buffer[3200];
+    uint8_t socket = 0xFF;
+    uint16_t length = 0;
+    uint16_t available = 0;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(socket, kPeerIp, 1883, 1000));
+
+    // Buffered 300-byte packet (2-byte remaining length): one call, varint stripped
+    uint16_t frame_len = build_mqtt_frame(frame, 300);
+    sim_w5500_peer_send(&g_chip, socket, frame, frame_len, 100);
+    sim_run_us(200);
+    sim_counters_t start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+    sim_counters_t framed = sim_counters_since(&start);
+    CHECK_EQ(301, length);
+    CHECK_EQ(0x30, buffer[0]);
+    CHECK(memcmp(buffer + 1, frame + 3, 300) == 0);
+
+    // Same packet the way the managed reader used to take it: header byte, each
+    // length byte, then the body (straight from the chip, no RX mirror)
+    sim_w5500_peer_send(&g_chip, socket, frame, frame_len, 100);
+    sim_run_us(200);
+    w5500_set_rx_mirror(false);
+    start = sim_counters();
+    uint16_t got = 0;
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ(W5500_SOCKET_OK, w5500_receive(socket, buffer, 1, 100, &got));
+    }
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_exact(socket, buffer, 300, 100, &got));
+    sim_counters_t bytewise = sim_counters_since(&start);
+    w5500_set_rx_mirror(true);
+    sim_counters_print("MQTT frame, native framing", &framed);
+    sim_counters_print("MQTT frame, byte-wise header", &bytewise);
+    CHECK(framed.spi_frames * 2 <= bytewise.spi_frames);
+
+    // Header split across segments: waits for the rest of the varint
+    sim_w5500_peer_send(&g_chip, socket, frame, 2, 100);
+    sim_w5500_peer_send(&g_chip, socket, frame + 2, (uint16_t)(frame_len - 2), 3000);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+    CHECK_EQ(301, length);
+    CHECK(memcmp(buffer + 1, frame + 3, 300) == 0);
+
+    // Too small a buffer: required size reported, nothing consumed
+    sim_w5500_peer_send(&g_chip, socket, frame, frame_len, 100);
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_receive_mqtt_frame(socket, buffer, 256, 100, &length));
+    CHECK_EQ(301, length);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_peek_available(socket, &available));
+    CHECK_EQ(frame_len, available);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+    CHECK_EQ(301, length);
+
+    // Larger than the 2 KB RX buffer: the body streams in as the peer sends it
+    frame_len = build_mqtt_frame(frame, 3000);
+    sim_w5500_peer_send(&g_chip, socket, frame, 1500, 100);
+    sim_w5500_peer_send(&g_chip, socket, frame + 1500, (uint16_t)(frame_len - 1500), 5000);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+    CHECK_EQ(3001, length);
+    CHECK(memcmp(buffer + 1, frame + 3, 3000) == 0);
+
+    // Quiet line consumes nothing; a five-byte varint is malformed
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 5, &length));
+    CHECK_EQ(0, length);
+    static const uint8_t malformed[] = {0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    sim_w5500_peer_send(&g_chip, socket, malformed, sizeof(malformed), 100);
+    CHECK_EQ(W5500_SOCKET_IO_ERROR, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+/* Reads 512 pending bytes 16 at a time; returns the SPI cost */
+static sim_counters_t read_in_chunks(uint8_t socket, const uint8_t *data, w5500_rx_stats_t *out_stats)
+{
+    uint8_t buffer[16];
+    uint16_t got = 0;
+
+    sim_w5500_peer_send(&g_chip, socket, data, 512, 100);
+    sim_run_us(200);
+    w5500_reset_rx_stats();
+    sim_counters_t start = sim_counters();
+    for (uint16_t offset = 0; offset < 512; offset += sizeof(buffer)) {
+        CHECK_EQ(W5500_SOCKET_OK, w5500_receive(socket, buffer, sizeof(buffer), 100, &got));
+        CHECK_EQ(sizeof(buffer), got);
+        CHECK(memcmp(buffer, data + offset, sizeof(buffer)) == 0);
+    }
+    sim_counters_t cost = sim_counters_since(&start);
+    w5500_get_rx_stats(out_stats);
+    return cost;
+}
+
+static void test_rx_mirror()
+{
+    static uint8_t data[512];
+    uint8_t frame[16];
+    uint8_t buffer[32];
+    uint8_t socket = 0xFF;
+    uint16_t length = 0;
+    uint16_t available = 0;
+    w5500_rx_stats_t direct_stats;
+    w5500_rx_stats_t mirror_stats;
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 13 + 5);
+    }
+
+    CHECK(w5500_get_rx_mirror());
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(socket, kPeerIp, 1883, 1000));
+
+    // Small reads out of a backlog: one RECV per read vs. one burst for all
+    w5500_set_rx_mirror(false);
+    sim_counters_t direct = read_in_chunks(socket, data, &direct_stats);
+    w5500_set_rx_mirror(true);
+    sim_counters_t mirrored = read_in_chunks(socket, data, &mirror_stats);
+    sim_counters_print("512 B in 16 B reads, no RX mirror", &direct);
+    sim_counters_print("512 B in 16 B reads, RX mirror", &mirrored);
+    printf("  SPI bytes per app byte: %.2f without, %.2f with the mirror; RECV %u vs %u\n",
+           (double)direct_stats.spiBytes / direct_stats.appBytes,
+           (double)mirror_stats.spiBytes / mirror_stats.appBytes,
+           (unsigned)direct_stats.recvCommands, (unsigned)mirror_stats.recvCommands);
+    CHECK_EQ(512, direct_stats.appBytes);
+    CHECK_EQ(0, direct_stats.mirrorBytes);
+    CHECK_EQ(32, direct_stats.recvCommands);
+    CHECK_EQ(512, mirror_stats.appBytes);
+    CHECK_EQ(512, mirror_stats.mirrorBytes);
+    CHECK_EQ(1, mirror_stats.recvCommands);
+    CHECK(mirror_stats.spiBytes * 2 < direct_stats.spiBytes);
+    CHECK(mirrored.spi_frames * 4 < direct.spi_frames);
+
+    // Peek counts mirrored bytes; switching the mirror off still serves them first
+    sim_w5500_peer_send(&g_chip, socket, data, 40, 100);
+    sim_run_us(200);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive(socket, buffer, 8, 100, &length));
+    CHECK(memcmp(buffer, data, 8) == 0);
+    sim_w5500_peer_send(&g_chip, socket, data + 40, 8, 100);
+    sim_run_us(200);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_peek_available(socket, &available));
+    CHECK_EQ(40, available);
+    w5500_set_rx_mirror(false);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_exact(socket, buffer, 32, 100, &length));
+    CHECK(memcmp(buffer, data + 8, 32) == 0);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_peek_available(socket, &available));
+    CHECK_EQ(8, available);
+    w5500_set_rx_mirror(true);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive(socket, buffer, sizeof(buffer), 100, &length));
+    CHECK_EQ(8, length);
+
+    // Eight PUBLISH packets buffered together: the first read pulls them all,
+    // the other seven are framed from RAM without touching the chip
+    uint16_t frame_len = build_mqtt_frame(frame, 12);
+    for (int i = 0; i < 8; i++) {
+        sim_w5500_peer_send(&g_chip, socket, frame, frame_len, 100);
+    }
+    sim_run_us(200);
+    sim_counters_t start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+    sim_counters_t first = sim_counters_since(&start);
+    start = sim_counters();
+    for (int i = 1; i < 8; i++) {
+        CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+        CHECK_EQ(13, length);
+        CHECK(memcmp(buffer + 1, frame + 2, 12) == 0);
+    }
+    sim_counters_t rest = sim_counters_since(&start);
+    sim_counters_print("MQTT frame 1 of 8 buffered", &first);
+    sim_counters_print("MQTT frames 2-8 from the RX mirror", &rest);
+    CHECK_EQ(0, rest.spi_frames);
+
+    // Closing drops what was mirrored; the next connection starts clean
+    sim_w5500_peer_send(&g_chip, socket, data, 40, 100);
+    sim_run_us(200);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive(socket, buffer, 8, 100, &length));
+    w5500_socket_disconnect(socket);
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_peek_available(socket, &available));
+    CHECK_EQ(0, available);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_udp_telemetry_and_discovery()
+{
+    static const uint8_t kBroadcast[4] = {255, 255, 255, 255};
+    static const uint8_t probe[] = "CUBLEY?";
+    static const uint8_t small[] = "az=42";
+    uint8_t telemetry[64];
+    uint8_t buffer[64];
+    uint8_t src_ip[4];
+    uint16_t src_port = 0;
+    uint16_t received = 0;
+    uint8_t udp = 0xFF;
+    uint8_t tcp = 0xFF;
+
+    for (size_t i = 0; i < sizeof(telemetry); i++) {
+        telemetry[i] = (uint8_t)(0xA0 + i);
+    }
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&udp));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_udp_open(udp, 30303));
+    CHECK_EQ(0x02, g_chip.sockets[udp].regs[0x00]);
+    CHECK_EQ(0x22, g_chip.sockets[udp].regs[0x03]);
+    CHECK_EQ(30303, (g_chip.sockets[udp].regs[0x04] << 8) | g_chip.sockets[udp].regs[0x05]);
+    CHECK(!w5500_socket_is_connected(udp));
+
+    // Fire-and-forget telemetry: destination, payload, TX_WR and SEND in one chain
+    sim_set_spi_setup_ns(3000);
+    sim_counters_t start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_udp_send_to(udp, kPeerIp, 9000, telemetry, sizeof(telemetry)));
+    sim_counters_t sendto = sim_counters_since(&start);
+    sim_set_spi_setup_ns(0);
+    sim_counters_print("UDP sendto 64 B", &sendto);
+    CHECK(sendto.spi_frames <= 8);
+    CHECK_EQ(1, g_chip.sockets[udp].datagrams_sent);
+    CHECK(memcmp(g_chip.sockets[udp].last_dest, kPeerIp, 4) == 0);
+    CHECK_EQ(9000, (g_chip.sockets[udp].last_dest[4] << 8) | g_chip.sockets[udp].last_dest[5]);
+    CHECK_EQ(sizeof(telemetry), sim_w5500_peer_take(&g_chip, udp, buffer, sizeof(buffer)));
+    CHECK(memcmp(buffer, telemetry, sizeof(telemetry)) == 0);
+
+    // Discovery: broadcast a probe, each datagram carries its own destination
+    CHECK_EQ(W5500_SOCKET_OK, w5500_udp_send_to(udp, kBroadcast, 30303, probe, sizeof(probe)));
+    CHECK(memcmp(g_chip.sockets[udp].last_dest, kBroadcast, 4) == 0);
+    CHECK_EQ(sizeof(probe), sim_w5500_peer_take(&g_chip, udp, buffer, sizeof(buffer)));
+
+    // Two queued replies come back one datagram per call, with their sources
+    static const uint8_t kOther[4] = {192, 168, 1, 77};
+    sim_w5500_peer_send_datagram(&g_chip, udp, kPeerIp, 40000, telemetry, sizeof(telemetry), 200);
+    sim_w5500_peer_send_datagram(&g_chip, udp, kOther, 40001, small, sizeof(small), 300);
+    sim_run_us(1000);
+
+    start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_udp_receive_from(udp, buffer, sizeof(buffer), 100, src_ip, &src_port, &received));
+    sim_counters_t recvfrom = sim_counters_since(&start);
+    sim_counters_print("UDP recvfrom 64 B", &recvfrom);
+    CHECK_EQ(sizeof(telemetry), received);
+    CHECK(memcmp(buffer, telemetry, sizeof(telemetry)) == 0);
+    CHECK(memcmp(src_ip, kPeerIp, 4) == 0);
+    CHECK_EQ(40000, src_port);
+
+    // A short buffer keeps the head of the datagram and drops the rest
+    CHECK_EQ(W5500_SOCKET_OK, w5500_udp_receive_from(udp, buffer, 2, 100, src_ip, &src_port, &received));
+    CHECK_EQ(2, received);
+    CHECK(memcmp(buffer, small, 2) == 0);
+    CHECK(memcmp(src_ip, kOther, 4) == 0);
+    CHECK_EQ(40001, src_port);
+
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_udp_receive_from(udp, buffer, sizeof(buffer), 10, src_ip, &src_port, &received));
+    CHECK_EQ(0, received);
+    CHECK((sim_now_ns() - t0) / 1000 >= 10000 - 100);
+
+    // A reply arriving mid-wait wakes the receiver
+    sim_w5500_peer_send_datagram(&g_chip, udp, kPeerIp, 40000, small, sizeof(small), 2000);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_udp_receive_from(udp, buffer, sizeof(buffer), 100, src_ip, &src_port, &received));
+    CHECK_EQ(sizeof(small), received);
+
+    // Bad sizes, and UDP calls on a TCP socket
+    static uint8_t jumbo[W5500_UDP_MAX_PAYLOAD + 1];
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_udp_send_to(udp, kPeerIp, 9000, jumbo, sizeof(jumbo)));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_udp_send_to(udp, kPeerIp, 9000, jumbo, 0));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&tcp));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(tcp, kPeerIp, 1883, 1000));
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_udp_send_to(tcp, kPeerIp, 9000, small, sizeof(small)));
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_udp_receive_from(tcp, buffer, sizeof(buffer), 0, src_ip, &src_port, &received));
+
+    // Port 0 takes the next source port; release closes it like a TCP socket
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(tcp));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(udp));
+    CHECK_EQ(0x00, g_chip.sockets[udp].regs[0x03]);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&udp));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_udp_open(udp, 0));
+    CHECK((g_chip.sockets[udp].regs[0x04] << 8 | g_chip.sockets[udp].regs[0x05]) >= 50000);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(udp));
+}
+
+int main()
+{
+    sim_w5500_init(&g_chip);
+    sim_w5500_set_link(&g_chip, true);
+    sim_w5500_attach_int(&g_chip, W5500_INT_LINE);
+    sim_spi_attach(&SPID2, &g_chip.dev);
+
+    RUN_TEST(test_init_brings_up_chip);
+    RUN_TEST(test_network_settings_applied_when_up);
+    RUN_TEST(test_connect_timeout_when_peer_refuses);
+    RUN_TEST(test_connect_latency);
+    RUN_TEST(test_send_throughput);
+    RUN_TEST(test_publish_spi_cost);
+    RUN_TEST(test_send_stream);
+    RUN_TEST(test_receive_latency);
+    RUN_TEST(test_idle_receive_spi_cost);
+    RUN_TEST(test_missed_int_edge_recovered_by_safety_poll);
+    RUN_TEST(test_receive_times_out_when_quiet);
+    RUN_TEST(test_disconnect);
+    RUN_TEST(test_sockets_run_concurrently);
+    RUN_TEST(test_buffer_split);
+    RUN_TEST(test_receive_exact);
+    RUN_TEST(test_receive_mqtt_frame);
+    RUN_TEST(test_rx_mirror);
+    RUN_TEST(test_spi_calibration);
+    RUN_TEST(test_udp_telemetry_and_discovery);
+    return TEST_RESULT();
+}
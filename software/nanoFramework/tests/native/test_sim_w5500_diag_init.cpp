@@ -0,0 +1,61 @@
+/**
+ * @file test_sim_w5500_diag_init.cpp
+ * @brief w5500_init() with the scope-assist diagnostic profile (one bring-up per process)
+ */
+
+#include "w5500_native.h"
+#include "board_cubley.h"
+#include "sim_devices.h"
+#include "test_check.h"
+
+extern volatile uint32_t g_cubley_diag_last_error;
+extern volatile uint32_t g_w5500_init_timing;
+
+static sim_w5500_t g_chip;
+
+static void test_diagnostic_profile_brings_up_chip()
+{
+    w5500_set_init_profile(W5500_INIT_DIAGNOSTIC);
+    CHECK_EQ(W5500_INIT_DIAGNOSTIC, w5500_get_init_profile());
+
+    sim_counters_t start = sim_counters();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_init());
+    sim_counters_t init = sim_counters_since(&start);
+    sim_counters_print("w5500_init (diagnostic profile)", &init);
+
+    // Same end state as the fast profile
+    uint8_t phycfgr = w5500_read_phycfgr();
+    CHECK_EQ(0xF0, phycfgr & 0xF8);
+    CHECK_EQ(0x07, phycfgr & 0x07);
+    CHECK_EQ(W5500_SPI_FASTEST_DIVIDER, w5500_get_spi_divider());
+    CHECK_EQ(PAL_HIGH, palReadLine(W5500_CS_LINE));
+
+    // Pulse train, scope bursts and fixed PHY delays dominate: over a second
+    uint32_t init_us = w5500_get_init_duration_us();
+    CHECK(init_us > 1000000);
+    CHECK_EQ(0xD7000000u | (init_us / 1000), g_w5500_init_timing);
+    CHECK_EQ(0xE14F0000u | (init_us / 10000), g_cubley_diag_last_error);
+}
+
+static void test_profile_change_after_bring_up_is_ignored()
+{
+    w5500_set_init_profile(W5500_INIT_FAST);
+
+    uint64_t t0 = sim_now_ns();
+    uint32_t timing = g_w5500_init_timing;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_init());
+    CHECK_EQ(t0, sim_now_ns());
+    CHECK_EQ(timing, g_w5500_init_timing);
+}
+
+int main()
+{
+    sim_w5500_init(&g_chip);
+    sim_w5500_set_link(&g_chip, true);
+    sim_w5500_attach_int(&g_chip, W5500_INT_LINE);
+    sim_spi_attach(&SPID2, &g_chip.dev);
+
+    RUN_TEST(test_diagnostic_profile_brings_up_chip);
+    RUN_TEST(test_profile_change_after_bring_up_is_ignored);
+    return TEST_RESULT();
+}
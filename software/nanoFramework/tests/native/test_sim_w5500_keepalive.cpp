@@ -0,0 +1,255 @@
+/**
+ * @file test_sim_w5500_keepalive.cpp
+ * @brief W5500 native MQTT keep-alive (PINGREQ injection, PINGRESP swallowing, dropping a silent connection) against the simulated chip
+ */
+
+#include "w5500_native.h"
+#include "board_cubley.h"
+#include "sim_devices.h"
+#include "test_check.h"
+
+#include <string.h>
+
+static sim_w5500_t g_chip;
+static const uint8_t kBrokerIp[4] = {192, 168, 1, 10};
+static const uint16_t kBrokerPort = 1883;
+// 1 s between an idle TX side and the PINGREQ, and 1 s for its PINGRESP
+static const uint16_t kKeepAliveSeconds = 2;
+
+static const uint8_t kPingReq[2] = {0xC0, 0x00};
+static const uint8_t kPingResp[2] = {0xD0, 0x00};
+static const uint8_t kPublish[9] = {0x30, 0x07, 0x00, 0x03, 'a', '/', 'b', 'h', 'i'};
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(sim_now_ns() / 1000000ULL);
+}
+
+static w5500_keepalive_stats_t stats_of(uint8_t socket)
+{
+    w5500_keepalive_stats_t stats;
+    w5500_keepalive_get_stats(socket, &stats);
+    return stats;
+}
+
+/**
+ * @brief Open a socket connected to the broker with nothing left in the peer capture
+ */
+static uint8_t connect_socket()
+{
+    uint8_t socket = 0xFF;
+    uint8_t drained[64];
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(socket, kBrokerIp, kBrokerPort, 100));
+    sim_w5500_peer_take(&g_chip, socket, drained, sizeof(drained));
+    return socket;
+}
+
+/**
+ * @brief Sleep until virtual time reaches at_ms
+ */
+static void sleep_until(uint32_t at_ms)
+{
+    uint32_t now = now_ms();
+    if (at_ms > now) {
+        chThdSleepMilliseconds(at_ms - now);
+    }
+}
+
+static void test_start_validates()
+{
+    uint8_t socket = 0xFF;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_init());
+
+    // Only sockets handed out by the pool, and only once connected
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_keepalive_start(0, 60));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_keepalive_start(socket, 60));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(socket, kBrokerIp, kBrokerPort, 100));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_keepalive_start(socket, 0));
+
+    // Sn_KPALVTR in 5 s units, rounded up and capped at 255
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, 60));
+    CHECK_EQ(12, g_chip.sockets[socket].regs[0x2F]);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, 3));
+    CHECK_EQ(1, g_chip.sockets[socket].regs[0x2F]);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, 65535));
+    CHECK_EQ(255, g_chip.sockets[socket].regs[0x2F]);
+
+    w5500_keepalive_stats_t stats;
+    CHECK(w5500_keepalive_get_stats(socket, &stats));
+    w5500_keepalive_stop(socket);
+    CHECK(!w5500_keepalive_get_stats(socket, &stats));
+    CHECK_EQ(0, g_chip.sockets[socket].regs[0x2F]);
+
+    // Disconnecting stops it too
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, 60));
+    w5500_socket_disconnect(socket);
+    CHECK(!w5500_keepalive_get_stats(socket, &stats));
+    CHECK_EQ(0, g_chip.sockets[socket].regs[0x2F]);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_pings_idle_connection()
+{
+    uint8_t socket = connect_socket();
+    uint8_t sent[16];
+    uint8_t buffer[16];
+    uint16_t length = 0;
+
+    const uint32_t start_ms = now_ms();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, kKeepAliveSeconds));
+
+    sleep_until(start_ms + 999);
+    CHECK_EQ(0, sim_w5500_peer_take(&g_chip, socket, sent, sizeof(sent)));
+    sleep_until(start_ms + 1002);
+    CHECK_EQ(2, sim_w5500_peer_take(&g_chip, socket, sent, sizeof(sent)));
+    CHECK(memcmp(sent, kPingReq, sizeof(kPingReq)) == 0);
+    CHECK_EQ(1, stats_of(socket).pingsSent);
+
+    // The PINGRESP never reaches the caller
+    sim_w5500_peer_send(&g_chip, socket, kPingResp, sizeof(kPingResp), 0);
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 100, &length));
+    CHECK_EQ(0, length);
+    CHECK_EQ(1, stats_of(socket).pingResponses);
+
+    // Answered pings keep the connection up, one per interval
+    sleep_until(start_ms + 2002);
+    CHECK_EQ(2, sim_w5500_peer_take(&g_chip, socket, sent, sizeof(sent)));
+    w5500_keepalive_stats_t stats = stats_of(socket);
+    CHECK_EQ(2, stats.pingsSent);
+    CHECK_EQ(0, stats.missed);
+    CHECK(w5500_socket_is_connected(socket));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_send_postpones_ping()
+{
+    uint8_t socket = connect_socket();
+    uint8_t sent[32];
+
+    const uint32_t start_ms = now_ms();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, kKeepAliveSeconds));
+
+    sleep_until(start_ms + 600);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(socket, kPublish, sizeof(kPublish)));
+    sleep_until(start_ms + 1100);
+    CHECK_EQ(0, stats_of(socket).pingsSent);
+    CHECK_EQ(sizeof(kPublish), sim_w5500_peer_take(&g_chip, socket, sent, sizeof(sent)));
+
+    // A pipelined streamed send counts too; the ping collects its SENDOK
+    uint32_t streamed = 0;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send_stream(socket, kPublish, sizeof(kPublish), W5500_SEND_NO_WAIT, 100, &streamed));
+    const uint32_t last_tx_ms = now_ms();
+    sleep_until(last_tx_ms + 999);
+    CHECK_EQ(0, stats_of(socket).pingsSent);
+    sleep_until(last_tx_ms + 1002);
+    CHECK_EQ(1, stats_of(socket).pingsSent);
+    CHECK_EQ(sizeof(kPublish) + sizeof(kPingReq), sim_w5500_peer_take(&g_chip, socket, sent, sizeof(sent)));
+    CHECK(memcmp(sent + sizeof(kPublish), kPingReq, sizeof(kPingReq)) == 0);
+    CHECK_EQ(0, g_chip.sockets[socket].send_overlaps);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_blocked_receive_swallows_pingresp()
+{
+    uint8_t socket = connect_socket();
+    uint8_t buffer[16];
+    uint16_t length = 0;
+
+    // Broker answers the ping at 1.1 s and publishes at 1.2 s, while this
+    // thread sits in one receive the whole time
+    const uint32_t start_ms = now_ms();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, kKeepAliveSeconds));
+    sim_w5500_peer_send(&g_chip, socket, kPingResp, sizeof(kPingResp), 1100000);
+    sim_w5500_peer_send(&g_chip, socket, kPublish, sizeof(kPublish), 1200000);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 3000, &length));
+    uint32_t elapsed_ms = now_ms() - start_ms;
+    w5500_keepalive_stats_t stats = stats_of(socket);
+    printf("  receive blocked %u ms: %u PINGREQ sent, %u PINGRESP swallowed\n", (unsigned)elapsed_ms,
+           (unsigned)stats.pingsSent, (unsigned)stats.pingResponses);
+    // Type byte and body (the remaining-length byte is dropped)
+    CHECK_EQ(sizeof(kPublish) - 1, length);
+    CHECK_EQ(kPublish[0], buffer[0]);
+    CHECK(memcmp(buffer + 1, kPublish + 2, sizeof(kPublish) - 2) == 0);
+    CHECK(elapsed_ms >= 1200 && elapsed_ms <= 1210);
+    CHECK_EQ(1, stats.pingsSent);
+    CHECK_EQ(1, stats.pingResponses);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_missed_pingresp_disconnects()
+{
+    uint8_t socket = connect_socket();
+    uint8_t buffer[16];
+    uint16_t length = 0;
+
+    // The reader is blocked in a long frame read when the ping goes unanswered
+    const uint32_t start_ms = now_ms();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, kKeepAliveSeconds));
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 10000, &length));
+    uint32_t dropped_ms = now_ms() - start_ms;
+
+    w5500_keepalive_stats_t stats;
+    CHECK(!w5500_keepalive_get_stats(socket, &stats));
+    printf("  unanswered ping: connection dropped, blocked read back after %u ms\n", (unsigned)dropped_ms);
+    CHECK_EQ(1, stats.pingsSent);
+    CHECK_EQ(1, stats.missed);
+    CHECK(dropped_ms >= 2000 && dropped_ms <= 2002);
+    CHECK(!w5500_socket_is_connected(socket));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_missed_pingresp_on_supervised_socket()
+{
+    static const w5500_reconnect_policy_t kPolicy = {1000, 50, 200};
+    uint8_t socket = 0xFF;
+    uint8_t buffer[16];
+    uint16_t length = 0;
+    w5500_reconnect_status_t status;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, &kPolicy));
+    chThdSleepMilliseconds(50);
+    CHECK(w5500_socket_is_connected(socket));
+
+    // The drop ends the blocked read; the reconnect that follows is not read on
+    const uint32_t start_ms = now_ms();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_keepalive_start(socket, kKeepAliveSeconds));
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 10000, &length));
+    uint32_t dropped_ms = now_ms() - start_ms;
+    CHECK(dropped_ms >= 2000 && dropped_ms <= 2002);
+
+    chThdSleepMilliseconds(kPolicy.maxBackoffMs + 50);
+    w5500_reconnect_get_status(socket, &status);
+    printf("  unanswered ping on a supervised socket: read back after %u ms, %u connects\n",
+           (unsigned)dropped_ms, (unsigned)status.connects);
+    CHECK_EQ(W5500_CONN_ESTABLISHED, status.state);
+    CHECK_EQ(2, status.connects);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+int main()
+{
+    sim_w5500_init(&g_chip);
+    sim_w5500_set_link(&g_chip, true);
+    sim_w5500_attach_int(&g_chip, W5500_INT_LINE);
+    sim_spi_attach(&SPID2, &g_chip.dev);
+
+    RUN_TEST(test_start_validates);
+    RUN_TEST(test_pings_idle_connection);
+    RUN_TEST(test_send_postpones_ping);
+    RUN_TEST(test_blocked_receive_swallows_pingresp);
+    RUN_TEST(test_missed_pingresp_disconnects);
+    RUN_TEST(test_missed_pingresp_on_supervised_socket);
+    return TEST_RESULT();
+}
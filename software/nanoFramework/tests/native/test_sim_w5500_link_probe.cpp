@@ -0,0 +1,356 @@
+/**
+ * @file test_sim_w5500_link_probe.cpp
+ * @brief W5500 link probe (socket 0 MACRAW ARP / ICMP echo) against the simulated chip
+ *
+ * Also a replay harness for recorded traffic: given a capture file, every
+ * frame is fed into socket 0's RX buffer at its recorded time offset and the
+ * replies the driver sends are written to a second capture:
+ *
+ *   test_sim_w5500_link_probe ping.pcap [replies.pcap]
+ */
+
+#include "w5500_native.h"
+#include "w5500_link_responder.h"
+#include "board_cubley.h"
+#include "sim_devices.h"
+#include "sim_pcap.h"
+#include "link_frames.h"
+#include "test_check.h"
+
+#include <string.h>
+
+static sim_w5500_t g_chip;
+
+static const uint8_t kOurMac[6] = {0x02, 0x08, 0xDC, 0x00, 0x00, 0x01};
+static const uint8_t kOurIp[4] = {192, 168, 1, 123};
+static const uint8_t kHostMac[6] = {0x3C, 0x52, 0x82, 0x11, 0x22, 0x33};
+static const uint8_t kHostIp[4] = {192, 168, 1, 10};
+static const uint8_t kOtherIp[4] = {192, 168, 1, 124};
+
+/* Capture loaded into memory before the replay starts */
+typedef struct {
+    uint64_t t_us;
+    uint16_t length;
+    uint8_t data[LINK_RESPONDER_MAX_FRAME_BYTES];
+} capture_frame_t;
+
+static capture_frame_t g_capture[256];
+static size_t g_capture_count;
+static uint32_t g_capture_skipped;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t replies;
+    uint64_t total_us;              // Arrival in the RX buffer -> reply SEND
+    uint64_t max_us;
+} replay_result_t;
+
+static void collect_frame(void *ctx, uint64_t t_us, const uint8_t *frame, uint32_t length)
+{
+    (void)ctx;
+    if (length > LINK_RESPONDER_MAX_FRAME_BYTES || g_capture_count >= sizeof(g_capture) / sizeof(g_capture[0])) {
+        g_capture_skipped++;
+        return;
+    }
+    g_capture[g_capture_count].t_us = t_us;
+    g_capture[g_capture_count].length = (uint16_t)length;
+    memcpy(g_capture[g_capture_count].data, frame, length);
+    g_capture_count++;
+}
+
+/**
+ * @brief Replay a capture through socket 0, keeping the recorded spacing
+ * @return false when the capture cannot be read
+ */
+static bool replay(const char *path, const char *replies_path, replay_result_t *result)
+{
+    static uint8_t sent[SIM_W5500_MAX_BUF_SIZE];
+    sim_w5500_socket_t *sock = &g_chip.sockets[0];
+    sim_pcap_writer_t writer = {NULL, 0};
+
+    memset(result, 0, sizeof(*result));
+    g_capture_count = 0;
+    g_capture_skipped = 0;
+    if (sim_pcap_read(path, collect_frame, NULL) < 0) {
+        return false;
+    }
+    if (replies_path != NULL && !sim_pcap_open(&writer, replies_path)) {
+        return false;
+    }
+
+    uint64_t base_us = sim_now_ns() / 1000;
+    for (size_t i = 0; i < g_capture_count; i++) {
+        const capture_frame_t *frame = &g_capture[i];
+        uint64_t due_us = base_us + (frame->t_us - g_capture[0].t_us);
+        uint64_t now_us = sim_now_ns() / 1000;
+        uint32_t delay_us = due_us > now_us ? (uint32_t)(due_us - now_us) : 0;
+        uint32_t sends = sock->datagrams_sent;
+        uint64_t arrival_ns = sim_now_ns() + (uint64_t)delay_us * 1000ULL;
+
+        sim_w5500_peer_send_frame(&g_chip, frame->data, frame->length, delay_us);
+        uint16_t handled = 0;
+        w5500_link_probe_service((int32_t)(delay_us / 1000 + 100), &handled);
+        result->frames++;
+
+        if (sock->datagrams_sent == sends) {
+            continue;
+        }
+
+        uint64_t latency_us = (sock->last_send_ns - arrival_ns) / 1000;
+        result->replies++;
+        result->total_us += latency_us;
+        if (latency_us > result->max_us) {
+            result->max_us = latency_us;
+        }
+
+        uint32_t length = sim_w5500_peer_take(&g_chip, 0, sent, sizeof(sent));
+        sim_pcap_write(&writer, frame->t_us + latency_us, sent, length);
+    }
+
+    sim_pcap_close(&writer);
+    return true;
+}
+
+static void print_replay(const char *label, const replay_result_t *result)
+{
+    printf("  %s: %u frames, %u replies, reply latency avg %llu us / max %llu us\n", label,
+           (unsigned)result->frames, (unsigned)result->replies,
+           (unsigned long long)(result->replies != 0 ? result->total_us / result->replies : 0),
+           (unsigned long long)result->max_us);
+}
+
+static void test_enable_claims_socket_zero()
+{
+    uint8_t socket = 0xFF;
+    uint8_t rx_kb[W5500_SOCKET_COUNT];
+    uint8_t tx_kb[W5500_SOCKET_COUNT];
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_init());
+
+    // Socket 0 handed out by the pool first
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(0, socket);
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_link_probe_enable(true));
+    CHECK(!w5500_link_probe_is_enabled());
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_link_probe_enable(true));
+    CHECK(w5500_link_probe_is_enabled());
+    CHECK_EQ(0x84, g_chip.sockets[0].regs[0x00]);       // MACRAW, MAC filter
+    CHECK_EQ(0x42, g_chip.sockets[0].regs[0x03]);
+    CHECK_EQ(0x10, g_chip.common[0x00] & 0x10);         // Chip ping reply blocked
+
+    // The pool skips socket 0 and the buffer split is locked
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(1, socket);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+    CHECK(!w5500_socket_is_open(0));
+    w5500_get_buffer_sizes(rx_kb, tx_kb);
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_set_buffer_sizes(rx_kb, tx_kb));
+
+    // Idempotent
+    CHECK_EQ(W5500_SOCKET_OK, w5500_link_probe_enable(true));
+}
+
+static void test_capture_replay()
+{
+    static const uint8_t kBroadcastMac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    static const char kCapture[] = "link_probe_capture.pcap";
+    static const char kReplies[] = "link_probe_replies.pcap";
+    static uint8_t frame[LINK_RESPONDER_MAX_FRAME_BYTES];
+    sim_pcap_writer_t writer;
+    uint64_t t_us = 1700000000ULL * 1000000ULL;
+
+    // What a host running "ping -c 5" after an ARP lookup puts on the wire,
+    // plus traffic the probe must leave alone
+    CHECK(sim_pcap_open(&writer, kCapture));
+    sim_pcap_write(&writer, t_us, frame, link_frames_arp_request(frame, kHostMac, kHostIp, kOurIp));
+    for (uint16_t seq = 1; seq <= 5; seq++) {
+        t_us += 1000000;
+        sim_pcap_write(&writer, t_us, frame,
+                       link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 0x4242, seq, 56));
+    }
+    t_us += 200000;
+    sim_pcap_write(&writer, t_us, frame, link_frames_arp_request(frame, kHostMac, kHostIp, kOtherIp));
+    t_us += 200000;
+    sim_pcap_write(&writer, t_us, frame,
+                   link_frames_echo_request(frame, kBroadcastMac, kHostMac, kHostIp, kOurIp, 0x4242, 6, 56));
+    t_us += 200000;
+    sim_pcap_write(&writer, t_us, frame,
+                   link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 0x4242, 7, 1400));
+    sim_pcap_close(&writer);
+    CHECK_EQ(9, writer.frames);
+
+    replay_result_t result;
+    CHECK(replay(kCapture, kReplies, &result));
+    print_replay("replay ping -c 5 (56 B) + 1400 B echo", &result);
+    CHECK_EQ(9, result.frames);
+    CHECK_EQ(7, result.replies);
+
+    // The 1400 B echo dominates: ~2.9 KB in and out over 21 MHz SPI
+    CHECK(result.max_us < 1500);
+
+    w5500_link_probe_stats_t stats;
+    w5500_link_probe_get_stats(&stats);
+    CHECK_EQ(9, stats.frames);
+    CHECK_EQ(1, stats.arpReplies);
+    CHECK_EQ(6, stats.echoReplies);
+    CHECK_EQ(0, stats.dropped);
+    CHECK(stats.lastEchoUs >= stats.maxEchoUs / 2);
+    CHECK(stats.maxEchoUs < 1500);
+
+    // The replies capture reads back: ARP reply first, then echo replies to the host
+    g_capture_count = 0;
+    CHECK_EQ(7, sim_pcap_read(kReplies, collect_frame, NULL));
+    CHECK_EQ(LINK_RESPONDER_MIN_FRAME_BYTES, g_capture[0].length);
+    CHECK_EQ(2, g_capture[0].data[21]);
+    for (size_t i = 1; i < g_capture_count; i++) {
+        CHECK(memcmp(&g_capture[i].data[0], kHostMac, 6) == 0);
+        CHECK_EQ(0, g_capture[i].data[34]);
+    }
+    CHECK_EQ(98, g_capture[1].length);
+    CHECK_EQ(1442, g_capture[6].length);
+}
+
+static void test_big_endian_nanosecond_capture()
+{
+    // Header and one record as written by a big-endian host with ns timestamps
+    static const uint8_t kHeader[] = {
+        0xA1, 0xB2, 0x3C, 0x4D, 0x00, 0x02, 0x00, 0x04, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x01,
+    };
+    static const uint8_t kRecord[] = {
+        0x00, 0x00, 0x00, 0x02, 0x1D, 0xCD, 0x65, 0x00, 0x00, 0x00, 0x00, 42, 0x00, 0x00, 0x00, 42,
+    };
+    uint8_t frame[42];
+
+    FILE *file = fopen("link_probe_be_ns.pcap", "wb");
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+    fwrite(kHeader, 1, sizeof(kHeader), file);
+    fwrite(kRecord, 1, sizeof(kRecord), file);
+    fwrite(frame, 1, link_frames_arp_request(frame, kHostMac, kHostIp, kOurIp), file);
+    fclose(file);
+
+    g_capture_count = 0;
+    CHECK_EQ(1, sim_pcap_read("link_probe_be_ns.pcap", collect_frame, NULL));
+    CHECK_EQ(2500000ULL, g_capture[0].t_us);           // 2 s + 500 000 000 ns
+    CHECK_EQ(42, g_capture[0].length);
+    CHECK_EQ(-1, sim_pcap_read("link_probe_missing.pcap", collect_frame, NULL));
+}
+
+static void test_answered_while_another_socket_waits()
+{
+    static uint8_t frame[LINK_RESPONDER_MAX_FRAME_BYTES];
+    sim_w5500_socket_t *probe = &g_chip.sockets[0];
+    uint8_t buffer[16];
+    uint16_t received = 0;
+    uint8_t mqtt = 0xFF;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&mqtt));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(mqtt, kHostIp, 1883, 1000));
+
+    // An MQTT client blocked in a receive keeps answering pings, in both I/O modes
+    static const w5500_io_mode_t kModes[] = {W5500_IO_INTERRUPT, W5500_IO_POLLED};
+    for (size_t m = 0; m < 2; m++) {
+        w5500_set_io_mode(kModes[m]);
+        w5500_link_probe_stats_t before;
+        w5500_link_probe_get_stats(&before);
+
+        uint16_t length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 0x77, (uint16_t)m, 56);
+        uint64_t arrival_ns = sim_now_ns() + 10000000ULL;
+        uint32_t sends = probe->datagrams_sent;
+        sim_w5500_peer_send_frame(&g_chip, frame, length, 10000);
+
+        uint64_t t0 = sim_now_ns();
+        CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive(mqtt, buffer, sizeof(buffer), 50, &received));
+        CHECK((sim_now_ns() - t0) / 1000 >= 50000 - 100);
+        CHECK_EQ(sends + 1, probe->datagrams_sent);
+
+        uint64_t latency_us = (probe->last_send_ns - arrival_ns) / 1000;
+        printf("  echo answered from an MQTT receive wait (%s): %llu us\n",
+               kModes[m] == W5500_IO_INTERRUPT ? "interrupt" : "polled", (unsigned long long)latency_us);
+        CHECK(latency_us < (kModes[m] == W5500_IO_INTERRUPT ? 500u : 1500u));
+
+        w5500_link_probe_stats_t after;
+        w5500_link_probe_get_stats(&after);
+        CHECK_EQ(before.echoReplies + 1, after.echoReplies);
+        CHECK_EQ(98, sim_w5500_peer_take(&g_chip, 0, frame, sizeof(frame)));
+    }
+    w5500_set_io_mode(W5500_IO_INTERRUPT);
+
+    // The probe's own socket never sees the MQTT traffic
+    sim_w5500_peer_send(&g_chip, mqtt, (const uint8_t *)"\xD0\x00", 2, 100);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive(mqtt, buffer, sizeof(buffer), 50, &received));
+    CHECK_EQ(2, received);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(mqtt));
+}
+
+static void test_service_times_out_when_quiet()
+{
+    uint16_t handled = 0xFFFF;
+
+    uint64_t t0 = sim_now_ns();
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_link_probe_service(20, &handled));
+    CHECK_EQ(0, handled);
+    CHECK((sim_now_ns() - t0) / 1000 >= 20000 - 100);
+}
+
+static void test_disable_returns_socket_zero()
+{
+    uint8_t socket = 0xFF;
+    uint16_t handled = 0xFFFF;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_link_probe_enable(false));
+    CHECK(!w5500_link_probe_is_enabled());
+    CHECK_EQ(0x00, g_chip.sockets[0].regs[0x03]);
+    CHECK_EQ(0x00, g_chip.common[0x00] & 0x10);
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_link_probe_service(0, &handled));
+    CHECK_EQ(0, handled);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(0, socket);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static int replay_file(const char *capture, const char *replies)
+{
+    replay_result_t result;
+
+    if (w5500_init() != W5500_SOCKET_OK || w5500_link_probe_enable(true) != W5500_SOCKET_OK) {
+        fprintf(stderr, "W5500 model did not come up\n");
+        return 1;
+    }
+    if (!replay(capture, replies, &result)) {
+        fprintf(stderr, "%s: not an Ethernet pcap capture\n", capture);
+        return 1;
+    }
+    print_replay(capture, &result);
+    if (g_capture_skipped != 0) {
+        printf("  %u frames over %u bytes or past %u frames skipped\n", (unsigned)g_capture_skipped,
+               (unsigned)LINK_RESPONDER_MAX_FRAME_BYTES, (unsigned)(sizeof(g_capture) / sizeof(g_capture[0])));
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    sim_w5500_init(&g_chip);
+    sim_w5500_set_link(&g_chip, true);
+    sim_w5500_attach_int(&g_chip, W5500_INT_LINE);
+    sim_spi_attach(&SPID2, &g_chip.dev);
+
+    if (argc > 1) {
+        return replay_file(argv[1], argc > 2 ? argv[2] : NULL);
+    }
+
+    RUN_TEST(test_enable_claims_socket_zero);
+    RUN_TEST(test_capture_replay);
+    RUN_TEST(test_big_endian_nanosecond_capture);
+    RUN_TEST(test_answered_while_another_socket_waits);
+    RUN_TEST(test_service_times_out_when_quiet);
+    RUN_TEST(test_disable_returns_socket_zero);
+    return TEST_RESULT();
+}
@@ -0,0 +1,315 @@
+/**
+ * @file test_sim_w5500_reconnect.cpp
+ * @brief W5500 native reconnect thread (backoff, broker restart) against the simulated chip
+ */
+
+#include "w5500_native.h"
+#include "board_cubley.h"
+#include "sim_devices.h"
+#include "test_check.h"
+
+#include <string.h>
+
+static sim_w5500_t g_chip;
+static const uint8_t kBrokerIp[4] = {192, 168, 1, 10};
+static const uint16_t kBrokerPort = 1883;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(sim_now_ns() / 1000000ULL);
+}
+
+static w5500_reconnect_status_t status_of(uint8_t socket)
+{
+    w5500_reconnect_status_t status;
+    w5500_reconnect_get_status(socket, &status);
+    return status;
+}
+
+/**
+ * @brief Wait on the reconnect event source (as the interop event thread does) for a state
+ */
+static bool wait_state(uint8_t socket, w5500_conn_state_t state, uint32_t timeout_ms)
+{
+    event_listener_t listener;
+    const systime_t start = chVTGetSystemTimeX();
+    bool reached = false;
+
+    chEvtRegisterMaskWithFlags(w5500_reconnect_get_event_source(), &listener, EVENT_MASK(0), 1U << socket);
+    while (true) {
+        chEvtGetAndClearFlags(&listener);
+        if (status_of(socket).state == state) {
+            reached = true;
+            break;
+        }
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= TIME_MS2I(timeout_ms)) {
+            break;
+        }
+        chEvtWaitAnyTimeout(EVENT_MASK(0), TIME_MS2I(timeout_ms) - elapsed);
+    }
+    chEvtUnregister(w5500_reconnect_get_event_source(), &listener);
+    return reached;
+}
+
+static void set_listening(void *arg)
+{
+    g_chip.sockets[(uintptr_t)arg].peer_listening = true;
+}
+
+static void test_start_validates()
+{
+    static const w5500_reconnect_policy_t kInverted = {1000, 500, 100};
+    static const w5500_reconnect_policy_t kNoTimeout = {0, 100, 1000};
+    uint8_t socket = 0xFF;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_init());
+
+    // Only sockets handed out by the pool
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_reconnect_start(0, kBrokerIp, kBrokerPort, NULL));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_reconnect_stop(0));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_reconnect_start(socket, kBrokerIp, 0, NULL));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, &kInverted));
+    CHECK_EQ(W5500_SOCKET_INVALID_PARAM, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, &kNoTimeout));
+    CHECK_EQ(W5500_CONN_CLOSED, status_of(socket).state);
+
+    // Supervised sockets are not reopened behind the thread's back
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, NULL));
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, NULL));
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_connect(socket, kBrokerIp, kBrokerPort, 100));
+    CHECK_EQ(W5500_SOCKET_BUSY, w5500_udp_open(socket, 0));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+    CHECK_EQ(W5500_CONN_CLOSED, status_of(socket).state);
+}
+
+static void test_connects_in_background()
+{
+    uint8_t socket = 0xFF;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+
+    uint32_t start_ms = now_ms();
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, NULL));
+    CHECK(wait_state(socket, W5500_CONN_ESTABLISHED, 100));
+    uint32_t elapsed_ms = now_ms() - start_ms;
+
+    w5500_reconnect_status_t status = status_of(socket);
+    CHECK_EQ(1, status.attempts);
+    CHECK_EQ(1, status.connects);
+    CHECK(w5500_socket_is_connected(socket));
+    CHECK_EQ(0x17, g_chip.sockets[socket].regs[0x03]);
+
+    // 500 us handshake seen by the first Sn_SR poll
+    printf("  background connect: %u ms (handshake %u us, seen after %u us)\n", (unsigned)elapsed_ms,
+           (unsigned)g_chip.timing.connect_rtt_us, (unsigned)status.lastConnectUs);
+    CHECK(status.lastConnectUs >= g_chip.timing.connect_rtt_us);
+    CHECK(status.lastConnectUs <= W5500_RECONNECT_CONNECT_POLL_MS * 1000 + 100);
+
+    // The connection is usable from this thread while the other one supervises it
+    static const uint8_t kPing[2] = {0xC0, 0x00};
+    CHECK_EQ(W5500_SOCKET_OK, w5500_send(socket, kPing, sizeof(kPing)));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_stop(socket));
+    CHECK_EQ(W5500_CONN_CLOSED, status_of(socket).state);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_backoff_doubles_with_jitter()
+{
+    static const w5500_reconnect_policy_t kPolicy = {1000, 100, 800};
+    static const uint32_t kCeilings[] = {100, 200, 400, 800, 800, 800};
+    const size_t kRounds = sizeof(kCeilings) / sizeof(kCeilings[0]);
+    uint32_t backoffs[sizeof(kCeilings) / sizeof(kCeilings[0])];
+    uint32_t last_attempt_ms = 0;
+    size_t count = 0;
+    uint8_t socket = 0xFF;
+    event_listener_t listener;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    g_chip.sockets[socket].peer_listening = false;
+
+    chEvtRegisterMaskWithFlags(w5500_reconnect_get_event_source(), &listener, EVENT_MASK(0), 1U << socket);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, &kPolicy));
+
+    uint32_t seen_attempts = 0;
+    while (count < kRounds) {
+        if (chEvtWaitAnyTimeout(EVENT_MASK(0), TIME_MS2I(2000)) == 0) {
+            break;
+        }
+        chEvtGetAndClearFlags(&listener);
+
+        w5500_reconnect_status_t status = status_of(socket);
+        if (status.state == W5500_CONN_SYNSENT && status.attempts != seen_attempts) {
+            // Gap between SYNs: the backoff plus the poll that saw the refusal
+            if (seen_attempts != 0) {
+                uint32_t gap_ms = now_ms() - last_attempt_ms;
+                CHECK(gap_ms >= backoffs[count - 1]);
+                CHECK(gap_ms <= backoffs[count - 1] + W5500_RECONNECT_CONNECT_POLL_MS + 1);
+            }
+            seen_attempts = status.attempts;
+            last_attempt_ms = now_ms();
+        } else if (status.state == W5500_CONN_BACKOFF && count < seen_attempts) {
+            backoffs[count++] = status.backoffMs;
+        }
+    }
+    chEvtUnregister(w5500_reconnect_get_event_source(), &listener);
+
+    CHECK_EQ(kRounds, count);
+    bool all_same = true;
+    for (size_t i = 0; i < count; i++) {
+        printf("  attempt %u refused, backoff %u ms (ceiling %u)\n", (unsigned)(i + 1), (unsigned)backoffs[i],
+               (unsigned)kCeilings[i]);
+        CHECK(backoffs[i] >= kCeilings[i] / 2);
+        CHECK(backoffs[i] <= kCeilings[i]);
+        all_same = all_same && backoffs[i] == backoffs[0];
+    }
+    CHECK(!all_same);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+    g_chip.sockets[socket].peer_listening = true;
+}
+
+static void test_broker_restart()
+{
+    static const w5500_reconnect_policy_t kPolicy = {3000, 250, 2000};
+    static const uint32_t kOutageMs = 3000;
+    uint8_t socket = 0xFF;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, &kPolicy));
+    CHECK(wait_state(socket, W5500_CONN_ESTABLISHED, 100));
+
+    // Broker goes away: FIN on the open connection, SYNs refused until it is back
+    uint32_t down_ms = now_ms();
+    g_chip.sockets[socket].peer_listening = false;
+    sim_w5500_peer_close(&g_chip, socket, 0);
+    sim_schedule_ns((uint64_t)kOutageMs * 1000000ULL, set_listening, (void *)(uintptr_t)socket);
+
+    CHECK(wait_state(socket, W5500_CONN_BACKOFF, W5500_RECONNECT_SUPERVISE_POLL_MS + 10));
+    uint32_t detect_ms = now_ms() - down_ms;
+
+    // A receive on the dropped connection sees it closed
+    uint8_t buffer[16];
+    uint16_t received = 0;
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_receive(socket, buffer, sizeof(buffer), 1000, &received));
+    CHECK(wait_state(socket, W5500_CONN_ESTABLISHED, kOutageMs + kPolicy.maxBackoffMs + 100));
+    uint32_t back_ms = now_ms() - down_ms;
+
+    w5500_reconnect_status_t status = status_of(socket);
+    printf("  broker restart (%u ms outage): drop seen after %u ms, reconnected after %u ms, %u attempts\n",
+           (unsigned)kOutageMs, (unsigned)detect_ms, (unsigned)back_ms, (unsigned)status.attempts);
+    CHECK_EQ(2, status.connects);
+    CHECK(back_ms >= kOutageMs);
+    // The last backoff before the broker returned is at most the cap
+    CHECK(back_ms <= kOutageMs + kPolicy.maxBackoffMs + W5500_RECONNECT_CONNECT_POLL_MS + 1);
+    CHECK(w5500_socket_is_connected(socket));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_reader_blocked_across_broker_restart()
+{
+    static const w5500_reconnect_policy_t kPolicy = {3000, 50, 200};
+    static const uint8_t kPublish[9] = {0x30, 0x07, 0x00, 0x03, 'a', '/', 'b', 'h', 'i'};
+    uint8_t socket = 0xFF;
+    uint8_t buffer[16];
+    uint16_t length = 0;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, &kPolicy));
+    CHECK(wait_state(socket, W5500_CONN_ESTABLISHED, 100));
+
+    // Broker publishes, then restarts (FIN at 100 ms, listening again at once)
+    // while the reader sits in one long frame read
+    const uint32_t start_ms = now_ms();
+    sim_w5500_peer_send(&g_chip, socket, kPublish, sizeof(kPublish), 50000);
+    sim_w5500_peer_close(&g_chip, socket, 100000);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 3000, &length));
+    CHECK_EQ(sizeof(kPublish) - 1, length);
+    CHECK_EQ(W5500_SOCKET_NOT_INITIALIZED, w5500_receive_mqtt_frame(socket, buffer, sizeof(buffer), 3000, &length));
+    uint32_t ended_ms = now_ms() - start_ms;
+    CHECK_EQ(0, length);
+
+    // The connection that comes back is a new session, not the one being read
+    CHECK(wait_state(socket, W5500_CONN_ESTABLISHED, kPolicy.maxBackoffMs + 100));
+    uint32_t back_ms = now_ms() - start_ms;
+    printf("  reader across broker restart: stream end seen after %u ms, new session after %u ms\n",
+           (unsigned)ended_ms, (unsigned)back_ms);
+    CHECK(ended_ms >= 100 && ended_ms <= 102);
+    CHECK_EQ(2, status_of(socket).connects);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+static void test_blocked_receive_does_not_stall_reconnect()
+{
+    static const w5500_reconnect_policy_t kPolicy = {3000, 50, 200};
+    uint8_t idle = 0xFF;
+    uint8_t supervised = 0xFF;
+
+    // A socket call waiting for data on another connection...
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&idle));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(idle, kBrokerIp, 8883, 100));
+
+    // ...while the supervised socket keeps retrying until its peer appears at 1 s
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&supervised));
+    g_chip.sockets[supervised].peer_listening = false;
+    sim_schedule_ns(1000ULL * 1000000ULL, set_listening, (void *)(uintptr_t)supervised);
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(supervised, kBrokerIp, kBrokerPort, &kPolicy));
+
+    uint8_t buffer[16];
+    uint16_t received = 0;
+    CHECK_EQ(W5500_SOCKET_TIMEOUT, w5500_receive(idle, buffer, sizeof(buffer), 1500, &received));
+
+    w5500_reconnect_status_t status = status_of(supervised);
+    CHECK_EQ(W5500_CONN_ESTABLISHED, status.state);
+    CHECK(status.attempts >= 5);
+    CHECK_EQ(1, status.connects);
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(supervised));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(idle));
+}
+
+static void test_stop_leaves_socket_idle()
+{
+    static const w5500_reconnect_policy_t kPolicy = {1000, 100, 100};
+    uint8_t socket = 0xFF;
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_open(&socket));
+    g_chip.sockets[socket].peer_listening = false;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_start(socket, kBrokerIp, kBrokerPort, &kPolicy));
+    CHECK(wait_state(socket, W5500_CONN_BACKOFF, 100));
+
+    CHECK_EQ(W5500_SOCKET_OK, w5500_reconnect_stop(socket));
+    uint32_t attempts = status_of(socket).attempts;
+    chThdSleepMilliseconds(1000);
+    CHECK_EQ(W5500_CONN_CLOSED, status_of(socket).state);
+    CHECK_EQ(attempts, status_of(socket).attempts);
+    CHECK_EQ(0x00, g_chip.sockets[socket].regs[0x03]);
+    CHECK(w5500_socket_is_open(socket));
+
+    // The socket can be driven directly again
+    g_chip.sockets[socket].peer_listening = true;
+    CHECK_EQ(W5500_SOCKET_OK, w5500_connect(socket, kBrokerIp, kBrokerPort, 100));
+    CHECK_EQ(W5500_SOCKET_OK, w5500_socket_release(socket));
+}
+
+int main()
+{
+    sim_w5500_init(&g_chip);
+    sim_w5500_set_link(&g_chip, true);
+    sim_w5500_attach_int(&g_chip, W5500_INT_LINE);
+    sim_spi_attach(&SPID2, &g_chip.dev);
+
+    RUN_TEST(test_start_validates);
+    RUN_TEST(test_connects_in_background);
+    RUN_TEST(test_backoff_doubles_with_jitter);
+    RUN_TEST(test_broker_restart);
+    RUN_TEST(test_reader_blocked_across_broker_restart);
+    RUN_TEST(test_blocked_receive_does_not_stall_reconnect);
+    RUN_TEST(test_stop_leaves_socket_idle);
+    return TEST_RESULT();
+}
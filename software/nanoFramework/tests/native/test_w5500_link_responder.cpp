@@ -0,0 +1,174 @@
+/**
+ * @file test_w5500_link_responder.cpp
+ * @brief Host tests for the MACRAW ARP / ICMP echo responder
+ */
+
+#include "w5500_link_responder.h"
+#include "link_frames.h"
+#include "test_check.h"
+
+#include <string.h>
+
+static const uint8_t kOurMac[6] = {0x02, 0x08, 0xDC, 0x00, 0x00, 0x01};
+static const uint8_t kOurIp[4] = {192, 168, 1, 123};
+static const uint8_t kHostMac[6] = {0x3C, 0x52, 0x82, 0x11, 0x22, 0x33};
+static const uint8_t kHostIp[4] = {192, 168, 1, 10};
+static const uint8_t kOtherIp[4] = {192, 168, 1, 124};
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static link_responder_kind_t reply(uint8_t *frame, uint16_t length, uint16_t *out_length)
+{
+    return link_responder_reply(frame, length, LINK_RESPONDER_MAX_FRAME_BYTES, kOurMac, kOurIp, out_length);
+}
+
+static void test_checksum_matches_rfc1071_example()
+{
+    // RFC 1071 section 3: the words sum to 0xDDF2 before complementing
+    static const uint8_t data[] = {0x00, 0x01, 0xF2, 0x03, 0xF4, 0xF5, 0xF6, 0xF7};
+    CHECK_EQ(0xFFFF & ~0xDDF2, link_responder_checksum(data, sizeof(data)));
+
+    // Odd length: the last byte is the high half of a zero-padded word
+    static const uint8_t odd[] = {0x12, 0x34, 0x56};
+    CHECK_EQ(0xFFFF & ~(0x1234 + 0x5600), link_responder_checksum(odd, sizeof(odd)));
+}
+
+static void test_arp_request_for_us_becomes_reply()
+{
+    uint8_t frame[LINK_RESPONDER_MAX_FRAME_BYTES];
+    uint16_t length = link_frames_arp_request(frame, kHostMac, kHostIp, kOurIp);
+    uint16_t reply_length = 0;
+
+    CHECK_EQ(LINK_RESPONDER_ARP_REPLY, reply(frame, length, &reply_length));
+    CHECK_EQ(LINK_RESPONDER_MIN_FRAME_BYTES, reply_length);
+
+    CHECK(memcmp(&frame[0], kHostMac, 6) == 0);
+    CHECK(memcmp(&frame[6], kOurMac, 6) == 0);
+    CHECK_EQ(0x0806, get16(&frame[12]));
+    CHECK_EQ(2, get16(&frame[20]));
+    CHECK(memcmp(&frame[22], kOurMac, 6) == 0);
+    CHECK(memcmp(&frame[28], kOurIp, 4) == 0);
+    CHECK(memcmp(&frame[32], kHostMac, 6) == 0);
+    CHECK(memcmp(&frame[38], kHostIp, 4) == 0);
+    for (uint16_t i = 42; i < LINK_RESPONDER_MIN_FRAME_BYTES; i++) {
+        CHECK_EQ(0, frame[i]);
+    }
+}
+
+static void test_arp_not_for_us_is_ignored()
+{
+    uint8_t frame[LINK_RESPONDER_MAX_FRAME_BYTES];
+    uint8_t copy[LINK_RESPONDER_MAX_FRAME_BYTES];
+    uint16_t reply_length = 0;
+
+    uint16_t length = link_frames_arp_request(frame, kHostMac, kHostIp, kOtherIp);
+    memcpy(copy, frame, length);
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+    CHECK(memcmp(frame, copy, length) == 0);
+
+    // Replies (someone else answering) are not answered
+    length = link_frames_arp_request(frame, kHostMac, kHostIp, kOurIp);
+    frame[21] = 2;
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+
+    // Truncated before the target address
+    length = link_frames_arp_request(frame, kHostMac, kHostIp, kOurIp);
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, (uint16_t)(length - 1), &reply_length));
+}
+
+static void test_echo_request_becomes_reply()
+{
+    uint8_t frame[LINK_RESPONDER_MAX_FRAME_BYTES];
+    uint16_t length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 0x1234, 7, 56);
+    uint16_t reply_length = 0;
+
+    CHECK_EQ(98, length);
+    CHECK_EQ(LINK_RESPONDER_ECHO_REPLY, reply(frame, length, &reply_length));
+    CHECK_EQ(length, reply_length);
+
+    CHECK(memcmp(&frame[0], kHostMac, 6) == 0);
+    CHECK(memcmp(&frame[6], kOurMac, 6) == 0);
+
+    const uint8_t *ip = &frame[14];
+    CHECK(memcmp(&ip[12], kOurIp, 4) == 0);
+    CHECK(memcmp(&ip[16], kHostIp, 4) == 0);
+    CHECK_EQ(64, ip[8]);
+    CHECK_EQ(0, link_responder_checksum(ip, 20));
+
+    const uint8_t *icmp = &ip[20];
+    CHECK_EQ(0, icmp[0]);
+    CHECK_EQ(0x1234, get16(&icmp[4]));
+    CHECK_EQ(7, get16(&icmp[6]));
+    CHECK_EQ(0, link_responder_checksum(icmp, 64));
+    for (uint16_t i = 0; i < 56; i++) {
+        CHECK_EQ((uint8_t)i, icmp[8 + i]);
+    }
+}
+
+static void test_short_echo_reply_is_padded()
+{
+    uint8_t frame[LINK_RESPONDER_MAX_FRAME_BYTES];
+    uint16_t reply_length = 0;
+
+    // Ethernet padding on the request is not part of the echoed data
+    uint16_t length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 1, 1, 0);
+    memset(&frame[length], 0xEE, LINK_RESPONDER_MIN_FRAME_BYTES - length);
+    CHECK_EQ(LINK_RESPONDER_ECHO_REPLY, reply(frame, LINK_RESPONDER_MIN_FRAME_BYTES, &reply_length));
+    CHECK_EQ(LINK_RESPONDER_MIN_FRAME_BYTES, reply_length);
+    CHECK_EQ(0, link_responder_checksum(&frame[34], 8));
+    CHECK_EQ(0, frame[LINK_RESPONDER_MIN_FRAME_BYTES - 1]);
+}
+
+static void test_echo_requests_left_alone()
+{
+    static const uint8_t kBroadcastMac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t frame[LINK_RESPONDER_MAX_FRAME_BYTES];
+    uint16_t reply_length = 0;
+    uint16_t length;
+
+    // Broadcast ping and ping for another address
+    length = link_frames_echo_request(frame, kBroadcastMac, kHostMac, kHostIp, kOurIp, 1, 1, 32);
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+    length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOtherIp, 1, 1, 32);
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+
+    // Fragment (more-fragments set)
+    length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 1, 1, 32);
+    frame[20] |= 0x20;
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+
+    // Corrupt IPv4 header, corrupt ICMP data
+    length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 1, 1, 32);
+    frame[22] ^= 0x01;
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+    length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 1, 1, 32);
+    frame[length - 1] ^= 0x01;
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+
+    // Echo reply, IPv4 total length past the captured frame, IPv6
+    length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 1, 1, 32);
+    frame[34] = 0;
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+    length = link_frames_echo_request(frame, kOurMac, kHostMac, kHostIp, kOurIp, 1, 1, 32);
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, (uint16_t)(length - 1), &reply_length));
+    frame[12] = 0x86;
+    frame[13] = 0xDD;
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, length, &reply_length));
+
+    // Runt frame
+    CHECK_EQ(LINK_RESPONDER_NONE, reply(frame, 13, &reply_length));
+}
+
+int main()
+{
+    RUN_TEST(test_checksum_matches_rfc1071_example);
+    RUN_TEST(test_arp_request_for_us_becomes_reply);
+    RUN_TEST(test_arp_not_for_us_is_ignored);
+    RUN_TEST(test_echo_request_becomes_reply);
+    RUN_TEST(test_short_echo_reply_is_padded);
+    RUN_TEST(test_echo_requests_left_alone);
+    return TEST_RESULT();
+}
@@ -56,6 +56,8 @@ x/wx $link_latch_addr
 x/wx $connect_params_addr
 set $post_connect_addr = &g_w5500_post_connect_sr
 x/wx $post_connect_addr
+set $init_timing_addr = &g_w5500_init_timing
+x/wx $init_timing_addr
 monitor resume
 quit
 EOF_GDB
@@ -76,6 +78,7 @@ for _ in $(seq 1 15); do
       link_latch_hex="${vals[2]:-0x00000000}"
       connect_params_hex="${vals[3]:-0x00000000}"
       post_connect_hex="${vals[4]:-0x00000000}"
+      init_timing_hex="${vals[5]:-0x00000000}"
       break
     fi
   fi
@@ -95,6 +98,7 @@ fi
 
 connect_params_hex="${connect_params_hex:-0x00000000}"
 post_connect_hex="${post_connect_hex:-0x00000000}"
+init_timing_hex="${init_timing_hex:-0x00000000}"
 
 mailbox_dec=$((mailbox_hex))
 mb_magic=$(((mailbox_dec >> 24) & 0xFF))
@@ -203,6 +207,8 @@ elif [[ "$err_op" -eq 0x54 ]]; then
   echo "Hint: opcode 0x54 = runtime VERSIONR+PHYCFGR snapshot; code byte is VERSIONR, detail byte is current PHYCFGR." >&2
   printf '  VERSIONR decode: 0x%02X%s\n' "$err_code" "$([[ "$err_code" -eq 0x04 ]] && echo ' (expected for W5500)' || echo ' (unexpected)')"
   decode_phycfgr "$err_detail"
+elif [[ "$err_op" -eq 0x4F ]]; then
+  printf 'Hint: opcode 0x4F = W5500 bring-up complete; code=init profile (%s), detail=duration in 10 ms units (~%d ms).\n' "$([[ "$err_code" -eq 0 ]] && echo 'diagnostic' || echo 'fast')" "$((err_detail * 10))" >&2
 elif [[ "$err_op" -eq 0x67 ]]; then
   echo "Hint: opcode 0x67 = entered w5500_connect(); detail byte is socket index." >&2
 elif [[ "$err_op" -eq 0x68 ]]; then
@@ -298,3 +304,22 @@ elif [[ "$pc_magic" -eq 0xCE ]]; then
 else
   printf '  Status: unexpected magic 0x%02X (expected 0xCE).\n' "$pc_magic"
 fi
+
+# Decode init-timing latch.
+it_dec=$((init_timing_hex))
+it_magic=$(((it_dec >> 24) & 0xFF))
+it_profile=$(((it_dec >> 16) & 0xFF))
+it_ms=$((it_dec & 0xFFFF))
+printf '\nInit-timing latch raw: %s\n' "$init_timing_hex"
+if [[ "$it_dec" -eq 0 ]]; then
+  echo '  Status: NOT SET -- w5500_init() has not completed an attempt yet.'
+elif [[ "$it_magic" -eq 0xD7 ]]; then
+  case "$it_profile" in
+    0) echo '  Profile: diagnostic (scope-assist sequences enabled)' ;;
+    1) echo '  Profile: fast' ;;
+    *) printf '  Profile: unknown (%d)\n' "$it_profile" ;;
+  esac
+  printf '  Bring-up duration: %d ms%s\n' "$it_ms" "$([[ "$it_ms" -eq 65535 ]] && echo ' (capped)')"
+else
+  printf '  Status: unexpected magic 0x%02X (expected 0xD7).\n' "$it_magic"
+fi
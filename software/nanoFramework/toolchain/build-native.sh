@@ -160,8 +160,10 @@ elif [ "$MODE" = "build" ]; then
 fi
 
 if [ "$MODE" = "build" ] && [ -x "$CHECKSUM_TOOL" ]; then
+    # Takes the checksum from build/DiSEqC_Control/Cubley.Interop.pe when the managed
+    # build has produced one, so the firmware binds the assembly it will run.
     echo "Running interop checksum preflight..."
-    "$CHECKSUM_TOOL" --check
+    "$CHECKSUM_TOOL" --sync
 elif [ "$MODE" = "build" ]; then
     echo "Error: checksum preflight tool not found or not executable: $CHECKSUM_TOOL"
     exit 1
@@ -870,12 +872,28 @@ if [ "$ENABLE_CUBLEY_STACK" = "TRUE" ]; then
     cp "$NF_NATIVE_DIR/board_cubley.h" "$TARGET_DIR/"
     cp "$NF_NATIVE_DIR/board_cubley.h" "$TARGET_DIR/board.h"
     cp "$NF_NATIVE_DIR/board_cubley.cpp" "$TARGET_DIR/board.c"
+    cp "$NF_NATIVE_DIR/diseqc_frame.h" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_frame.cpp" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_queue.h" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_queue.cpp" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_rx.h" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_rx.cpp" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_sat_table.h" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_sat_table.cpp" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_usals.h" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_usals.cpp" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_motion.h" "$TARGET_DIR/common/"
+    cp "$NF_NATIVE_DIR/diseqc_motion.cpp" "$TARGET_DIR/common/"
     cp "$NF_NATIVE_DIR/diseqc_native.h" "$TARGET_DIR/common/"
     cp "$NF_NATIVE_DIR/diseqc_native.cpp" "$TARGET_DIR/common/"
     cp "$NF_NATIVE_DIR/lnbh26_native.h" "$TARGET_DIR/common/"
     cp "$NF_NATIVE_DIR/lnbh26_native.cpp" "$TARGET_DIR/common/"
     cp "$NF_NATIVE_DIR/cubley_interop.cpp" "$TARGET_DIR/nanoCLR/"
     cp "$NF_NATIVE_DIR/lnbh26_interop.cpp" "$TARGET_DIR/nanoCLR/"
+    cp "$NF_NATIVE_DIR/w5500_native.h" "$TARGET_DIR/nanoCLR/"
+    cp "$NF_NATIVE_DIR/w5500_native.cpp" "$TARGET_DIR/nanoCLR/"
+    cp "$NF_NATIVE_DIR/w5500_link_responder.h" "$TARGET_DIR/nanoCLR/"
+    cp "$NF_NATIVE_DIR/w5500_link_responder.cpp" "$TARGET_DIR/nanoCLR/"
     cp "$NF_NATIVE_DIR/w5500_interop.cpp" "$TARGET_DIR/nanoCLR/"
 fi
 
@@ -888,6 +906,8 @@ set(Cubley_Interop_INCLUDE_DIRS "${TARGET_DIR}/nanoCLR")
 set(Cubley_Interop_SOURCES
     "${TARGET_DIR}/nanoCLR/cubley_interop.cpp"
     "${TARGET_DIR}/nanoCLR/lnbh26_interop.cpp"
+    "${TARGET_DIR}/nanoCLR/w5500_native.cpp"
+    "${TARGET_DIR}/nanoCLR/w5500_link_responder.cpp"
     "${TARGET_DIR}/nanoCLR/w5500_interop.cpp")
 
 include(FindPackageHandleStandardArgs)
@@ -1369,6 +1389,12 @@ cat > "$TARGET_DIR/nanoCLR/CMakeLists.txt" << 'EOF_NANOCLR_CMAKE'
 #
 
 list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/main.c")
+list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/diseqc_frame.cpp")
+list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/diseqc_queue.cpp")
+list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/diseqc_rx.cpp")
+list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/diseqc_sat_table.cpp")
+list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/diseqc_usals.cpp")
+list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/diseqc_motion.cpp")
 list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/diseqc_native.cpp")
 list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/lnbh26_native.cpp")
 list(APPEND NANOCLR_PROJECT_SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/../common/Device_BlockStorage.c")
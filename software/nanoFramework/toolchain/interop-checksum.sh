@@ -11,19 +11,27 @@ ALLOWED_NATIVE_VERSION_FILE="$ASSEMBLY_INFO_PATH"
 
 MODE="check"
 PE_PATH="$DEFAULT_PE_PATH"
+ALLOW_STALE="false"
 
 usage() {
   cat <<'EOF'
 Usage:
-  ./toolchain/interop-checksum.sh [--check|--fix] [--pe /path/to/Cubley.Interop.pe]
+  ./toolchain/interop-checksum.sh [--check|--fix|--sync] [--allow-stale] [--pe /path/to/Cubley.Interop.pe]
 
 Modes:
   --check  Verify checksums are aligned. Fails on mismatch. (default)
   --fix    Read checksum from PE and update both source files.
+  --sync   --fix when the PE exists, then --check.
+
+Options:
+  --allow-stale  Warn instead of failing when slots were appended without a
+                 refresh (for the managed build, which is about to produce the PE).
 
 Notes:
   - PE checksum is read from CLR_RECORD_ASSEMBLY.nativeMethodsChecksum (offset 20).
   - In --check mode, if PE exists it is also compared against source values.
+  - The checksum comment in cubley_interop.cpp records the method_lookup slots
+    it covers; --check fails when slots were appended without a refresh.
 EOF
 }
 
@@ -37,6 +45,14 @@ while [[ $# -gt 0 ]]; do
       MODE="fix"
       shift
       ;;
+    --sync)
+      MODE="sync"
+      shift
+      ;;
+    --allow-stale)
+      ALLOW_STALE="true"
+      shift
+      ;;
     --pe)
       PE_PATH="${2:-}"
       shift 2
@@ -75,6 +91,17 @@ extract_native_checksum() {
     | tr '[:lower:]' '[:upper:]'
 }
 
+extract_native_covered_last_slot() {
+  sed -n '/g_CLR_AssemblyNative_Cubley_Interop/,/};/p' "$NATIVE_INTEROP_PATH" \
+    | sed -n 's/.*method_lookup\[0\.\.\([0-9][0-9]*\)\].*/\1/p' \
+    | head -n1
+}
+
+count_native_slots() {
+  sed -n '/method_lookup\[\] =/,/};/p' "$NATIVE_INTEROP_PATH" \
+    | grep -c '// \[[0-9][0-9]*\]'
+}
+
 extract_pe_checksum() {
   local pe="$1"
   python3 - <<'PYEOF' "$pe"
@@ -126,7 +153,9 @@ if [[ -z "$NATIVE_SUM" ]]; then
   exit 1
 fi
 
-if [[ "$MODE" == "fix" ]]; then
+SLOT_COUNT="$(count_native_slots)"
+
+if [[ "$MODE" == "fix" || ( "$MODE" == "sync" && -f "$PE_PATH" ) ]]; then
   if [[ ! -f "$PE_PATH" ]]; then
     echo "PE file not found: $PE_PATH" >&2
     echo "Build Cubley.Interop first, then rerun with --fix." >&2
@@ -137,11 +166,20 @@ if [[ "$MODE" == "fix" ]]; then
 
   sed -E -i 's/AssemblyNativeVersion\("[0-9A-Fa-f]{8}"\)/AssemblyNativeVersion("'"$PE_SUM"'")/' "$ASSEMBLY_INFO_PATH"
   perl -0777 -i -pe 's/(g_CLR_AssemblyNative_Cubley_Interop\s*=\s*\{\s*"Cubley\.Interop",\s*)0x[0-9A-Fa-f]{8}/${1}0x'"$PE_SUM"'/s' "$NATIVE_INTEROP_PATH"
+  perl -0777 -i -pe 's/(g_CLR_AssemblyNative_Cubley_Interop\s*=.*?method_lookup\[0\.\.)[0-9]+(\])/${1}'"$((SLOT_COUNT - 1))"'${2}/s' "$NATIVE_INTEROP_PATH"
 
-  echo "Updated checksums to $PE_SUM"
-  echo "  - $ASSEMBLY_INFO_PATH"
-  echo "  - $NATIVE_INTEROP_PATH"
-  exit 0
+  if [[ "$PE_SUM" != "$CS_SUM" || "$PE_SUM" != "$NATIVE_SUM" || "$MODE" == "fix" ]]; then
+    echo "Updated checksums to $PE_SUM"
+    echo "  - $ASSEMBLY_INFO_PATH"
+    echo "  - $NATIVE_INTEROP_PATH"
+  fi
+
+  if [[ "$MODE" == "fix" ]]; then
+    exit 0
+  fi
+
+  CS_SUM="$(extract_cs_checksum)"
+  NATIVE_SUM="$(extract_native_checksum)"
 fi
 
 if [[ "$CS_SUM" != "$NATIVE_SUM" ]]; then
@@ -151,6 +189,24 @@ if [[ "$CS_SUM" != "$NATIVE_SUM" ]]; then
   exit 1
 fi
 
+CHECK_RESULT="Checksum OK: $CS_SUM"
+COVERED_LAST_SLOT="$(extract_native_covered_last_slot)"
+if [[ -z "$COVERED_LAST_SLOT" ]]; then
+  echo "Unable to parse covered method_lookup range from the checksum comment in $NATIVE_INTEROP_PATH" >&2
+  exit 1
+fi
+
+if [[ "$((COVERED_LAST_SLOT + 1))" != "$SLOT_COUNT" ]]; then
+  echo "Stale checksum: $CS_SUM covers method_lookup[0..$COVERED_LAST_SLOT] but the table has $SLOT_COUNT slots." >&2
+  if [[ "$ALLOW_STALE" == "true" ]]; then
+    echo "Continuing: the checksum is refreshed from the Cubley.Interop.pe this build produces." >&2
+    CHECK_RESULT="Checksum stale (allowed): $CS_SUM"
+  else
+    echo "Build the managed solution first (./toolchain/build-managed.sh build); it refreshes the checksum from Cubley.Interop.pe." >&2
+    exit 1
+  fi
+fi
+
 if [[ -f "$PE_PATH" ]]; then
   PE_SUM="$(extract_pe_checksum "$PE_PATH")"
   if [[ "$PE_SUM" != "$CS_SUM" ]]; then
@@ -162,4 +218,4 @@ if [[ -f "$PE_PATH" ]]; then
   fi
 fi
 
-echo "Checksum OK: $CS_SUM"
+echo "$CHECK_RESULT"